@@ -1,5 +1,6 @@
 set(TARGETNAME_V2MPASM V2MPAsm)
 set(TARGETNAME_V2MPLINK V2MPLink)
+set(TARGETNAME_V2MPAOT V2MPAot)
 set(TARGETNAME_V2MPEXPLORER V2MPExplorer)
 set(TARGETNAME_LIBV2MP LibV2MP)
 set(TARGETNAME_LIBV2MPASM LibV2MPAsm)
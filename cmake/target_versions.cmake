@@ -9,3 +9,4 @@ set_version(LIBV2MPASM 1 0 0)
 set_version(LIBV2MPLINK 1 0 0)
 set_version(V2MPASM 1 0 0)
 set_version(V2MPLINK 1 0 0)
+set_version(V2MPAOT 1 0 0)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+namespace CmdArgs
+{
+	static constexpr const char* const INPUT_FILE = "input_file";
+	static constexpr const char* const OUTPUT_FILE = "--output_file";
+	static constexpr const char* const OUTPUT_FILE_SHORT = "-o";
+	static constexpr const char* const SOURCE_FILE = "--source_file";
+	static constexpr const char* const SOURCE_ONLY = "--source_only";
+	static constexpr const char* const COMPILER = "--compiler";
+
+	static constexpr const char* const DEFAULT_COMPILER = "cc";
+};
@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "V2MPAotArgumentParser.h"
+
+enum ReturnCode
+{
+	RETURN_OK = 0,
+	RETURN_ENCOUNTERED_WARNINGS,
+	RETURN_ENCOUNTERED_ERRORS,
+	RETURN_UNEXPECTED_ERROR = -1,
+};
+
+static std::vector<V2MP_Word> ReadCodeSegment(const std::string& inputFile)
+{
+	std::ifstream inStream(inputFile, std::ios::binary);
+
+	if ( !inStream.good() )
+	{
+		throw std::runtime_error("Could not open input file " + inputFile);
+	}
+
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(inStream)), std::istreambuf_iterator<char>());
+
+	if ( bytes.empty() || bytes.size() % sizeof(V2MP_Word) != 0 )
+	{
+		throw std::runtime_error("Input file " + inputFile + " does not contain a whole number of code words.");
+	}
+
+	// Object files hold code words in host byte order.
+	std::vector<V2MP_Word> words(bytes.size() / sizeof(V2MP_Word));
+	std::memcpy(words.data(), bytes.data(), bytes.size());
+
+	return words;
+}
+
+static void WriteSource(void* userData, const char* text)
+{
+	*static_cast<std::ofstream*>(userData) << text;
+}
+
+static void GenerateSource(const std::vector<V2MP_Word>& cs, const std::string& sourceFile)
+{
+	std::ofstream outStream(sourceFile, std::ios::trunc);
+
+	if ( !outStream.good() )
+	{
+		throw std::runtime_error("Could not open source file " + sourceFile + " for writing.");
+	}
+
+	if ( !V2MP_PrecompiledProgram_GenerateSource(cs.data(), cs.size(), &WriteSource, &outStream) )
+	{
+		throw std::runtime_error("Failed to generate source for precompiled program.");
+	}
+
+	outStream.close();
+
+	if ( outStream.fail() )
+	{
+		throw std::runtime_error("Failed to write source file " + sourceFile);
+	}
+}
+
+static ReturnCode CompileSource(const std::string& compiler, const std::string& sourceFile, const std::string& outputFile)
+{
+	const std::string command =
+		compiler + " -std=c99 -O2 -shared -fPIC -o \"" + outputFile + "\" \"" + sourceFile + "\"";
+
+	if ( std::system(command.c_str()) != 0 )
+	{
+		std::cerr << "Compiler command failed: " << command << std::endl;
+		return RETURN_ENCOUNTERED_ERRORS;
+	}
+
+	return RETURN_OK;
+}
+
+static ReturnCode GenerateOutput(const V2MPAotArgumentParser& parser)
+{
+	const std::vector<V2MP_Word> cs = ReadCodeSegment(parser.GetInputFile());
+	const std::string sourceFile = parser.GetSourceFile();
+
+	GenerateSource(cs, sourceFile);
+
+	return parser.GetSourceOnly()
+		? RETURN_OK
+		: CompileSource(parser.GetCompiler(), sourceFile, parser.GetOutputFile());
+}
+
+int main(int argc, char** argv)
+{
+	V2MPAotArgumentParser parser;
+
+	try
+	{
+		parser.Parse(argc, argv);
+	}
+	catch ( const std::runtime_error& ex )
+	{
+		std::cerr << ex.what() << std::endl;
+		parser.PrintHelp(std::cerr);
+		std::cerr << std::endl;
+
+		return RETURN_UNEXPECTED_ERROR;
+	}
+	catch ( ... )
+	{
+		std::cerr << "Encountered an unhandled exception." << std::endl;
+		return RETURN_UNEXPECTED_ERROR;
+	}
+
+	try
+	{
+		return GenerateOutput(parser);
+	}
+	catch ( const std::runtime_error& ex )
+	{
+		std::cerr << "ERROR: " << ex.what() << std::endl;
+		return RETURN_UNEXPECTED_ERROR;
+	}
+	catch ( ... )
+	{
+		std::cerr << "Encountered an unhandled exception." << std::endl;
+		return RETURN_UNEXPECTED_ERROR;
+	}
+}
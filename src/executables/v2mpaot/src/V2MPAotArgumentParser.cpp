@@ -0,0 +1,136 @@
+#include <string>
+#include "V2MPAotArgumentParser.h"
+#include "argparse/argparse.hpp"
+#include "Version.gen.h"
+#include "LibV2MP/Version.h"
+#include "CommandLineArgs.h"
+
+class V2MPAotArgumentParser::Impl
+{
+public:
+	Impl() :
+		m_Parser("V2MPAot", VERSION_STRING)
+	{
+		m_Parser.add_description(
+			"Frontend " + std::string(VERSION_STRING) +
+			", Lib: " + std::string(V2MP_Version_GetVersionString())
+		);
+
+		AddCommandLineArgs();
+	}
+
+	argparse::ArgumentParser& GetParser()
+	{
+		return m_Parser;
+	}
+
+	const argparse::ArgumentParser& GetParser() const
+	{
+		return m_Parser;
+	}
+
+	void Parse(int argc, char** argv)
+	{
+		m_Parser.parse_known_args(argc, argv);
+		ValidateArgs();
+	}
+
+	void PrintHelp(std::ostream& stream)
+	{
+		stream << m_Parser;
+	}
+
+private:
+	void AddCommandLineArgs()
+	{
+		m_Parser
+			.add_argument(CmdArgs::INPUT_FILE)
+			.help("Input object file, containing the program's code segment.");
+
+		m_Parser
+			.add_argument(CmdArgs::OUTPUT_FILE_SHORT, CmdArgs::OUTPUT_FILE)
+			.help("Output shared library to create.")
+			.required();
+
+		m_Parser
+			.add_argument(CmdArgs::SOURCE_FILE)
+			.help("C source file to generate. Defaults to the output file name with \".c\" appended.")
+			.default_value(std::string());
+
+		m_Parser
+			.add_argument(CmdArgs::SOURCE_ONLY)
+			.help("Only generate the C source file, and do not compile it.")
+			.default_value(false)
+			.implicit_value(true);
+
+		m_Parser
+			.add_argument(CmdArgs::COMPILER)
+			.help("C compiler used to build the shared library. Must accept GCC-style arguments.")
+			.default_value(std::string(CmdArgs::DEFAULT_COMPILER));
+	}
+
+	void ValidateArgs()
+	{
+		if ( m_Parser.get<std::string>(CmdArgs::INPUT_FILE).empty() )
+		{
+			throw std::runtime_error("No input file specified.");
+		}
+
+		if ( m_Parser.get<std::string>(CmdArgs::OUTPUT_FILE).empty() )
+		{
+			throw std::runtime_error("No output file specified.");
+		}
+
+		if ( m_Parser.get<std::string>(CmdArgs::COMPILER).empty() )
+		{
+			throw std::runtime_error("No compiler specified.");
+		}
+	}
+
+	argparse::ArgumentParser m_Parser;
+};
+
+V2MPAotArgumentParser::V2MPAotArgumentParser() noexcept :
+	m_Impl(std::make_unique<Impl>())
+{
+}
+
+V2MPAotArgumentParser::~V2MPAotArgumentParser() noexcept
+{
+}
+
+void V2MPAotArgumentParser::PrintHelp(std::ostream& stream) const
+{
+	m_Impl->PrintHelp(stream);
+}
+
+void V2MPAotArgumentParser::Parse(int argc, char** argv)
+{
+	m_Impl->Parse(argc, argv);
+}
+
+std::string V2MPAotArgumentParser::GetInputFile() const
+{
+	return m_Impl->GetParser().get<std::string>(CmdArgs::INPUT_FILE);
+}
+
+std::string V2MPAotArgumentParser::GetOutputFile() const
+{
+	return m_Impl->GetParser().get<std::string>(CmdArgs::OUTPUT_FILE);
+}
+
+std::string V2MPAotArgumentParser::GetSourceFile() const
+{
+	const std::string sourceFile = m_Impl->GetParser().get<std::string>(CmdArgs::SOURCE_FILE);
+	return sourceFile.empty() ? GetOutputFile() + ".c" : sourceFile;
+}
+
+std::string V2MPAotArgumentParser::GetCompiler() const
+{
+	return m_Impl->GetParser().get<std::string>(CmdArgs::COMPILER);
+}
+
+bool V2MPAotArgumentParser::GetSourceOnly() const
+{
+	return m_Impl->GetParser().get<bool>(CmdArgs::SOURCE_ONLY);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+#include <memory>
+
+class V2MPAotArgumentParser
+{
+public:
+	V2MPAotArgumentParser() noexcept;
+	~V2MPAotArgumentParser() noexcept;
+
+	void PrintHelp(std::ostream& stream) const;
+	void Parse(int argc, char** argv);
+
+	std::string GetInputFile() const;
+	std::string GetOutputFile() const;
+	std::string GetSourceFile() const;
+	std::string GetCompiler() const;
+	bool GetSourceOnly() const;
+
+private:
+	class Impl;
+
+	std::unique_ptr<Impl> m_Impl;
+};
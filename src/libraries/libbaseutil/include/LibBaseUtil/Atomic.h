@@ -0,0 +1,96 @@
+#ifndef BASEUTIL_ATOMIC_H
+#define BASEUTIL_ATOMIC_H
+
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C99 has no atomics, so these wrap the compiler's intrinsics. All operations
+// are sequentially consistent, which is more than enough for reference counts
+// and for publishing pointers between threads.
+
+static inline size_t BaseUtil_Atomic_IncrementSize(size_t* value)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (size_t)_InterlockedIncrement64((volatile __int64*)value);
+#elif defined(_MSC_VER)
+	return (size_t)_InterlockedIncrement((volatile long*)value);
+#else
+	return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline size_t BaseUtil_Atomic_DecrementSize(size_t* value)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (size_t)_InterlockedDecrement64((volatile __int64*)value);
+#elif defined(_MSC_VER)
+	return (size_t)_InterlockedDecrement((volatile long*)value);
+#else
+	return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns the value before the addition.
+static inline size_t BaseUtil_Atomic_FetchAddSize(size_t* value, size_t amount)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (size_t)_InterlockedExchangeAdd64((volatile __int64*)value, (__int64)amount);
+#elif defined(_MSC_VER)
+	return (size_t)_InterlockedExchangeAdd((volatile long*)value, (long)amount);
+#else
+	return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline size_t BaseUtil_Atomic_LoadSize(const size_t* value)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (size_t)_InterlockedCompareExchange64((volatile __int64*)value, 0, 0);
+#elif defined(_MSC_VER)
+	return (size_t)_InterlockedCompareExchange((volatile long*)value, 0, 0);
+#else
+	return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void BaseUtil_Atomic_StoreSize(size_t* value, size_t newValue)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	_InterlockedExchange64((volatile __int64*)value, (__int64)newValue);
+#elif defined(_MSC_VER)
+	_InterlockedExchange((volatile long*)value, (long)newValue);
+#else
+	__atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void* BaseUtil_Atomic_LoadPtr(void* const* ptr)
+{
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchangePointer((void* volatile*)ptr, NULL, NULL);
+#else
+	return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void BaseUtil_Atomic_StorePtr(void** ptr, void* newValue)
+{
+#if defined(_MSC_VER)
+	_InterlockedExchangePointer((void* volatile*)ptr, newValue);
+#else
+	__atomic_store_n(ptr, newValue, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // BASEUTIL_ATOMIC_H
@@ -2,20 +2,36 @@
 #define BASEUTIL_HEAP_H
 
 #include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Flags for BaseUtil_Heap_MapPages().
+// Requests that anonymous memory be backed by huge pages where the system supports it.
+#define BASEUTIL_MAP_HUGE_PAGES (1 << 0)
+
 typedef struct BaseUtil_HeapFunctions
 {
 	void* (*mallocFunc)(size_t);
 	void* (*reallocFunc)(void*, size_t);
 	void* (*callocFunc)(size_t, size_t);
 	void  (*freeFunc)(void*);
+
+	// For large allocations that are mapped from the system in whole pages.
+	// Unmapping is always given the same size and flags that were used for mapping.
+	void* (*mapPagesFunc)(size_t, const char*, unsigned int);
+	void  (*unmapPagesFunc)(void*, size_t, unsigned int);
 } BaseUtil_HeapFunctions;
 
-void BaseUtil_Heap_SetHeapFunctions(BaseUtil_HeapFunctions functions);
+// Any functions that are NULL are replaced with the defaults. A free function must
+// be given if and only if any allocation function is, and likewise for the map and
+// unmap functions: otherwise, false is returned and the functions are not changed.
+// Setting or resetting the functions is not supported while other threads are
+// using the heap. Memory must be freed by the same functions that allocated it,
+// so the functions should be set before anything is allocated.
+bool BaseUtil_Heap_SetHeapFunctions(BaseUtil_HeapFunctions functions);
 void BaseUtil_Heap_ResetHeapFunctions(void);
 
 void* BaseUtil_Heap_Malloc(size_t size);
@@ -23,10 +39,20 @@ void* BaseUtil_Heap_Realloc(void* ptr, size_t newSize);
 void* BaseUtil_Heap_Calloc(size_t numElements, size_t elementSize);
 void BaseUtil_Heap_Free(void* ptr);
 
+// If filePath is NULL, maps anonymous memory that is filled with zeroes.
+// Otherwise, maps the given file as shared memory, so that writes to the
+// memory are written to the file. The file is created if it does not exist,
+// and extended with zeroes if it is smaller than the requested size.
+// Returns NULL if the memory could not be mapped.
+void* BaseUtil_Heap_MapPages(size_t size, const char* filePath, unsigned int flags);
+void BaseUtil_Heap_UnmapPages(void* ptr, size_t size, unsigned int flags);
+
 #define BASEUTIL_MALLOC(size) BaseUtil_Heap_Malloc(size)
 #define BASEUTIL_REALLOC(ptr, newSize) BaseUtil_Heap_Realloc(ptr, newSize)
 #define BASEUTIL_CALLOC(numElements, elementSize) BaseUtil_Heap_Calloc(numElements, elementSize)
 #define BASEUTIL_FREE(ptr) BaseUtil_Heap_Free(ptr)
+#define BASEUTIL_MAP_PAGES(size, filePath, flags) BaseUtil_Heap_MapPages(size, filePath, flags)
+#define BASEUTIL_UNMAP_PAGES(ptr, size, flags) BaseUtil_Heap_UnmapPages(ptr, size, flags)
 
 #define BASEUTIL_MALLOC_STRUCT(structType) ((structType*)BASEUTIL_MALLOC(sizeof(structType)))
 #define BASEUTIL_CALLOC_STRUCT(structType) ((structType*)BASEUTIL_CALLOC(1, sizeof(structType)))
@@ -0,0 +1,54 @@
+#ifndef BASEUTIL_THREAD_H
+#define BASEUTIL_THREAD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BaseUtil_Thread BaseUtil_Thread;
+typedef struct BaseUtil_Mutex BaseUtil_Mutex;
+typedef struct BaseUtil_CondVar BaseUtil_CondVar;
+
+typedef void (*BaseUtil_ThreadFunc)(void* userData);
+
+// Starts a thread that calls the given function. Returns NULL if the thread
+// could not be started. Every thread that is started must be joined.
+BaseUtil_Thread* BaseUtil_Thread_Start(BaseUtil_ThreadFunc func, void* userData);
+
+// Waits for the thread's function to return, and then frees the thread.
+void BaseUtil_Thread_Join(BaseUtil_Thread* thread);
+
+// Returns the number of processors available to run threads on, which is always at least 1.
+size_t BaseUtil_Thread_GetProcessorCount(void);
+
+BaseUtil_Mutex* BaseUtil_Mutex_AllocateAndInit(void);
+void BaseUtil_Mutex_DeinitAndFree(BaseUtil_Mutex* mutex);
+
+// For placing a mutex in memory owned by the caller, such as next to the data
+// it protects. The memory must be at least BaseUtil_Mutex_GetSize() bytes, and
+// aligned as for any built-in type. Returns NULL if the mutex could not be
+// initialised. A mutex initialised in place must be deinitialised with
+// BaseUtil_Mutex_Deinit(), rather than freed.
+size_t BaseUtil_Mutex_GetSize(void);
+BaseUtil_Mutex* BaseUtil_Mutex_InitInPlace(void* memory);
+void BaseUtil_Mutex_Deinit(BaseUtil_Mutex* mutex);
+void BaseUtil_Mutex_Lock(BaseUtil_Mutex* mutex);
+void BaseUtil_Mutex_Unlock(BaseUtil_Mutex* mutex);
+
+BaseUtil_CondVar* BaseUtil_CondVar_AllocateAndInit(void);
+void BaseUtil_CondVar_DeinitAndFree(BaseUtil_CondVar* condVar);
+
+// The mutex must be locked by the calling thread. It is unlocked while waiting,
+// and locked again before returning. Wakeups may be spurious, so the condition
+// being waited for must always be checked again after this returns.
+void BaseUtil_CondVar_Wait(BaseUtil_CondVar* condVar, BaseUtil_Mutex* mutex);
+void BaseUtil_CondVar_Broadcast(BaseUtil_CondVar* condVar);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // BASEUTIL_THREAD_H
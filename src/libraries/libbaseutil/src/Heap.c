@@ -1,5 +1,26 @@
+#if !defined(_WIN32)
+// Required for anonymous and huge page mappings, which are not part of C99.
+#define _DEFAULT_SOURCE
+#endif
+
 #include <stdlib.h>
 #include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Atomic.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(MAP_HUGETLB)
+// Huge page mappings must be a whole number of huge pages in size.
+// This is the most common huge page size on Linux.
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#endif
 
 // According to Windows, functions like malloc() are dllimported, so they don't
 // necessarily have a static address. Instead, we have to wrap them.
@@ -24,16 +45,201 @@ static void LocalFree(void* ptr)
 	free(ptr);
 }
 
-BaseUtil_HeapFunctions LocalHeapFunctions =
+#if defined(_WIN32)
+
+static void* MapFile(size_t size, const char* filePath)
+{
+	HANDLE file;
+	HANDLE mapping;
+	void* view = NULL;
+
+	file = CreateFileA(filePath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		return NULL;
+	}
+
+	// This extends the file if it is smaller than the mapping.
+	mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), NULL);
+
+	if ( mapping )
+	{
+		view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+		CloseHandle(mapping);
+	}
+
+	// The view keeps the file open for as long as it is mapped.
+	CloseHandle(file);
+	return view;
+}
+
+static void* LocalMapPages(size_t size, const char* filePath, unsigned int flags)
+{
+	// Large pages require the process to hold a privilege that
+	// it usually does not, so they are not requested here.
+	(void)flags;
+
+	if ( size < 1 )
+	{
+		return NULL;
+	}
+
+	if ( filePath )
+	{
+		return MapFile(size, filePath);
+	}
+
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+static void LocalUnmapPages(void* ptr, size_t size, unsigned int flags)
+{
+	MEMORY_BASIC_INFORMATION info;
+
+	(void)size;
+	(void)flags;
+
+	if ( VirtualQuery(ptr, &info, sizeof(info)) == sizeof(info) && info.Type == MEM_MAPPED )
+	{
+		UnmapViewOfFile(ptr);
+	}
+	else
+	{
+		VirtualFree(ptr, 0, MEM_RELEASE);
+	}
+}
+
+#else
+
+static size_t GetMappingSize(size_t size, unsigned int flags)
+{
+#if defined(MAP_HUGETLB)
+	if ( flags & BASEUTIL_MAP_HUGE_PAGES )
+	{
+		return ((size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+	}
+#else
+	(void)flags;
+#endif
+
+	return size;
+}
+
+static void* MapFile(size_t size, const char* filePath)
+{
+	int fd;
+	struct stat fileStat;
+	void* ptr;
+
+	fd = open(filePath, O_RDWR | O_CREAT, 0644);
+
+	if ( fd < 0 )
+	{
+		return NULL;
+	}
+
+	// Extending the file fills it with zeroes. A larger file is left as it is.
+	if ( fstat(fd, &fileStat) != 0 ||
+	     ((size_t)fileStat.st_size < size && ftruncate(fd, (off_t)size) != 0) )
+	{
+		close(fd);
+		return NULL;
+	}
+
+	ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	// The mapping keeps the file open for as long as it exists.
+	close(fd);
+	return ptr != MAP_FAILED ? ptr : NULL;
+}
+
+static void* MapAnonymous(size_t size, unsigned int flags)
+{
+	void* ptr = MAP_FAILED;
+
+	size = GetMappingSize(size, flags);
+
+#if defined(MAP_HUGETLB)
+	// This only succeeds if the system has reserved huge pages.
+	if ( flags & BASEUTIL_MAP_HUGE_PAGES )
+	{
+		ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+#endif
+
+	if ( ptr == MAP_FAILED )
+	{
+		ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if ( ptr == MAP_FAILED )
+		{
+			return NULL;
+		}
+
+#if defined(MADV_HUGEPAGE)
+		// Otherwise, ask for transparent huge pages. This is only advice,
+		// so it does not matter if it is not followed.
+		if ( flags & BASEUTIL_MAP_HUGE_PAGES )
+		{
+			madvise(ptr, size, MADV_HUGEPAGE);
+		}
+#endif
+	}
+
+	return ptr;
+}
+
+static void* LocalMapPages(size_t size, const char* filePath, unsigned int flags)
+{
+	if ( size < 1 )
+	{
+		return NULL;
+	}
+
+	return filePath ? MapFile(size, filePath) : MapAnonymous(size, flags);
+}
+
+static void LocalUnmapPages(void* ptr, size_t size, unsigned int flags)
+{
+	munmap(ptr, GetMappingSize(size, flags));
+}
+
+#endif
+
+static BaseUtil_HeapFunctions DefaultHeapFunctions =
 {
 	&LocalMalloc,
 	&LocalRealloc,
 	&LocalCalloc,
-	&LocalFree
+	&LocalFree,
+	&LocalMapPages,
+	&LocalUnmapPages
 };
 
-void BaseUtil_Heap_SetHeapFunctions(BaseUtil_HeapFunctions functions)
+// Heap calls only read the active table, so any number of threads may make
+// them at once. Setting the functions overwrites the custom table in place,
+// so is not supported while other threads are using the heap.
+static BaseUtil_HeapFunctions CustomHeapFunctions;
+
+static void* ActiveHeapFunctions = &DefaultHeapFunctions;
+
+static inline const BaseUtil_HeapFunctions* GetHeapFunctions(void)
+{
+	return (const BaseUtil_HeapFunctions*)BaseUtil_Atomic_LoadPtr(&ActiveHeapFunctions);
+}
+
+bool BaseUtil_Heap_SetHeapFunctions(BaseUtil_HeapFunctions functions)
 {
+	const bool customAlloc = functions.mallocFunc || functions.reallocFunc || functions.callocFunc;
+
+	// Memory must be freed or unmapped by the counterpart of whatever allocated it.
+	if ( customAlloc != (functions.freeFunc != NULL) ||
+	     (functions.mapPagesFunc != NULL) != (functions.unmapPagesFunc != NULL) )
+	{
+		return false;
+	}
+
 	if ( !functions.mallocFunc )
 	{
 		functions.mallocFunc = &LocalMalloc;
@@ -54,31 +260,53 @@ void BaseUtil_Heap_SetHeapFunctions(BaseUtil_HeapFunctions functions)
 		functions.freeFunc = &LocalFree;
 	}
 
-	LocalHeapFunctions = functions;
+	if ( !functions.mapPagesFunc )
+	{
+		functions.mapPagesFunc = &LocalMapPages;
+	}
+
+	if ( !functions.unmapPagesFunc )
+	{
+		functions.unmapPagesFunc = &LocalUnmapPages;
+	}
+
+	CustomHeapFunctions = functions;
+	BaseUtil_Atomic_StorePtr(&ActiveHeapFunctions, &CustomHeapFunctions);
+
+	return true;
 }
 
 void BaseUtil_Heap_ResetHeapFunctions(void)
 {
-	BaseUtil_HeapFunctions functions = { NULL, NULL, NULL, NULL };
-	BaseUtil_Heap_SetHeapFunctions(functions);
+	BaseUtil_Atomic_StorePtr(&ActiveHeapFunctions, &DefaultHeapFunctions);
 }
 
 void* BaseUtil_Heap_Malloc(size_t size)
 {
-	return LocalHeapFunctions.mallocFunc(size);
+	return GetHeapFunctions()->mallocFunc(size);
 }
 
 void* BaseUtil_Heap_Realloc(void* ptr, size_t newSize)
 {
-	return LocalHeapFunctions.reallocFunc(ptr, newSize);
+	return GetHeapFunctions()->reallocFunc(ptr, newSize);
 }
 
 void* BaseUtil_Heap_Calloc(size_t numElements, size_t elementSize)
 {
-	return LocalHeapFunctions.callocFunc(numElements, elementSize);
+	return GetHeapFunctions()->callocFunc(numElements, elementSize);
 }
 
 void BaseUtil_Heap_Free(void* ptr)
 {
-	LocalHeapFunctions.freeFunc(ptr);
+	GetHeapFunctions()->freeFunc(ptr);
+}
+
+void* BaseUtil_Heap_MapPages(size_t size, const char* filePath, unsigned int flags)
+{
+	return GetHeapFunctions()->mapPagesFunc(size, filePath, flags);
+}
+
+void BaseUtil_Heap_UnmapPages(void* ptr, size_t size, unsigned int flags)
+{
+	GetHeapFunctions()->unmapPagesFunc(ptr, size, flags);
 }
@@ -0,0 +1,315 @@
+#if !defined(_WIN32)
+// Required for querying the number of processors, which is not part of C99.
+#define _DEFAULT_SOURCE
+#endif
+
+#include "LibBaseUtil/Thread.h"
+#include "LibBaseUtil/Heap.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+struct BaseUtil_Thread
+{
+	HANDLE handle;
+	BaseUtil_ThreadFunc func;
+	void* userData;
+};
+
+struct BaseUtil_Mutex
+{
+	SRWLOCK lock;
+};
+
+struct BaseUtil_CondVar
+{
+	CONDITION_VARIABLE condVar;
+};
+
+static DWORD WINAPI ThreadEntryPoint(LPVOID param)
+{
+	BaseUtil_Thread* thread = (BaseUtil_Thread*)param;
+
+	thread->func(thread->userData);
+	return 0;
+}
+
+BaseUtil_Thread* BaseUtil_Thread_Start(BaseUtil_ThreadFunc func, void* userData)
+{
+	BaseUtil_Thread* thread;
+
+	if ( !func )
+	{
+		return NULL;
+	}
+
+	thread = BASEUTIL_CALLOC_STRUCT(BaseUtil_Thread);
+
+	if ( !thread )
+	{
+		return NULL;
+	}
+
+	thread->func = func;
+	thread->userData = userData;
+	thread->handle = CreateThread(NULL, 0, &ThreadEntryPoint, thread, 0, NULL);
+
+	if ( !thread->handle )
+	{
+		BASEUTIL_FREE(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void BaseUtil_Thread_Join(BaseUtil_Thread* thread)
+{
+	if ( !thread )
+	{
+		return;
+	}
+
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	BASEUTIL_FREE(thread);
+}
+
+size_t BaseUtil_Thread_GetProcessorCount(void)
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+}
+
+BaseUtil_Mutex* BaseUtil_Mutex_InitInPlace(void* memory)
+{
+	BaseUtil_Mutex* mutex = (BaseUtil_Mutex*)memory;
+
+	if ( mutex )
+	{
+		InitializeSRWLock(&mutex->lock);
+	}
+
+	return mutex;
+}
+
+void BaseUtil_Mutex_Deinit(BaseUtil_Mutex* mutex)
+{
+	// SRW locks do not need to be destroyed.
+	(void)mutex;
+}
+
+void BaseUtil_Mutex_Lock(BaseUtil_Mutex* mutex)
+{
+	AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void BaseUtil_Mutex_Unlock(BaseUtil_Mutex* mutex)
+{
+	ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+BaseUtil_CondVar* BaseUtil_CondVar_AllocateAndInit(void)
+{
+	BaseUtil_CondVar* condVar = BASEUTIL_CALLOC_STRUCT(BaseUtil_CondVar);
+
+	if ( condVar )
+	{
+		InitializeConditionVariable(&condVar->condVar);
+	}
+
+	return condVar;
+}
+
+void BaseUtil_CondVar_DeinitAndFree(BaseUtil_CondVar* condVar)
+{
+	// Condition variables do not need to be destroyed.
+	if ( condVar )
+	{
+		BASEUTIL_FREE(condVar);
+	}
+}
+
+void BaseUtil_CondVar_Wait(BaseUtil_CondVar* condVar, BaseUtil_Mutex* mutex)
+{
+	SleepConditionVariableSRW(&condVar->condVar, &mutex->lock, INFINITE, 0);
+}
+
+void BaseUtil_CondVar_Broadcast(BaseUtil_CondVar* condVar)
+{
+	WakeAllConditionVariable(&condVar->condVar);
+}
+
+#else
+
+struct BaseUtil_Thread
+{
+	pthread_t handle;
+	BaseUtil_ThreadFunc func;
+	void* userData;
+};
+
+struct BaseUtil_Mutex
+{
+	pthread_mutex_t mutex;
+};
+
+struct BaseUtil_CondVar
+{
+	pthread_cond_t condVar;
+};
+
+static void* ThreadEntryPoint(void* param)
+{
+	BaseUtil_Thread* thread = (BaseUtil_Thread*)param;
+
+	thread->func(thread->userData);
+	return NULL;
+}
+
+BaseUtil_Thread* BaseUtil_Thread_Start(BaseUtil_ThreadFunc func, void* userData)
+{
+	BaseUtil_Thread* thread;
+
+	if ( !func )
+	{
+		return NULL;
+	}
+
+	thread = BASEUTIL_CALLOC_STRUCT(BaseUtil_Thread);
+
+	if ( !thread )
+	{
+		return NULL;
+	}
+
+	thread->func = func;
+	thread->userData = userData;
+
+	if ( pthread_create(&thread->handle, NULL, &ThreadEntryPoint, thread) != 0 )
+	{
+		BASEUTIL_FREE(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void BaseUtil_Thread_Join(BaseUtil_Thread* thread)
+{
+	if ( !thread )
+	{
+		return;
+	}
+
+	pthread_join(thread->handle, NULL);
+	BASEUTIL_FREE(thread);
+}
+
+size_t BaseUtil_Thread_GetProcessorCount(void)
+{
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (size_t)count : 1;
+}
+
+BaseUtil_Mutex* BaseUtil_Mutex_InitInPlace(void* memory)
+{
+	BaseUtil_Mutex* mutex = (BaseUtil_Mutex*)memory;
+
+	if ( mutex && pthread_mutex_init(&mutex->mutex, NULL) != 0 )
+	{
+		mutex = NULL;
+	}
+
+	return mutex;
+}
+
+void BaseUtil_Mutex_Deinit(BaseUtil_Mutex* mutex)
+{
+	if ( mutex )
+	{
+		pthread_mutex_destroy(&mutex->mutex);
+	}
+}
+
+void BaseUtil_Mutex_Lock(BaseUtil_Mutex* mutex)
+{
+	pthread_mutex_lock(&mutex->mutex);
+}
+
+void BaseUtil_Mutex_Unlock(BaseUtil_Mutex* mutex)
+{
+	pthread_mutex_unlock(&mutex->mutex);
+}
+
+BaseUtil_CondVar* BaseUtil_CondVar_AllocateAndInit(void)
+{
+	BaseUtil_CondVar* condVar = BASEUTIL_CALLOC_STRUCT(BaseUtil_CondVar);
+
+	if ( condVar && pthread_cond_init(&condVar->condVar, NULL) != 0 )
+	{
+		BASEUTIL_FREE(condVar);
+		condVar = NULL;
+	}
+
+	return condVar;
+}
+
+void BaseUtil_CondVar_DeinitAndFree(BaseUtil_CondVar* condVar)
+{
+	if ( condVar )
+	{
+		pthread_cond_destroy(&condVar->condVar);
+		BASEUTIL_FREE(condVar);
+	}
+}
+
+void BaseUtil_CondVar_Wait(BaseUtil_CondVar* condVar, BaseUtil_Mutex* mutex)
+{
+	pthread_cond_wait(&condVar->condVar, &mutex->mutex);
+}
+
+void BaseUtil_CondVar_Broadcast(BaseUtil_CondVar* condVar)
+{
+	pthread_cond_broadcast(&condVar->condVar);
+}
+
+#endif
+
+// These are the same on every platform.
+
+size_t BaseUtil_Mutex_GetSize(void)
+{
+	return sizeof(BaseUtil_Mutex);
+}
+
+BaseUtil_Mutex* BaseUtil_Mutex_AllocateAndInit(void)
+{
+	BaseUtil_Mutex* mutex = BASEUTIL_CALLOC_STRUCT(BaseUtil_Mutex);
+
+	if ( mutex && !BaseUtil_Mutex_InitInPlace(mutex) )
+	{
+		BASEUTIL_FREE(mutex);
+		mutex = NULL;
+	}
+
+	return mutex;
+}
+
+void BaseUtil_Mutex_DeinitAndFree(BaseUtil_Mutex* mutex)
+{
+	if ( mutex )
+	{
+		BaseUtil_Mutex_Deinit(mutex);
+		BASEUTIL_FREE(mutex);
+	}
+}
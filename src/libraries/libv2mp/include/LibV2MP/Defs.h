@@ -1,6 +1,7 @@
 #ifndef V2MPINTERNAL_DEFS_H
 #define V2MPINTERNAL_DEFS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef uint16_t V2MP_Word;
@@ -41,7 +42,11 @@ typedef enum V2MP_Fault
 
 typedef enum V2MP_SignalCode
 {
-	V2MP_SIGNAL_END_PROGRAM = 0x0000
+	V2MP_SIGNAL_END_PROGRAM = 0x0000,
+	V2MP_SIGNAL_SWAP_DATA_PAGE = 0x0001,
+	V2MP_SIGNAL_COPY_DS_BLOCK = 0x0002,
+	V2MP_SIGNAL_FILL_DS_BLOCK = 0x0003,
+	V2MP_SIGNAL_COPY_DS_BLOCK_TO_SS = 0x0004
 } V2MP_SignalCode;
 
 typedef enum V2MP_RegisterIndex
@@ -60,6 +65,21 @@ typedef enum V2MP_BitwiseOp
 	V2MP_BITOP_NOT = 0x3
 } V2MP_BitwiseOp;
 
+typedef enum V2MP_RunStopReason
+{
+	V2MP_RUNSTOP_CYCLE_LIMIT = 0x0,
+	V2MP_RUNSTOP_PROGRAM_EXITED = 0x1,
+	V2MP_RUNSTOP_FAULT = 0x2
+} V2MP_RunStopReason;
+
+typedef struct V2MP_RunResult
+{
+	// Number of clock cycles that were executed during the run,
+	// including the cycle on which a fault was raised (if any).
+	size_t cyclesExecuted;
+	V2MP_RunStopReason stopReason;
+} V2MP_RunResult;
+
 #define V2MP_REGID_MAX 3
 #define V2MP_REGID_MASK(val) ((val) & V2MP_REGID_MAX)
 
@@ -2,6 +2,7 @@
 #define V2MPINTERNAL_MODULES_CPU_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "LibV2MP/LibExport.gen.h"
 #include "LibV2MP/Defs.h"
 
@@ -22,9 +23,24 @@ typedef struct V2MP_CPU_SupervisorInterface
 	void (*requestStackPush)(void* supervisor, V2MP_Word regFlags);
 	void (*requestStackPop)(void* supervisor, V2MP_Word regFlags);
 
+	// Optional immediate forms of the LDST and STK requests above. If these are
+	// set, the CPU uses them to access memory within the same clock cycle, and
+	// each returns a fault word indicating the result. If they are not set, the
+	// request functions are used instead, and the supervisor resolves the
+	// request once the clock cycle has completed.
+	V2MP_Word (*loadWordFromDS)(void* supervisor, V2MP_Word address, V2MP_Word* outWord);
+	V2MP_Word (*storeWordToDS)(void* supervisor, V2MP_Word address, V2MP_Word wordToStore);
+	V2MP_Word (*pushWordsToStack)(void* supervisor, const V2MP_Word* words, size_t numWords);
+	V2MP_Word (*popWordsFromStack)(void* supervisor, V2MP_Word* outWords, size_t numWords);
+
 	// SIG
 	void (*raiseSignal)(void* supervisor, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr, V2MP_Word sp);
 
+	// Called by V2MP_CPU_Run() after each clock cycle. Returns false if the
+	// supervisor encountered an error. outProgramExited is set to true if
+	// the program has exited and the CPU should stop running.
+	bool (*completeClockCycle)(void* supervisor, bool* outProgramExited);
+
 } V2MP_CPU_SupervisorInterface;
 
 LIBV2MP_PUBLIC(V2MP_CPU*) V2MP_CPU_AllocateAndInit(void);
@@ -36,6 +52,39 @@ LIBV2MP_PUBLIC(void) V2MP_CPU_ResetSupervisorInterface(V2MP_CPU* cpu);
 LIBV2MP_PUBLIC(void) V2MP_CPU_Reset(V2MP_CPU* cpu);
 LIBV2MP_PUBLIC(bool) V2MP_CPU_ExecuteClockCycle(V2MP_CPU* cpu);
 
+// Executes clock cycles until maxCycles have been executed, a fault is raised,
+// or the supervisor reports that the program has exited. Returns false under
+// the same exceptional circumstances as V2MP_CPU_ExecuteClockCycle().
+LIBV2MP_PUBLIC(bool) V2MP_CPU_Run(V2MP_CPU* cpu, size_t maxCycles, V2MP_RunResult* outResult);
+
+// Number of CPUs that V2MP_CPU_RunLockstep() executes together.
+#define V2MP_CPU_LOCKSTEP_LANES 16
+
+// Produces the same results as calling V2MP_CPU_Run() on each of the CPUs in
+// turn with the same cycle budget, with one result written to outResults per
+// CPU. The CPUs are taken in groups of V2MP_CPU_LOCKSTEP_LANES. Within a group,
+// while CPUs share the same decoded code segment (ie. the same program image)
+// and are at the same PC, each run of register-only instructions is executed
+// for all of them at once. When their PCs diverge, the largest set of CPUs at
+// the same PC continues in lockstep, and the rest are split out and run on
+// their own. Returns false under the same circumstances as V2MP_CPU_Run() for
+// any of the CPUs, in which case the results are not valid.
+LIBV2MP_PUBLIC(bool) V2MP_CPU_RunLockstep(V2MP_CPU* const* cpus, size_t numCPUs, size_t maxCycles, V2MP_RunResult* outResults);
+
+// When enabled, V2MP_CPU_Run() translates frequently executed basic blocks
+// of the loaded program into lists of instruction handlers, and runs those
+// instead of interpreting the block one cycle at a time. The results are
+// identical either way. Executing individual clock cycles or instructions
+// always uses the interpreter. Disabled by default.
+LIBV2MP_PUBLIC(void) V2MP_CPU_SetBlockTranslationEnabled(V2MP_CPU* cpu, bool enabled);
+LIBV2MP_PUBLIC(bool) V2MP_CPU_IsBlockTranslationEnabled(const V2MP_CPU* cpu);
+
+// While the CPU is stalled, clock cycles still elapse and are completed with the
+// supervisor, but no instructions are fetched or executed. The supervisor uses
+// this to make the CPU wait for operations that take more than one cycle.
+LIBV2MP_PUBLIC(void) V2MP_CPU_SetStalled(V2MP_CPU* cpu, bool stalled);
+LIBV2MP_PUBLIC(bool) V2MP_CPU_IsStalled(const V2MP_CPU* cpu);
+
 LIBV2MP_PUBLIC(void) V2MP_CPU_NotifyFault(V2MP_CPU* cpu, V2MP_Fault fault);
 LIBV2MP_PUBLIC(bool) V2MP_CPU_HasFault(const V2MP_CPU* cpu);
 LIBV2MP_PUBLIC(V2MP_Word) V2MP_CPU_GetFaultWord(const V2MP_CPU* cpu);
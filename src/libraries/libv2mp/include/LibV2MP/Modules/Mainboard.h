@@ -8,6 +8,10 @@ struct V2MP_CPU;
 struct V2MP_MemoryStore;
 
 LIBV2MP_PUBLIC(V2MP_Mainboard*) V2MP_Mainboard_AllocateAndInit(void);
+
+// Takes ownership of the given memory store, which is freed along with
+// the mainboard. If the mainboard cannot be created, the store is freed.
+LIBV2MP_PUBLIC(V2MP_Mainboard*) V2MP_Mainboard_AllocateAndInitWithMemoryStore(struct V2MP_MemoryStore* memoryStore);
 LIBV2MP_PUBLIC(void) V2MP_Mainboard_DeinitAndFree(V2MP_Mainboard* board);
 
 LIBV2MP_PUBLIC(struct V2MP_CPU*) V2MP_Mainboard_GetCPU(const V2MP_Mainboard* board);
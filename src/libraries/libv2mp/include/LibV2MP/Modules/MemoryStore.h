@@ -6,16 +6,87 @@
 #include "LibV2MP/LibExport.gen.h"
 #include "LibV2MP/Defs.h"
 
+// Size of each page of memory allocated by V2MP_MemoryStore_AllocatePagedMemory().
+#define V2MP_MEMORYSTORE_PAGE_SIZE 1024
+
 typedef struct V2MP_MemoryStore V2MP_MemoryStore;
 
+// Where contiguous memory is allocated from. Paged memory
+// is always allocated from the heap.
+typedef enum V2MP_MemoryStore_Backing
+{
+	// The default.
+	V2MP_MEMORYSTORE_BACKING_HEAP = 0,
+
+	// Mapped directly from the system, using huge pages if they are available.
+	// This reduces TLB misses when the memory is large, or when many stores
+	// are in use at once. Memory is filled with zeroes when allocated.
+	V2MP_MEMORYSTORE_BACKING_HUGE_PAGES,
+
+	// A shared mapping of a file, so that memory persists in the file after
+	// the store is freed, and may be inspected by another process while it is
+	// in use. Memory begins with the existing contents of the file, if any.
+	// Paged memory cannot be allocated with this backing.
+	V2MP_MEMORYSTORE_BACKING_FILE
+} V2MP_MemoryStore_Backing;
+
 LIBV2MP_PUBLIC(V2MP_MemoryStore*) V2MP_MemoryStore_AllocateAndInit(void);
+
+// The file path must be provided if, and only if, the backing is a file.
+LIBV2MP_PUBLIC(V2MP_MemoryStore*) V2MP_MemoryStore_AllocateAndInitWithBacking(
+	V2MP_MemoryStore_Backing backing,
+	const char* filePath
+);
+
 LIBV2MP_PUBLIC(void) V2MP_MemoryStore_DeinitAndFree(V2MP_MemoryStore* mem);
+LIBV2MP_PUBLIC(V2MP_MemoryStore_Backing) V2MP_MemoryStore_GetBacking(const V2MP_MemoryStore* mem);
 
 // Total memory must be a multiple of sizeof(V2MP_Word), otherwise allocation will fail.
 LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_AllocateTotalMemory(V2MP_MemoryStore* mem, size_t sizeInBytes);
 
+// Alternative to V2MP_MemoryStore_AllocateTotalMemory(), which divides the total memory
+// into pages of V2MP_MEMORYSTORE_PAGE_SIZE bytes. A page is only allocated, and filled
+// with zeroes, the first time it is written to. Until then, reads from it return zero.
+// The same restrictions apply to the total memory size.
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_AllocatePagedMemory(V2MP_MemoryStore* mem, size_t sizeInBytes);
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_IsPaged(const V2MP_MemoryStore* mem);
+
+// Replaces the memory of this store with a copy of the source store's memory.
+// If the source memory is paged, its committed pages are shared copy-on-write:
+// neither store sees the other's subsequent writes, and a page is only copied
+// when one of the stores that shares it writes to it. Contiguous memory is
+// copied in full.
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_ForkFrom(V2MP_MemoryStore* mem, V2MP_MemoryStore* source);
+
 LIBV2MP_PUBLIC(size_t) V2MP_MemoryStore_GetTotalMemorySize(const V2MP_MemoryStore* mem);
 
+// For paged memory, this is the total size of all pages that have been written to.
+// Otherwise, it is the same as the total memory size.
+LIBV2MP_PUBLIC(size_t) V2MP_MemoryStore_GetCommittedMemorySize(const V2MP_MemoryStore* mem);
+
+// Total size of the committed pages that are shared with at least one other store.
+// This is always zero if memory is not paged.
+LIBV2MP_PUBLIC(size_t) V2MP_MemoryStore_GetSharedMemorySize(const V2MP_MemoryStore* mem);
+
+// Memory is divided into pages of V2MP_MEMORYSTORE_PAGE_SIZE bytes for the purposes
+// of dirty tracking, whether or not it is paged. A page is marked dirty whenever it is
+// written to, including by a program that is running from the memory store, or when
+// a writable pointer to it is obtained. Allocating memory clears all the dirty bits,
+// and forking marks all of the forked store's committed pages as dirty.
+// The bitmap holds one bit per page, with page N at bit (N % 8) of byte (N / 8).
+LIBV2MP_PUBLIC(size_t) V2MP_MemoryStore_GetDirtyPageBitmapSize(const V2MP_MemoryStore* mem);
+
+// Copies the dirty page bitmap into the given buffer, and clears the dirty bits.
+// Returns false if the buffer is smaller than V2MP_MemoryStore_GetDirtyPageBitmapSize().
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_GetAndClearDirtyPages(
+	V2MP_MemoryStore* mem,
+	V2MP_Byte* outBitmap,
+	size_t bitmapSizeInBytes
+);
+
+// Returns null if memory is paged, since it is not contiguous.
+// Since the pointer can be used to write to any part of memory,
+// all pages are marked dirty.
 LIBV2MP_PUBLIC(V2MP_Byte*) V2MP_MemoryStore_GetPtrToBase(V2MP_MemoryStore* mem);
 LIBV2MP_PUBLIC(const V2MP_Byte*) V2MP_MemoryStore_GetConstPtrToBase(const V2MP_MemoryStore* mem);
 
@@ -31,14 +102,43 @@ LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_StoreWord(
 	V2MP_Word inWord
 );
 
-// Returns null if the range would exceed the total memory area.
+// These work with any range within the total memory area, whether or not memory is paged.
+// Returns false if the range would exceed the total memory area.
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_ReadRange(
+	const V2MP_MemoryStore* mem,
+	size_t base,
+	V2MP_Byte* outBuffer,
+	size_t length
+);
+
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_WriteRange(
+	V2MP_MemoryStore* mem,
+	size_t base,
+	const V2MP_Byte* data,
+	size_t length
+);
+
+// Fills the range with zeroes. If memory is paged, pages that have not been
+// committed are already zero, so are left uncommitted. Returns false if the
+// range would exceed the total memory area.
+LIBV2MP_PUBLIC(bool) V2MP_MemoryStore_ZeroRange(
+	V2MP_MemoryStore* mem,
+	size_t base,
+	size_t length
+);
+
+// Returns null if the range would exceed the total memory area. If memory is paged,
+// also returns null if the range spans more than one page, and commits the page
+// (or copies it, if it is shared with another store) so that it can be written to.
 LIBV2MP_PUBLIC(V2MP_Byte*) V2MP_MemoryStore_GetPtrToRange(
 	V2MP_MemoryStore* mem,
 	size_t base,
 	size_t length
 );
 
-// Returns null if the range would exceed the total memory area.
+// Returns null if the range would exceed the total memory area. If memory is paged,
+// also returns null if the range spans more than one page. If the page has not been
+// committed, the pointer refers to shared read-only memory that is filled with zeroes.
 LIBV2MP_PUBLIC(const V2MP_Byte*) V2MP_MemoryStore_GetConstPtrToRange(
 	const V2MP_MemoryStore* mem,
 	size_t base,
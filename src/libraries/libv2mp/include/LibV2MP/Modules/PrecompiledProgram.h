@@ -0,0 +1,96 @@
+#ifndef V2MPINTERNAL_MODULES_PRECOMPILEDPROGRAM_H
+#define V2MPINTERNAL_MODULES_PRECOMPILEDPROGRAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "LibV2MP/LibExport.gen.h"
+#include "LibV2MP/Defs.h"
+
+// A precompiled program is native code generated ahead of time from a
+// program's code segment, with one function per basic block. It is built
+// into a shared library (see the v2mpaot tool), and the descriptor that
+// the library exports is attached to a supervisor after the matching
+// program has been loaded. V2MP_Supervisor_Run() then executes each
+// block with a single native call, instead of interpreting it.
+//
+// Blocks only contain instructions that operate on registers. LDST, STK
+// and SIG, and any invalid encodings, are always left to the interpreter,
+// so memory access, segment checks and signals behave exactly as they
+// would otherwise. The layout of the structures below is shared with
+// generated code, so any change to them must increment the ABI version.
+
+#define V2MP_PRECOMPILED_ABI_VERSION 1
+
+// Name of the V2MP_PrecompiledProgram object exported by a precompiled library.
+#define V2MP_PRECOMPILED_PROGRAM_SYMBOL "V2MP_PrecompiledProgramDescriptor"
+
+typedef struct V2MP_PrecompiledRegisters
+{
+	V2MP_Word r0;
+	V2MP_Word r1;
+	V2MP_Word lr;
+	V2MP_Word pc;
+	V2MP_Word sr;
+	V2MP_Word ir;
+
+	// Set by the block if its last instruction raised a fault.
+	V2MP_Word fault;
+} V2MP_PrecompiledRegisters;
+
+typedef void (*V2MP_PrecompiledBlockFunc)(V2MP_PrecompiledRegisters* regs);
+
+typedef struct V2MP_PrecompiledBlock
+{
+	// Index of the block's first instruction in the code segment.
+	uint32_t startWordIndex;
+
+	// Number of instructions in the block, and therefore clock cycles.
+	uint32_t numCycles;
+
+	V2MP_PrecompiledBlockFunc execute;
+} V2MP_PrecompiledBlock;
+
+typedef struct V2MP_PrecompiledProgram
+{
+	uint32_t abiVersion;
+
+	// See V2MP_PrecompiledProgram_HashCS().
+	uint32_t csHash;
+	uint32_t csLengthInWords;
+
+	uint32_t numBlocks;
+	const V2MP_PrecompiledBlock* blocks;
+} V2MP_PrecompiledProgram;
+
+typedef struct V2MP_PrecompiledLibrary V2MP_PrecompiledLibrary;
+
+// Called repeatedly with consecutive chunks of generated source code.
+typedef void (*V2MP_PrecompiledSourceWriter)(void* userData, const char* text);
+
+// 32-bit FNV-1a hash of the code segment, taken over each word in little-endian byte order.
+LIBV2MP_PUBLIC(uint32_t) V2MP_PrecompiledProgram_HashCS(const V2MP_Word* cs, size_t csLengthInWords);
+
+// Generates self-contained C99 source for a precompiled program from the given code
+// segment. The source depends only on the C standard library, and defines the exported
+// descriptor named by V2MP_PRECOMPILED_PROGRAM_SYMBOL. Returns false if the arguments
+// are invalid.
+LIBV2MP_PUBLIC(bool) V2MP_PrecompiledProgram_GenerateSource(
+	const V2MP_Word* cs,
+	size_t csLengthInWords,
+	V2MP_PrecompiledSourceWriter writer,
+	void* userData
+);
+
+// Loads a shared library built from generated source. Returns NULL if the library
+// could not be loaded, does not export a descriptor, or was generated for a different
+// ABI version.
+LIBV2MP_PUBLIC(V2MP_PrecompiledLibrary*) V2MP_PrecompiledLibrary_AllocateAndLoad(const char* path);
+
+// Any supervisor that the library's program is attached to must have been
+// detached from it before the library is unloaded.
+LIBV2MP_PUBLIC(void) V2MP_PrecompiledLibrary_UnloadAndFree(V2MP_PrecompiledLibrary* library);
+
+LIBV2MP_PUBLIC(const V2MP_PrecompiledProgram*) V2MP_PrecompiledLibrary_GetProgram(const V2MP_PrecompiledLibrary* library);
+
+#endif // V2MPINTERNAL_MODULES_PRECOMPILEDPROGRAM_H
@@ -0,0 +1,29 @@
+#ifndef V2MPINTERNAL_MODULES_PROGRAMIMAGE_H
+#define V2MPINTERNAL_MODULES_PROGRAMIMAGE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "LibV2MP/LibExport.gen.h"
+#include "LibV2MP/Defs.h"
+
+// Immutable image of a program's code segment, along with its predecoded form.
+// Since CS is read-only, a single image can be shared by any number of supervisors,
+// each of which keeps only its DS and SS in its own memory store. Images are
+// reference counted: the creator holds the first reference, and each supervisor
+// that the image is loaded into holds another until its program is cleared.
+typedef struct V2MP_ProgramImage V2MP_ProgramImage;
+
+// Copies the code segment. Returns NULL if it is empty or could not be allocated.
+LIBV2MP_PUBLIC(V2MP_ProgramImage*) V2MP_ProgramImage_AllocateAndInit(const V2MP_Word* cs, size_t csLengthInWords);
+
+// Returns the image, for convenience.
+LIBV2MP_PUBLIC(V2MP_ProgramImage*) V2MP_ProgramImage_AddRef(V2MP_ProgramImage* image);
+
+// Frees the image once the last reference is released.
+LIBV2MP_PUBLIC(void) V2MP_ProgramImage_Release(V2MP_ProgramImage* image);
+
+LIBV2MP_PUBLIC(size_t) V2MP_ProgramImage_GetRefCount(const V2MP_ProgramImage* image);
+LIBV2MP_PUBLIC(const V2MP_Word*) V2MP_ProgramImage_GetCS(const V2MP_ProgramImage* image);
+LIBV2MP_PUBLIC(size_t) V2MP_ProgramImage_GetCSLengthInWords(const V2MP_ProgramImage* image);
+
+#endif // V2MPINTERNAL_MODULES_PROGRAMIMAGE_H
@@ -8,6 +8,38 @@
 
 typedef struct V2MP_Supervisor V2MP_Supervisor;
 struct V2MP_Mainboard;
+struct V2MP_PrecompiledProgram;
+struct V2MP_ProgramImage;
+
+// Latencies are the number of cycles for which the CPU stalls after an
+// instruction that accesses memory, in addition to the cycle that executed
+// the instruction. If a cache is simulated, the miss penalty is added to the
+// latency for each cache line that the access misses. The cache is addressed
+// by location in the memory store, and is shared by all segments.
+typedef struct V2MP_Supervisor_TimingModel
+{
+	size_t loadLatency;
+	size_t storeLatency;
+	size_t stackLatency;
+
+	// Block copy and fill signals take this many cycles per word,
+	// in addition to any cache misses on the ranges they access.
+	size_t blockLatencyPerWord;
+
+	// If the number of sets is 0, no cache is simulated. Otherwise, the number
+	// of sets and the line size must be powers of two, the line size must be
+	// at least one word, and there must be at least one way per set.
+	size_t cacheNumSets;
+	size_t cacheNumWays;
+	size_t cacheLineSizeInBytes;
+	size_t cacheMissPenalty;
+} V2MP_Supervisor_TimingModel;
+
+typedef struct V2MP_Supervisor_CacheStatistics
+{
+	size_t hits;
+	size_t misses;
+} V2MP_Supervisor_CacheStatistics;
 
 LIBV2MP_PUBLIC(V2MP_Supervisor*) V2MP_Supervisor_AllocateAndInit(void);
 LIBV2MP_PUBLIC(void) V2MP_Supervisor_DeinitAndFree(V2MP_Supervisor* supervisor);
@@ -15,6 +47,8 @@ LIBV2MP_PUBLIC(void) V2MP_Supervisor_DeinitAndFree(V2MP_Supervisor* supervisor);
 LIBV2MP_PUBLIC(struct V2MP_Mainboard*) V2MP_Supervisor_GetMainboard(const V2MP_Supervisor* supervisor);
 LIBV2MP_PUBLIC(void) V2MP_Supervisor_SetMainboard(V2MP_Supervisor* supervisor, struct V2MP_Mainboard* mainboard);
 
+// Creates a program image for the code segment, which is
+// owned by this supervisor, and loads it as described below.
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_LoadProgram(
 	V2MP_Supervisor* supervisor,
 	const V2MP_Word* cs,
@@ -24,7 +58,109 @@ LIBV2MP_PUBLIC(bool) V2MP_Supervisor_LoadProgram(
 	size_t ssLengthInWords
 );
 
+// Loads a program whose code segment is held by the given image. The supervisor
+// takes a reference to the image until the program is cleared or replaced, and
+// fetches instructions directly from it. Only the data and stack segments are
+// placed in the memory store, so they alone must fit within its total memory.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_LoadProgramImage(
+	V2MP_Supervisor* supervisor,
+	struct V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+);
+
+// Resets the CPU, discards any actions in progress, and fills all memory that
+// has been written to through the program's segments since the last reset with
+// zeroes. Nothing else in memory is cleared, and nothing is freed or allocated,
+// so this is much cheaper than creating a new supervisor and memory store.
+// The program itself remains loaded, with data page 0 mapped as its data
+// segment. Any data pages that were added after it was loaded are removed.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_ResetProgramState(V2MP_Supervisor* supervisor);
+
+// Resets the program state and then loads the current program image again with
+// the given data segment, so that the program runs again from the start. When
+// the same image is loaded again, the CPU's translated blocks and any attached
+// precompiled program are kept. Returns false if no program is loaded.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_ReloadProgram(
+	V2MP_Supervisor* supervisor,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+);
+
+// Adds a data page to the loaded program, after all of its existing segments
+// in memory. The page is pageLengthInWords long, and begins with the given
+// initialisation data, which may be shorter than the page. Pages are numbered
+// in the order they are added: page 0 is the data segment that the program
+// was loaded with. Returns false if the page does not fit in memory.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_AddDataPage(
+	V2MP_Supervisor* supervisor,
+	const V2MP_Word* data,
+	size_t dataLengthInWords,
+	size_t pageLengthInWords,
+	size_t* outPageIndex
+);
+
+LIBV2MP_PUBLIC(size_t) V2MP_Supervisor_GetDataPageCount(const V2MP_Supervisor* supervisor);
+
+// Returns the index of the data page that is currently mapped as the data segment.
+LIBV2MP_PUBLIC(size_t) V2MP_Supervisor_GetActiveDataPage(const V2MP_Supervisor* supervisor);
+
+// Maps the given data page as the data segment, as if the program had raised
+// a swap data page signal. The contents of the pages are not moved.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_SetActiveDataPage(V2MP_Supervisor* supervisor, size_t pageIndex);
+
+// Returns null if no program is loaded.
+LIBV2MP_PUBLIC(struct V2MP_ProgramImage*) V2MP_Supervisor_GetProgramImage(const V2MP_Supervisor* supervisor);
+
+// Copies the program that is loaded by the source supervisor, along with the
+// execution state of its CPU, so that the program continues identically under
+// this supervisor. The contents of memory are not copied: the memory store of
+// this supervisor's mainboard must already hold a copy of the source's memory,
+// for example by using V2MP_MemoryStore_ForkFrom().
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_CopyProgramState(V2MP_Supervisor* supervisor, const V2MP_Supervisor* source);
+
 LIBV2MP_PUBLIC(void) V2MP_Supervisor_ClearProgram(V2MP_Supervisor* supervisor);
+// Executes blocks from the given precompiled program in place of interpreting them,
+// until the program is cleared or replaced. The precompiled program must have been
+// generated from exactly the code segment that is currently loaded: if it was not,
+// it is rejected and false is returned. Pass NULL to go back to interpreting.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_SetPrecompiledProgram(
+	V2MP_Supervisor* supervisor,
+	const struct V2MP_PrecompiledProgram* program
+);
+
+// By default, LDST and STK access memory within the clock cycle that executes
+// them. When deferred memory access is enabled, they are instead queued as
+// supervisor actions and resolved after the clock cycle has completed, which
+// is slower but allows the access to be observed or to take multiple cycles.
+// Faults are raised under the same conditions either way.
+LIBV2MP_PUBLIC(void) V2MP_Supervisor_SetDeferredMemoryAccessEnabled(V2MP_Supervisor* supervisor, bool enabled);
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_IsDeferredMemoryAccessEnabled(const V2MP_Supervisor* supervisor);
+
+// Models the number of cycles taken by memory accesses. Pass NULL to go back to
+// every instruction taking a single cycle. While a timing model is set, memory
+// accesses are always deferred, and the CPU stalls until each one completes,
+// so programs produce the same results but take more cycles to do so. The cache
+// is emptied, and its statistics are cleared, whenever a program is loaded.
+// Returns false if the model is invalid.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_SetTimingModel(
+	V2MP_Supervisor* supervisor,
+	const V2MP_Supervisor_TimingModel* model
+);
+
+// Returns false if no timing model is set.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_GetTimingModel(
+	const V2MP_Supervisor* supervisor,
+	V2MP_Supervisor_TimingModel* outModel
+);
+
+LIBV2MP_PUBLIC(void) V2MP_Supervisor_GetCacheStatistics(
+	const V2MP_Supervisor* supervisor,
+	V2MP_Supervisor_CacheStatistics* outStats
+);
+
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_IsProgramLoaded(const V2MP_Supervisor* supervisor);
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_HasProgramExited(const V2MP_Supervisor* supervisor);
 LIBV2MP_PUBLIC(V2MP_Word) V2MP_Supervisor_ProgramExitCode(const V2MP_Supervisor* supervisor);
@@ -32,6 +168,11 @@ LIBV2MP_PUBLIC(V2MP_Word) V2MP_Supervisor_ProgramExitCode(const V2MP_Supervisor*
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_ExecuteClockCycle(V2MP_Supervisor* supervisor);
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_ExecuteSingleInstruction(V2MP_Supervisor* supervisor, V2MP_Word instruction);
 
+// Runs the loaded program for at most maxCycles clock cycles. Execution stops
+// early if the program exits or the CPU raises a fault; the reason is reported
+// in outResult. Returns false if the program could not be run.
+LIBV2MP_PUBLIC(bool) V2MP_Supervisor_Run(V2MP_Supervisor* supervisor, size_t maxCycles, V2MP_RunResult* outResult);
+
 LIBV2MP_PUBLIC(bool) V2MP_Supervisor_FetchCSWord(
 	const V2MP_Supervisor* supervisor,
 	V2MP_Word address,
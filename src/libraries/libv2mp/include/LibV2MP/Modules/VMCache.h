@@ -0,0 +1,57 @@
+#ifndef V2MPINTERNAL_MODULES_VMCACHE_H
+#define V2MPINTERNAL_MODULES_VMCACHE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "LibV2MP/LibExport.gen.h"
+#include "LibV2MP/Defs.h"
+
+struct V2MP_VirtualMachine;
+struct V2MP_ProgramImage;
+
+// Holds virtual machines that are not in use, so that they can be used again
+// instead of being freed and created each time a program is run. A recycled
+// virtual machine keeps its memory, its supervisor's action lists, and the
+// program image that it last ran, so reusing it only costs a reset of its state
+// and clearing the memory that the previous program wrote to. Any settings
+// changed on a virtual machine, such as its timing model, are kept as well.
+// The cache may be used from any number of threads at once.
+typedef struct V2MP_VMCache V2MP_VMCache;
+
+// Virtual machines created by the cache have memoryBytesPerVM of contiguous
+// memory. At most maxIdleVMs are held at once: any more that are recycled
+// are freed. Returns NULL if memoryBytesPerVM is not a valid memory size.
+LIBV2MP_PUBLIC(V2MP_VMCache*) V2MP_VMCache_AllocateAndInit(size_t memoryBytesPerVM, size_t maxIdleVMs);
+
+// Frees the virtual machines that are held by the cache. Virtual machines
+// that have been acquired and not recycled belong to the caller.
+LIBV2MP_PUBLIC(void) V2MP_VMCache_DeinitAndFree(V2MP_VMCache* cache);
+
+// Removes a virtual machine from the cache, or creates a new one if the cache
+// is empty. The caller owns the virtual machine until it is recycled. A virtual
+// machine from the cache has had its program state reset, as if by
+// V2MP_VirtualMachine_ResetProgramState(), but may still have the program that
+// it last ran loaded.
+LIBV2MP_PUBLIC(struct V2MP_VirtualMachine*) V2MP_VMCache_Acquire(V2MP_VMCache* cache);
+
+// As V2MP_VMCache_Acquire(), but loads the given program image into the virtual
+// machine as well. A virtual machine that last ran the same image is preferred,
+// so that the work derived from the image, such as translated blocks, is kept.
+// Returns NULL if the program could not be loaded.
+LIBV2MP_PUBLIC(struct V2MP_VirtualMachine*) V2MP_VMCache_AcquireWithProgramImage(
+	V2MP_VMCache* cache,
+	struct V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+);
+
+// Returns a virtual machine to the cache, after which the caller must no longer
+// use it. The virtual machine is freed instead if the cache is full, or if its
+// memory no longer matches what the cache creates. The virtual machine need not
+// have come from this cache.
+LIBV2MP_PUBLIC(void) V2MP_VMCache_Recycle(V2MP_VMCache* cache, struct V2MP_VirtualMachine* vm);
+
+LIBV2MP_PUBLIC(size_t) V2MP_VMCache_GetIdleCount(V2MP_VMCache* cache);
+
+#endif // V2MPINTERNAL_MODULES_VMCACHE_H
@@ -0,0 +1,79 @@
+#ifndef V2MPINTERNAL_MODULES_VMPOOL_H
+#define V2MPINTERNAL_MODULES_VMPOOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "LibV2MP/LibExport.gen.h"
+#include "LibV2MP/Defs.h"
+
+struct V2MP_VirtualMachine;
+
+// Owns a fixed number of virtual machines, and runs all of them once per tick
+// across a fixed set of worker threads. Each virtual machine is only ever run
+// by one thread at a time, and separate virtual machines share no mutable
+// state, so the pool needs no locking around running a virtual machine.
+// Virtual machines may share program images and copy-on-write memory pages,
+// whose reference counts are atomic.
+typedef struct V2MP_VMPool V2MP_VMPool;
+
+// Decides which worker thread runs each virtual machine during a tick.
+typedef enum V2MP_VMPool_Scheduler
+{
+	// Each worker runs a fixed, contiguous range of the virtual machines.
+	// This has the least overhead, but a tick lasts as long as the worker
+	// with the most expensive range, while the other workers sit idle.
+	V2MP_VMPOOL_SCHEDULER_CONTIGUOUS = 0,
+
+	// Worker N runs virtual machines N, N + T, N + 2T, etc. where T is the
+	// number of workers. This spreads clusters of expensive virtual machines
+	// across workers, but is otherwise as fixed as the contiguous scheduler.
+	V2MP_VMPOOL_SCHEDULER_ROUND_ROBIN,
+
+	// Each worker starts the tick with a contiguous range of the virtual
+	// machines queued. Once a worker's queue is empty, it steals virtual
+	// machines one at a time from the back of randomly chosen other workers'
+	// queues, so that no worker is idle while there is still work queued.
+	// This is the default.
+	V2MP_VMPOOL_SCHEDULER_WORK_STEALING
+} V2MP_VMPool_Scheduler;
+
+typedef struct V2MP_VMPool_Result
+{
+	// Result of the virtual machine's run during the most recent tick.
+	// A virtual machine that had already exited or faulted before the tick
+	// reports the same stop reason again, having executed 0 cycles.
+	V2MP_RunResult runResult;
+
+	// Set if the virtual machine could not be run at all, for example
+	// because it has no program loaded. The run result is not valid.
+	bool runFailed;
+} V2MP_VMPool_Result;
+
+// Creates numVMs virtual machines, each with memoryBytesPerVM of contiguous
+// memory, and numThreads worker threads to run them. If numThreads is 0, one
+// thread is started for each processor on the host. No more threads are started
+// than there are virtual machines. Returns NULL if numVMs is 0, or if any of the
+// virtual machines, their memory or the threads could not be created.
+LIBV2MP_PUBLIC(V2MP_VMPool*) V2MP_VMPool_AllocateAndInit(size_t numVMs, size_t memoryBytesPerVM, size_t numThreads);
+LIBV2MP_PUBLIC(void) V2MP_VMPool_DeinitAndFree(V2MP_VMPool* pool);
+
+LIBV2MP_PUBLIC(size_t) V2MP_VMPool_GetVMCount(const V2MP_VMPool* pool);
+LIBV2MP_PUBLIC(size_t) V2MP_VMPool_GetThreadCount(const V2MP_VMPool* pool);
+
+// Takes effect from the next tick. Returns false if the scheduler is not valid.
+LIBV2MP_PUBLIC(bool) V2MP_VMPool_SetScheduler(V2MP_VMPool* pool, V2MP_VMPool_Scheduler scheduler);
+LIBV2MP_PUBLIC(V2MP_VMPool_Scheduler) V2MP_VMPool_GetScheduler(const V2MP_VMPool* pool);
+
+// The virtual machine remains owned by the pool. It may be set up and inspected
+// freely between ticks, but must not be accessed while a tick is running.
+LIBV2MP_PUBLIC(struct V2MP_VirtualMachine*) V2MP_VMPool_GetVM(V2MP_VMPool* pool, size_t index);
+
+// Runs every virtual machine in the pool for up to cycleQuantum cycles, and
+// blocks until all of them have finished. The results of the tick can then
+// be retrieved for each virtual machine.
+LIBV2MP_PUBLIC(bool) V2MP_VMPool_RunTick(V2MP_VMPool* pool, size_t cycleQuantum);
+
+// Returns NULL if the index is out of range.
+LIBV2MP_PUBLIC(const V2MP_VMPool_Result*) V2MP_VMPool_GetResult(const V2MP_VMPool* pool, size_t index);
+
+#endif // V2MPINTERNAL_MODULES_VMPOOL_H
@@ -9,8 +9,31 @@
 typedef struct V2MP_VirtualMachine V2MP_VirtualMachine;
 struct V2MP_Supervisor;
 struct V2MP_Mainboard;
+struct V2MP_MemoryStore;
+struct V2MP_PrecompiledProgram;
+struct V2MP_ProgramImage;
 
 LIBV2MP_PUBLIC(V2MP_VirtualMachine*) V2MP_VirtualMachine_AllocateAndInit(void);
+
+// See V2MP_Mainboard_AllocateAndInitWithMemoryStore().
+LIBV2MP_PUBLIC(V2MP_VirtualMachine*) V2MP_VirtualMachine_AllocateAndInitWithMemoryStore(struct V2MP_MemoryStore* memoryStore);
+
+// Creates a virtual machine whose modules, action lists and totalMemoryBytes of
+// contiguous memory are all placed in one allocation, each aligned to its own
+// cache line, so that a virtual machine costs a single allocation to create
+// and is compact in memory to run. The virtual machine is used and freed in
+// exactly the same way as any other. Anything that it later needs to grow,
+// such as its memory or its action lists, is allocated separately as usual.
+// Returns NULL if totalMemoryBytes is odd.
+LIBV2MP_PUBLIC(V2MP_VirtualMachine*) V2MP_VirtualMachine_AllocateAndInitInSingleBlock(size_t totalMemoryBytes);
+
+// Creates a new virtual machine that continues from the current state of the
+// given one. If the parent's memory is paged, the child shares its pages
+// copy-on-write, so forking only costs as much as the pages that either
+// machine subsequently writes to. Contiguous memory is copied in full.
+// Any precompiled program attached to the parent is also attached to the
+// child, and so must outlive both of them.
+LIBV2MP_PUBLIC(V2MP_VirtualMachine*) V2MP_VirtualMachine_Fork(V2MP_VirtualMachine* parent);
 LIBV2MP_PUBLIC(void) V2MP_VirtualMachine_DeinitAndFree(V2MP_VirtualMachine* vm);
 
 LIBV2MP_PUBLIC(struct V2MP_Mainboard*) V2MP_VirtualMachine_GetMainboard(V2MP_VirtualMachine* vm);
@@ -19,6 +42,9 @@ LIBV2MP_PUBLIC(struct V2MP_Supervisor*) V2MP_VirtualMachine_GetSupervisor(V2MP_V
 LIBV2MP_PUBLIC(size_t) V2MP_VirtualMachine_GetTotalMemoryBytes(V2MP_VirtualMachine* vm);
 LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_AllocateTotalMemory(V2MP_VirtualMachine* vm, size_t sizeInBytes);
 
+// See V2MP_MemoryStore_AllocatePagedMemory().
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_AllocatePagedMemory(V2MP_VirtualMachine* vm, size_t sizeInBytes);
+
 LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_LoadProgram(
 	V2MP_VirtualMachine* vm,
 	const V2MP_Word* cs,
@@ -28,9 +54,51 @@ LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_LoadProgram(
 	size_t ssLengthInWords
 );
 
+// See V2MP_Supervisor_LoadProgramImage().
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_LoadProgramImage(
+	V2MP_VirtualMachine* vm,
+	struct V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+);
+
+// See V2MP_Supervisor_ResetProgramState().
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_ResetProgramState(V2MP_VirtualMachine* vm);
+
+// See V2MP_Supervisor_ReloadProgram().
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_ReloadProgram(
+	V2MP_VirtualMachine* vm,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+);
+
+// See V2MP_Supervisor_SetPrecompiledProgram().
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_SetPrecompiledProgram(
+	V2MP_VirtualMachine* vm,
+	const struct V2MP_PrecompiledProgram* program
+);
+
 LIBV2MP_PUBLIC(void) V2MP_VirtualMachine_ClearProgram(V2MP_VirtualMachine* vm);
 LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_IsProgramLoaded(const V2MP_VirtualMachine* vm);
 
 LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_ExecuteClockCycle(V2MP_VirtualMachine* vm);
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_Run(V2MP_VirtualMachine* vm, size_t maxCycles, V2MP_RunResult* outResult);
+
+// Produces the same results as calling V2MP_VirtualMachine_Run() on each of the
+// virtual machines in turn, but runs them using V2MP_CPU_RunLockstep(). This is
+// only faster than running them individually if the virtual machines share a
+// program image, and mostly follow the same path through it.
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_RunLockstep(
+	V2MP_VirtualMachine* const* vms,
+	size_t numVMs,
+	size_t maxCycles,
+	V2MP_RunResult* outResults
+);
+
+// See V2MP_CPU_SetBlockTranslationEnabled().
+LIBV2MP_PUBLIC(void) V2MP_VirtualMachine_SetBlockTranslationEnabled(V2MP_VirtualMachine* vm, bool enabled);
+LIBV2MP_PUBLIC(bool) V2MP_VirtualMachine_IsBlockTranslationEnabled(const V2MP_VirtualMachine* vm);
 
 #endif // V2MPINTERNAL_MODULES_VIRTUALMACHINE_H
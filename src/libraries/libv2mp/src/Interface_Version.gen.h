@@ -0,0 +1,14 @@
+// This file is generated by CMake. Do not edit it manually!
+
+#ifndef V2MP_INTERFACE_VERSION_GEN_H
+#define V2MP_INTERFACE_VERSION_GEN_H
+
+#include <stdint.h>
+
+#define V2MP_VERSION_MAJOR (int32_t)(1)
+#define V2MP_VERSION_MINOR (int32_t)(0)
+#define V2MP_VERSION_PATCH (int32_t)(0)
+#define V2MP_VERSION_STRING "1.0.0";
+#define V2MP_BUILD_IDENTIFIER_STRING "";
+
+#endif // V2MP_INTERFACE_VERSION_GEN_H
@@ -0,0 +1,29 @@
+#ifndef V2MP_MODULES_BLOCKLAYOUT_H
+#define V2MP_MODULES_BLOCKLAYOUT_H
+
+#include <stddef.h>
+#include "LibV2MP/Defs.h"
+
+// Every region reserved within a block begins on a boundary of this many bytes,
+// so that no two modules share a cache line.
+#define V2MP_BLOCKLAYOUT_ALIGNMENT 64
+
+// Carves a single allocation into regions for several modules. Layout happens
+// in two passes over the same code: first with no base, to measure how large
+// the block must be, and then again once the block has been allocated, to hand
+// out pointers into it. While measuring, every reservation returns NULL.
+typedef struct V2MP_BlockLayout
+{
+	V2MP_Byte* base;
+	size_t size;
+} V2MP_BlockLayout;
+
+static inline void* V2MP_BlockLayout_Reserve(V2MP_BlockLayout* layout, size_t numBytes)
+{
+	const size_t offset = (layout->size + V2MP_BLOCKLAYOUT_ALIGNMENT - 1) & ~((size_t)V2MP_BLOCKLAYOUT_ALIGNMENT - 1);
+
+	layout->size = offset + numBytes;
+	return layout->base ? layout->base + offset : NULL;
+}
+
+#endif // V2MP_MODULES_BLOCKLAYOUT_H
@@ -2,18 +2,40 @@
 #include "LibBaseUtil/Heap.h"
 #include "LibBaseUtil/Util.h"
 #include "Modules/CPU_Internal.h"
+#include "Modules/CPU_Flags.h"
 #include "Modules/CPU_Instructions.h"
+#include "Modules/CPU_Fusion.h"
+#include "Modules/CPU_Precompiled.h"
 
 V2MP_CPU* V2MP_CPU_AllocateAndInit(void)
 {
 	return BASEUTIL_CALLOC_STRUCT(V2MP_CPU);
 }
 
+V2MP_CPU* V2MP_CPU_PlaceInBlock(V2MP_BlockLayout* layout)
+{
+	V2MP_CPU* cpu = (V2MP_CPU*)V2MP_BlockLayout_Reserve(layout, sizeof(V2MP_CPU));
+
+	if ( cpu )
+	{
+		BASEUTIL_ZERO_STRUCT_PTR(cpu);
+		cpu->placedInBlock = true;
+	}
+
+	return cpu;
+}
+
 void V2MP_CPU_DeinitAndFree(V2MP_CPU* cpu)
 {
 	if ( cpu )
 	{
-		BASEUTIL_FREE(cpu);
+		V2MP_CPU_BlockCache_DeinitAndFree(cpu->blockCache);
+		cpu->blockCache = NULL;
+
+		if ( !cpu->placedInBlock )
+		{
+			BASEUTIL_FREE(cpu);
+		}
 	}
 }
 
@@ -46,36 +68,187 @@ void V2MP_CPU_Reset(V2MP_CPU* cpu)
 		return;
 	}
 
-	cpu->pc = 0;
+	cpu->regs[V2MP_REGID_PC] = 0;
 	cpu->sp = 0;
-	cpu->sr = 0;
-	cpu->lr = 0;
-	cpu->r0 = 0;
-	cpu->r1 = 0;
+	V2MP_CPU_ClearFlags(cpu);
+	cpu->regs[V2MP_REGID_LR] = 0;
+	cpu->regs[V2MP_REGID_R0] = 0;
+	cpu->regs[V2MP_REGID_R1] = 0;
 	cpu->ir = 0;
 	cpu->fault = 0;
+	cpu->stalled = false;
+}
+
+void V2MP_CPU_CopyState(V2MP_CPU* cpu, const V2MP_CPU* source)
+{
+	size_t index;
+
+	if ( !cpu || !source || cpu == source )
+	{
+		return;
+	}
+
+	for ( index = 0; index < BASEUTIL_ARRAY_SIZE(cpu->regs); ++index )
+	{
+		cpu->regs[index] = source->regs[index];
+	}
+
+	cpu->sr = source->sr;
+
+#ifdef V2MP_LAZY_FLAGS
+	cpu->pendingFlags = source->pendingFlags;
+	cpu->flagsResult = source->flagsResult;
+	cpu->flagsOperand = source->flagsOperand;
+#endif
+
+	cpu->ir = source->ir;
+	cpu->sp = source->sp;
+	cpu->fault = source->fault;
+	cpu->stalled = source->stalled;
+
+	V2MP_CPU_SetBlockTranslationEnabled(cpu, source->blockTranslationEnabled);
 }
 
 bool V2MP_CPU_ExecuteClockCycle(V2MP_CPU* cpu)
 {
-	V2MP_Word fault;
+	V2MP_CPU_DecodedInstruction scratch;
+	const V2MP_CPU_DecodedInstruction* decoded;
 
 	if ( !cpu || !cpu->supervisorInterface.fetchInstructionWord )
 	{
 		return false;
 	}
 
-	fault = cpu->supervisorInterface.fetchInstructionWord(cpu->supervisorInterface.supervisor, cpu->pc, &cpu->ir);
+	if ( cpu->stalled )
+	{
+		// The cycle passes without executing anything.
+		return true;
+	}
+
+	decoded = V2MP_CPU_FetchNextInstruction(cpu, &scratch);
 
-	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+	if ( !decoded )
 	{
-		V2MP_CPU_NotifyFault(cpu, fault);
+		// Fetching raised a fault.
 		return true;
 	}
 
-	cpu->pc += 2;
+	return V2MP_CPU_ExecuteDecodedInstruction(cpu, decoded);
+}
 
-	return V2MP_CPU_ExecuteInstructionInternal(cpu);
+#ifndef V2MP_CPU_HAS_THREADED_DISPATCH
+static bool RunWithInstructionTable(V2MP_CPU* cpu, size_t maxCycles, V2MP_RunResult* outResult)
+{
+	bool programExited = false;
+	size_t cyclesThisStep = 0;
+
+	outResult->cyclesExecuted = 0;
+	outResult->stopReason = V2MP_RUNSTOP_CYCLE_LIMIT;
+
+	while ( true )
+	{
+		if ( V2MP_CPU_FAULT_CODE(cpu->fault) != V2MP_FAULT_NONE )
+		{
+			outResult->stopReason = V2MP_RUNSTOP_FAULT;
+			break;
+		}
+
+		if ( programExited )
+		{
+			outResult->stopReason = V2MP_RUNSTOP_PROGRAM_EXITED;
+			break;
+		}
+
+		if ( outResult->cyclesExecuted >= maxCycles )
+		{
+			break;
+		}
+
+		if ( cpu->stalled )
+		{
+			// The cycle passes without executing anything.
+			cyclesThisStep = 1;
+		}
+		else
+		{
+			cyclesThisStep = V2MP_CPU_TryExecutePrecompiledBlock(cpu, maxCycles - outResult->cyclesExecuted);
+		}
+
+		if ( cyclesThisStep == 0 &&
+		     !V2MP_CPU_TryExecuteTranslatedBlock(cpu, maxCycles - outResult->cyclesExecuted, &cyclesThisStep) )
+		{
+			return false;
+		}
+
+		if ( cyclesThisStep == 0 )
+		{
+			cyclesThisStep = V2MP_CPU_TryExecuteFusedInstruction(cpu, maxCycles - outResult->cyclesExecuted);
+		}
+
+		if ( cyclesThisStep == 0 )
+		{
+			if ( !V2MP_CPU_ExecuteClockCycle(cpu) )
+			{
+				return false;
+			}
+
+			cyclesThisStep = 1;
+		}
+
+		outResult->cyclesExecuted += cyclesThisStep;
+
+		if ( cpu->supervisorInterface.completeClockCycle &&
+		     !cpu->supervisorInterface.completeClockCycle(cpu->supervisorInterface.supervisor, &programExited) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif
+
+bool V2MP_CPU_Run(V2MP_CPU* cpu, size_t maxCycles, V2MP_RunResult* outResult)
+{
+	if ( !cpu || !outResult || !cpu->supervisorInterface.fetchInstructionWord )
+	{
+		return false;
+	}
+
+#ifdef V2MP_CPU_HAS_THREADED_DISPATCH
+	return V2MP_CPU_RunThreaded(cpu, maxCycles, outResult);
+#else
+	return RunWithInstructionTable(cpu, maxCycles, outResult);
+#endif
+}
+
+void V2MP_CPU_SetBlockTranslationEnabled(V2MP_CPU* cpu, bool enabled)
+{
+	if ( !cpu || cpu->blockTranslationEnabled == enabled )
+	{
+		return;
+	}
+
+	cpu->blockTranslationEnabled = enabled;
+	V2MP_CPU_RebuildBlockCache(cpu);
+}
+
+bool V2MP_CPU_IsBlockTranslationEnabled(const V2MP_CPU* cpu)
+{
+	return cpu ? cpu->blockTranslationEnabled : false;
+}
+
+void V2MP_CPU_SetStalled(V2MP_CPU* cpu, bool stalled)
+{
+	if ( cpu )
+	{
+		cpu->stalled = stalled;
+	}
+}
+
+bool V2MP_CPU_IsStalled(const V2MP_CPU* cpu)
+{
+	return cpu ? cpu->stalled : false;
 }
 
 void V2MP_CPU_NotifyFault(V2MP_CPU* cpu, V2MP_Fault fault)
@@ -136,13 +309,7 @@ bool V2MP_CPU_SetRegisterValueAndUpdateSR(V2MP_CPU* cpu, V2MP_RegisterIndex regI
 	}
 
 	*regPtr = value;
-
-	cpu->sr = 0;
-
-	if ( *regPtr == 0 )
-	{
-		cpu->sr |= V2MP_CPU_SR_Z;
-	}
+	V2MP_CPU_SetFlagsFromResult(cpu, value);
 
 	return true;
 }
@@ -181,7 +348,7 @@ bool V2MP_CPU_ExecuteSingleInstruction(V2MP_CPU* cpu, V2MP_Word instruction)
 
 V2MP_Word V2MP_CPU_GetProgramCounter(const V2MP_CPU* cpu)
 {
-	return cpu ? cpu->pc : 0;
+	return cpu ? cpu->regs[V2MP_REGID_PC] : 0;
 }
 
 void V2MP_CPU_SetProgramCounter(V2MP_CPU* cpu, V2MP_Word value)
@@ -191,12 +358,12 @@ void V2MP_CPU_SetProgramCounter(V2MP_CPU* cpu, V2MP_Word value)
 		return;
 	}
 
-	cpu->pc = value;
+	cpu->regs[V2MP_REGID_PC] = value;
 }
 
 V2MP_Word V2MP_CPU_GetStatusRegister(const V2MP_CPU* cpu)
 {
-	return cpu ? cpu->sr : 0;
+	return cpu ? V2MP_CPU_GetFlagsConst(cpu) : 0;
 }
 
 void V2MP_CPU_SetStatusRegister(V2MP_CPU* cpu, V2MP_Word value)
@@ -206,12 +373,12 @@ void V2MP_CPU_SetStatusRegister(V2MP_CPU* cpu, V2MP_Word value)
 		return;
 	}
 
-	cpu->sr = value;
+	V2MP_CPU_SetFlags(cpu, value);
 }
 
 V2MP_Word V2MP_CPU_GetLinkRegister(const V2MP_CPU* cpu)
 {
-	return cpu ? cpu->lr : 0;
+	return cpu ? cpu->regs[V2MP_REGID_LR] : 0;
 }
 
 void V2MP_CPU_SetLinkRegister(V2MP_CPU* cpu, V2MP_Word value)
@@ -221,12 +388,12 @@ void V2MP_CPU_SetLinkRegister(V2MP_CPU* cpu, V2MP_Word value)
 		return;
 	}
 
-	cpu->lr = value;
+	cpu->regs[V2MP_REGID_LR] = value;
 }
 
 V2MP_Word V2MP_CPU_GetR0(const V2MP_CPU* cpu)
 {
-	return cpu ? cpu->r0 : 0;
+	return cpu ? cpu->regs[V2MP_REGID_R0] : 0;
 }
 
 void V2MP_CPU_SetR0(V2MP_CPU* cpu, V2MP_Word value)
@@ -236,12 +403,12 @@ void V2MP_CPU_SetR0(V2MP_CPU* cpu, V2MP_Word value)
 		return;
 	}
 
-	cpu->r0 = value;
+	cpu->regs[V2MP_REGID_R0] = value;
 }
 
 V2MP_Word V2MP_CPU_GetR1(const V2MP_CPU* cpu)
 {
-	return cpu ? cpu->r1 : 0;
+	return cpu ? cpu->regs[V2MP_REGID_R1] : 0;
 }
 
 void V2MP_CPU_SetR1(V2MP_CPU* cpu, V2MP_Word value)
@@ -251,7 +418,7 @@ void V2MP_CPU_SetR1(V2MP_CPU* cpu, V2MP_Word value)
 		return;
 	}
 
-	cpu->r1 = value;
+	cpu->regs[V2MP_REGID_R1] = value;
 }
 
 V2MP_Word V2MP_CPU_GetInstructionRegister(const V2MP_CPU* cpu)
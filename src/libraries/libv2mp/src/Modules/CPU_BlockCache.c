@@ -0,0 +1,250 @@
+#include <string.h>
+#include "Modules/CPU_BlockCache.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/CPU_Instructions.h"
+#include "Modules/CPU_Fusion.h"
+#include "LibBaseUtil/Heap.h"
+
+typedef struct BlockEntry
+{
+	const V2MP_CPU_DecodedInstruction* decoded;
+
+	// If NULL, the entry is a fused operation.
+	V2MP_CPU_InstructionCallback callback;
+} BlockEntry;
+
+typedef struct TranslatedBlock
+{
+	size_t numCycles;
+	size_t numEntries;
+	BlockEntry entries[];
+} TranslatedBlock;
+
+struct V2MP_CPU_BlockCache
+{
+	size_t numCSWords;
+
+	// Both of these have one entry per word in CS.
+	uint16_t* visitCounts;
+	TranslatedBlock** blocks;
+};
+
+static bool EndsBlock(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_NOP:
+		case V2MP_OP_MUL:
+		{
+			return false;
+		}
+
+		case V2MP_OP_ADD:
+		case V2MP_OP_SUB:
+		case V2MP_OP_ASGN:
+		case V2MP_OP_SHFT:
+		case V2MP_OP_BITW:
+		{
+			return decoded->destReg == V2MP_REGID_PC;
+		}
+
+		default:
+		{
+			// Branches, instructions that may fault, instructions
+			// that create supervisor actions, and invalid encodings.
+			return true;
+		}
+	}
+}
+
+static TranslatedBlock* TranslateBlock(const V2MP_CPU_DecodedInstruction* decodedCS, size_t count, size_t startIndex)
+{
+	BlockEntry entries[V2MP_CPU_BLOCK_MAX_ENTRIES];
+	size_t numEntries = 0;
+	size_t numCycles = 0;
+	size_t index = startIndex;
+	TranslatedBlock* block;
+	bool blockEnded = false;
+
+	while ( index < count && numEntries < V2MP_CPU_BLOCK_MAX_ENTRIES && !blockEnded )
+	{
+		const V2MP_CPU_DecodedInstruction* decoded = &decodedCS[index];
+		size_t length = V2MP_CPU_GetFusedLength(decoded);
+		size_t subIndex;
+
+		entries[numEntries].decoded = decoded;
+
+		if ( length > 0 )
+		{
+			entries[numEntries].callback = NULL;
+
+			for ( subIndex = 0; subIndex < length; ++subIndex )
+			{
+				blockEnded = blockEnded || EndsBlock(&decoded[subIndex]);
+			}
+		}
+		else
+		{
+			length = 1;
+			entries[numEntries].callback = V2MP_CPU_GetInstructionCallback(decoded->handler);
+			blockEnded = EndsBlock(decoded);
+
+			if ( !entries[numEntries].callback )
+			{
+				return NULL;
+			}
+		}
+
+		++numEntries;
+		numCycles += length;
+		index += length;
+	}
+
+	block = (TranslatedBlock*)BASEUTIL_MALLOC(sizeof(TranslatedBlock) + (numEntries * sizeof(BlockEntry)));
+
+	if ( !block )
+	{
+		return NULL;
+	}
+
+	block->numCycles = numCycles;
+	block->numEntries = numEntries;
+	memcpy(block->entries, entries, numEntries * sizeof(BlockEntry));
+
+	return block;
+}
+
+static bool ExecuteBlock(V2MP_CPU* cpu, const TranslatedBlock* block)
+{
+	size_t index;
+
+	for ( index = 0; index < block->numEntries; ++index )
+	{
+		const BlockEntry* entry = &block->entries[index];
+
+		if ( !entry->callback )
+		{
+			V2MP_CPU_ExecuteFusedInstruction(cpu, entry->decoded);
+			continue;
+		}
+
+		cpu->ir = entry->decoded->word;
+		cpu->regs[V2MP_REGID_PC] += sizeof(V2MP_Word);
+
+		if ( !entry->callback(cpu, entry->decoded) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+V2MP_CPU_BlockCache* V2MP_CPU_BlockCache_AllocateAndInit(size_t numCSWords)
+{
+	V2MP_CPU_BlockCache* cache;
+
+	if ( numCSWords < 1 )
+	{
+		return NULL;
+	}
+
+	cache = BASEUTIL_CALLOC_STRUCT(V2MP_CPU_BlockCache);
+
+	if ( !cache )
+	{
+		return NULL;
+	}
+
+	cache->numCSWords = numCSWords;
+	cache->visitCounts = (uint16_t*)BASEUTIL_CALLOC(numCSWords, sizeof(uint16_t));
+	cache->blocks = (TranslatedBlock**)BASEUTIL_CALLOC(numCSWords, sizeof(TranslatedBlock*));
+
+	if ( !cache->visitCounts || !cache->blocks )
+	{
+		V2MP_CPU_BlockCache_DeinitAndFree(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void V2MP_CPU_BlockCache_DeinitAndFree(V2MP_CPU_BlockCache* cache)
+{
+	size_t index;
+
+	if ( !cache )
+	{
+		return;
+	}
+
+	if ( cache->blocks )
+	{
+		for ( index = 0; index < cache->numCSWords; ++index )
+		{
+			if ( cache->blocks[index] )
+			{
+				BASEUTIL_FREE(cache->blocks[index]);
+			}
+		}
+
+		BASEUTIL_FREE(cache->blocks);
+	}
+
+	if ( cache->visitCounts )
+	{
+		BASEUTIL_FREE(cache->visitCounts);
+	}
+
+	BASEUTIL_FREE(cache);
+}
+
+bool V2MP_CPU_TryExecuteTranslatedBlock(V2MP_CPU* cpu, size_t maxCycles, size_t* outCycles)
+{
+	V2MP_CPU_BlockCache* cache = cpu->blockCache;
+	TranslatedBlock* block;
+	size_t index;
+
+	*outCycles = 0;
+
+	if ( !cache || (cpu->regs[V2MP_REGID_PC] & 1) != 0 )
+	{
+		return true;
+	}
+
+	index = (size_t)(cpu->regs[V2MP_REGID_PC] >> 1);
+
+	if ( index >= cache->numCSWords )
+	{
+		return true;
+	}
+
+	block = cache->blocks[index];
+
+	if ( !block )
+	{
+		if ( cache->visitCounts[index] < V2MP_CPU_BLOCK_HOT_THRESHOLD )
+		{
+			++cache->visitCounts[index];
+			return true;
+		}
+
+		// If translation fails, the count stays at the threshold
+		// and translation is attempted again on the next visit.
+		block = TranslateBlock(cpu->decodedCS, cpu->decodedCSCount, index);
+		cache->blocks[index] = block;
+
+		if ( !block )
+		{
+			return true;
+		}
+	}
+
+	if ( block->numCycles > maxCycles )
+	{
+		return true;
+	}
+
+	*outCycles = block->numCycles;
+	return ExecuteBlock(cpu, block);
+}
@@ -0,0 +1,36 @@
+#ifndef V2MP_MODULES_CPU_BLOCKCACHE_H
+#define V2MP_MODULES_CPU_BLOCKCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "LibV2MP/Modules/CPU.h"
+
+// Number of times execution must arrive at an address in the
+// code segment before the basic block starting there is translated.
+#define V2MP_CPU_BLOCK_HOT_THRESHOLD 16
+
+// Upper limit on the number of entries in a single translated block.
+#define V2MP_CPU_BLOCK_MAX_ENTRIES 64
+
+// Holds translations of frequently executed basic blocks from the CPU's
+// decoded code segment. A translated block is a flat list of instruction
+// handlers that can be run back to back, without the per-cycle fetch,
+// fault, budget and supervisor checks that the run loop performs.
+//
+// A block ends at the first instruction that may write to PC, raise a
+// fault, or create a supervisor action, so none of these checks can
+// change the outcome for any instruction except the last one.
+typedef struct V2MP_CPU_BlockCache V2MP_CPU_BlockCache;
+
+V2MP_CPU_BlockCache* V2MP_CPU_BlockCache_AllocateAndInit(size_t numCSWords);
+void V2MP_CPU_BlockCache_DeinitAndFree(V2MP_CPU_BlockCache* cache);
+
+// If the CPU has block translation enabled and PC is at the start of a
+// translated block that fits within the cycle budget, executes the block
+// and sets outCycles to the number of cycles it accounts for. Otherwise,
+// records a visit to PC for the purposes of detecting hot blocks, and
+// sets outCycles to 0. Returns false under the same circumstances that
+// an instruction handler would.
+bool V2MP_CPU_TryExecuteTranslatedBlock(V2MP_CPU* cpu, size_t maxCycles, size_t* outCycles);
+
+#endif // V2MP_MODULES_CPU_BLOCKCACHE_H
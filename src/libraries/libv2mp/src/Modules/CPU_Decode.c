@@ -0,0 +1,324 @@
+#include "Modules/CPU_Decode.h"
+#include "Modules/CPU_Instructions.h"
+
+typedef void (* DecodeCallback)(V2MP_Word, V2MP_CPU_DecodedInstruction*);
+
+static void Decode_NOP(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_ADDOrSUB(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_MULOrDIV(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_ASGN(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_SHFT(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_BITW(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_CBX(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_LDST(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_STK(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_SIG(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+static void Decode_Unassigned(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded);
+
+static const DecodeCallback DECODE_TABLE[0x10] =
+{
+	&Decode_NOP,			// 0x0
+	&Decode_ADDOrSUB,		// 0x1
+	&Decode_ADDOrSUB,		// 0x2
+	&Decode_MULOrDIV,		// 0x3
+	&Decode_MULOrDIV,		// 0x4
+	&Decode_ASGN,			// 0x5
+	&Decode_SHFT,			// 0x6
+	&Decode_BITW,			// 0x7
+	&Decode_CBX,			// 0x8
+	&Decode_LDST,			// 0x9
+	&Decode_STK,			// 0xA
+	&Decode_SIG,			// 0xB
+	&Decode_Unassigned,		// 0xC
+	&Decode_Unassigned,		// 0xD
+	&Decode_Unassigned,		// 0xE
+	&Decode_Unassigned		// 0xF
+};
+
+static void Decode_NOP(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_NOP_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+}
+
+static void Decode_ADDOrSUB(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	decoded->sourceReg = (uint8_t)V2MP_OP_ADDSUB_SREGINDEX(instr);
+	decoded->destReg = (uint8_t)V2MP_OP_ADDSUB_DREGINDEX(instr);
+
+	if ( decoded->sourceReg != decoded->destReg )
+	{
+		if ( V2MP_OP_ADDSUB_VALUE(instr) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+	}
+	else
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_LITERAL;
+		decoded->immediate = (V2MP_Word)((uint8_t)V2MP_OP_ADDSUB_VALUE(instr));
+	}
+}
+
+static void Decode_MULOrDIV(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_MULDIV_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	decoded->destReg = V2MP_OP_MULDIV_DEST_IS_R1(instr) ? V2MP_REGID_R1 : V2MP_REGID_R0;
+	decoded->sourceReg = V2MP_OP_MULDIV_DEST_IS_R1(instr) ? V2MP_REGID_R0 : V2MP_REGID_R1;
+
+	if ( V2MP_OP_MULDIV_IS_SIGNED(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_SIGNED;
+	}
+
+	if ( V2MP_OP_MULDIV_SOURCE_IS_STATIC(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_LITERAL;
+
+		if ( V2MP_OP_MULDIV_IS_SIGNED(instr) )
+		{
+			const int8_t value = (int8_t)V2MP_OP_MULDIV_VALUE(instr);
+			decoded->immediate = (V2MP_Word)((int16_t)value);
+		}
+		else
+		{
+			decoded->immediate = (V2MP_Word)V2MP_OP_MULDIV_VALUE(instr);
+		}
+	}
+}
+
+static void Decode_ASGN(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	decoded->sourceReg = (uint8_t)V2MP_OP_ASGN_SREGINDEX(instr);
+	decoded->destReg = (uint8_t)V2MP_OP_ASGN_DREGINDEX(instr);
+
+	if ( decoded->sourceReg != decoded->destReg )
+	{
+		if ( V2MP_OP_ASGN_VALUE(instr) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+	}
+	else
+	{
+		if ( decoded->destReg == V2MP_REGID_PC )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+
+		decoded->flags |= V2MP_DECODED_FLAG_LITERAL;
+		decoded->immediate = (V2MP_Word)((int8_t)V2MP_OP_ASGN_VALUE(instr));
+	}
+}
+
+static void Decode_SHFT(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_SHFT_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	decoded->sourceReg = (uint8_t)V2MP_OP_SHFT_SREGINDEX(instr);
+	decoded->destReg = (uint8_t)V2MP_OP_SHFT_DREGINDEX(instr);
+
+	if ( decoded->sourceReg != decoded->destReg )
+	{
+		if ( V2MP_OP_SHFT_VALUE(instr) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+	}
+	else
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_LITERAL;
+		decoded->immediate = V2MP_OP_SHFT_VALUE(instr);
+
+		if ( decoded->immediate & 0x0010 )
+		{
+			// This is a 5-bit value. Bit 4 signifies that it is negative.
+			// Construct a 16-bit two's complement for the negative value.
+			decoded->immediate = 0xFFF0 | (decoded->immediate & 0x000F);
+		}
+	}
+}
+
+static void Decode_BITW(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_BITW_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	decoded->sourceReg = (uint8_t)V2MP_OP_BITW_SREGINDEX(instr);
+	decoded->destReg = (uint8_t)V2MP_OP_BITW_DREGINDEX(instr);
+	decoded->flags |= (uint8_t)(V2MP_OP_BITW_OPTYPE(instr) << V2MP_DECODED_FLAGS_BITOP_SHIFT);
+
+	if ( decoded->sourceReg != decoded->destReg )
+	{
+		if ( V2MP_OP_BITW_MASKSHIFT(instr) != 0 ||
+		     V2MP_OP_BITW_FLIPMASK(instr) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+	}
+	else
+	{
+		if ( V2MP_OP_BITW_OPTYPE(instr) == V2MP_BITOP_NOT &&
+		     (V2MP_OP_BITW_FLIPMASK(instr) | V2MP_OP_BITW_MASKSHIFT(instr)) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+
+		decoded->flags |= V2MP_DECODED_FLAG_LITERAL;
+		decoded->immediate = (V2MP_Word)(1 << V2MP_OP_BITW_MASKSHIFT(instr));
+
+		if ( V2MP_OP_BITW_FLIPMASK(instr) )
+		{
+			decoded->immediate = (V2MP_Word)(~decoded->immediate);
+		}
+	}
+}
+
+static void Decode_CBX(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_CBX_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	if ( V2MP_OP_CBX_BRANCH_ON_SR_C(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_ALT;
+	}
+
+	if ( V2MP_OP_CBX_LR_IS_TARGET(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_LR_TARGET;
+
+		if ( V2MP_OP_CBX_OFFSET(instr) != 0 )
+		{
+			decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+		}
+	}
+	else
+	{
+		decoded->immediate = (V2MP_Word)(sizeof(V2MP_Word) * (int8_t)V2MP_OP_CBX_OFFSET(instr));
+	}
+}
+
+static void Decode_LDST(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_LDST_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	if ( V2MP_OP_LDST_IS_STORE(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_ALT;
+	}
+
+	decoded->sourceReg = (uint8_t)V2MP_OP_LDST_REGINDEX(instr);
+	decoded->destReg = decoded->sourceReg;
+}
+
+static void Decode_STK(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_STK_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+
+	if ( V2MP_OP_STK_PUSH(instr) )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_ALT;
+	}
+
+	if ( V2MP_OP_STK_R0(instr) )
+	{
+		decoded->immediate |= (1 << V2MP_REGID_R0);
+	}
+
+	if ( V2MP_OP_STK_R1(instr) )
+	{
+		decoded->immediate |= (1 << V2MP_REGID_R1);
+	}
+
+	if ( V2MP_OP_STK_LR(instr) )
+	{
+		decoded->immediate |= (1 << V2MP_REGID_LR);
+	}
+
+	if ( V2MP_OP_STK_PC(instr) )
+	{
+		decoded->immediate |= (1 << V2MP_REGID_PC);
+	}
+
+	if ( decoded->immediate == 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+}
+
+static void Decode_SIG(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( V2MP_OP_SIG_RESBITS(instr) != 0 )
+	{
+		decoded->flags |= V2MP_DECODED_FLAG_RESBITS;
+	}
+}
+
+static void Decode_Unassigned(V2MP_Word instr, V2MP_CPU_DecodedInstruction* decoded)
+{
+	// Nothing to decode - executing the instruction raises an INI fault.
+	(void)instr;
+	(void)decoded;
+}
+
+void V2MP_CPU_DecodeInstruction(V2MP_Word instruction, V2MP_CPU_DecodedInstruction* outDecoded)
+{
+	if ( !outDecoded )
+	{
+		return;
+	}
+
+	outDecoded->word = instruction;
+	outDecoded->immediate = 0;
+	outDecoded->handler = (uint8_t)V2MP_OPCODE(instruction);
+	outDecoded->sourceReg = 0;
+	outDecoded->destReg = 0;
+	outDecoded->flags = 0;
+	outDecoded->fusion = 0;
+
+	DECODE_TABLE[V2MP_OPCODE(instruction)](instruction, outDecoded);
+
+	if ( outDecoded->flags & V2MP_DECODED_FLAG_RESBITS )
+	{
+		outDecoded->handler = V2MP_DECODED_HANDLER_RES;
+	}
+}
+
+void V2MP_CPU_DecodeInstructions(
+	const V2MP_Word* instructions,
+	size_t numInstructions,
+	V2MP_CPU_DecodedInstruction* outDecoded
+)
+{
+	size_t index;
+
+	if ( !instructions || !outDecoded )
+	{
+		return;
+	}
+
+	for ( index = 0; index < numInstructions; ++index )
+	{
+		V2MP_CPU_LookUpDecodedInstruction(instructions[index], &outDecoded[index]);
+	}
+}
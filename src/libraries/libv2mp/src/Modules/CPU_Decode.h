@@ -0,0 +1,92 @@
+#ifndef V2MP_MODULES_CPU_DECODE_H
+#define V2MP_MODULES_CPU_DECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "LibV2MP/Defs.h"
+
+// Set if any reserved bits were set in the instruction word,
+// or if the combination of operands is otherwise invalid.
+// Executing the instruction raises a RES fault.
+#define V2MP_DECODED_FLAG_RESBITS (1 << 0)
+
+// Set if the instruction operates on the literal value held in
+// the immediate field, rather than on the source register.
+#define V2MP_DECODED_FLAG_LITERAL (1 << 1)
+
+// MUL/DIV: the operation is signed.
+#define V2MP_DECODED_FLAG_SIGNED (1 << 2)
+
+// LDST: the operation is a store.
+// STK: the operation is a push.
+// CBX: the branch is taken based on SR[C] rather than SR[Z].
+#define V2MP_DECODED_FLAG_ALT (1 << 3)
+
+// CBX: the branch target is LR.
+#define V2MP_DECODED_FLAG_LR_TARGET (1 << 4)
+
+// BITW: the bitwise operation is held in the top two bits of the flags.
+#define V2MP_DECODED_FLAGS_BITOP_SHIFT 6
+#define V2MP_DECODED_BITOP(flags) ((V2MP_BitwiseOp)(((flags) >> V2MP_DECODED_FLAGS_BITOP_SHIFT) & 0x3))
+
+// Handler indices 0x0-0xF correspond directly to opcodes.
+// Encodings that are known at decode time to be invalid are
+// instead given a dedicated handler that just raises the fault,
+// so that the opcode handlers do not need to check for them.
+#define V2MP_DECODED_HANDLER_RES 0x10
+#define V2MP_DECODED_HANDLER_COUNT 0x11
+
+// Compact representation of an instruction word, with all operands
+// extracted so that handlers do not need to re-parse the raw word.
+typedef struct V2MP_CPU_DecodedInstruction
+{
+	// Original instruction word, to be placed into IR.
+	V2MP_Word word;
+
+	// Literal operand, already extended to 16 bits according to the
+	// rules of the instruction. For CBX this is the branch offset in
+	// bytes, for STK it is the register bitmask, and for a BITW with
+	// a literal operand it is the generated bit mask.
+	V2MP_Word immediate;
+
+	// Index into the CPU's instruction handler table.
+	uint8_t handler;
+
+	// Always valid indices into the CPU's register file.
+	uint8_t sourceReg;
+	uint8_t destReg;
+	uint8_t flags;
+
+	// If non-zero, this instruction begins a sequence that may be executed
+	// as a single fused operation. Set at load time - see CPU_Fusion.h.
+	uint8_t fusion;
+} V2MP_CPU_DecodedInstruction;
+
+// Always computes the decoded form from scratch, regardless of
+// whether the build is using the full decode table.
+void V2MP_CPU_DecodeInstruction(V2MP_Word instruction, V2MP_CPU_DecodedInstruction* outDecoded);
+
+#ifdef V2MP_FULL_DECODE_TABLE
+// Every possible instruction word, decoded at build time
+// by tools/DecodeTableGenerator.c.
+extern const V2MP_CPU_DecodedInstruction V2MP_CPU_DECODE_TABLE[0x10000];
+#endif
+
+// Uses the decode table if the build has one, and computes the
+// decoded form otherwise.
+static inline void V2MP_CPU_LookUpDecodedInstruction(V2MP_Word instruction, V2MP_CPU_DecodedInstruction* outDecoded)
+{
+#ifdef V2MP_FULL_DECODE_TABLE
+	*outDecoded = V2MP_CPU_DECODE_TABLE[instruction];
+#else
+	V2MP_CPU_DecodeInstruction(instruction, outDecoded);
+#endif
+}
+
+void V2MP_CPU_DecodeInstructions(
+	const V2MP_Word* instructions,
+	size_t numInstructions,
+	V2MP_CPU_DecodedInstruction* outDecoded
+);
+
+#endif // V2MP_MODULES_CPU_DECODE_H
@@ -0,0 +1,153 @@
+#ifndef V2MP_MODULES_CPU_FLAGS_H
+#define V2MP_MODULES_CPU_FLAGS_H
+
+#include "Modules/CPU_Internal.h"
+
+// All writes to and reads from SR inside the CPU go through these functions.
+//
+// If V2MP_LAZY_FLAGS is defined, instructions that set SR purely from their
+// result only record the result (and, for ADD and SUB, the original value
+// of the destination register), and SR is computed from these the next time
+// it is read. Otherwise, SR is always computed immediately.
+
+#ifdef V2MP_LAZY_FLAGS
+static inline V2MP_Word V2MP_CPU_ComputeFlags(const V2MP_CPU* cpu)
+{
+	V2MP_Word flags = 0;
+
+	switch ( cpu->pendingFlags )
+	{
+		case V2MP_CPU_FLAGS_RESOLVED:
+		{
+			return cpu->sr;
+		}
+
+		case V2MP_CPU_FLAGS_ADD:
+		{
+			if ( cpu->flagsResult < cpu->flagsOperand )
+			{
+				flags |= V2MP_CPU_SR_C;
+			}
+
+			break;
+		}
+
+		case V2MP_CPU_FLAGS_SUB:
+		{
+			if ( cpu->flagsResult > cpu->flagsOperand )
+			{
+				flags |= V2MP_CPU_SR_C;
+			}
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	if ( cpu->flagsResult == 0 )
+	{
+		flags |= V2MP_CPU_SR_Z;
+	}
+
+	return flags;
+}
+#endif
+
+// Returns the up-to-date value of SR.
+static inline V2MP_Word V2MP_CPU_GetFlags(V2MP_CPU* cpu)
+{
+#ifdef V2MP_LAZY_FLAGS
+	if ( cpu->pendingFlags != V2MP_CPU_FLAGS_RESOLVED )
+	{
+		cpu->sr = V2MP_CPU_ComputeFlags(cpu);
+		cpu->pendingFlags = V2MP_CPU_FLAGS_RESOLVED;
+	}
+#endif
+
+	return cpu->sr;
+}
+
+static inline V2MP_Word V2MP_CPU_GetFlagsConst(const V2MP_CPU* cpu)
+{
+#ifdef V2MP_LAZY_FLAGS
+	return V2MP_CPU_ComputeFlags(cpu);
+#else
+	return cpu->sr;
+#endif
+}
+
+static inline void V2MP_CPU_SetFlags(V2MP_CPU* cpu, V2MP_Word flags)
+{
+	cpu->sr = flags;
+
+#ifdef V2MP_LAZY_FLAGS
+	cpu->pendingFlags = V2MP_CPU_FLAGS_RESOLVED;
+#endif
+}
+
+// Individual flags may be set on SR directly after this is called.
+static inline void V2MP_CPU_ClearFlags(V2MP_CPU* cpu)
+{
+	V2MP_CPU_SetFlags(cpu, 0);
+}
+
+// Z is set if the result is zero.
+static inline void V2MP_CPU_SetFlagsFromResult(V2MP_CPU* cpu, V2MP_Word result)
+{
+#ifdef V2MP_LAZY_FLAGS
+	cpu->pendingFlags = V2MP_CPU_FLAGS_RESULT;
+	cpu->flagsResult = result;
+#else
+	cpu->sr = result == 0 ? V2MP_CPU_SR_Z : 0;
+#endif
+}
+
+// C is set if the addition overflowed, and Z is set if the result is zero.
+static inline void V2MP_CPU_SetFlagsFromAdd(V2MP_CPU* cpu, V2MP_Word result, V2MP_Word oldValue)
+{
+#ifdef V2MP_LAZY_FLAGS
+	cpu->pendingFlags = V2MP_CPU_FLAGS_ADD;
+	cpu->flagsResult = result;
+	cpu->flagsOperand = oldValue;
+#else
+	cpu->sr = 0;
+
+	if ( result < oldValue )
+	{
+		cpu->sr |= V2MP_CPU_SR_C;
+	}
+
+	if ( result == 0 )
+	{
+		cpu->sr |= V2MP_CPU_SR_Z;
+	}
+#endif
+}
+
+// C is set if the subtraction underflowed, and Z is set if the result is zero.
+static inline void V2MP_CPU_SetFlagsFromSub(V2MP_CPU* cpu, V2MP_Word result, V2MP_Word oldValue)
+{
+#ifdef V2MP_LAZY_FLAGS
+	cpu->pendingFlags = V2MP_CPU_FLAGS_SUB;
+	cpu->flagsResult = result;
+	cpu->flagsOperand = oldValue;
+#else
+	cpu->sr = 0;
+
+	if ( result > oldValue )
+	{
+		cpu->sr |= V2MP_CPU_SR_C;
+	}
+
+	if ( result == 0 )
+	{
+		cpu->sr |= V2MP_CPU_SR_Z;
+	}
+#endif
+}
+
+#endif // V2MP_MODULES_CPU_FLAGS_H
@@ -0,0 +1,161 @@
+#include "Modules/CPU_Fusion.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/CPU_Flags.h"
+#include "LibBaseUtil/Util.h"
+
+// A fused operation must leave the CPU in exactly the same state as
+// executing each of its instructions in turn would have done. Only
+// sequences that cannot raise a fault or create supervisor actions
+// are suitable for fusion.
+typedef struct FusionDef
+{
+	// Number of instructions replaced by the fused operation.
+	size_t length;
+
+	// Called with at least "length" instructions available.
+	bool (* matches)(const V2MP_CPU_DecodedInstruction* instrs);
+
+	// Called with PC pointing to the first instruction of the sequence.
+	void (* execute)(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* instrs);
+} FusionDef;
+
+static bool Matches_Load16(const V2MP_CPU_DecodedInstruction* instrs);
+static void Execute_Load16(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* instrs);
+static bool Matches_Jump(const V2MP_CPU_DecodedInstruction* instrs);
+static void Execute_Jump(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* instrs);
+
+// Where one idiom is a prefix of another, the longer one must come first.
+// Entry N in this table is referred to by a fusion index of N + 1.
+static const FusionDef FUSION_TABLE[] =
+{
+	// asgn R R <hi; shft R R 8; add R R >lo; asgn R 3 0
+	{ 4, &Matches_Jump, &Execute_Jump },
+
+	// asgn R R <hi; shft R R 8; add R R >lo
+	{ 3, &Matches_Load16, &Execute_Load16 }
+};
+
+static inline bool IsLiteralOp(const V2MP_CPU_DecodedInstruction* instr, uint8_t handler, uint8_t reg)
+{
+	return
+		instr->handler == handler &&
+		(instr->flags & V2MP_DECODED_FLAG_LITERAL) &&
+		instr->destReg == reg;
+}
+
+static inline V2MP_Word ComputeLoad16Value(const V2MP_CPU_DecodedInstruction* instrs)
+{
+	// Mirrors the ASGN, SHFT and ADD handlers.
+	return (V2MP_Word)((V2MP_Word)(instrs[0].immediate << 8) + instrs[2].immediate);
+}
+
+static bool Matches_Load16(const V2MP_CPU_DecodedInstruction* instrs)
+{
+	const uint8_t reg = instrs[0].destReg;
+
+	return
+		reg != V2MP_REGID_PC &&
+		IsLiteralOp(&instrs[0], V2MP_OP_ASGN, reg) &&
+		IsLiteralOp(&instrs[1], V2MP_OP_SHFT, reg) &&
+		instrs[1].immediate == 8 &&
+		IsLiteralOp(&instrs[2], V2MP_OP_ADD, reg);
+}
+
+static void Execute_Load16(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* instrs)
+{
+	const V2MP_Word shifted = (V2MP_Word)(instrs[0].immediate << 8);
+	const V2MP_Word value = ComputeLoad16Value(instrs);
+
+	cpu->regs[instrs[0].destReg] = value;
+
+	// SR is left as the final ADD would leave it.
+	V2MP_CPU_SetFlagsFromAdd(cpu, value, shifted);
+
+	cpu->ir = instrs[2].word;
+	cpu->regs[V2MP_REGID_PC] += 3 * sizeof(V2MP_Word);
+}
+
+static bool Matches_Jump(const V2MP_CPU_DecodedInstruction* instrs)
+{
+	return
+		Matches_Load16(instrs) &&
+		instrs[3].handler == V2MP_OP_ASGN &&
+		!(instrs[3].flags & V2MP_DECODED_FLAG_LITERAL) &&
+		instrs[3].sourceReg == instrs[0].destReg &&
+		instrs[3].destReg == V2MP_REGID_PC;
+}
+
+static void Execute_Jump(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* instrs)
+{
+	const V2MP_Word value = ComputeLoad16Value(instrs);
+
+	cpu->regs[instrs[0].destReg] = value;
+
+	// SR is left as the final ASGN would leave it.
+	V2MP_CPU_SetFlagsFromResult(cpu, value);
+
+	cpu->ir = instrs[3].word;
+	cpu->regs[V2MP_REGID_PC] = value;
+}
+
+void V2MP_CPU_FuseInstructions(V2MP_CPU_DecodedInstruction* decoded, size_t count)
+{
+	size_t index;
+	size_t fusionIndex;
+
+	if ( !decoded )
+	{
+		return;
+	}
+
+	for ( index = 0; index < count; ++index )
+	{
+		decoded[index].fusion = 0;
+
+		for ( fusionIndex = 0; fusionIndex < BASEUTIL_ARRAY_SIZE(FUSION_TABLE); ++fusionIndex )
+		{
+			const FusionDef* def = &FUSION_TABLE[fusionIndex];
+
+			if ( def->length <= count - index && def->matches(&decoded[index]) )
+			{
+				decoded[index].fusion = (uint8_t)(fusionIndex + 1);
+				break;
+			}
+		}
+	}
+}
+
+size_t V2MP_CPU_GetFusedLength(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	return decoded->fusion != 0 ? FUSION_TABLE[decoded->fusion - 1].length : 0;
+}
+
+void V2MP_CPU_ExecuteFusedInstruction(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	FUSION_TABLE[decoded->fusion - 1].execute(cpu, decoded);
+}
+
+size_t V2MP_CPU_TryExecuteFusedInstruction(V2MP_CPU* cpu, size_t maxCycles)
+{
+	const V2MP_CPU_DecodedInstruction* decoded;
+	size_t length;
+
+	if ( !cpu->decodedCS ||
+	     (cpu->regs[V2MP_REGID_PC] & 1) != 0 ||
+	     (size_t)(cpu->regs[V2MP_REGID_PC] >> 1) >= cpu->decodedCSCount )
+	{
+		return 0;
+	}
+
+	decoded = &cpu->decodedCS[cpu->regs[V2MP_REGID_PC] >> 1];
+
+	length = V2MP_CPU_GetFusedLength(decoded);
+
+	if ( length == 0 || length > maxCycles )
+	{
+		return 0;
+	}
+
+	V2MP_CPU_ExecuteFusedInstruction(cpu, decoded);
+	return length;
+}
@@ -0,0 +1,29 @@
+#ifndef V2MP_MODULES_CPU_FUSION_H
+#define V2MP_MODULES_CPU_FUSION_H
+
+#include <stddef.h>
+#include "LibV2MP/Modules/CPU.h"
+#include "Modules/CPU_Decode.h"
+
+// Scans a decoded code segment for known multi-instruction idioms,
+// and marks the first instruction of each with the fused operation
+// that replaces the sequence. The remaining instructions are left
+// untouched, so that branching into the middle of a sequence, or
+// executing it one cycle at a time, behaves exactly as before.
+void V2MP_CPU_FuseInstructions(V2MP_CPU_DecodedInstruction* decoded, size_t count);
+
+// Returns the number of instructions covered by the fused operation that
+// begins at this instruction, or 0 if the instruction is not fused.
+size_t V2MP_CPU_GetFusedLength(const V2MP_CPU_DecodedInstruction* decoded);
+
+// Executes the fused operation that begins at this instruction, which must be
+// the instruction at PC. The instruction must have a non-zero fused length.
+void V2MP_CPU_ExecuteFusedInstruction(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+
+// If the instruction at PC begins a fused sequence that fits within
+// the given cycle budget, executes the whole sequence and returns
+// the number of cycles that it accounts for. Otherwise, returns 0
+// and leaves the CPU untouched.
+size_t V2MP_CPU_TryExecuteFusedInstruction(V2MP_CPU* cpu, size_t maxCycles);
+
+#endif // V2MP_MODULES_CPU_FUSION_H
@@ -1,30 +1,31 @@
 #include <stdlib.h>
 #include "Modules/CPU_Instructions.h"
 #include "Modules/CPU_Internal.h"
-
-// Return value is false under exceptional circumstances
-// (eg. CPU was not set up with supervisor interface).
-// These circumstances imply a programmer error. Other
-// error states that the CPU may legitimately enter into
-// (eg. raising a fault) should still result in true
-// being returned.
-typedef bool (* InstructionCallback)(V2MP_CPU*);
-
-static bool Execute_NOP(V2MP_CPU* cpu);
-static bool Execute_ADD(V2MP_CPU* cpu);
-static bool Execute_SUB(V2MP_CPU* cpu);
-static bool Execute_MUL(V2MP_CPU* cpu);
-static bool Execute_DIV(V2MP_CPU* cpu);
-static bool Execute_ASGN(V2MP_CPU* cpu);
-static bool Execute_SHFT(V2MP_CPU* cpu);
-static bool Execute_BITW(V2MP_CPU* cpu);
-static bool Execute_CBX(V2MP_CPU* cpu);
-static bool Execute_LDST(V2MP_CPU* cpu);
-static bool Execute_STK(V2MP_CPU* cpu);
-static bool Execute_SIG(V2MP_CPU* cpu);
-static bool Execute_Unassigned(V2MP_CPU* cpu);
-
-static const InstructionCallback INSTRUCTION_TABLE[0x10] =
+#include "Modules/CPU_Decode.h"
+#include "Modules/CPU_Flags.h"
+#include "Modules/CPU_Fusion.h"
+#include "Modules/CPU_BlockCache.h"
+#include "Modules/CPU_Precompiled.h"
+#include "LibBaseUtil/Util.h"
+
+typedef V2MP_CPU_InstructionCallback InstructionCallback;
+
+static bool Execute_NOP(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_ADD(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_SUB(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_MUL(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_DIV(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_ASGN(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_SHFT(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_BITW(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_CBX(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_LDST(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_STK(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_SIG(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_Unassigned(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+static bool Execute_ReservedBits(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+
+static const InstructionCallback INSTRUCTION_TABLE[V2MP_DECODED_HANDLER_COUNT] =
 {
 	&Execute_NOP,			// 0x0
 	&Execute_ADD,			// 0x1
@@ -41,7 +42,8 @@ static const InstructionCallback INSTRUCTION_TABLE[0x10] =
 	&Execute_Unassigned,	// 0xC
 	&Execute_Unassigned,	// 0xD
 	&Execute_Unassigned,	// 0xE
-	&Execute_Unassigned		// 0xF
+	&Execute_Unassigned,	// 0xF
+	&Execute_ReservedBits	// V2MP_DECODED_HANDLER_RES
 };
 
 static inline void SetFault(V2MP_CPU* cpu, V2MP_Fault fault, V2MP_Word args)
@@ -49,109 +51,80 @@ static inline void SetFault(V2MP_CPU* cpu, V2MP_Fault fault, V2MP_Word args)
 	V2MP_CPU_NotifyFault(cpu, V2MP_CPU_MAKE_FAULT_WORD(fault, args));
 }
 
-static bool Execute_ADDOrSUB(V2MP_CPU* cpu, bool isAdd)
+static inline bool HasLiteralOperand(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	return (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+}
+
+static bool Execute_ADDOrSUB(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded, bool isAdd)
 {
 	int32_t multiplier;
-	V2MP_Word* sourceReg;
 	V2MP_Word* destReg;
 	V2MP_Word oldValue;
 
 	multiplier = isAdd ? 1 : -1;
-	sourceReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_ADDSUB_SREGINDEX(cpu->ir));
-	destReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_ADDSUB_DREGINDEX(cpu->ir));
+	destReg = &cpu->regs[decoded->destReg];
 	oldValue = *destReg;
 
-	if ( V2MP_OP_ADDSUB_DREGINDEX(cpu->ir) == V2MP_REGID_PC )
+	if ( decoded->destReg == V2MP_REGID_PC )
 	{
 		// Increment or decrement by words, not bytes.
 		multiplier *= sizeof(V2MP_Word);
 	}
 
-	if ( sourceReg != destReg )
+	if ( HasLiteralOperand(decoded) )
 	{
-		if ( V2MP_OP_ADDSUB_VALUE(cpu->ir) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		*destReg += (V2MP_Word)(multiplier * (int32_t)(*sourceReg));
+		*destReg += (V2MP_Word)(multiplier * (int32_t)decoded->immediate);
 	}
 	else
 	{
-		*destReg += (V2MP_Word)(multiplier * (int32_t)((uint8_t)V2MP_OP_ADDSUB_VALUE(cpu->ir)));
+		*destReg += (V2MP_Word)(multiplier * (int32_t)(cpu->regs[decoded->sourceReg]));
 	}
 
-	cpu->sr = 0;
-
-	if ( (V2MP_OPCODE(cpu->ir) == V2MP_OP_ADD && *destReg < oldValue) ||
-	     (V2MP_OPCODE(cpu->ir) == V2MP_OP_SUB && *destReg > oldValue) )
+	if ( isAdd )
 	{
-		cpu->sr |= V2MP_CPU_SR_C;
+		V2MP_CPU_SetFlagsFromAdd(cpu, *destReg, oldValue);
 	}
-
-	if ( *destReg == 0 )
+	else
 	{
-		cpu->sr |= V2MP_CPU_SR_Z;
+		V2MP_CPU_SetFlagsFromSub(cpu, *destReg, oldValue);
 	}
 
 	return true;
 }
 
-static bool Execute_NOP(V2MP_CPU* cpu)
+static bool Execute_NOP(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	if ( V2MP_OP_NOP_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
+	(void)cpu;
+	(void)decoded;
 
 	// Do absolutely nothing.
 	return true;
 }
 
-static bool Execute_ADD(V2MP_CPU* cpu)
+static bool Execute_ADD(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	return Execute_ADDOrSUB(cpu, true);
+	return Execute_ADDOrSUB(cpu, decoded, true);
 }
 
-static bool Execute_SUB(V2MP_CPU* cpu)
+static bool Execute_SUB(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	return Execute_ADDOrSUB(cpu, false);
+	return Execute_ADDOrSUB(cpu, decoded, false);
 }
 
-static bool Execute_MUL(V2MP_CPU* cpu)
+static bool Execute_MUL(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
 	V2MP_Word* destReg;
 	V2MP_Word srcVal;
 	bool overflowed = false;
 
-	if ( V2MP_OP_MULDIV_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
+	destReg = &cpu->regs[decoded->destReg];
 
-	destReg = V2MP_OP_MULDIV_DEST_IS_R1(cpu->ir) ? &cpu->r1 : &cpu->r0;
-
-	if ( V2MP_OP_MULDIV_SOURCE_IS_STATIC(cpu->ir) )
-	{
-		if ( V2MP_OP_MULDIV_IS_SIGNED(cpu->ir) )
-		{
-			const int8_t value = (int8_t)V2MP_OP_MULDIV_VALUE(cpu->ir);
-			srcVal =  (V2MP_Word)((int16_t)value);
-		}
-		else
-		{
-			srcVal = (V2MP_Word)V2MP_OP_MULDIV_VALUE(cpu->ir);
-		}
-	}
-	else
-	{
-		srcVal = V2MP_OP_MULDIV_DEST_IS_R1(cpu->ir) ? cpu->r0 : cpu->r1;
-	}
+	srcVal = HasLiteralOperand(decoded)
+		? decoded->immediate
+		: cpu->regs[decoded->sourceReg];
 
-	if ( V2MP_OP_MULDIV_IS_SIGNED(cpu->ir) )
+	if ( decoded->flags & V2MP_DECODED_FLAG_SIGNED )
 	{
 		int32_t result = (int16_t)(*destReg) * (int16_t)srcVal;
 		V2MP_Word* castResult = (V2MP_Word*)(&result);
@@ -165,7 +138,7 @@ static bool Execute_MUL(V2MP_CPU* cpu)
 			overflowed = result < -32768;
 		}
 
-		cpu->lr = castResult[1];
+		cpu->regs[V2MP_REGID_LR] = castResult[1];
 		*destReg = castResult[0];
 	}
 	else
@@ -175,18 +148,18 @@ static bool Execute_MUL(V2MP_CPU* cpu)
 
 		overflowed = castResult[1] != 0;
 
-		cpu->lr = castResult[1];
+		cpu->regs[V2MP_REGID_LR] = castResult[1];
 		*destReg = castResult[0];
 	}
 
-	cpu->sr = 0;
+	V2MP_CPU_ClearFlags(cpu);
 
 	if ( overflowed )
 	{
 		cpu->sr |= V2MP_CPU_SR_C;
 	}
 
-	if ( cpu->lr == 0 && *destReg == 0 )
+	if ( cpu->regs[V2MP_REGID_LR] == 0 && *destReg == 0 )
 	{
 		cpu->sr |= V2MP_CPU_SR_Z;
 	}
@@ -194,35 +167,16 @@ static bool Execute_MUL(V2MP_CPU* cpu)
 	return true;
 }
 
-static bool Execute_DIV(V2MP_CPU* cpu)
+static bool Execute_DIV(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
 	V2MP_Word* destReg;
 	V2MP_Word srcVal;
 
-	if ( V2MP_OP_MULDIV_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
+	destReg = &cpu->regs[decoded->destReg];
 
-	destReg = V2MP_OP_MULDIV_DEST_IS_R1(cpu->ir) ? &cpu->r1 : &cpu->r0;
-
-	if ( V2MP_OP_MULDIV_SOURCE_IS_STATIC(cpu->ir) )
-	{
-		if ( V2MP_OP_MULDIV_IS_SIGNED(cpu->ir) )
-		{
-			const int8_t value = (int8_t)V2MP_OP_MULDIV_VALUE(cpu->ir);
-			srcVal =  (V2MP_Word)((int16_t)value);
-		}
-		else
-		{
-			srcVal = (V2MP_Word)V2MP_OP_MULDIV_VALUE(cpu->ir);
-		}
-	}
-	else
-	{
-		srcVal = V2MP_OP_MULDIV_DEST_IS_R1(cpu->ir) ? cpu->r0 : cpu->r1;
-	}
+	srcVal = HasLiteralOperand(decoded)
+		? decoded->immediate
+		: cpu->regs[decoded->sourceReg];
 
 	if ( srcVal == 0 )
 	{
@@ -230,20 +184,20 @@ static bool Execute_DIV(V2MP_CPU* cpu)
 		return true;
 	}
 
-	if ( V2MP_OP_MULDIV_IS_SIGNED(cpu->ir) )
+	if ( decoded->flags & V2MP_DECODED_FLAG_SIGNED )
 	{
-		cpu->lr = (V2MP_Word)(*((int16_t*)(destReg)) % (int16_t)srcVal);
+		cpu->regs[V2MP_REGID_LR] = (V2MP_Word)(*((int16_t*)(destReg)) % (int16_t)srcVal);
 		*destReg = (V2MP_Word)(*((int16_t*)(destReg)) / (int16_t)srcVal);
 	}
 	else
 	{
-		cpu->lr = *destReg % srcVal;
+		cpu->regs[V2MP_REGID_LR] = *destReg % srcVal;
 		*destReg /= srcVal;
 	}
 
-	cpu->sr = 0;
+	V2MP_CPU_ClearFlags(cpu);
 
-	if ( cpu->lr != 0 )
+	if ( cpu->regs[V2MP_REGID_LR] != 0 )
 	{
 		cpu->sr |= V2MP_CPU_SR_C;
 	}
@@ -256,87 +210,36 @@ static bool Execute_DIV(V2MP_CPU* cpu)
 	return true;
 }
 
-static bool Execute_ASGN(V2MP_CPU* cpu)
+static bool Execute_ASGN(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	V2MP_Word* sourceReg;
 	V2MP_Word* destReg;
 
-	sourceReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_ASGN_SREGINDEX(cpu->ir));
-	destReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_ASGN_DREGINDEX(cpu->ir));
-
-	if ( sourceReg != destReg )
-	{
-		if ( V2MP_OP_ASGN_VALUE(cpu->ir) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		*destReg = *sourceReg;
-	}
-	else
-	{
-		if ( V2MP_OP_ASGN_DREGINDEX(cpu->ir) == V2MP_REGID_PC )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		*destReg = (int8_t)V2MP_OP_ASGN_VALUE(cpu->ir);
-	}
-
-	cpu->sr = 0;
+	destReg = &cpu->regs[decoded->destReg];
 
-	if ( *destReg == 0 )
-	{
-		cpu->sr |= V2MP_CPU_SR_Z;
-	}
+	*destReg = HasLiteralOperand(decoded)
+		? decoded->immediate
+		: cpu->regs[decoded->sourceReg];
 
+	V2MP_CPU_SetFlagsFromResult(cpu, *destReg);
 	return true;
 }
 
-static bool Execute_SHFT(V2MP_CPU* cpu)
+static bool Execute_SHFT(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	V2MP_Word* sourceReg;
 	V2MP_Word* destReg;
 	V2MP_Word rawShiftValue = 0;
 	int16_t signedShiftValue = 0;
 
-	if ( V2MP_OP_SHFT_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
+	destReg = &cpu->regs[decoded->destReg];
 
-	sourceReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_SHFT_SREGINDEX(cpu->ir));
-	destReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_SHFT_DREGINDEX(cpu->ir));
-
-	if ( sourceReg != destReg )
-	{
-		if ( V2MP_OP_SHFT_VALUE(cpu->ir) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		rawShiftValue = *sourceReg;
-	}
-	else
-	{
-		rawShiftValue = V2MP_OP_SHFT_VALUE(cpu->ir);
-
-		if ( rawShiftValue & 0x0010 )
-		{
-			// This is a 5-bit value. Bit 4 signifies that it is negative.
-			// Construct a 16-bit two's complement for the negative value.
-			rawShiftValue = 0xFFF0 | (rawShiftValue & 0x000F);
-		}
-	}
+	rawShiftValue = HasLiteralOperand(decoded)
+		? decoded->immediate
+		: cpu->regs[decoded->sourceReg];
 
 	// Actually interpret these bits as signed now.
 	signedShiftValue = *((int16_t*)&rawShiftValue);
 
-	cpu->sr = 0;
+	V2MP_CPU_ClearFlags(cpu);
 
 	// To check whether any bits got shifted off the end,
 	// we can mask the original value with the span of bits
@@ -373,50 +276,18 @@ static bool Execute_SHFT(V2MP_CPU* cpu)
 	return true;
 }
 
-static bool Execute_BITW(V2MP_CPU* cpu)
+static bool Execute_BITW(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	V2MP_Word* sourceReg;
 	V2MP_Word* destReg;
 	V2MP_Word bitmask;
 
-	if ( V2MP_OP_BITW_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
-
-	sourceReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_BITW_SREGINDEX(cpu->ir));
-	destReg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_BITW_DREGINDEX(cpu->ir));
-
-	if ( sourceReg != destReg )
-	{
-		if ( V2MP_OP_BITW_MASKSHIFT(cpu->ir) != 0 ||
-		     V2MP_OP_BITW_FLIPMASK(cpu->ir) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		bitmask = *sourceReg;
-	}
-	else
-	{
-		if ( V2MP_OP_BITW_OPTYPE(cpu->ir) == V2MP_BITOP_NOT &&
-		     (V2MP_OP_BITW_FLIPMASK(cpu->ir) | V2MP_OP_BITW_MASKSHIFT(cpu->ir)) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		bitmask = (1 << V2MP_OP_BITW_MASKSHIFT(cpu->ir));
+	destReg = &cpu->regs[decoded->destReg];
 
-		if ( V2MP_OP_BITW_FLIPMASK(cpu->ir) )
-		{
-			bitmask = ~bitmask;
-		}
-	}
+	bitmask = HasLiteralOperand(decoded)
+		? decoded->immediate
+		: cpu->regs[decoded->sourceReg];
 
-	switch ( V2MP_OP_BITW_OPTYPE(cpu->ir) )
+	switch ( V2MP_DECODED_BITOP(decoded->flags) )
 	{
 		case V2MP_BITOP_AND:
 		{
@@ -443,100 +314,101 @@ static bool Execute_BITW(V2MP_CPU* cpu)
 		}
 	}
 
-	cpu->sr = 0;
-
-	if ( *destReg == 0 )
-	{
-		cpu->sr |= V2MP_CPU_SR_Z;
-	}
-
+	V2MP_CPU_SetFlagsFromResult(cpu, *destReg);
 	return true;
 }
 
-static bool Execute_CBX(V2MP_CPU* cpu)
+static bool Execute_CBX(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
 	bool shouldBranch;
 
-	if ( V2MP_OP_CBX_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
-
-	shouldBranch =
-		(V2MP_OP_CBX_BRANCH_ON_SR_Z(cpu->ir) && (cpu->sr & V2MP_CPU_SR_Z)) ||
-		(V2MP_OP_CBX_BRANCH_ON_SR_C(cpu->ir) && (cpu->sr & V2MP_CPU_SR_C));
+	shouldBranch = (decoded->flags & V2MP_DECODED_FLAG_ALT)
+		? (V2MP_CPU_GetFlags(cpu) & V2MP_CPU_SR_C) != 0
+		: (V2MP_CPU_GetFlags(cpu) & V2MP_CPU_SR_Z) != 0;
 
-	if ( V2MP_OP_CBX_LR_IS_TARGET(cpu->ir) )
+	if ( shouldBranch )
 	{
-		if ( V2MP_OP_CBX_OFFSET(cpu->ir) != 0 )
-		{
-			SetFault(cpu, V2MP_FAULT_RES, 0);
-			return true;
-		}
-
-		if ( shouldBranch )
+		if ( decoded->flags & V2MP_DECODED_FLAG_LR_TARGET )
 		{
-			cpu->pc = cpu->lr;
+			cpu->regs[V2MP_REGID_PC] = cpu->regs[V2MP_REGID_LR];
 		}
-	}
-	else
-	{
-		if ( shouldBranch )
+		else
 		{
-			cpu->pc += sizeof(V2MP_Word) * (int8_t)V2MP_OP_CBX_OFFSET(cpu->ir);
+			cpu->regs[V2MP_REGID_PC] += decoded->immediate;
 		}
 	}
 
-	cpu->sr = 0;
-
-	if ( !shouldBranch )
-	{
-		cpu->sr |= V2MP_CPU_SR_Z;
-	}
+	V2MP_CPU_SetFlags(cpu, shouldBranch ? 0 : V2MP_CPU_SR_Z);
 
 	return true;
 }
 
-static bool Execute_LDST(V2MP_CPU* cpu)
+static bool Execute_LDST(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
 	V2MP_Word* reg;
+	V2MP_Word fault;
+	V2MP_Word loadedWord = 0;
 
-	if ( !cpu->supervisorInterface.requestLoadWordFromDS ||
-	     !cpu->supervisorInterface.requestStoreWordToDS )
-	{
-		return false;
-	}
+	reg = &cpu->regs[decoded->destReg];
 
-	if ( V2MP_OP_LDST_RESBITS(cpu->ir) != 0 )
+	if ( cpu->supervisorInterface.loadWordFromDS &&
+	     cpu->supervisorInterface.storeWordToDS )
 	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
+		if ( decoded->flags & V2MP_DECODED_FLAG_ALT )
+		{
+			fault = cpu->supervisorInterface.storeWordToDS(
+				cpu->supervisorInterface.supervisor,
+				cpu->regs[V2MP_REGID_LR],
+				*reg
+			);
+
+			V2MP_CPU_SetFlagsFromResult(cpu, *reg);
+		}
+		else
+		{
+			fault = cpu->supervisorInterface.loadWordFromDS(
+				cpu->supervisorInterface.supervisor,
+				cpu->regs[V2MP_REGID_LR],
+				&loadedWord
+			);
+
+			if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_NONE )
+			{
+				*reg = loadedWord;
+				V2MP_CPU_SetFlagsFromResult(cpu, loadedWord);
+			}
+		}
+
+		if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+		{
+			V2MP_CPU_NotifyFault(cpu, fault);
+		}
+
 		return true;
 	}
 
-	reg = V2MP_CPU_GetRegisterPtr(cpu, V2MP_OP_LDST_REGINDEX(cpu->ir));
+	if ( !cpu->supervisorInterface.requestLoadWordFromDS ||
+	     !cpu->supervisorInterface.requestStoreWordToDS )
+	{
+		return false;
+	}
 
-	if ( V2MP_OP_LDST_IS_STORE(cpu->ir) )
+	if ( decoded->flags & V2MP_DECODED_FLAG_ALT )
 	{
 		cpu->supervisorInterface.requestStoreWordToDS(
 			cpu->supervisorInterface.supervisor,
-			cpu->lr,
+			cpu->regs[V2MP_REGID_LR],
 			*reg
 		);
 
-		cpu->sr = 0;
-
-		if ( *reg == 0 )
-		{
-			cpu->sr |= V2MP_CPU_SR_Z;
-		}
+		V2MP_CPU_SetFlagsFromResult(cpu, *reg);
 	}
 	else
 	{
 		cpu->supervisorInterface.requestLoadWordFromDS(
 			cpu->supervisorInterface.supervisor,
-			cpu->lr,
-			(V2MP_RegisterIndex)V2MP_OP_LDST_REGINDEX(cpu->ir)
+			cpu->regs[V2MP_REGID_LR],
+			(V2MP_RegisterIndex)decoded->destReg
 		);
 
 		// The status register will be updated later.
@@ -545,111 +417,404 @@ static bool Execute_LDST(V2MP_CPU* cpu)
 	return true;
 }
 
-static bool Execute_STK(V2MP_CPU* cpu)
+static void ExecuteImmediateStackOperation(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	V2MP_Word regFlags = 0;
+	V2MP_Word words[V2MP_REGID_MAX + 1];
+	size_t numWords = 0;
+	size_t index;
+	V2MP_Word fault;
 
-	if ( !cpu->supervisorInterface.requestStackPush ||
-	     !cpu->supervisorInterface.requestStackPop )
+	if ( decoded->flags & V2MP_DECODED_FLAG_ALT )
 	{
-		return false;
-	}
+		for ( index = 0; index <= V2MP_REGID_MAX; ++index )
+		{
+			if ( decoded->immediate & (1 << index) )
+			{
+				words[numWords++] = cpu->regs[index];
+			}
+		}
 
-	if ( V2MP_OP_STK_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
+		fault = cpu->supervisorInterface.pushWordsToStack(cpu->supervisorInterface.supervisor, words, numWords);
 	}
-
-	if ( V2MP_OP_STK_R0(cpu->ir) )
+	else
 	{
-		regFlags |= (1 << V2MP_REGID_R0);
-	}
+		for ( index = 0; index <= V2MP_REGID_MAX; ++index )
+		{
+			if ( decoded->immediate & (1 << index) )
+			{
+				++numWords;
+			}
+		}
 
-	if ( V2MP_OP_STK_R1(cpu->ir) )
-	{
-		regFlags |= (1 << V2MP_REGID_R1);
+		fault = cpu->supervisorInterface.popWordsFromStack(cpu->supervisorInterface.supervisor, words, numWords);
+
+		if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_NONE )
+		{
+			numWords = 0;
+
+			for ( index = 0; index <= V2MP_REGID_MAX; ++index )
+			{
+				if ( decoded->immediate & (1 << index) )
+				{
+					cpu->regs[index] = words[numWords++];
+				}
+			}
+		}
 	}
 
-	if ( V2MP_OP_STK_LR(cpu->ir) )
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
 	{
-		regFlags |= (1 << V2MP_REGID_LR);
+		V2MP_CPU_NotifyFault(cpu, fault);
 	}
+}
 
-	if ( V2MP_OP_STK_PC(cpu->ir) )
+static bool Execute_STK(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( cpu->supervisorInterface.pushWordsToStack &&
+	     cpu->supervisorInterface.popWordsFromStack )
 	{
-		regFlags |= (1 << V2MP_REGID_PC);
+		ExecuteImmediateStackOperation(cpu, decoded);
+		return true;
 	}
 
-	if ( regFlags == 0 )
+	if ( !cpu->supervisorInterface.requestStackPush ||
+	     !cpu->supervisorInterface.requestStackPop )
 	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
+		return false;
 	}
 
-	if ( V2MP_OP_STK_PUSH(cpu->ir) )
+	if ( decoded->flags & V2MP_DECODED_FLAG_ALT )
 	{
 		cpu->supervisorInterface.requestStackPush(
 			cpu->supervisorInterface.supervisor,
-			regFlags
+			decoded->immediate
 		);
 	}
 	else
 	{
 		cpu->supervisorInterface.requestStackPop(
 			cpu->supervisorInterface.supervisor,
-			regFlags
+			decoded->immediate
 		);
 	}
 
 	return true;
 }
 
-static bool Execute_SIG(V2MP_CPU* cpu)
+static bool Execute_SIG(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
+	(void)decoded;
+
 	if ( !cpu->supervisorInterface.raiseSignal )
 	{
 		return false;
 	}
 
-	if ( V2MP_OP_SIG_RESBITS(cpu->ir) != 0 )
-	{
-		SetFault(cpu, V2MP_FAULT_RES, 0);
-		return true;
-	}
-
 	cpu->supervisorInterface.raiseSignal(
 		cpu->supervisorInterface.supervisor,
-		cpu->r0,
-		cpu->r1,
-		cpu->lr,
+		cpu->regs[V2MP_REGID_R0],
+		cpu->regs[V2MP_REGID_R1],
+		cpu->regs[V2MP_REGID_LR],
 		cpu->sp
 	);
 
 	return true;
 }
 
-static bool Execute_Unassigned(V2MP_CPU* cpu)
+static bool Execute_Unassigned(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
-	SetFault(cpu, V2MP_FAULT_INI, cpu->ir >> 12);
+	SetFault(cpu, V2MP_FAULT_INI, decoded->word >> 12);
 	return true;
 }
 
-bool V2MP_CPU_ExecuteInstructionInternal(V2MP_CPU* cpu)
+static bool Execute_ReservedBits(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	(void)decoded;
+
+	SetFault(cpu, V2MP_FAULT_RES, 0);
+	return true;
+}
+
+bool V2MP_CPU_ExecuteDecodedInstruction(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded)
 {
 	InstructionCallback instructionToExecute = NULL;
 
-	if ( !cpu )
+	if ( !cpu || !decoded )
+	{
+		return false;
+	}
+
+	if ( (size_t)decoded->handler >= BASEUTIL_ARRAY_SIZE(INSTRUCTION_TABLE) )
 	{
 		return false;
 	}
 
-	instructionToExecute = INSTRUCTION_TABLE[V2MP_OPCODE(cpu->ir)];
+	instructionToExecute = INSTRUCTION_TABLE[decoded->handler];
 
 	if ( !instructionToExecute )
 	{
 		return false;
 	}
 
-	return (*instructionToExecute)(cpu);
+	return (*instructionToExecute)(cpu, decoded);
+}
+
+V2MP_CPU_InstructionCallback V2MP_CPU_GetInstructionCallback(uint8_t handler)
+{
+	return (size_t)handler < BASEUTIL_ARRAY_SIZE(INSTRUCTION_TABLE)
+		? INSTRUCTION_TABLE[handler]
+		: NULL;
+}
+
+bool V2MP_CPU_ExecuteInstructionInternal(V2MP_CPU* cpu)
+{
+#ifndef V2MP_FULL_DECODE_TABLE
+	V2MP_CPU_DecodedInstruction decoded;
+#endif
+
+	if ( !cpu )
+	{
+		return false;
+	}
+
+#ifdef V2MP_FULL_DECODE_TABLE
+	return V2MP_CPU_ExecuteDecodedInstruction(cpu, &V2MP_CPU_DECODE_TABLE[cpu->ir]);
+#else
+	V2MP_CPU_DecodeInstruction(cpu->ir, &decoded);
+	return V2MP_CPU_ExecuteDecodedInstruction(cpu, &decoded);
+#endif
+}
+
+const V2MP_CPU_DecodedInstruction* V2MP_CPU_FetchNextInstruction(
+	V2MP_CPU* cpu,
+	V2MP_CPU_DecodedInstruction* scratch
+)
+{
+	V2MP_Word fault;
+
+	if ( cpu->decodedCS &&
+	     (cpu->regs[V2MP_REGID_PC] & 1) == 0 &&
+	     (size_t)(cpu->regs[V2MP_REGID_PC] >> 1) < cpu->decodedCSCount )
+	{
+		const V2MP_CPU_DecodedInstruction* decoded = &cpu->decodedCS[cpu->regs[V2MP_REGID_PC] >> 1];
+
+		cpu->ir = decoded->word;
+		cpu->regs[V2MP_REGID_PC] += 2;
+
+		return decoded;
+	}
+
+	fault = cpu->supervisorInterface.fetchInstructionWord(
+		cpu->supervisorInterface.supervisor,
+		cpu->regs[V2MP_REGID_PC],
+		&cpu->ir
+	);
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+	{
+		V2MP_CPU_NotifyFault(cpu, fault);
+		return NULL;
+	}
+
+	cpu->regs[V2MP_REGID_PC] += 2;
+
+#ifdef V2MP_FULL_DECODE_TABLE
+	(void)scratch;
+	return &V2MP_CPU_DECODE_TABLE[cpu->ir];
+#else
+	V2MP_CPU_DecodeInstruction(cpu->ir, scratch);
+	return scratch;
+#endif
+}
+
+#ifdef V2MP_CPU_HAS_THREADED_DISPATCH
+
+typedef enum ThreadedCycleState
+{
+	THREADED_EXECUTE = 0,
+	THREADED_STOP,
+	THREADED_ERROR
+} ThreadedCycleState;
+
+static inline bool CompleteThreadedCycle(V2MP_CPU* cpu, V2MP_RunResult* outResult, bool* programExited)
+{
+	++outResult->cyclesExecuted;
+
+	return
+		!cpu->supervisorInterface.completeClockCycle ||
+		cpu->supervisorInterface.completeClockCycle(cpu->supervisorInterface.supervisor, programExited);
+}
+
+static inline ThreadedCycleState BeginThreadedCycle(
+	V2MP_CPU* cpu,
+	size_t maxCycles,
+	V2MP_RunResult* outResult,
+	bool* programExited,
+	V2MP_CPU_DecodedInstruction* scratch,
+	const V2MP_CPU_DecodedInstruction** outDecoded
+)
+{
+	size_t batchCycles;
+
+	while ( true )
+	{
+		if ( V2MP_CPU_FAULT_CODE(cpu->fault) != V2MP_FAULT_NONE )
+		{
+			outResult->stopReason = V2MP_RUNSTOP_FAULT;
+			return THREADED_STOP;
+		}
+
+		if ( *programExited )
+		{
+			outResult->stopReason = V2MP_RUNSTOP_PROGRAM_EXITED;
+			return THREADED_STOP;
+		}
+
+		if ( outResult->cyclesExecuted >= maxCycles )
+		{
+			return THREADED_STOP;
+		}
+
+		if ( cpu->stalled )
+		{
+			// The cycle passes without executing anything.
+			if ( !CompleteThreadedCycle(cpu, outResult, programExited) )
+			{
+				return THREADED_ERROR;
+			}
+
+			continue;
+		}
+
+		batchCycles = V2MP_CPU_TryExecutePrecompiledBlock(cpu, maxCycles - outResult->cyclesExecuted);
+
+		if ( batchCycles == 0 &&
+		     !V2MP_CPU_TryExecuteTranslatedBlock(cpu, maxCycles - outResult->cyclesExecuted, &batchCycles) )
+		{
+			return THREADED_ERROR;
+		}
+
+		if ( batchCycles == 0 )
+		{
+			batchCycles = V2MP_CPU_TryExecuteFusedInstruction(cpu, maxCycles - outResult->cyclesExecuted);
+		}
+
+		if ( batchCycles > 0 )
+		{
+			// Completing the cycle accounts for the last instruction in the batch.
+			outResult->cyclesExecuted += batchCycles - 1;
+
+			if ( !CompleteThreadedCycle(cpu, outResult, programExited) )
+			{
+				return THREADED_ERROR;
+			}
+
+			continue;
+		}
+
+		*outDecoded = V2MP_CPU_FetchNextInstruction(cpu, scratch);
+
+		if ( *outDecoded )
+		{
+			return THREADED_EXECUTE;
+		}
+
+		// The fetch raised a fault, which still uses up the cycle.
+		if ( !CompleteThreadedCycle(cpu, outResult, programExited) )
+		{
+			return THREADED_ERROR;
+		}
+	}
+}
+
+// Taking the address of a label and jumping to it are
+// GNU extensions, which -pedantic would otherwise reject.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#define THREADED_DISPATCH() \
+	do \
+	{ \
+		switch ( BeginThreadedCycle(cpu, maxCycles, outResult, &programExited, &scratch, &decoded) ) \
+		{ \
+			case THREADED_EXECUTE: \
+			{ \
+				goto *HANDLER_LABELS[decoded->handler]; \
+			} \
+			case THREADED_STOP: \
+			{ \
+				return true; \
+			} \
+			default: \
+			{ \
+				return false; \
+			} \
+		} \
+	} \
+	while ( 0 )
+
+#define THREADED_HANDLER(label, handler) \
+	label: \
+	{ \
+		if ( !handler(cpu, decoded) || !CompleteThreadedCycle(cpu, outResult, &programExited) ) \
+		{ \
+			return false; \
+		} \
+		THREADED_DISPATCH(); \
+	}
+
+bool V2MP_CPU_RunThreaded(V2MP_CPU* cpu, size_t maxCycles, V2MP_RunResult* outResult)
+{
+	// Must be kept in the same order as INSTRUCTION_TABLE.
+	static const void* const HANDLER_LABELS[V2MP_DECODED_HANDLER_COUNT] =
+	{
+		&&Label_NOP,
+		&&Label_ADD,
+		&&Label_SUB,
+		&&Label_MUL,
+		&&Label_DIV,
+		&&Label_ASGN,
+		&&Label_SHFT,
+		&&Label_BITW,
+		&&Label_CBX,
+		&&Label_LDST,
+		&&Label_STK,
+		&&Label_SIG,
+		&&Label_Unassigned,
+		&&Label_Unassigned,
+		&&Label_Unassigned,
+		&&Label_Unassigned,
+		&&Label_ReservedBits
+	};
+
+	V2MP_CPU_DecodedInstruction scratch;
+	const V2MP_CPU_DecodedInstruction* decoded = NULL;
+	bool programExited = false;
+
+	outResult->cyclesExecuted = 0;
+	outResult->stopReason = V2MP_RUNSTOP_CYCLE_LIMIT;
+
+	THREADED_DISPATCH();
+
+	THREADED_HANDLER(Label_NOP, Execute_NOP)
+	THREADED_HANDLER(Label_ADD, Execute_ADD)
+	THREADED_HANDLER(Label_SUB, Execute_SUB)
+	THREADED_HANDLER(Label_MUL, Execute_MUL)
+	THREADED_HANDLER(Label_DIV, Execute_DIV)
+	THREADED_HANDLER(Label_ASGN, Execute_ASGN)
+	THREADED_HANDLER(Label_SHFT, Execute_SHFT)
+	THREADED_HANDLER(Label_BITW, Execute_BITW)
+	THREADED_HANDLER(Label_CBX, Execute_CBX)
+	THREADED_HANDLER(Label_LDST, Execute_LDST)
+	THREADED_HANDLER(Label_STK, Execute_STK)
+	THREADED_HANDLER(Label_SIG, Execute_SIG)
+	THREADED_HANDLER(Label_Unassigned, Execute_Unassigned)
+	THREADED_HANDLER(Label_ReservedBits, Execute_ReservedBits)
 }
+
+#undef THREADED_HANDLER
+#undef THREADED_DISPATCH
+
+#pragma GCC diagnostic pop
+
+#endif // V2MP_CPU_HAS_THREADED_DISPATCH
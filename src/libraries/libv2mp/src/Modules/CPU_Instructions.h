@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "LibV2MP/Defs.h"
 #include "LibV2MP/Modules/CPU.h"
+#include "Modules/CPU_Decode.h"
 
 #define V2MP_OPCODE(instr) ((instr) >> 12)
 
@@ -54,6 +55,44 @@
 
 #define V2MP_OP_SIG_RESBITS(instr) ((instr) & 0x0FFF)
 
+// Return value is false under exceptional circumstances
+// (eg. CPU was not set up with supervisor interface).
+// These circumstances imply a programmer error. Other
+// error states that the CPU may legitimately enter into
+// (eg. raising a fault) should still result in true
+// being returned.
+typedef bool (* V2MP_CPU_InstructionCallback)(V2MP_CPU*, const V2MP_CPU_DecodedInstruction*);
+
+// Threaded dispatch relies on the labels-as-values extension.
+// On compilers that do not provide it, the instruction table is used.
+#if defined(V2MP_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define V2MP_CPU_HAS_THREADED_DISPATCH 1
+#endif
+
+// Fetches the instruction at PC into IR and advances PC. Returns the
+// decoded instruction, which may point either into the CPU's decoded
+// code segment or to the scratch record that is passed in. If the fetch
+// failed, the CPU fault is set and NULL is returned.
+const V2MP_CPU_DecodedInstruction* V2MP_CPU_FetchNextInstruction(
+	V2MP_CPU* cpu,
+	V2MP_CPU_DecodedInstruction* scratch
+);
+
+// Decodes and executes the instruction currently held in IR.
 bool V2MP_CPU_ExecuteInstructionInternal(V2MP_CPU* cpu);
 
+// Executes an instruction that has already been decoded.
+// IR is assumed to already hold the instruction word.
+bool V2MP_CPU_ExecuteDecodedInstruction(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decoded);
+
+// Returns NULL if the handler index is out of range.
+V2MP_CPU_InstructionCallback V2MP_CPU_GetInstructionCallback(uint8_t handler);
+
+#ifdef V2MP_CPU_HAS_THREADED_DISPATCH
+// Equivalent to the loop in V2MP_CPU_Run(), but each instruction
+// handler jumps directly to the next one instead of returning
+// through a table call. Arguments are assumed to be valid.
+bool V2MP_CPU_RunThreaded(V2MP_CPU* cpu, size_t maxCycles, V2MP_RunResult* outResult);
+#endif
+
 #endif // V2MP_MODULES_CPU_INSTRUCTIONS_H
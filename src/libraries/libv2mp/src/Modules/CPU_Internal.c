@@ -1,43 +1,46 @@
 #include <stddef.h>
 #include "Modules/CPU_Internal.h"
 
-V2MP_Word* V2MP_CPU_GetRegisterPtr(V2MP_CPU* cpu, V2MP_Word regIndex)
+void V2MP_CPU_SetDecodedCodeSegment(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decodedCS, size_t count)
 {
-	return (V2MP_Word*)V2MP_CPU_GetRegisterConstPtr(cpu, regIndex);
+	if ( !cpu )
+	{
+		return;
+	}
+
+	cpu->decodedCS = decodedCS;
+	cpu->decodedCSCount = decodedCS ? count : 0;
+
+	V2MP_CPU_RebuildBlockCache(cpu);
 }
 
-const V2MP_Word* V2MP_CPU_GetRegisterConstPtr(const V2MP_CPU* cpu, V2MP_Word regIndex)
+void V2MP_CPU_SetPrecompiledBlocks(V2MP_CPU* cpu, const V2MP_PrecompiledBlock* const* blocks, size_t count)
 {
 	if ( !cpu )
 	{
-		return NULL;
+		return;
+	}
+
+	cpu->precompiledBlocks = blocks;
+	cpu->precompiledBlocksCount = blocks ? count : 0;
+}
+
+void V2MP_CPU_RebuildBlockCache(V2MP_CPU* cpu)
+{
+	if ( !cpu )
+	{
+		return;
+	}
+
+	if ( cpu->blockCache )
+	{
+		V2MP_CPU_BlockCache_DeinitAndFree(cpu->blockCache);
+		cpu->blockCache = NULL;
 	}
 
-	switch ( V2MP_REGID_MASK(regIndex) )
+	if ( cpu->blockTranslationEnabled && cpu->decodedCS )
 	{
-		case V2MP_REGID_R0:
-		{
-			return &cpu->r0;
-		}
-
-		case V2MP_REGID_R1:
-		{
-			return &cpu->r1;
-		}
-
-		case V2MP_REGID_LR:
-		{
-			return &cpu->lr;
-		}
-
-		case V2MP_REGID_PC:
-		{
-			return &cpu->pc;
-		}
-
-		default:
-		{
-			return NULL;
-		}
+		// If this fails, the CPU just runs without translated blocks.
+		cpu->blockCache = V2MP_CPU_BlockCache_AllocateAndInit(cpu->decodedCSCount);
 	}
 }
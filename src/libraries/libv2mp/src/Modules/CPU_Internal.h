@@ -1,23 +1,100 @@
 #ifndef V2MP_MODULES_CPU_INTERNAL_H
 #define V2MP_MODULES_CPU_INTERNAL_H
 
+#include <stddef.h>
 #include "LibV2MP/Modules/CPU.h"
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "Modules/CPU_Decode.h"
+#include "Modules/CPU_BlockCache.h"
+#include "Modules/BlockLayout.h"
+
+#ifdef V2MP_LAZY_FLAGS
+// How SR should be computed from the CPU's recorded flags
+// state the next time it is read. See CPU_Flags.h.
+typedef enum V2MP_CPU_PendingFlags
+{
+	V2MP_CPU_FLAGS_RESOLVED = 0,
+	V2MP_CPU_FLAGS_RESULT,
+	V2MP_CPU_FLAGS_ADD,
+	V2MP_CPU_FLAGS_SUB
+} V2MP_CPU_PendingFlags;
+#endif
 
 struct V2MP_CPU
 {
-	V2MP_Word pc;
+	// Registers that instructions can address, indexed by V2MP_RegisterIndex,
+	// so that handlers can use the register fields of an instruction directly.
+	V2MP_Word regs[V2MP_REGID_MAX + 1];
+
+	// Only up to date if no flags are pending.
+	// Use the functions in CPU_Flags.h to access this.
 	V2MP_Word sr;
-	V2MP_Word lr;
-	V2MP_Word r0;
-	V2MP_Word r1;
+
+#ifdef V2MP_LAZY_FLAGS
+	V2MP_CPU_PendingFlags pendingFlags;
+	V2MP_Word flagsResult;
+	V2MP_Word flagsOperand;
+#endif
+
 	V2MP_Word ir;
 	V2MP_Word sp;
 	V2MP_Word fault;
 
+	// While set, clock cycles elapse without any instructions being executed.
+	bool stalled;
+
 	V2MP_CPU_SupervisorInterface supervisorInterface;
+
+	// Predecoded form of the code segment, owned by the supervisor.
+	// If this is set, instructions at word-aligned addresses within
+	// the segment are executed from here rather than being fetched
+	// and decoded on every clock cycle.
+	const V2MP_CPU_DecodedInstruction* decodedCS;
+	size_t decodedCSCount;
+
+	// Only allocated if block translation is enabled
+	// and the CPU has a decoded code segment.
+	bool blockTranslationEnabled;
+	V2MP_CPU_BlockCache* blockCache;
+
+	// Lookup table with one entry per word in CS, owned by the supervisor.
+	// Entries are NULL at addresses where no precompiled block begins.
+	const V2MP_PrecompiledBlock* const* precompiledBlocks;
+	size_t precompiledBlocksCount;
+
+	// If set, the CPU lies within a block owned by something
+	// else, and is not freed by V2MP_CPU_DeinitAndFree().
+	bool placedInBlock;
 };
 
-V2MP_Word* V2MP_CPU_GetRegisterPtr(V2MP_CPU* cpu, V2MP_Word regIndex);
-const V2MP_Word* V2MP_CPU_GetRegisterConstPtr(const V2MP_CPU* cpu, V2MP_Word regIndex);
+static inline V2MP_Word* V2MP_CPU_GetRegisterPtr(V2MP_CPU* cpu, V2MP_Word regIndex)
+{
+	return cpu ? &cpu->regs[V2MP_REGID_MASK(regIndex)] : NULL;
+}
+
+static inline const V2MP_Word* V2MP_CPU_GetRegisterConstPtr(const V2MP_CPU* cpu, V2MP_Word regIndex)
+{
+	return cpu ? &cpu->regs[V2MP_REGID_MASK(regIndex)] : NULL;
+}
+
+// Copies the registers, flags, fault and stall state from the source CPU, along with
+// whether block translation is enabled. The supervisor interface, decoded code
+// segment and precompiled blocks are not copied, since they are owned by the
+// supervisor that the CPU is attached to.
+void V2MP_CPU_CopyState(V2MP_CPU* cpu, const V2MP_CPU* source);
+
+// Reserves space for a CPU within the block, and initialises it there
+// if the block has been allocated. See BlockLayout.h.
+V2MP_CPU* V2MP_CPU_PlaceInBlock(V2MP_BlockLayout* layout);
+
+// Pass NULL to go back to fetching and decoding each instruction from memory.
+void V2MP_CPU_SetDecodedCodeSegment(V2MP_CPU* cpu, const V2MP_CPU_DecodedInstruction* decodedCS, size_t count);
+
+// Pass NULL to stop executing precompiled blocks.
+void V2MP_CPU_SetPrecompiledBlocks(V2MP_CPU* cpu, const V2MP_PrecompiledBlock* const* blocks, size_t count);
+
+// Discards all translated blocks, and creates a fresh block cache
+// if one is required for the CPU's current configuration.
+void V2MP_CPU_RebuildBlockCache(V2MP_CPU* cpu);
 
 #endif // V2MP_MODULES_CPU_INTERNAL_H
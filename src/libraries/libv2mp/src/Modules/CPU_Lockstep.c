@@ -0,0 +1,653 @@
+#include <string.h>
+#include "Modules/CPU_Lockstep.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/CPU_Flags.h"
+
+#define LANES V2MP_CPU_LOCKSTEP_LANES
+
+typedef struct Lane
+{
+	V2MP_CPU* cpu;
+	V2MP_RunResult* result;
+
+	// Cleared once the lane has stopped for any reason.
+	bool running;
+
+	// Set once the lane has left the lockstep group,
+	// after which it has been run on its own.
+	bool split;
+} Lane;
+
+static inline bool InGroup(const Lane* lane)
+{
+	return lane->running && !lane->split;
+}
+
+static inline V2MP_Word ZeroFlag(V2MP_Word result)
+{
+	return result == 0 ? V2MP_CPU_SR_Z : 0;
+}
+
+static void ExecuteADDOrSUB(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded, bool isAdd)
+{
+	V2MP_Word* dest = lanes->regs[decoded->destReg];
+	const V2MP_Word* src = lanes->regs[decoded->sourceReg];
+	const bool literal = (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+	int32_t multiplier = isAdd ? 1 : -1;
+	size_t lane;
+
+	if ( decoded->destReg == V2MP_REGID_PC )
+	{
+		// Increment or decrement by words, not bytes.
+		multiplier *= sizeof(V2MP_Word);
+	}
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		const V2MP_Word operand = literal ? decoded->immediate : src[lane];
+		const V2MP_Word oldValue = dest[lane];
+		const V2MP_Word result = (V2MP_Word)(oldValue + (V2MP_Word)(multiplier * (int32_t)operand));
+		const bool carry = isAdd ? result < oldValue : result > oldValue;
+
+		dest[lane] = result;
+		lanes->sr[lane] = (V2MP_Word)((carry ? V2MP_CPU_SR_C : 0) | ZeroFlag(result));
+	}
+}
+
+static void ExecuteMUL(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* dest = lanes->regs[decoded->destReg];
+	V2MP_Word* lr = lanes->regs[V2MP_REGID_LR];
+	const V2MP_Word* src = lanes->regs[decoded->sourceReg];
+	const bool literal = (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+	const bool isSigned = (decoded->flags & V2MP_DECODED_FLAG_SIGNED) != 0;
+	size_t lane;
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		const V2MP_Word operand = literal ? decoded->immediate : src[lane];
+		const int32_t signedResult = (int32_t)(int16_t)dest[lane] * (int32_t)(int16_t)operand;
+		const uint32_t unsignedResult = (uint32_t)dest[lane] * (uint32_t)operand;
+		const uint32_t result = isSigned ? (uint32_t)signedResult : unsignedResult;
+		const bool overflowed = isSigned
+			? (signedResult > 32767 || signedResult < -32768)
+			: (unsignedResult >> 16) != 0;
+
+		lr[lane] = (V2MP_Word)(result >> 16);
+		dest[lane] = (V2MP_Word)(result & 0xFFFF);
+		lanes->sr[lane] = (V2MP_Word)((overflowed ? V2MP_CPU_SR_C : 0) | ZeroFlag((V2MP_Word)(lr[lane] | dest[lane])));
+	}
+}
+
+static void ExecuteASGN(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* dest = lanes->regs[decoded->destReg];
+	const V2MP_Word* src = lanes->regs[decoded->sourceReg];
+	const bool literal = (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+	size_t lane;
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		dest[lane] = literal ? decoded->immediate : src[lane];
+		lanes->sr[lane] = ZeroFlag(dest[lane]);
+	}
+}
+
+static void ExecuteSHFT(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* dest = lanes->regs[decoded->destReg];
+	const int16_t shift = (int16_t)decoded->immediate;
+	V2MP_Word mask;
+	int distance;
+	size_t lane;
+
+	// Only literal shifts are executed in lockstep, so the direction and
+	// distance are the same for every lane. The mask covers the bits that
+	// are shifted off the end, which set the carry flag.
+	if ( shift < 0 )
+	{
+		distance = -shift;
+		mask = (V2MP_Word)(0xFFFF >> (16 - distance));
+
+		for ( lane = 0; lane < LANES; ++lane )
+		{
+			const bool carry = (dest[lane] & mask) != 0;
+
+			dest[lane] = (V2MP_Word)(dest[lane] >> distance);
+			lanes->sr[lane] = (V2MP_Word)((carry ? V2MP_CPU_SR_C : 0) | ZeroFlag(dest[lane]));
+		}
+	}
+	else
+	{
+		distance = shift;
+		mask = (V2MP_Word)((uint32_t)0xFFFF << (16 - distance));
+
+		for ( lane = 0; lane < LANES; ++lane )
+		{
+			const bool carry = (dest[lane] & mask) != 0;
+
+			dest[lane] = (V2MP_Word)(dest[lane] << distance);
+			lanes->sr[lane] = (V2MP_Word)((carry ? V2MP_CPU_SR_C : 0) | ZeroFlag(dest[lane]));
+		}
+	}
+}
+
+static void ExecuteBITW(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* dest = lanes->regs[decoded->destReg];
+	const V2MP_Word* src = lanes->regs[decoded->sourceReg];
+	const bool literal = (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+	size_t lane;
+
+	// The operation is chosen outside the loops, so that
+	// each loop body is a single vectorisable operation.
+	switch ( V2MP_DECODED_BITOP(decoded->flags) )
+	{
+		case V2MP_BITOP_AND:
+		{
+			for ( lane = 0; lane < LANES; ++lane )
+			{
+				dest[lane] &= literal ? decoded->immediate : src[lane];
+			}
+
+			break;
+		}
+
+		case V2MP_BITOP_OR:
+		{
+			for ( lane = 0; lane < LANES; ++lane )
+			{
+				dest[lane] |= literal ? decoded->immediate : src[lane];
+			}
+
+			break;
+		}
+
+		case V2MP_BITOP_XOR:
+		{
+			for ( lane = 0; lane < LANES; ++lane )
+			{
+				dest[lane] ^= literal ? decoded->immediate : src[lane];
+			}
+
+			break;
+		}
+
+		default:
+		{
+			for ( lane = 0; lane < LANES; ++lane )
+			{
+				dest[lane] = (V2MP_Word)(~dest[lane]);
+			}
+
+			break;
+		}
+	}
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		lanes->sr[lane] = ZeroFlag(dest[lane]);
+	}
+}
+
+static void ExecuteCBX(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* pc = lanes->regs[V2MP_REGID_PC];
+	const V2MP_Word* lr = lanes->regs[V2MP_REGID_LR];
+	const V2MP_Word condition = (decoded->flags & V2MP_DECODED_FLAG_ALT) ? V2MP_CPU_SR_C : V2MP_CPU_SR_Z;
+	const bool lrTarget = (decoded->flags & V2MP_DECODED_FLAG_LR_TARGET) != 0;
+	size_t lane;
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		const bool shouldBranch = (lanes->sr[lane] & condition) != 0;
+		const V2MP_Word target = lrTarget ? lr[lane] : (V2MP_Word)(pc[lane] + decoded->immediate);
+
+		pc[lane] = shouldBranch ? target : pc[lane];
+		lanes->sr[lane] = shouldBranch ? 0 : V2MP_CPU_SR_Z;
+	}
+}
+
+bool V2MP_CPU_CanExecuteInLockstep(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_NOP:
+		case V2MP_OP_ADD:
+		case V2MP_OP_SUB:
+		case V2MP_OP_MUL:
+		case V2MP_OP_ASGN:
+		case V2MP_OP_BITW:
+		case V2MP_OP_CBX:
+		{
+			return true;
+		}
+
+		case V2MP_OP_SHFT:
+		{
+			return (decoded->flags & V2MP_DECODED_FLAG_LITERAL) != 0;
+		}
+
+		default:
+		{
+			// DIV may fault, LDST, STK and SIG go through the
+			// supervisor, and anything else is an invalid encoding.
+			return false;
+		}
+	}
+}
+
+bool V2MP_CPU_LockstepInstructionWritesPC(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_NOP:
+		case V2MP_OP_MUL:
+		{
+			return false;
+		}
+
+		case V2MP_OP_CBX:
+		{
+			return true;
+		}
+
+		default:
+		{
+			return decoded->destReg == V2MP_REGID_PC;
+		}
+	}
+}
+
+void V2MP_CPU_ExecuteInLockstep(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	V2MP_Word* pc = lanes->regs[V2MP_REGID_PC];
+	size_t lane;
+
+	for ( lane = 0; lane < LANES; ++lane )
+	{
+		pc[lane] += sizeof(V2MP_Word);
+	}
+
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_ADD:
+		{
+			ExecuteADDOrSUB(lanes, decoded, true);
+			break;
+		}
+
+		case V2MP_OP_SUB:
+		{
+			ExecuteADDOrSUB(lanes, decoded, false);
+			break;
+		}
+
+		case V2MP_OP_MUL:
+		{
+			ExecuteMUL(lanes, decoded);
+			break;
+		}
+
+		case V2MP_OP_ASGN:
+		{
+			ExecuteASGN(lanes, decoded);
+			break;
+		}
+
+		case V2MP_OP_SHFT:
+		{
+			ExecuteSHFT(lanes, decoded);
+			break;
+		}
+
+		case V2MP_OP_BITW:
+		{
+			ExecuteBITW(lanes, decoded);
+			break;
+		}
+
+		case V2MP_OP_CBX:
+		{
+			ExecuteCBX(lanes, decoded);
+			break;
+		}
+
+		default:
+		{
+			// NOP does nothing.
+			break;
+		}
+	}
+}
+
+static void StopIfFinished(Lane* lane, size_t maxCycles, bool programExited)
+{
+	if ( V2MP_CPU_FAULT_CODE(lane->cpu->fault) != V2MP_FAULT_NONE )
+	{
+		lane->result->stopReason = V2MP_RUNSTOP_FAULT;
+		lane->running = false;
+	}
+	else if ( programExited )
+	{
+		lane->result->stopReason = V2MP_RUNSTOP_PROGRAM_EXITED;
+		lane->running = false;
+	}
+	else if ( lane->result->cyclesExecuted >= maxCycles )
+	{
+		lane->running = false;
+	}
+}
+
+// Runs the lane on the scalar path for at most the given number of cycles.
+static bool RunLaneAlone(Lane* lane, size_t maxCycles, size_t cycles)
+{
+	V2MP_RunResult stepResult;
+	size_t remaining = maxCycles - lane->result->cyclesExecuted;
+
+	if ( !V2MP_CPU_Run(lane->cpu, cycles < remaining ? cycles : remaining, &stepResult) )
+	{
+		return false;
+	}
+
+	lane->result->cyclesExecuted += stepResult.cyclesExecuted;
+
+	if ( stepResult.stopReason != V2MP_RUNSTOP_CYCLE_LIMIT )
+	{
+		lane->result->stopReason = stepResult.stopReason;
+		lane->running = false;
+	}
+	else if ( lane->result->cyclesExecuted >= maxCycles )
+	{
+		lane->running = false;
+	}
+
+	return true;
+}
+
+static bool SplitLane(Lane* lane, size_t maxCycles)
+{
+	lane->split = true;
+	return RunLaneAlone(lane, maxCycles, maxCycles);
+}
+
+// Keeps the largest set of lanes that share a code segment and PC in the group,
+// and runs every other lane on its own. outLeader is set to the index of one of
+// the remaining lanes, or LANES if too few remain for lockstep to be worthwhile.
+static bool SplitDivergedLanes(Lane* lanes, size_t numLanes, size_t maxCycles, size_t* outLeader)
+{
+	size_t leader = LANES;
+	size_t leaderCount = 0;
+	size_t count;
+	size_t index;
+	size_t other;
+
+	// Only a handful of lanes, so just count every candidate.
+	for ( index = 0; index < numLanes; ++index )
+	{
+		if ( !InGroup(&lanes[index]) || !lanes[index].cpu->decodedCS )
+		{
+			continue;
+		}
+
+		count = 0;
+
+		for ( other = index; other < numLanes; ++other )
+		{
+			if ( InGroup(&lanes[other]) &&
+			     lanes[other].cpu->decodedCS == lanes[index].cpu->decodedCS &&
+			     lanes[other].cpu->regs[V2MP_REGID_PC] == lanes[index].cpu->regs[V2MP_REGID_PC] )
+			{
+				++count;
+			}
+		}
+
+		if ( count > leaderCount )
+		{
+			leader = index;
+			leaderCount = count;
+		}
+	}
+
+	if ( leaderCount < 2 )
+	{
+		leader = LANES;
+	}
+
+	for ( index = 0; index < numLanes; ++index )
+	{
+		if ( !InGroup(&lanes[index]) )
+		{
+			continue;
+		}
+
+		if ( leader == LANES ||
+		     lanes[index].cpu->decodedCS != lanes[leader].cpu->decodedCS ||
+		     lanes[index].cpu->regs[V2MP_REGID_PC] != lanes[leader].cpu->regs[V2MP_REGID_PC] )
+		{
+			if ( !SplitLane(&lanes[index], maxCycles) )
+			{
+				return false;
+			}
+		}
+	}
+
+	*outLeader = leader;
+	return true;
+}
+
+static size_t GetLockstepRunLength(const Lane* lanes, size_t numLanes, size_t leader, size_t maxCycles)
+{
+	const V2MP_CPU* cpu = lanes[leader].cpu;
+	const V2MP_Word pc = cpu->regs[V2MP_REGID_PC];
+	size_t budget = maxCycles;
+	size_t remaining;
+	size_t first;
+	size_t length = 0;
+	size_t index;
+
+	if ( (pc & 1) != 0 )
+	{
+		return 0;
+	}
+
+	for ( index = 0; index < numLanes; ++index )
+	{
+		if ( InGroup(&lanes[index]) )
+		{
+			remaining = maxCycles - lanes[index].result->cyclesExecuted;
+			budget = remaining < budget ? remaining : budget;
+		}
+	}
+
+	first = (size_t)(pc >> 1);
+
+	while ( length < budget && first + length < cpu->decodedCSCount )
+	{
+		const V2MP_CPU_DecodedInstruction* decoded = &cpu->decodedCS[first + length];
+
+		if ( !V2MP_CPU_CanExecuteInLockstep(decoded) )
+		{
+			break;
+		}
+
+		++length;
+
+		if ( V2MP_CPU_LockstepInstructionWritesPC(decoded) )
+		{
+			break;
+		}
+	}
+
+	return length;
+}
+
+static bool ExecuteLockstepRun(Lane* lanes, size_t numLanes, size_t leader, size_t length, size_t maxCycles)
+{
+	V2MP_CPU_LockstepRegisters regs;
+	const V2MP_CPU_DecodedInstruction* decoded;
+	V2MP_CPU* cpu;
+	size_t index;
+	size_t reg;
+	bool programExited;
+
+	memset(&regs, 0, sizeof(regs));
+
+	for ( index = 0; index < numLanes; ++index )
+	{
+		if ( InGroup(&lanes[index]) )
+		{
+			cpu = lanes[index].cpu;
+
+			for ( reg = 0; reg <= V2MP_REGID_MAX; ++reg )
+			{
+				regs.regs[reg][index] = cpu->regs[reg];
+			}
+
+			regs.sr[index] = V2MP_CPU_GetFlags(cpu);
+		}
+	}
+
+	decoded = &lanes[leader].cpu->decodedCS[lanes[leader].cpu->regs[V2MP_REGID_PC] >> 1];
+
+	for ( index = 0; index < length; ++index )
+	{
+		V2MP_CPU_ExecuteInLockstep(&regs, &decoded[index]);
+	}
+
+	for ( index = 0; index < numLanes; ++index )
+	{
+		if ( !InGroup(&lanes[index]) )
+		{
+			continue;
+		}
+
+		cpu = lanes[index].cpu;
+
+		for ( reg = 0; reg <= V2MP_REGID_MAX; ++reg )
+		{
+			cpu->regs[reg] = regs.regs[reg][index];
+		}
+
+		V2MP_CPU_SetFlags(cpu, regs.sr[index]);
+		cpu->ir = decoded[length - 1].word;
+
+		// As with a translated block, none of the instructions in the run
+		// interact with the supervisor, so completing the cycle once
+		// accounts for all of them.
+		lanes[index].result->cyclesExecuted += length;
+		programExited = false;
+
+		if ( cpu->supervisorInterface.completeClockCycle &&
+		     !cpu->supervisorInterface.completeClockCycle(cpu->supervisorInterface.supervisor, &programExited) )
+		{
+			return false;
+		}
+
+		StopIfFinished(&lanes[index], maxCycles, programExited);
+	}
+
+	return true;
+}
+
+static bool RunGroup(V2MP_CPU* const* cpus, size_t numLanes, size_t maxCycles, V2MP_RunResult* results)
+{
+	Lane lanes[LANES];
+	size_t index;
+	size_t leader;
+	size_t length;
+
+	for ( index = 0; index < numLanes; ++index )
+	{
+		lanes[index].cpu = cpus[index];
+		lanes[index].result = &results[index];
+		lanes[index].running = true;
+		lanes[index].split = false;
+
+		results[index].cyclesExecuted = 0;
+		results[index].stopReason = V2MP_RUNSTOP_CYCLE_LIMIT;
+
+		StopIfFinished(&lanes[index], maxCycles, false);
+	}
+
+	while ( true )
+	{
+		// Stalled lanes wait out their stall one cycle at a time,
+		// so that all lanes in the group can execute together.
+		for ( index = 0; index < numLanes; ++index )
+		{
+			while ( InGroup(&lanes[index]) && lanes[index].cpu->stalled )
+			{
+				if ( !RunLaneAlone(&lanes[index], maxCycles, 1) )
+				{
+					return false;
+				}
+			}
+		}
+
+		if ( !SplitDivergedLanes(lanes, numLanes, maxCycles, &leader) )
+		{
+			return false;
+		}
+
+		if ( leader == LANES )
+		{
+			// Every lane has either stopped or been run on its own.
+			return true;
+		}
+
+		length = GetLockstepRunLength(lanes, numLanes, leader, maxCycles);
+
+		if ( length > 0 )
+		{
+			if ( !ExecuteLockstepRun(lanes, numLanes, leader, length, maxCycles) )
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		// The next instruction must go through the scalar path, but
+		// the lanes stay in the group as long as they stay together.
+		for ( index = 0; index < numLanes; ++index )
+		{
+			if ( InGroup(&lanes[index]) && !RunLaneAlone(&lanes[index], maxCycles, 1) )
+			{
+				return false;
+			}
+		}
+	}
+}
+
+bool V2MP_CPU_RunLockstep(V2MP_CPU* const* cpus, size_t numCPUs, size_t maxCycles, V2MP_RunResult* outResults)
+{
+	size_t first;
+	size_t count;
+	size_t index;
+
+	if ( (!cpus || !outResults) && numCPUs > 0 )
+	{
+		return false;
+	}
+
+	for ( index = 0; index < numCPUs; ++index )
+	{
+		if ( !cpus[index] || !cpus[index]->supervisorInterface.fetchInstructionWord )
+		{
+			return false;
+		}
+	}
+
+	for ( first = 0; first < numCPUs; first += count )
+	{
+		count = numCPUs - first < LANES ? numCPUs - first : LANES;
+
+		if ( !RunGroup(&cpus[first], count, maxCycles, &outResults[first]) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,34 @@
+#ifndef V2MP_MODULES_CPU_LOCKSTEP_H
+#define V2MP_MODULES_CPU_LOCKSTEP_H
+
+#include <stdbool.h>
+#include "LibV2MP/Modules/CPU.h"
+#include "Modules/CPU_Decode.h"
+
+// Registers of every lane in a lockstep group, in structure-of-arrays form.
+// Each instruction is applied to all lanes with a fixed-length loop and no
+// per-lane control flow, which the compiler turns into vector instructions.
+// Lanes that are not in use hold values that are never written back.
+typedef struct V2MP_CPU_LockstepRegisters
+{
+	V2MP_Word regs[V2MP_REGID_MAX + 1][V2MP_CPU_LOCKSTEP_LANES];
+
+	// Always resolved, regardless of whether the build uses lazy flags.
+	V2MP_Word sr[V2MP_CPU_LOCKSTEP_LANES];
+} V2MP_CPU_LockstepRegisters;
+
+// Returns true for instructions whose effects are purely on registers, which
+// cannot fault and which do not create supervisor actions. Where the outcome
+// for an operand cannot be reproduced without per-lane branching (eg. shifts
+// by a register), the instruction is left to the scalar path.
+bool V2MP_CPU_CanExecuteInLockstep(const V2MP_CPU_DecodedInstruction* decoded);
+
+// Returns true if executing the instruction may change PC other than by
+// advancing it to the next instruction. Lanes may diverge after this.
+bool V2MP_CPU_LockstepInstructionWritesPC(const V2MP_CPU_DecodedInstruction* decoded);
+
+// Advances PC past the instruction in every lane, and then executes it in
+// every lane. The instruction must be one that can be executed in lockstep.
+void V2MP_CPU_ExecuteInLockstep(V2MP_CPU_LockstepRegisters* lanes, const V2MP_CPU_DecodedInstruction* decoded);
+
+#endif // V2MP_MODULES_CPU_LOCKSTEP_H
@@ -0,0 +1,47 @@
+#include "Modules/CPU_Precompiled.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/CPU_Flags.h"
+
+size_t V2MP_CPU_TryExecutePrecompiledBlock(V2MP_CPU* cpu, size_t maxCycles)
+{
+	const V2MP_PrecompiledBlock* block;
+	V2MP_PrecompiledRegisters regs;
+
+	if ( !cpu->precompiledBlocks ||
+	     (cpu->regs[V2MP_REGID_PC] & 1) != 0 ||
+	     (size_t)(cpu->regs[V2MP_REGID_PC] >> 1) >= cpu->precompiledBlocksCount )
+	{
+		return 0;
+	}
+
+	block = cpu->precompiledBlocks[cpu->regs[V2MP_REGID_PC] >> 1];
+
+	if ( !block || block->numCycles > maxCycles )
+	{
+		return 0;
+	}
+
+	regs.r0 = cpu->regs[V2MP_REGID_R0];
+	regs.r1 = cpu->regs[V2MP_REGID_R1];
+	regs.lr = cpu->regs[V2MP_REGID_LR];
+	regs.pc = cpu->regs[V2MP_REGID_PC];
+	regs.sr = V2MP_CPU_GetFlags(cpu);
+	regs.ir = cpu->ir;
+	regs.fault = 0;
+
+	block->execute(&regs);
+
+	cpu->regs[V2MP_REGID_R0] = regs.r0;
+	cpu->regs[V2MP_REGID_R1] = regs.r1;
+	cpu->regs[V2MP_REGID_LR] = regs.lr;
+	cpu->regs[V2MP_REGID_PC] = regs.pc;
+	V2MP_CPU_SetFlags(cpu, regs.sr);
+	cpu->ir = regs.ir;
+
+	if ( V2MP_CPU_FAULT_CODE(regs.fault) != V2MP_FAULT_NONE )
+	{
+		V2MP_CPU_NotifyFault(cpu, regs.fault);
+	}
+
+	return block->numCycles;
+}
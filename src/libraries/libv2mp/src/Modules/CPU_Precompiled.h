@@ -0,0 +1,13 @@
+#ifndef V2MP_MODULES_CPU_PRECOMPILED_H
+#define V2MP_MODULES_CPU_PRECOMPILED_H
+
+#include <stddef.h>
+#include "LibV2MP/Modules/CPU.h"
+
+// If a precompiled program is attached to the CPU and PC is at the start of one
+// of its blocks, and the block fits within the cycle budget, executes the block
+// natively and returns the number of cycles that it accounts for. Otherwise,
+// returns 0 and leaves the CPU untouched.
+size_t V2MP_CPU_TryExecutePrecompiledBlock(V2MP_CPU* cpu, size_t maxCycles);
+
+#endif // V2MP_MODULES_CPU_PRECOMPILED_H
@@ -2,11 +2,17 @@
 #include "LibV2MP/Modules/CPU.h"
 #include "LibV2MP/Modules/MemoryStore.h"
 #include "LibBaseUtil/Heap.h"
+#include "Modules/Mainboard_Internal.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/MemoryStore_Internal.h"
 
 struct V2MP_Mainboard
 {
 	V2MP_CPU* cpu;
 	V2MP_MemoryStore* memoryStore;
+
+	// If set, the mainboard lies within a block owned by something else.
+	bool placedInBlock;
 };
 
 static inline bool HasAllModules(V2MP_Mainboard* board)
@@ -18,15 +24,21 @@ static inline bool HasAllModules(V2MP_Mainboard* board)
 }
 
 V2MP_Mainboard* V2MP_Mainboard_AllocateAndInit(void)
+{
+	return V2MP_Mainboard_AllocateAndInitWithMemoryStore(V2MP_MemoryStore_AllocateAndInit());
+}
+
+V2MP_Mainboard* V2MP_Mainboard_AllocateAndInitWithMemoryStore(struct V2MP_MemoryStore* memoryStore)
 {
 	V2MP_Mainboard* board = BASEUTIL_CALLOC_STRUCT(V2MP_Mainboard);
 
 	if ( !board )
 	{
+		V2MP_MemoryStore_DeinitAndFree(memoryStore);
 		return NULL;
 	}
 
-	board->memoryStore = V2MP_MemoryStore_AllocateAndInit();
+	board->memoryStore = memoryStore;
 	board->cpu = V2MP_CPU_AllocateAndInit();
 
 	if ( !HasAllModules(board) )
@@ -38,6 +50,26 @@ V2MP_Mainboard* V2MP_Mainboard_AllocateAndInit(void)
 	return board;
 }
 
+V2MP_Mainboard* V2MP_Mainboard_PlaceInBlock(V2MP_BlockLayout* layout, size_t totalMemoryBytes)
+{
+	V2MP_Mainboard* board;
+	V2MP_CPU* cpu;
+	V2MP_MemoryStore* memoryStore;
+
+	board = (V2MP_Mainboard*)V2MP_BlockLayout_Reserve(layout, sizeof(V2MP_Mainboard));
+	cpu = V2MP_CPU_PlaceInBlock(layout);
+	memoryStore = V2MP_MemoryStore_PlaceInBlock(layout, totalMemoryBytes);
+
+	if ( board )
+	{
+		board->cpu = cpu;
+		board->memoryStore = memoryStore;
+		board->placedInBlock = true;
+	}
+
+	return board;
+}
+
 void V2MP_Mainboard_DeinitAndFree(V2MP_Mainboard* board)
 {
 	if ( !board )
@@ -57,7 +89,10 @@ void V2MP_Mainboard_DeinitAndFree(V2MP_Mainboard* board)
 		board->memoryStore = NULL;
 	}
 
-	BASEUTIL_FREE(board);
+	if ( !board->placedInBlock )
+	{
+		BASEUTIL_FREE(board);
+	}
 }
 
 struct V2MP_CPU* V2MP_Mainboard_GetCPU(const V2MP_Mainboard* board)
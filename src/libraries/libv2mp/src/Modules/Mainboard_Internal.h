@@ -0,0 +1,12 @@
+#ifndef V2MP_MODULES_MAINBOARD_INTERNAL_H
+#define V2MP_MODULES_MAINBOARD_INTERNAL_H
+
+#include "LibV2MP/Modules/Mainboard.h"
+#include "Modules/BlockLayout.h"
+
+// Reserves space within the block for a mainboard, its CPU, and a memory store
+// with totalMemoryBytes of contiguous memory, and initialises all of them there
+// if the block has been allocated. See BlockLayout.h.
+V2MP_Mainboard* V2MP_Mainboard_PlaceInBlock(V2MP_BlockLayout* layout, size_t totalMemoryBytes);
+
+#endif // V2MP_MODULES_MAINBOARD_INTERNAL_H
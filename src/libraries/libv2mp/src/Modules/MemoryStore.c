@@ -1,32 +1,330 @@
+#include <string.h>
 #include "LibV2MP/Modules/MemoryStore.h"
+#include "Modules/MemoryStore_Internal.h"
 #include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Atomic.h"
+#include "LibBaseUtil/String.h"
 #include "LibV2MP/Defs.h"
 
+#define PAGE_INDEX(address) ((address) / V2MP_MEMORYSTORE_PAGE_SIZE)
+#define PAGE_OFFSET(address) ((address) % V2MP_MEMORYSTORE_PAGE_SIZE)
+#define DIRTY_BITMAP_SIZE(memorySize) (((PAGE_INDEX((memorySize) + V2MP_MEMORYSTORE_PAGE_SIZE - 1)) + 7) / 8)
+
+typedef struct MemoryPage
+{
+	// Number of memory stores that refer to this page. If this is
+	// greater than 1, the page is copied before it is written to.
+	// Stores that share pages may be used on different threads,
+	// so this is only ever modified atomically.
+	size_t refCount;
+	V2MP_Byte data[V2MP_MEMORYSTORE_PAGE_SIZE];
+} MemoryPage;
+
 struct V2MP_MemoryStore
 {
-	V2MP_Byte* totalMemory;
+	// Chosen when the store is created. Only applies to contiguous memory.
+	V2MP_MemoryStore_Backing backing;
+	char* backingFilePath;
+
 	size_t totalMemorySizeInBytes;
+
+	// Only used if memory is contiguous.
+	V2MP_Byte* totalMemory;
+
+	// Only used if memory is paged. Entries are NULL until the page is committed.
+	MemoryPage** pages;
+	size_t numPages;
+	size_t numCommittedPages;
+
+	// Incremented whenever a page is committed or copied on write.
+	size_t numPageBarriers;
+
+	// One bit per page of memory, whether or not memory is paged.
+	V2MP_Byte* dirtyPages;
+
+	V2MP_MemoryStore_ChangeCallback changeCallback;
+	void* changeCallbackUserData;
+
+	// If set, the store itself lies within a block owned by something else.
+	bool placedInBlock;
+
+	// If set, the contiguous memory and the dirty page bitmap
+	// lie within the block too, so are not freed by the store.
+	bool memoryInBlock;
 };
 
+// Returned for reads from pages that have not been committed yet.
+static const V2MP_Byte ZERO_PAGE[V2MP_MEMORYSTORE_PAGE_SIZE] = { 0 };
+
+static void NotifyChange(V2MP_MemoryStore* mem, V2MP_MemoryStore_ChangeType changeType)
+{
+	if ( mem->changeCallback )
+	{
+		mem->changeCallback(mem->changeCallbackUserData, changeType);
+	}
+}
+
+static void ReleasePage(MemoryPage* page)
+{
+	if ( BaseUtil_Atomic_DecrementSize(&page->refCount) < 1 )
+	{
+		BASEUTIL_FREE(page);
+	}
+}
+
+static V2MP_Byte* AllocateContiguousMemory(const V2MP_MemoryStore* mem, size_t sizeInBytes)
+{
+	switch ( mem->backing )
+	{
+		case V2MP_MEMORYSTORE_BACKING_HUGE_PAGES:
+		{
+			return (V2MP_Byte*)BASEUTIL_MAP_PAGES(sizeInBytes, NULL, BASEUTIL_MAP_HUGE_PAGES);
+		}
+
+		case V2MP_MEMORYSTORE_BACKING_FILE:
+		{
+			return (V2MP_Byte*)BASEUTIL_MAP_PAGES(sizeInBytes, mem->backingFilePath, 0);
+		}
+
+		default:
+		{
+			return (V2MP_Byte*)BASEUTIL_MALLOC(sizeInBytes);
+		}
+	}
+}
+
+static void FreeContiguousMemory(V2MP_MemoryStore* mem)
+{
+	switch ( mem->backing )
+	{
+		case V2MP_MEMORYSTORE_BACKING_HUGE_PAGES:
+		{
+			BASEUTIL_UNMAP_PAGES(mem->totalMemory, mem->totalMemorySizeInBytes, BASEUTIL_MAP_HUGE_PAGES);
+			break;
+		}
+
+		case V2MP_MEMORYSTORE_BACKING_FILE:
+		{
+			BASEUTIL_UNMAP_PAGES(mem->totalMemory, mem->totalMemorySizeInBytes, 0);
+			break;
+		}
+
+		default:
+		{
+			BASEUTIL_FREE(mem->totalMemory);
+			break;
+		}
+	}
+}
+
 static void FreeAllMemory(V2MP_MemoryStore* mem)
 {
+	size_t index;
+
 	if ( !mem )
 	{
 		return;
 	}
 
-	if ( mem->totalMemory )
+	if ( mem->totalMemory && !mem->memoryInBlock )
+	{
+		FreeContiguousMemory(mem);
+	}
+
+	if ( mem->pages )
+	{
+		for ( index = 0; index < mem->numPages; ++index )
+		{
+			if ( mem->pages[index] )
+			{
+				ReleasePage(mem->pages[index]);
+			}
+		}
+
+		BASEUTIL_FREE(mem->pages);
+	}
+
+	if ( mem->dirtyPages && !mem->memoryInBlock )
 	{
-		BASEUTIL_FREE(mem->totalMemory);
+		BASEUTIL_FREE(mem->dirtyPages);
 	}
 
+	mem->memoryInBlock = false;
 	mem->totalMemory = NULL;
+	mem->pages = NULL;
+	mem->dirtyPages = NULL;
+	mem->numPages = 0;
+	mem->numCommittedPages = 0;
 	mem->totalMemorySizeInBytes = 0;
 }
 
+static bool AllocateDirtyPageBitmap(V2MP_MemoryStore* mem)
+{
+	if ( mem->totalMemorySizeInBytes < 1 )
+	{
+		return true;
+	}
+
+	mem->dirtyPages = (V2MP_Byte*)BASEUTIL_CALLOC(DIRTY_BITMAP_SIZE(mem->totalMemorySizeInBytes), 1);
+	return mem->dirtyPages != NULL;
+}
+
+static void MarkCommittedPagesDirty(V2MP_MemoryStore* mem)
+{
+	size_t index;
+
+	if ( !mem->pages )
+	{
+		V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, 0, mem->totalMemorySizeInBytes);
+		return;
+	}
+
+	for ( index = 0; index < mem->numPages; ++index )
+	{
+		if ( mem->pages[index] )
+		{
+			V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, index * V2MP_MEMORYSTORE_PAGE_SIZE, 1);
+		}
+	}
+}
+
+static inline bool RangeIsInMemory(const V2MP_MemoryStore* mem, size_t base, size_t length)
+{
+	// The following checks are carefully constructed to avoid calculating
+	// values that are outside of the range of a size_t:
+	return
+		base < mem->totalMemorySizeInBytes &&
+		mem->totalMemorySizeInBytes - base >= length;
+}
+
+// This is the write barrier for paged memory: the page is committed if
+// it has not been already, and copied if it is shared with another store.
+static V2MP_Byte* GetWritablePage(V2MP_MemoryStore* mem, size_t pageIndex)
+{
+	MemoryPage* page = mem->pages[pageIndex];
+
+	if ( !page )
+	{
+		page = BASEUTIL_CALLOC_STRUCT(MemoryPage);
+
+		if ( !page )
+		{
+			return NULL;
+		}
+
+		page->refCount = 1;
+		mem->pages[pageIndex] = page;
+		++mem->numCommittedPages;
+		++mem->numPageBarriers;
+	}
+	else if ( BaseUtil_Atomic_LoadSize(&page->refCount) > 1 )
+	{
+		page = (MemoryPage*)BASEUTIL_MALLOC(sizeof(MemoryPage));
+
+		if ( !page )
+		{
+			return NULL;
+		}
+
+		memcpy(page->data, mem->pages[pageIndex]->data, V2MP_MEMORYSTORE_PAGE_SIZE);
+		page->refCount = 1;
+
+		ReleasePage(mem->pages[pageIndex]);
+		mem->pages[pageIndex] = page;
+		++mem->numPageBarriers;
+	}
+
+	return page->data;
+}
+
+static inline const V2MP_Byte* GetConstPage(const V2MP_MemoryStore* mem, size_t pageIndex)
+{
+	return mem->pages[pageIndex] ? mem->pages[pageIndex]->data : ZERO_PAGE;
+}
+
+static inline bool RangeIsInSinglePage(size_t base, size_t length)
+{
+	return length <= V2MP_MEMORYSTORE_PAGE_SIZE - PAGE_OFFSET(base);
+}
+
+static bool CopyContiguousMemory(V2MP_MemoryStore* mem, const V2MP_MemoryStore* source)
+{
+	mem->totalMemory = AllocateContiguousMemory(mem, source->totalMemorySizeInBytes);
+
+	if ( !mem->totalMemory )
+	{
+		return false;
+	}
+
+	memcpy(mem->totalMemory, source->totalMemory, source->totalMemorySizeInBytes);
+	mem->totalMemorySizeInBytes = source->totalMemorySizeInBytes;
+
+	return true;
+}
+
+static bool SharePages(V2MP_MemoryStore* mem, V2MP_MemoryStore* source)
+{
+	size_t index;
+
+	mem->pages = (MemoryPage**)BASEUTIL_MALLOC(source->numPages * sizeof(MemoryPage*));
+
+	if ( !mem->pages )
+	{
+		return false;
+	}
+
+	for ( index = 0; index < source->numPages; ++index )
+	{
+		mem->pages[index] = source->pages[index];
+
+		if ( mem->pages[index] )
+		{
+			BaseUtil_Atomic_IncrementSize(&mem->pages[index]->refCount);
+		}
+	}
+
+	mem->numPages = source->numPages;
+	mem->numCommittedPages = source->numCommittedPages;
+	mem->totalMemorySizeInBytes = source->totalMemorySizeInBytes;
+
+	return true;
+}
+
 V2MP_MemoryStore* V2MP_MemoryStore_AllocateAndInit(void)
 {
-	return BASEUTIL_CALLOC_STRUCT(V2MP_MemoryStore);
+	return V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MEMORYSTORE_BACKING_HEAP, NULL);
+}
+
+V2MP_MemoryStore* V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MemoryStore_Backing backing, const char* filePath)
+{
+	V2MP_MemoryStore* mem;
+
+	if ( (backing == V2MP_MEMORYSTORE_BACKING_FILE) != (filePath != NULL) )
+	{
+		return NULL;
+	}
+
+	mem = BASEUTIL_CALLOC_STRUCT(V2MP_MemoryStore);
+
+	if ( !mem )
+	{
+		return NULL;
+	}
+
+	mem->backing = backing;
+
+	if ( filePath )
+	{
+		mem->backingFilePath = BaseUtil_String_Duplicate(filePath);
+
+		if ( !mem->backingFilePath )
+		{
+			BASEUTIL_FREE(mem);
+			return NULL;
+		}
+	}
+
+	return mem;
 }
 
 void V2MP_MemoryStore_DeinitAndFree(V2MP_MemoryStore* mem)
@@ -37,7 +335,56 @@ void V2MP_MemoryStore_DeinitAndFree(V2MP_MemoryStore* mem)
 	}
 
 	FreeAllMemory(mem);
-	BASEUTIL_FREE(mem);
+
+	if ( mem->backingFilePath )
+	{
+		BASEUTIL_FREE(mem->backingFilePath);
+	}
+
+	if ( !mem->placedInBlock )
+	{
+		BASEUTIL_FREE(mem);
+	}
+}
+
+V2MP_MemoryStore* V2MP_MemoryStore_PlaceInBlock(V2MP_BlockLayout* layout, size_t sizeInBytes)
+{
+	V2MP_MemoryStore* mem;
+	V2MP_Byte* dirtyPages;
+	V2MP_Byte* totalMemory;
+
+	mem = (V2MP_MemoryStore*)V2MP_BlockLayout_Reserve(layout, sizeof(V2MP_MemoryStore));
+	dirtyPages = (V2MP_Byte*)V2MP_BlockLayout_Reserve(layout, DIRTY_BITMAP_SIZE(sizeInBytes));
+
+	// Memory goes last, so that the store's own fields are not pushed
+	// far away from the modules placed before it.
+	totalMemory = (V2MP_Byte*)V2MP_BlockLayout_Reserve(layout, sizeInBytes);
+
+	if ( !mem )
+	{
+		return NULL;
+	}
+
+	memset(mem, 0, sizeof(*mem));
+	memset(dirtyPages, 0, DIRTY_BITMAP_SIZE(sizeInBytes));
+
+	mem->backing = V2MP_MEMORYSTORE_BACKING_HEAP;
+	mem->placedInBlock = true;
+
+	if ( sizeInBytes > 0 )
+	{
+		mem->totalMemory = totalMemory;
+		mem->totalMemorySizeInBytes = sizeInBytes;
+		mem->dirtyPages = dirtyPages;
+		mem->memoryInBlock = true;
+	}
+
+	return mem;
+}
+
+V2MP_MemoryStore_Backing V2MP_MemoryStore_GetBacking(const V2MP_MemoryStore* mem)
+{
+	return mem ? mem->backing : V2MP_MEMORYSTORE_BACKING_HEAP;
 }
 
 bool V2MP_MemoryStore_AllocateTotalMemory(V2MP_MemoryStore* mem, size_t sizeInBytes)
@@ -49,17 +396,205 @@ bool V2MP_MemoryStore_AllocateTotalMemory(V2MP_MemoryStore* mem, size_t sizeInBy
 
 	FreeAllMemory(mem);
 
-	mem->totalMemory = BASEUTIL_MALLOC(sizeInBytes);
+	mem->totalMemory = AllocateContiguousMemory(mem, sizeInBytes);
 
 	if ( !mem->totalMemory )
 	{
+		NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
 		return false;
 	}
 
 	mem->totalMemorySizeInBytes = sizeInBytes;
+
+	if ( !AllocateDirtyPageBitmap(mem) )
+	{
+		FreeAllMemory(mem);
+		NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+		return false;
+	}
+
+	NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+
 	return true;
 }
 
+bool V2MP_MemoryStore_AllocatePagedMemory(V2MP_MemoryStore* mem, size_t sizeInBytes)
+{
+	size_t numPages;
+
+	if ( !mem || sizeInBytes < 1 || (sizeInBytes & 0x1) || mem->backing != V2MP_MEMORYSTORE_BACKING_HEAP )
+	{
+		return false;
+	}
+
+	FreeAllMemory(mem);
+
+	numPages = PAGE_INDEX(sizeInBytes - 1) + 1;
+	mem->pages = (MemoryPage**)BASEUTIL_CALLOC(numPages, sizeof(MemoryPage*));
+
+	if ( !mem->pages )
+	{
+		NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+		return false;
+	}
+
+	mem->numPages = numPages;
+	mem->totalMemorySizeInBytes = sizeInBytes;
+
+	if ( !AllocateDirtyPageBitmap(mem) )
+	{
+		FreeAllMemory(mem);
+		NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+		return false;
+	}
+
+	NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+
+	return true;
+}
+
+bool V2MP_MemoryStore_ForkFrom(V2MP_MemoryStore* mem, V2MP_MemoryStore* source)
+{
+	bool success;
+
+	if ( !mem || !source || mem == source )
+	{
+		return false;
+	}
+
+	// Pages are always allocated from the heap.
+	if ( source->pages && mem->backing != V2MP_MEMORYSTORE_BACKING_HEAP )
+	{
+		return false;
+	}
+
+	FreeAllMemory(mem);
+
+	if ( source->pages )
+	{
+		success = SharePages(mem, source);
+	}
+	else if ( source->totalMemory )
+	{
+		success = CopyContiguousMemory(mem, source);
+	}
+	else
+	{
+		success = true;
+	}
+
+	if ( success && AllocateDirtyPageBitmap(mem) )
+	{
+		// Relative to a freshly allocated store, everything
+		// that was inherited from the source has changed.
+		MarkCommittedPagesDirty(mem);
+	}
+	else
+	{
+		FreeAllMemory(mem);
+		success = false;
+	}
+
+	NotifyChange(mem, V2MP_MEMORYSTORE_CHANGE_REALLOC);
+
+	if ( success && source->numCommittedPages > 0 )
+	{
+		// Any pages the source could previously write to
+		// directly must now be copied before being written.
+		NotifyChange(source, V2MP_MEMORYSTORE_CHANGE_PAGES_SHARED);
+	}
+
+	return success;
+}
+
+bool V2MP_MemoryStore_IsPaged(const V2MP_MemoryStore* mem)
+{
+	return mem && mem->pages;
+}
+
+size_t V2MP_MemoryStore_GetCommittedMemorySize(const V2MP_MemoryStore* mem)
+{
+	if ( !mem )
+	{
+		return 0;
+	}
+
+	return mem->pages
+		? mem->numCommittedPages * V2MP_MEMORYSTORE_PAGE_SIZE
+		: mem->totalMemorySizeInBytes;
+}
+
+size_t V2MP_MemoryStore_GetDirtyPageBitmapSize(const V2MP_MemoryStore* mem)
+{
+	return (mem && mem->dirtyPages) ? DIRTY_BITMAP_SIZE(mem->totalMemorySizeInBytes) : 0;
+}
+
+bool V2MP_MemoryStore_GetAndClearDirtyPages(
+	V2MP_MemoryStore* mem,
+	V2MP_Byte* outBitmap,
+	size_t bitmapSizeInBytes
+)
+{
+	size_t dirtyBitmapSize;
+
+	if ( !mem || !outBitmap )
+	{
+		return false;
+	}
+
+	dirtyBitmapSize = V2MP_MemoryStore_GetDirtyPageBitmapSize(mem);
+
+	if ( bitmapSizeInBytes < dirtyBitmapSize )
+	{
+		return false;
+	}
+
+	if ( dirtyBitmapSize > 0 )
+	{
+		memcpy(outBitmap, mem->dirtyPages, dirtyBitmapSize);
+		memset(mem->dirtyPages, 0, dirtyBitmapSize);
+	}
+
+	return true;
+}
+
+V2MP_Byte* V2MP_MemoryStore_GetDirtyPageBitmap(V2MP_MemoryStore* mem)
+{
+	return mem ? mem->dirtyPages : NULL;
+}
+
+size_t V2MP_MemoryStore_GetSharedMemorySize(const V2MP_MemoryStore* mem)
+{
+	size_t numSharedPages = 0;
+	size_t index;
+
+	if ( !mem || !mem->pages )
+	{
+		return 0;
+	}
+
+	for ( index = 0; index < mem->numPages; ++index )
+	{
+		if ( mem->pages[index] && BaseUtil_Atomic_LoadSize(&mem->pages[index]->refCount) > 1 )
+		{
+			++numSharedPages;
+		}
+	}
+
+	return numSharedPages * V2MP_MEMORYSTORE_PAGE_SIZE;
+}
+
+void V2MP_MemoryStore_SetChangeCallback(V2MP_MemoryStore* mem, V2MP_MemoryStore_ChangeCallback callback, void* userData)
+{
+	if ( !mem )
+	{
+		return;
+	}
+
+	mem->changeCallback = callback;
+	mem->changeCallbackUserData = callback ? userData : NULL;
+}
+
 size_t V2MP_MemoryStore_GetTotalMemorySize(const V2MP_MemoryStore* mem)
 {
 	return mem ? mem->totalMemorySizeInBytes : 0;
@@ -67,7 +602,13 @@ size_t V2MP_MemoryStore_GetTotalMemorySize(const V2MP_MemoryStore* mem)
 
 V2MP_Byte* V2MP_MemoryStore_GetPtrToBase(V2MP_MemoryStore* mem)
 {
-	return (V2MP_Byte*)V2MP_MemoryStore_GetConstPtrToBase(mem);
+	if ( !mem || !mem->totalMemory )
+	{
+		return NULL;
+	}
+
+	V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, 0, mem->totalMemorySizeInBytes);
+	return mem->totalMemory;
 }
 
 const V2MP_Byte* V2MP_MemoryStore_GetConstPtrToBase(const V2MP_MemoryStore* mem)
@@ -81,45 +622,158 @@ bool V2MP_MemoryStore_LoadWord(
 	V2MP_Word* outWord
 )
 {
-	const V2MP_Byte* rawData;
-
-	if ( !mem || !outWord )
+	if ( !outWord )
 	{
 		return false;
 	}
 
-	rawData = V2MP_MemoryStore_GetConstPtrToRange(mem, address, sizeof(V2MP_Word));
+	return V2MP_MemoryStore_ReadRange(mem, address, (V2MP_Byte*)outWord, sizeof(V2MP_Word));
+}
+
+bool V2MP_MemoryStore_StoreWord(
+	V2MP_MemoryStore* mem,
+	size_t address,
+	V2MP_Word inWord
+)
+{
+	return V2MP_MemoryStore_WriteRange(mem, address, (const V2MP_Byte*)&inWord, sizeof(V2MP_Word));
+}
 
-	if ( !rawData )
+bool V2MP_MemoryStore_ReadRange(
+	const V2MP_MemoryStore* mem,
+	size_t base,
+	V2MP_Byte* outBuffer,
+	size_t length
+)
+{
+	size_t chunkLength;
+
+	if ( !mem || !outBuffer || !RangeIsInMemory(mem, base, length) )
 	{
 		return false;
 	}
 
-	*outWord = *((const V2MP_Word*)rawData);
+	if ( mem->totalMemory )
+	{
+		memcpy(outBuffer, &mem->totalMemory[base], length);
+		return true;
+	}
+
+	while ( length > 0 )
+	{
+		chunkLength = V2MP_MEMORYSTORE_PAGE_SIZE - PAGE_OFFSET(base);
+
+		if ( chunkLength > length )
+		{
+			chunkLength = length;
+		}
+
+		memcpy(outBuffer, GetConstPage(mem, PAGE_INDEX(base)) + PAGE_OFFSET(base), chunkLength);
+
+		outBuffer += chunkLength;
+		base += chunkLength;
+		length -= chunkLength;
+	}
+
 	return true;
 }
 
-bool V2MP_MemoryStore_StoreWord(
+bool V2MP_MemoryStore_WriteRange(
 	V2MP_MemoryStore* mem,
-	size_t address,
-	V2MP_Word inWord
+	size_t base,
+	const V2MP_Byte* data,
+	size_t length
 )
 {
-	V2MP_Byte* rawData;
+	V2MP_Byte* page;
+	size_t chunkLength;
 
-	if ( !mem )
+	if ( !mem || !data || !RangeIsInMemory(mem, base, length) )
 	{
 		return false;
 	}
 
-	rawData = V2MP_MemoryStore_GetPtrToRange(mem, address, sizeof(V2MP_Word));
+	if ( mem->totalMemory )
+	{
+		memcpy(&mem->totalMemory[base], data, length);
+		V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, base, length);
+		return true;
+	}
+
+	while ( length > 0 )
+	{
+		chunkLength = V2MP_MEMORYSTORE_PAGE_SIZE - PAGE_OFFSET(base);
+
+		if ( chunkLength > length )
+		{
+			chunkLength = length;
+		}
+
+		page = GetWritablePage(mem, PAGE_INDEX(base));
+
+		if ( !page )
+		{
+			return false;
+		}
+
+		memcpy(page + PAGE_OFFSET(base), data, chunkLength);
+		V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, base, chunkLength);
+
+		data += chunkLength;
+		base += chunkLength;
+		length -= chunkLength;
+	}
+
+	return true;
+}
+
+bool V2MP_MemoryStore_ZeroRange(
+	V2MP_MemoryStore* mem,
+	size_t base,
+	size_t length
+)
+{
+	V2MP_Byte* page;
+	size_t chunkLength;
 
-	if ( !rawData )
+	if ( !mem || !RangeIsInMemory(mem, base, length) )
 	{
 		return false;
 	}
 
-	*((V2MP_Word*)rawData) = inWord;
+	if ( mem->totalMemory )
+	{
+		memset(&mem->totalMemory[base], 0, length);
+		V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, base, length);
+		return true;
+	}
+
+	while ( length > 0 )
+	{
+		chunkLength = V2MP_MEMORYSTORE_PAGE_SIZE - PAGE_OFFSET(base);
+
+		if ( chunkLength > length )
+		{
+			chunkLength = length;
+		}
+
+		if ( mem->pages[PAGE_INDEX(base)] )
+		{
+			page = GetWritablePage(mem, PAGE_INDEX(base));
+
+			if ( !page )
+			{
+				return false;
+			}
+
+			memset(page + PAGE_OFFSET(base), 0, chunkLength);
+			V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, base, chunkLength);
+		}
+
+		base += chunkLength;
+		length -= chunkLength;
+	}
+
 	return true;
 }
 
@@ -129,7 +783,33 @@ V2MP_Byte* V2MP_MemoryStore_GetPtrToRange(
 	size_t length
 )
 {
-	return (V2MP_Byte*)V2MP_MemoryStore_GetConstPtrToRange(mem, base, length);
+	V2MP_Byte* ptr;
+
+	if ( !mem || !mem->pages )
+	{
+		ptr = (V2MP_Byte*)V2MP_MemoryStore_GetConstPtrToRange(mem, base, length);
+	}
+	else if ( !RangeIsInMemory(mem, base, length) || !RangeIsInSinglePage(base, length) )
+	{
+		ptr = NULL;
+	}
+	else
+	{
+		ptr = GetWritablePage(mem, PAGE_INDEX(base));
+
+		if ( ptr )
+		{
+			ptr += PAGE_OFFSET(base);
+		}
+	}
+
+	if ( ptr )
+	{
+		// The caller may write through the pointer.
+		V2MP_MemoryStore_MarkRangeDirty(mem->dirtyPages, base, length);
+	}
+
+	return ptr;
 }
 
 const V2MP_Byte* V2MP_MemoryStore_GetConstPtrToRange(
@@ -138,25 +818,48 @@ const V2MP_Byte* V2MP_MemoryStore_GetConstPtrToRange(
 	size_t length
 )
 {
-	if ( !mem || !mem->totalMemory || mem->totalMemorySizeInBytes < 1 )
+	if ( !mem || mem->totalMemorySizeInBytes < 1 || !RangeIsInMemory(mem, base, length) )
 	{
 		return NULL;
 	}
 
-	// The following checks are carefully constructed to avoid calculating
-	// values that are outside of the range of a size_t:
+	if ( mem->pages )
+	{
+		if ( !RangeIsInSinglePage(base, length) )
+		{
+			return NULL;
+		}
+
+		return GetConstPage(mem, PAGE_INDEX(base)) + PAGE_OFFSET(base);
+	}
+
+	return mem->totalMemory ? &mem->totalMemory[base] : NULL;
+}
 
-	if ( base >= mem->totalMemorySizeInBytes )
+size_t V2MP_MemoryStore_GetPageBarrierCount(const V2MP_MemoryStore* mem)
+{
+	return mem ? mem->numPageBarriers : 0;
+}
+
+V2MP_Byte* V2MP_MemoryStore_GetExclusivePtrToRange(
+	V2MP_MemoryStore* mem,
+	size_t base,
+	size_t length
+)
+{
+	MemoryPage* page;
+
+	if ( !mem || !mem->pages )
 	{
-		// Begins out of range.
-		return NULL;
+		return (V2MP_Byte*)V2MP_MemoryStore_GetConstPtrToRange(mem, base, length);
 	}
 
-	if ( mem->totalMemorySizeInBytes - base < length )
+	if ( !RangeIsInMemory(mem, base, length) || !RangeIsInSinglePage(base, length) )
 	{
-		// Ends out of range.
 		return NULL;
 	}
 
-	return &mem->totalMemory[base];
+	page = mem->pages[PAGE_INDEX(base)];
+
+	return (page && BaseUtil_Atomic_LoadSize(&page->refCount) == 1) ? page->data + PAGE_OFFSET(base) : NULL;
 }
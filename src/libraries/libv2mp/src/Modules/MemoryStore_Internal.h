@@ -0,0 +1,72 @@
+#ifndef V2MP_MODULES_MEMORYSTORE_INTERNAL_H
+#define V2MP_MODULES_MEMORYSTORE_INTERNAL_H
+
+#include "LibV2MP/Modules/MemoryStore.h"
+#include "Modules/BlockLayout.h"
+
+typedef enum V2MP_MemoryStore_ChangeType
+{
+	// The memory store's total memory was allocated or freed, after
+	// which any pointers previously obtained from the store are invalid.
+	V2MP_MEMORYSTORE_CHANGE_REALLOC = 0,
+
+	// The store's pages were shared with another store by V2MP_MemoryStore_ForkFrom().
+	// Pointers obtained from V2MP_MemoryStore_GetExclusivePtrToRange() are no longer
+	// safe to write through, though they may still be read from.
+	V2MP_MEMORYSTORE_CHANGE_PAGES_SHARED
+} V2MP_MemoryStore_ChangeType;
+
+// Reserves space within the block for a memory store with sizeInBytes of contiguous
+// memory and its dirty page bitmap, and initialises the store there if the block
+// has been allocated. The memory is not filled with zeroes, so the block should
+// already be. If the store's memory is later reallocated, the new memory comes
+// from the heap as usual, and the memory within the block goes unused.
+V2MP_MemoryStore* V2MP_MemoryStore_PlaceInBlock(V2MP_BlockLayout* layout, size_t sizeInBytes);
+
+typedef void (*V2MP_MemoryStore_ChangeCallback)(void* userData, V2MP_MemoryStore_ChangeType changeType);
+
+// Only one callback may be registered at a time. Pass NULL to clear it.
+void V2MP_MemoryStore_SetChangeCallback(V2MP_MemoryStore* mem, V2MP_MemoryStore_ChangeCallback callback, void* userData);
+
+// Dirty page bitmap for the memory store, with one bit per V2MP_MEMORYSTORE_PAGE_SIZE
+// bytes of memory. This is only reallocated when the store's memory is reallocated.
+// Anything that writes directly to memory obtained from the store via
+// V2MP_MemoryStore_GetExclusivePtrToRange() must mark the pages it writes to
+// using V2MP_MemoryStore_MarkRangeDirty().
+V2MP_Byte* V2MP_MemoryStore_GetDirtyPageBitmap(V2MP_MemoryStore* mem);
+
+static inline void V2MP_MemoryStore_MarkRangeDirty(V2MP_Byte* dirtyPages, size_t base, size_t length)
+{
+	size_t page;
+	size_t lastPage;
+
+	if ( !dirtyPages || length < 1 )
+	{
+		return;
+	}
+
+	lastPage = (base + length - 1) / V2MP_MEMORYSTORE_PAGE_SIZE;
+
+	for ( page = base / V2MP_MEMORYSTORE_PAGE_SIZE; page <= lastPage; ++page )
+	{
+		dirtyPages[page >> 3] |= (V2MP_Byte)(1 << (page & 0x7));
+	}
+}
+
+// Returns a pointer to the range only if it may be written to directly: for paged
+// memory, the range must lie within a single page that is committed and not shared
+// with any other store. Unlike V2MP_MemoryStore_GetPtrToRange(), this never commits
+// or copies a page, so returns null in cases where that would be required.
+V2MP_Byte* V2MP_MemoryStore_GetExclusivePtrToRange(
+	V2MP_MemoryStore* mem,
+	size_t base,
+	size_t length
+);
+
+// Counts the times that a page of paged memory has been committed, or copied
+// because it was shared, since the store was created. Any pointers to the
+// store's pages that were obtained before the count last changed may refer
+// to a page that is no longer the store's own.
+size_t V2MP_MemoryStore_GetPageBarrierCount(const V2MP_MemoryStore* mem);
+
+#endif // V2MP_MODULES_MEMORYSTORE_INTERNAL_H
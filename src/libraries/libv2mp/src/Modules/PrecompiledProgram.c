@@ -0,0 +1,118 @@
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "LibBaseUtil/Heap.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define FNV1A_OFFSET_BASIS 0x811C9DC5u
+#define FNV1A_PRIME 0x01000193u
+
+struct V2MP_PrecompiledLibrary
+{
+	void* handle;
+	const V2MP_PrecompiledProgram* program;
+};
+
+static void* OpenLibrary(const char* path)
+{
+#if defined(_WIN32)
+	return (void*)LoadLibraryA(path);
+#else
+	return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+static void* LookUpSymbol(void* handle, const char* name)
+{
+#if defined(_WIN32)
+	return (void*)GetProcAddress((HMODULE)handle, name);
+#else
+	return dlsym(handle, name);
+#endif
+}
+
+static void CloseLibrary(void* handle)
+{
+#if defined(_WIN32)
+	FreeLibrary((HMODULE)handle);
+#else
+	dlclose(handle);
+#endif
+}
+
+uint32_t V2MP_PrecompiledProgram_HashCS(const V2MP_Word* cs, size_t csLengthInWords)
+{
+	uint32_t hash = FNV1A_OFFSET_BASIS;
+	size_t index;
+
+	if ( !cs )
+	{
+		return hash;
+	}
+
+	for ( index = 0; index < csLengthInWords; ++index )
+	{
+		hash = (hash ^ (uint32_t)(cs[index] & 0xFF)) * FNV1A_PRIME;
+		hash = (hash ^ (uint32_t)(cs[index] >> 8)) * FNV1A_PRIME;
+	}
+
+	return hash;
+}
+
+V2MP_PrecompiledLibrary* V2MP_PrecompiledLibrary_AllocateAndLoad(const char* path)
+{
+	V2MP_PrecompiledLibrary* library;
+
+	if ( !path )
+	{
+		return NULL;
+	}
+
+	library = BASEUTIL_CALLOC_STRUCT(V2MP_PrecompiledLibrary);
+
+	if ( !library )
+	{
+		return NULL;
+	}
+
+	library->handle = OpenLibrary(path);
+
+	if ( !library->handle )
+	{
+		V2MP_PrecompiledLibrary_UnloadAndFree(library);
+		return NULL;
+	}
+
+	library->program = (const V2MP_PrecompiledProgram*)LookUpSymbol(library->handle, V2MP_PRECOMPILED_PROGRAM_SYMBOL);
+
+	if ( !library->program || library->program->abiVersion != V2MP_PRECOMPILED_ABI_VERSION )
+	{
+		V2MP_PrecompiledLibrary_UnloadAndFree(library);
+		return NULL;
+	}
+
+	return library;
+}
+
+void V2MP_PrecompiledLibrary_UnloadAndFree(V2MP_PrecompiledLibrary* library)
+{
+	if ( !library )
+	{
+		return;
+	}
+
+	if ( library->handle )
+	{
+		CloseLibrary(library->handle);
+	}
+
+	BASEUTIL_FREE(library);
+}
+
+const V2MP_PrecompiledProgram* V2MP_PrecompiledLibrary_GetProgram(const V2MP_PrecompiledLibrary* library)
+{
+	return library ? library->program : NULL;
+}
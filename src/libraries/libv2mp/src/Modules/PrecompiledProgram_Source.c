@@ -0,0 +1,608 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "LibBaseUtil/Heap.h"
+#include "Modules/CPU_Decode.h"
+
+// Instructions past this address can never be reached, since PC is 16 bits wide.
+#define MAX_REACHABLE_WORDS 0x8000
+
+// Upper limit on the number of instructions in a single block.
+#define MAX_BLOCK_LENGTH 256
+
+typedef struct SourceOutput
+{
+	V2MP_PrecompiledSourceWriter writer;
+	void* userData;
+} SourceOutput;
+
+static const char* const REGISTER_NAMES[] =
+{
+	"r0",	// V2MP_REGID_R0
+	"r1",	// V2MP_REGID_R1
+	"lr",	// V2MP_REGID_LR
+	"pc"	// V2MP_REGID_PC
+};
+
+// Every helper below mirrors the corresponding handler in CPU_Instructions.c,
+// including the order in which registers are written, so that an instruction
+// that uses the same register for more than one purpose behaves identically.
+static const char* const SOURCE_PREAMBLE =
+	"#include <stdint.h>\n"
+	"\n"
+	"#if defined(_WIN32)\n"
+	"#define EXPORT __declspec(dllexport)\n"
+	"#elif defined(__GNUC__)\n"
+	"#define EXPORT __attribute__((visibility(\"default\")))\n"
+	"#else\n"
+	"#define EXPORT\n"
+	"#endif\n"
+	"\n"
+	"typedef uint16_t Word;\n"
+	"\n"
+	"// Layout must match LibV2MP/Modules/PrecompiledProgram.h.\n"
+	"typedef struct Registers\n"
+	"{\n"
+	"\tWord r0;\n"
+	"\tWord r1;\n"
+	"\tWord lr;\n"
+	"\tWord pc;\n"
+	"\tWord sr;\n"
+	"\tWord ir;\n"
+	"\tWord fault;\n"
+	"} Registers;\n"
+	"\n"
+	"typedef struct Block\n"
+	"{\n"
+	"\tuint32_t startWordIndex;\n"
+	"\tuint32_t numCycles;\n"
+	"\tvoid (*execute)(Registers* regs);\n"
+	"} Block;\n"
+	"\n"
+	"typedef struct Program\n"
+	"{\n"
+	"\tuint32_t abiVersion;\n"
+	"\tuint32_t csHash;\n"
+	"\tuint32_t csLengthInWords;\n"
+	"\tuint32_t numBlocks;\n"
+	"\tconst Block* blocks;\n"
+	"} Program;\n"
+	"\n"
+	"static inline void AddSub(Registers* regs, Word* dest, int32_t multiplier, Word operand)\n"
+	"{\n"
+	"\tconst Word oldValue = *dest;\n"
+	"\n"
+	"\t*dest = (Word)(*dest + (Word)(multiplier * (int32_t)operand));\n"
+	"\tregs->sr = 0;\n"
+	"\n"
+	"\tif ( (multiplier > 0 && *dest < oldValue) || (multiplier < 0 && *dest > oldValue) )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_C;\n"
+	"\t}\n"
+	"\n"
+	"\tif ( *dest == 0 )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_Z;\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void Mul(Registers* regs, Word* dest, Word operand, int isSigned)\n"
+	"{\n"
+	"\tint overflowed;\n"
+	"\n"
+	"\tif ( isSigned )\n"
+	"\t{\n"
+	"\t\tconst int32_t result = (int32_t)(int16_t)(*dest) * (int32_t)(int16_t)operand;\n"
+	"\n"
+	"\t\toverflowed = result > 0 ? result > 32767 : result < -32768;\n"
+	"\t\tregs->lr = (Word)((uint32_t)result >> 16);\n"
+	"\t\t*dest = (Word)((uint32_t)result & 0xFFFF);\n"
+	"\t}\n"
+	"\telse\n"
+	"\t{\n"
+	"\t\tconst uint32_t result = (uint32_t)(*dest) * (uint32_t)operand;\n"
+	"\n"
+	"\t\toverflowed = (result >> 16) != 0;\n"
+	"\t\tregs->lr = (Word)(result >> 16);\n"
+	"\t\t*dest = (Word)(result & 0xFFFF);\n"
+	"\t}\n"
+	"\n"
+	"\tregs->sr = 0;\n"
+	"\n"
+	"\tif ( overflowed )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_C;\n"
+	"\t}\n"
+	"\n"
+	"\tif ( regs->lr == 0 && *dest == 0 )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_Z;\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void Div(Registers* regs, Word* dest, Word operand, int isSigned)\n"
+	"{\n"
+	"\tif ( operand == 0 )\n"
+	"\t{\n"
+	"\t\tregs->fault = FAULT_DIV;\n"
+	"\t\treturn;\n"
+	"\t}\n"
+	"\n"
+	"\tif ( isSigned )\n"
+	"\t{\n"
+	"\t\tregs->lr = (Word)((int16_t)(*dest) % (int16_t)operand);\n"
+	"\t\t*dest = (Word)((int16_t)(*dest) / (int16_t)operand);\n"
+	"\t}\n"
+	"\telse\n"
+	"\t{\n"
+	"\t\tregs->lr = (Word)(*dest % operand);\n"
+	"\t\t*dest = (Word)(*dest / operand);\n"
+	"\t}\n"
+	"\n"
+	"\tregs->sr = 0;\n"
+	"\n"
+	"\tif ( regs->lr != 0 )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_C;\n"
+	"\t}\n"
+	"\n"
+	"\tif ( *dest == 0 )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_Z;\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void Asgn(Registers* regs, Word* dest, Word operand)\n"
+	"{\n"
+	"\t*dest = operand;\n"
+	"\tregs->sr = *dest == 0 ? SR_Z : 0;\n"
+	"}\n"
+	"\n"
+	"static inline void Shft(Registers* regs, Word* dest, Word operand)\n"
+	"{\n"
+	"\tint16_t shift = (int16_t)operand;\n"
+	"\n"
+	"\tregs->sr = 0;\n"
+	"\n"
+	"\tif ( shift < 0 )\n"
+	"\t{\n"
+	"\t\tshift = (int16_t)(-shift);\n"
+	"\n"
+	"\t\tif ( *dest & (0xFFFF >> (16 - shift)) )\n"
+	"\t\t{\n"
+	"\t\t\tregs->sr |= SR_C;\n"
+	"\t\t}\n"
+	"\n"
+	"\t\t*dest = (Word)(*dest >> shift);\n"
+	"\t}\n"
+	"\telse\n"
+	"\t{\n"
+	"\t\tif ( *dest & (0xFFFF << (16 - shift)) )\n"
+	"\t\t{\n"
+	"\t\t\tregs->sr |= SR_C;\n"
+	"\t\t}\n"
+	"\n"
+	"\t\t*dest = (Word)(*dest << shift);\n"
+	"\t}\n"
+	"\n"
+	"\tif ( *dest == 0 )\n"
+	"\t{\n"
+	"\t\tregs->sr |= SR_Z;\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void Bitw(Registers* regs, Word* dest, Word operand, int op)\n"
+	"{\n"
+	"\tswitch ( op )\n"
+	"\t{\n"
+	"\t\tcase BITOP_AND: *dest &= operand; break;\n"
+	"\t\tcase BITOP_OR: *dest |= operand; break;\n"
+	"\t\tcase BITOP_XOR: *dest ^= operand; break;\n"
+	"\t\tdefault: *dest = (Word)~(*dest); break;\n"
+	"\t}\n"
+	"\n"
+	"\tregs->sr = *dest == 0 ? SR_Z : 0;\n"
+	"}\n"
+	"\n"
+	"static inline void Cbx(Registers* regs, int onCarry, int toLR, Word offset)\n"
+	"{\n"
+	"\tconst int shouldBranch = onCarry ? (regs->sr & SR_C) != 0 : (regs->sr & SR_Z) != 0;\n"
+	"\n"
+	"\tif ( shouldBranch )\n"
+	"\t{\n"
+	"\t\tregs->pc = toLR ? regs->lr : (Word)(regs->pc + offset);\n"
+	"\t}\n"
+	"\n"
+	"\tregs->sr = shouldBranch ? 0 : SR_Z;\n"
+	"}\n";
+
+static void Emit(const SourceOutput* output, const char* format, ...)
+{
+	char buffer[256];
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	output->writer(output->userData, buffer);
+}
+
+// Instructions that need the supervisor, or that always fault,
+// are left to the interpreter and are never part of a block.
+static bool IsInterpreted(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_NOP:
+		case V2MP_OP_ADD:
+		case V2MP_OP_SUB:
+		case V2MP_OP_MUL:
+		case V2MP_OP_DIV:
+		case V2MP_OP_ASGN:
+		case V2MP_OP_SHFT:
+		case V2MP_OP_BITW:
+		case V2MP_OP_CBX:
+		{
+			return false;
+		}
+
+		default:
+		{
+			return true;
+		}
+	}
+}
+
+// Instructions that may change the flow of execution, or raise a fault,
+// are included in a block but always end it.
+static bool EndsBlock(const V2MP_CPU_DecodedInstruction* decoded)
+{
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_NOP:
+		{
+			return false;
+		}
+
+		case V2MP_OP_DIV:
+		case V2MP_OP_CBX:
+		{
+			return true;
+		}
+
+		default:
+		{
+			return decoded->destReg == V2MP_REGID_PC;
+		}
+	}
+}
+
+static bool IsLiteralOp(const V2MP_CPU_DecodedInstruction* decoded, uint8_t handler, uint8_t reg)
+{
+	return
+		decoded->handler == handler &&
+		(decoded->flags & V2MP_DECODED_FLAG_LITERAL) &&
+		decoded->destReg == reg;
+}
+
+static void MarkLeader(bool* leaders, size_t count, V2MP_Word address)
+{
+	if ( (address & 1) == 0 && (size_t)(address >> 1) < count )
+	{
+		leaders[address >> 1] = true;
+	}
+}
+
+// Block boundaries are placed after every instruction that ends a block or is
+// interpreted, and at every branch target that can be determined statically.
+// Execution that arrives anywhere else is interpreted until it reaches a block.
+static void FindLeaders(const V2MP_CPU_DecodedInstruction* decoded, size_t count, bool* leaders)
+{
+	size_t index;
+
+	leaders[0] = true;
+
+	for ( index = 0; index < count; ++index )
+	{
+		const V2MP_CPU_DecodedInstruction* instr = &decoded[index];
+		const V2MP_Word nextAddress = (V2MP_Word)((index + 1) * sizeof(V2MP_Word));
+
+		if ( (IsInterpreted(instr) || EndsBlock(instr)) && index + 1 < count )
+		{
+			leaders[index + 1] = true;
+		}
+
+		if ( instr->handler == V2MP_OP_CBX && !(instr->flags & V2MP_DECODED_FLAG_LR_TARGET) )
+		{
+			MarkLeader(leaders, count, (V2MP_Word)(nextAddress + instr->immediate));
+		}
+		else if ( IsLiteralOp(instr, V2MP_OP_ADD, V2MP_REGID_PC) )
+		{
+			MarkLeader(leaders, count, (V2MP_Word)(nextAddress + (2 * instr->immediate)));
+		}
+		else if ( IsLiteralOp(instr, V2MP_OP_SUB, V2MP_REGID_PC) )
+		{
+			MarkLeader(leaders, count, (V2MP_Word)(nextAddress - (2 * instr->immediate)));
+		}
+		else if ( index >= 3 &&
+		          instr->handler == V2MP_OP_ASGN &&
+		          !(instr->flags & V2MP_DECODED_FLAG_LITERAL) &&
+		          instr->destReg == V2MP_REGID_PC &&
+		          instr->sourceReg != V2MP_REGID_PC &&
+		          IsLiteralOp(&decoded[index - 3], V2MP_OP_ASGN, instr->sourceReg) &&
+		          IsLiteralOp(&decoded[index - 2], V2MP_OP_SHFT, instr->sourceReg) &&
+		          decoded[index - 2].immediate == 8 &&
+		          IsLiteralOp(&decoded[index - 1], V2MP_OP_ADD, instr->sourceReg) )
+		{
+			// Jump to a 16-bit address loaded by the preceding three instructions.
+			MarkLeader(
+				leaders,
+				count,
+				(V2MP_Word)((V2MP_Word)(decoded[index - 3].immediate << 8) + decoded[index - 1].immediate)
+			);
+		}
+	}
+}
+
+static size_t GetBlockLength(const V2MP_CPU_DecodedInstruction* decoded, size_t count, const bool* leaders, size_t start)
+{
+	size_t index = start;
+
+	while ( index < count && index - start < MAX_BLOCK_LENGTH && !IsInterpreted(&decoded[index]) )
+	{
+		if ( EndsBlock(&decoded[index++]) || (index < count && leaders[index]) )
+		{
+			break;
+		}
+	}
+
+	return index - start;
+}
+
+static void EmitOperand(char* buffer, size_t size, const V2MP_CPU_DecodedInstruction* decoded)
+{
+	if ( decoded->flags & V2MP_DECODED_FLAG_LITERAL )
+	{
+		snprintf(buffer, size, "0x%04X", (unsigned int)decoded->immediate);
+	}
+	else
+	{
+		snprintf(buffer, size, "regs->%s", REGISTER_NAMES[V2MP_REGID_MASK(decoded->sourceReg)]);
+	}
+}
+
+static void EmitInstruction(const SourceOutput* output, const V2MP_CPU_DecodedInstruction* decoded, size_t index)
+{
+	const char* dest = REGISTER_NAMES[V2MP_REGID_MASK(decoded->destReg)];
+	const int isSigned = (decoded->flags & V2MP_DECODED_FLAG_SIGNED) ? 1 : 0;
+	char operand[32];
+
+	EmitOperand(operand, sizeof(operand), decoded);
+
+	Emit(output, "\n\t// 0x%04X: 0x%04X\n", (unsigned int)(index * sizeof(V2MP_Word)), (unsigned int)decoded->word);
+	Emit(output, "\tregs->ir = 0x%04X;\n", (unsigned int)decoded->word);
+	Emit(output, "\tregs->pc = 0x%04X;\n", (unsigned int)((index + 1) * sizeof(V2MP_Word)));
+
+	switch ( decoded->handler )
+	{
+		case V2MP_OP_ADD:
+		case V2MP_OP_SUB:
+		{
+			Emit(
+				output,
+				"\tAddSub(regs, &regs->%s, %d, %s);\n",
+				dest,
+				(decoded->handler == V2MP_OP_ADD ? 1 : -1) * (decoded->destReg == V2MP_REGID_PC ? 2 : 1),
+				operand
+			);
+
+			break;
+		}
+
+		case V2MP_OP_MUL:
+		{
+			Emit(output, "\tMul(regs, &regs->%s, %s, %d);\n", dest, operand, isSigned);
+			break;
+		}
+
+		case V2MP_OP_DIV:
+		{
+			Emit(output, "\tDiv(regs, &regs->%s, %s, %d);\n", dest, operand, isSigned);
+			break;
+		}
+
+		case V2MP_OP_ASGN:
+		{
+			Emit(output, "\tAsgn(regs, &regs->%s, %s);\n", dest, operand);
+			break;
+		}
+
+		case V2MP_OP_SHFT:
+		{
+			Emit(output, "\tShft(regs, &regs->%s, %s);\n", dest, operand);
+			break;
+		}
+
+		case V2MP_OP_BITW:
+		{
+			Emit(output, "\tBitw(regs, &regs->%s, %s, %d);\n", dest, operand, (int)V2MP_DECODED_BITOP(decoded->flags));
+			break;
+		}
+
+		case V2MP_OP_CBX:
+		{
+			Emit(
+				output,
+				"\tCbx(regs, %d, %d, 0x%04X);\n",
+				(decoded->flags & V2MP_DECODED_FLAG_ALT) ? 1 : 0,
+				(decoded->flags & V2MP_DECODED_FLAG_LR_TARGET) ? 1 : 0,
+				(unsigned int)decoded->immediate
+			);
+
+			break;
+		}
+
+		default:
+		{
+			// NOP
+			break;
+		}
+	}
+}
+
+static void EmitDefinitions(const SourceOutput* output)
+{
+	Emit(output, "// Generated by libv2mp. Do not edit.\n\n");
+	Emit(output, "#define SR_Z 0x%X\n", (unsigned int)V2MP_CPU_SR_Z);
+	Emit(output, "#define SR_C 0x%X\n", (unsigned int)V2MP_CPU_SR_C);
+	Emit(output, "#define FAULT_DIV 0x%04X\n", (unsigned int)V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_DIV, 0));
+	Emit(output, "#define BITOP_AND %d\n", (int)V2MP_BITOP_AND);
+	Emit(output, "#define BITOP_OR %d\n", (int)V2MP_BITOP_OR);
+	Emit(output, "#define BITOP_XOR %d\n\n", (int)V2MP_BITOP_XOR);
+
+	output->writer(output->userData, SOURCE_PREAMBLE);
+}
+
+static size_t EmitBlocks(
+	const SourceOutput* output,
+	const V2MP_CPU_DecodedInstruction* decoded,
+	size_t count,
+	const bool* leaders
+)
+{
+	size_t numBlocks = 0;
+	size_t start;
+	size_t index;
+
+	for ( start = 0; start < count; ++start )
+	{
+		const size_t length = leaders[start] ? GetBlockLength(decoded, count, leaders, start) : 0;
+
+		if ( length < 1 )
+		{
+			continue;
+		}
+
+		Emit(output, "\nstatic void Block_%05X(Registers* regs)\n{", (unsigned int)start);
+
+		for ( index = start; index < start + length; ++index )
+		{
+			EmitInstruction(output, &decoded[index], index);
+		}
+
+		Emit(output, "}\n");
+		++numBlocks;
+	}
+
+	return numBlocks;
+}
+
+static void EmitDescriptor(
+	const SourceOutput* output,
+	const V2MP_CPU_DecodedInstruction* decoded,
+	size_t count,
+	const bool* leaders,
+	size_t numBlocks,
+	uint32_t csHash,
+	size_t csLengthInWords
+)
+{
+	size_t start;
+
+	if ( numBlocks > 0 )
+	{
+		Emit(output, "\nstatic const Block BLOCKS[] =\n{\n");
+
+		for ( start = 0; start < count; ++start )
+		{
+			const size_t length = leaders[start] ? GetBlockLength(decoded, count, leaders, start) : 0;
+
+			if ( length > 0 )
+			{
+				Emit(
+					output,
+					"\t{ %luu, %luu, &Block_%05X },\n",
+					(unsigned long)start,
+					(unsigned long)length,
+					(unsigned int)start
+				);
+			}
+		}
+
+		Emit(output, "};\n");
+	}
+	else
+	{
+		Emit(output, "\nstatic const Block BLOCKS[] = { { 0u, 0u, 0 } };\n");
+	}
+
+	Emit(output, "\nEXPORT const Program %s =\n{\n", V2MP_PRECOMPILED_PROGRAM_SYMBOL);
+	Emit(output, "\t%du,\n", V2MP_PRECOMPILED_ABI_VERSION);
+	Emit(output, "\t0x%08lXu,\n", (unsigned long)csHash);
+	Emit(output, "\t%luu,\n", (unsigned long)csLengthInWords);
+	Emit(output, "\t%luu,\n", (unsigned long)numBlocks);
+	Emit(output, "\tBLOCKS\n};\n");
+}
+
+bool V2MP_PrecompiledProgram_GenerateSource(
+	const V2MP_Word* cs,
+	size_t csLengthInWords,
+	V2MP_PrecompiledSourceWriter writer,
+	void* userData
+)
+{
+	SourceOutput output;
+	V2MP_CPU_DecodedInstruction* decoded;
+	bool* leaders;
+	size_t count;
+	size_t numBlocks;
+
+	if ( !cs || csLengthInWords < 1 || csLengthInWords > UINT32_MAX || !writer )
+	{
+		return false;
+	}
+
+	count = csLengthInWords < MAX_REACHABLE_WORDS ? csLengthInWords : MAX_REACHABLE_WORDS;
+	decoded = (V2MP_CPU_DecodedInstruction*)BASEUTIL_MALLOC(count * sizeof(V2MP_CPU_DecodedInstruction));
+	leaders = (bool*)BASEUTIL_CALLOC(count, sizeof(bool));
+
+	if ( !decoded || !leaders )
+	{
+		if ( decoded )
+		{
+			BASEUTIL_FREE(decoded);
+		}
+
+		if ( leaders )
+		{
+			BASEUTIL_FREE(leaders);
+		}
+
+		return false;
+	}
+
+	output.writer = writer;
+	output.userData = userData;
+
+	V2MP_CPU_DecodeInstructions(cs, count, decoded);
+	FindLeaders(decoded, count, leaders);
+
+	EmitDefinitions(&output);
+	numBlocks = EmitBlocks(&output, decoded, count, leaders);
+
+	EmitDescriptor(
+		&output,
+		decoded,
+		count,
+		leaders,
+		numBlocks,
+		V2MP_PrecompiledProgram_HashCS(cs, csLengthInWords),
+		csLengthInWords
+	);
+
+	BASEUTIL_FREE(decoded);
+	BASEUTIL_FREE(leaders);
+
+	return true;
+}
@@ -0,0 +1,98 @@
+#include <string.h>
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Atomic.h"
+#include "Modules/ProgramImage_Internal.h"
+#include "Modules/CPU_Fusion.h"
+
+static void FreeImage(V2MP_ProgramImage* image)
+{
+	if ( image->decodedCS )
+	{
+		BASEUTIL_FREE(image->decodedCS);
+	}
+
+	if ( image->cs )
+	{
+		BASEUTIL_FREE(image->cs);
+	}
+
+	BASEUTIL_FREE(image);
+}
+
+V2MP_ProgramImage* V2MP_ProgramImage_AllocateAndInit(const V2MP_Word* cs, size_t csLengthInWords)
+{
+	V2MP_ProgramImage* image;
+
+	if ( !cs || csLengthInWords < 1 )
+	{
+		return NULL;
+	}
+
+	image = BASEUTIL_CALLOC_STRUCT(V2MP_ProgramImage);
+
+	if ( !image )
+	{
+		return NULL;
+	}
+
+	image->cs = (V2MP_Word*)BASEUTIL_MALLOC(csLengthInWords * sizeof(V2MP_Word));
+
+	if ( !image->cs )
+	{
+		FreeImage(image);
+		return NULL;
+	}
+
+	memcpy(image->cs, cs, csLengthInWords * sizeof(V2MP_Word));
+	image->csLengthInWords = csLengthInWords;
+	image->csHash = V2MP_PrecompiledProgram_HashCS(cs, csLengthInWords);
+	image->refCount = 1;
+
+	// If this allocation fails, the program can still be run
+	// by fetching and decoding each instruction from the image.
+	image->decodedCS =
+		(V2MP_CPU_DecodedInstruction*)BASEUTIL_MALLOC(csLengthInWords * sizeof(V2MP_CPU_DecodedInstruction));
+
+	if ( image->decodedCS )
+	{
+		V2MP_CPU_DecodeInstructions(cs, csLengthInWords, image->decodedCS);
+		V2MP_CPU_FuseInstructions(image->decodedCS, csLengthInWords);
+	}
+
+	return image;
+}
+
+V2MP_ProgramImage* V2MP_ProgramImage_AddRef(V2MP_ProgramImage* image)
+{
+	if ( image )
+	{
+		BaseUtil_Atomic_IncrementSize(&image->refCount);
+	}
+
+	return image;
+}
+
+void V2MP_ProgramImage_Release(V2MP_ProgramImage* image)
+{
+	if ( image && BaseUtil_Atomic_DecrementSize(&image->refCount) < 1 )
+	{
+		FreeImage(image);
+	}
+}
+
+size_t V2MP_ProgramImage_GetRefCount(const V2MP_ProgramImage* image)
+{
+	return image ? BaseUtil_Atomic_LoadSize(&image->refCount) : 0;
+}
+
+const V2MP_Word* V2MP_ProgramImage_GetCS(const V2MP_ProgramImage* image)
+{
+	return image ? image->cs : NULL;
+}
+
+size_t V2MP_ProgramImage_GetCSLengthInWords(const V2MP_ProgramImage* image)
+{
+	return image ? image->csLengthInWords : 0;
+}
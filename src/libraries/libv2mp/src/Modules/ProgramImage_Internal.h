@@ -0,0 +1,26 @@
+#ifndef V2MP_MODULES_PROGRAMIMAGE_INTERNAL_H
+#define V2MP_MODULES_PROGRAMIMAGE_INTERNAL_H
+
+#include <stdint.h>
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "Modules/CPU_Decode.h"
+
+struct V2MP_ProgramImage
+{
+	// Images may be shared by VMs that run on different threads,
+	// so this is only ever modified atomically.
+	size_t refCount;
+
+	V2MP_Word* cs;
+	size_t csLengthInWords;
+
+	// One entry per word in CS. May be NULL if the allocation failed, in which
+	// case the CPU falls back to fetching and decoding from the image.
+	V2MP_CPU_DecodedInstruction* decodedCS;
+
+	// Hash of the code segment, which a precompiled
+	// program must match in order to be attached.
+	uint32_t csHash;
+};
+
+#endif // V2MP_MODULES_PROGRAMIMAGE_INTERNAL_H
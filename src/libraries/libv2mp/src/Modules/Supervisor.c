@@ -3,8 +3,12 @@
 #include "LibV2MP/Modules/CPU.h"
 #include "LibV2MP/Modules/MemoryStore.h"
 #include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Util.h"
 #include "Modules/Supervisor_Internal.h"
 #include "Modules/Supervisor_CPUInterface.h"
+#include "Modules/MemoryStore_Internal.h"
+#include "Modules/CPU_Internal.h"
+#include "Modules/ProgramImage_Internal.h"
 
 static void DetachFromMainboard(V2MP_Supervisor* supervisor)
 {
@@ -15,15 +19,196 @@ static void DetachFromMainboard(V2MP_Supervisor* supervisor)
 		return;
 	}
 
+	V2MP_MemoryStore_SetChangeCallback(V2MP_Mainboard_GetMemoryStore(supervisor->mainboard), NULL, NULL);
+
 	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
 
 	if ( cpu )
 	{
+		V2MP_CPU_SetDecodedCodeSegment(cpu, NULL, 0);
+		V2MP_CPU_SetPrecompiledBlocks(cpu, NULL, 0);
 		V2MP_CPU_ResetSupervisorInterface(cpu);
 	}
 }
 
-static void AttachToMainboard(V2MP_Supervisor* supervisor)
+static void PassDecodedCSToCPU(V2MP_Supervisor* supervisor)
+{
+	V2MP_CPU* cpu;
+
+	if ( !supervisor || !supervisor->mainboard )
+	{
+		return;
+	}
+
+	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
+
+	if ( cpu )
+	{
+		V2MP_CPU_SetDecodedCodeSegment(
+			cpu,
+			supervisor->programImage ? supervisor->programImage->decodedCS : NULL,
+			supervisor->programImage ? supervisor->programImage->csLengthInWords : 0
+		);
+	}
+}
+
+static void ReleaseProgramImage(V2MP_Supervisor* supervisor)
+{
+	if ( !supervisor->programImage )
+	{
+		return;
+	}
+
+	V2MP_ProgramImage_Release(supervisor->programImage);
+	supervisor->programImage = NULL;
+
+	ResetProgramMemorySegment(&supervisor->programCS);
+	PassDecodedCSToCPU(supervisor);
+}
+
+static void PassPrecompiledBlocksToCPU(V2MP_Supervisor* supervisor)
+{
+	V2MP_CPU* cpu;
+
+	if ( !supervisor || !supervisor->mainboard )
+	{
+		return;
+	}
+
+	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
+
+	if ( cpu )
+	{
+		V2MP_CPU_SetPrecompiledBlocks(
+			cpu,
+			supervisor->precompiledBlocks,
+			supervisor->programCS.lengthInBytes / sizeof(V2MP_Word)
+		);
+	}
+}
+
+static void FreePrecompiledBlocks(V2MP_Supervisor* supervisor)
+{
+	if ( !supervisor->precompiledBlocks )
+	{
+		return;
+	}
+
+	BASEUTIL_FREE((void*)supervisor->precompiledBlocks);
+	supervisor->precompiledBlocks = NULL;
+
+	PassPrecompiledBlocksToCPU(supervisor);
+}
+
+static bool PrecompiledProgramMatches(const V2MP_Supervisor* supervisor, const V2MP_PrecompiledProgram* program)
+{
+	const size_t csLengthInWords = supervisor->programCS.lengthInBytes / sizeof(V2MP_Word);
+	size_t index;
+
+	if ( program->abiVersion != V2MP_PRECOMPILED_ABI_VERSION ||
+	     program->csLengthInWords != csLengthInWords ||
+	     program->csHash != supervisor->programImage->csHash ||
+	     (program->numBlocks > 0 && !program->blocks) )
+	{
+		return false;
+	}
+
+	for ( index = 0; index < program->numBlocks; ++index )
+	{
+		const V2MP_PrecompiledBlock* block = &program->blocks[index];
+
+		if ( block->startWordIndex >= csLengthInWords ||
+		     block->numCycles < 1 ||
+		     block->numCycles > csLengthInWords - block->startWordIndex ||
+		     !block->execute )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool ReserveDataPages(V2MP_Supervisor* supervisor, size_t numPages)
+{
+	size_t newCapacity;
+	DataPage* newPages;
+
+	if ( numPages <= supervisor->dataPagesCapacity )
+	{
+		return true;
+	}
+
+	newCapacity = supervisor->dataPagesCapacity > 0 ? supervisor->dataPagesCapacity : 4;
+
+	while ( newCapacity < numPages )
+	{
+		newCapacity *= 2;
+	}
+
+	newPages = (DataPage*)BASEUTIL_REALLOC(supervisor->dataPages, newCapacity * sizeof(DataPage));
+
+	if ( !newPages )
+	{
+		return false;
+	}
+
+	supervisor->dataPages = newPages;
+	supervisor->dataPagesCapacity = newCapacity;
+	return true;
+}
+
+static void FreeDataPages(V2MP_Supervisor* supervisor)
+{
+	if ( supervisor->dataPages )
+	{
+		BASEUTIL_FREE(supervisor->dataPages);
+		supervisor->dataPages = NULL;
+	}
+
+	supervisor->numDataPages = 0;
+	supervisor->dataPagesCapacity = 0;
+	supervisor->activeDataPage = 0;
+}
+
+static size_t GetEndOfProgramMemory(const V2MP_Supervisor* supervisor)
+{
+	const DataPage* lastPage;
+
+	// Any pages after the first are laid out after the stack segment.
+	if ( supervisor->numDataPages < 2 )
+	{
+		return supervisor->programSS.base + supervisor->programSS.lengthInBytes;
+	}
+
+	lastPage = &supervisor->dataPages[supervisor->numDataPages - 1];
+	return lastPage->base + lastPage->lengthInBytes;
+}
+
+static bool ClearWrittenMemory(V2MP_Supervisor* supervisor)
+{
+	V2MP_MemoryStore* memoryStore;
+	size_t memorySize;
+	size_t end;
+
+	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	memorySize = V2MP_MemoryStore_GetTotalMemorySize(memoryStore);
+
+	// The memory may have been reallocated to a smaller size since it was written.
+	end = supervisor->writtenEnd < memorySize ? supervisor->writtenEnd : memorySize;
+
+	if ( supervisor->writtenBase < end &&
+	     !V2MP_MemoryStore_ZeroRange(memoryStore, supervisor->writtenBase, end - supervisor->writtenBase) )
+	{
+		return false;
+	}
+
+	supervisor->writtenBase = 0;
+	supervisor->writtenEnd = 0;
+	return true;
+}
+
+static void PassInterfaceToCPU(V2MP_Supervisor* supervisor)
 {
 	V2MP_CPU* cpu;
 
@@ -42,6 +227,35 @@ static void AttachToMainboard(V2MP_Supervisor* supervisor)
 	}
 }
 
+static void HandleMemoryChange(void* userData, V2MP_MemoryStore_ChangeType changeType)
+{
+	V2MP_Supervisor* supervisor = (V2MP_Supervisor*)userData;
+
+	// The code segment is held by the program image rather than the memory
+	// store, so it is unaffected by any change. Only the pointers to the
+	// other segments need to be resolved again.
+	(void)changeType;
+	V2MP_Supervisor_RefreshSegmentCache(supervisor);
+}
+
+static void AttachToMainboard(V2MP_Supervisor* supervisor)
+{
+	if ( !supervisor || !supervisor->mainboard )
+	{
+		return;
+	}
+
+	V2MP_MemoryStore_SetChangeCallback(
+		V2MP_Mainboard_GetMemoryStore(supervisor->mainboard),
+		&HandleMemoryChange,
+		supervisor
+	);
+
+	PassInterfaceToCPU(supervisor);
+	PassDecodedCSToCPU(supervisor);
+	PassPrecompiledBlocksToCPU(supervisor);
+}
+
 static bool HandlePostInstructionTasks(V2MP_Supervisor* supervisor)
 {
 	if ( !V2MP_Supervisor_ResolveOutstandingActions(supervisor) )
@@ -71,6 +285,22 @@ V2MP_Supervisor* V2MP_Supervisor_AllocateAndInit(void)
 	return supervisor;
 }
 
+V2MP_Supervisor* V2MP_Supervisor_PlaceInBlock(V2MP_BlockLayout* layout)
+{
+	V2MP_Supervisor* supervisor;
+
+	supervisor = (V2MP_Supervisor*)V2MP_BlockLayout_Reserve(layout, sizeof(V2MP_Supervisor));
+
+	if ( supervisor )
+	{
+		BASEUTIL_ZERO_STRUCT_PTR(supervisor);
+		supervisor->placedInBlock = true;
+	}
+
+	V2MP_Supervisor_PlaceActionListsInBlock(supervisor, layout);
+	return supervisor;
+}
+
 void V2MP_Supervisor_DeinitAndFree(V2MP_Supervisor* supervisor)
 {
 	if ( !supervisor )
@@ -80,8 +310,15 @@ void V2MP_Supervisor_DeinitAndFree(V2MP_Supervisor* supervisor)
 
 	V2MP_Supervisor_SetMainboard(supervisor, NULL);
 	V2MP_Supervisor_DestroyActionLists(supervisor);
+	FreePrecompiledBlocks(supervisor);
+	ReleaseProgramImage(supervisor);
+	FreeDataPages(supervisor);
+	V2MP_Supervisor_Timing_Disable(&supervisor->timing);
 
-	BASEUTIL_FREE(supervisor);
+	if ( !supervisor->placedInBlock )
+	{
+		BASEUTIL_FREE(supervisor);
+	}
 }
 
 struct V2MP_Mainboard* V2MP_Supervisor_GetMainboard(const V2MP_Supervisor* supervisor)
@@ -98,6 +335,7 @@ void V2MP_Supervisor_SetMainboard(V2MP_Supervisor* supervisor, struct V2MP_Mainb
 
 	DetachFromMainboard(supervisor);
 	supervisor->mainboard = mainboard;
+	V2MP_Supervisor_RefreshSegmentCache(supervisor);
 	AttachToMainboard(supervisor);
 }
 
@@ -110,77 +348,358 @@ bool V2MP_Supervisor_LoadProgram(
 	size_t ssLengthInWords
 )
 {
-	V2MP_MemoryStore* memoryStore;
-	size_t totalMemoryAvailableInWords;
-	V2MP_Byte* rawMemory = NULL;
+	V2MP_ProgramImage* image;
+	bool success;
 
-	if ( !supervisor || !cs || csLengthInWords < 1 || (!ds && dsLengthInWords > 0) )
+	if ( !supervisor || !cs || csLengthInWords < 1 )
 	{
 		return false;
 	}
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	image = V2MP_ProgramImage_AllocateAndInit(cs, csLengthInWords);
 
-	if ( !memoryStore )
+	if ( !image )
 	{
 		return false;
 	}
 
-	rawMemory = V2MP_MemoryStore_GetPtrToBase(memoryStore);
+	success = V2MP_Supervisor_LoadProgramImage(supervisor, image, ds, dsLengthInWords, ssLengthInWords);
+
+	// If the program was loaded, the supervisor now holds the only reference.
+	V2MP_ProgramImage_Release(image);
 
-	if ( !rawMemory )
+	return success;
+}
+
+bool V2MP_Supervisor_LoadProgramImage(
+	V2MP_Supervisor* supervisor,
+	V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+)
+{
+	V2MP_MemoryStore* memoryStore;
+	size_t totalMemoryAvailableInWords;
+	bool imageChanged;
+
+	if ( !supervisor || !image || (!ds && dsLengthInWords > 0) )
 	{
 		return false;
 	}
 
-	totalMemoryAvailableInWords = V2MP_MemoryStore_GetTotalMemorySize(memoryStore) / sizeof(V2MP_Word);
-
-	// We do this carefully, to avoid overflowing any size_t calculations:
+	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
 
-	// First of all, is either segment on its own larger than the total RAM that we have?
-	if ( csLengthInWords > totalMemoryAvailableInWords ||
-	     dsLengthInWords > totalMemoryAvailableInWords ||
-		 ssLengthInWords > totalMemoryAvailableInWords )
+	if ( !memoryStore )
 	{
 		return false;
 	}
 
-	// Next, is any pair larger than the max available memory?
-	if ( csLengthInWords + dsLengthInWords > totalMemoryAvailableInWords ||
-	     csLengthInWords + ssLengthInWords > totalMemoryAvailableInWords ||
+	totalMemoryAvailableInWords = V2MP_MemoryStore_GetTotalMemorySize(memoryStore) / sizeof(V2MP_Word);
+
+	// The code segment is served from the image, so only the data
+	// and stack segments need to fit in memory. We do this carefully,
+	// to avoid overflowing any size_t calculations:
+	if ( dsLengthInWords > totalMemoryAvailableInWords ||
+	     ssLengthInWords > totalMemoryAvailableInWords ||
 	     dsLengthInWords + ssLengthInWords > totalMemoryAvailableInWords )
 	{
 		return false;
 	}
 
-	// Finally, is the entire sum larger than the max available memory?
-	if ( csLengthInWords + dsLengthInWords + ssLengthInWords > totalMemoryAvailableInWords )
+	if ( !ReserveDataPages(supervisor, 1) )
 	{
 		return false;
 	}
 
-	supervisor->programCS.base = 0;
-	supervisor->programCS.lengthInBytes = csLengthInWords * sizeof(V2MP_Word);
+	imageChanged = image != supervisor->programImage;
 
-	supervisor->programDS.base = supervisor->programCS.base + supervisor->programCS.lengthInBytes;
+	// If the same image is loaded again, everything derived from it is still
+	// valid, so the CPU's translated blocks and any precompiled program are kept.
+	if ( imageChanged )
+	{
+		// Any precompiled program was built for the previous code segment.
+		FreePrecompiledBlocks(supervisor);
+
+		V2MP_ProgramImage_AddRef(image);
+		ReleaseProgramImage(supervisor);
+		supervisor->programImage = image;
+
+		supervisor->programCS.base = 0;
+		supervisor->programCS.lengthInBytes = image->csLengthInWords * sizeof(V2MP_Word);
+	}
+
+	supervisor->programDS.base = 0;
 	supervisor->programDS.lengthInBytes = dsLengthInWords * sizeof(V2MP_Word);
 
 	supervisor->programSS.base = supervisor->programDS.base + supervisor->programDS.lengthInBytes;
 	supervisor->programSS.lengthInBytes = ssLengthInWords * sizeof(V2MP_Word);
 
-	memcpy(rawMemory + supervisor->programCS.base, cs, supervisor->programCS.lengthInBytes);
+	// Nothing that was in progress for a previous program carries over.
+	V2MP_Supervisor_ClearActions(supervisor);
+	V2MP_Supervisor_Timing_Reset(&supervisor->timing);
+
+	supervisor->dataPages[0].base = supervisor->programDS.base;
+	supervisor->dataPages[0].lengthInBytes = supervisor->programDS.lengthInBytes;
+	supervisor->numDataPages = 1;
+	supervisor->activeDataPage = 0;
+
+	V2MP_Supervisor_RefreshSegmentCache(supervisor);
+
+	if ( imageChanged )
+	{
+		PassDecodedCSToCPU(supervisor);
+	}
+
+	// Only the data segment is written, so that if memory is paged,
+	// the pages of the stack segment are not committed until used.
+	if ( supervisor->programDS.lengthInBytes > 0 &&
+	     !V2MP_Supervisor_WriteRangeToSegment(
+			supervisor,
+			&supervisor->programDS,
+			0,
+			(const V2MP_Byte*)ds,
+			supervisor->programDS.lengthInBytes) )
+	{
+		return false;
+	}
+
+	supervisor->programHasExited = false;
+	supervisor->programExitCode = 0;
+
+	return true;
+}
+
+bool V2MP_Supervisor_ResetProgramState(V2MP_Supervisor* supervisor)
+{
+	V2MP_CPU* cpu;
+
+	if ( !supervisor || !ClearWrittenMemory(supervisor) )
+	{
+		return false;
+	}
+
+	// Any pages added since the program was loaded have been cleared,
+	// so only the data segment that the program was loaded with remains.
+	// Clearing may also have copied pages that the segments refer to.
+	if ( supervisor->numDataPages > 0 )
+	{
+		supervisor->programDS.base = supervisor->dataPages[0].base;
+		supervisor->programDS.lengthInBytes = supervisor->dataPages[0].lengthInBytes;
+		supervisor->numDataPages = 1;
+		supervisor->activeDataPage = 0;
+	}
+
+	V2MP_Supervisor_RefreshSegmentCache(supervisor);
 
-	if ( supervisor->programDS.lengthInBytes > 0 )
+	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
+
+	if ( cpu )
 	{
-		memcpy(rawMemory + supervisor->programDS.base, ds, supervisor->programDS.lengthInBytes);
+		V2MP_CPU_Reset(cpu);
 	}
 
+	V2MP_Supervisor_ClearActions(supervisor);
+	V2MP_Supervisor_Timing_Reset(&supervisor->timing);
+
+	supervisor->cpuStalled = false;
 	supervisor->programHasExited = false;
 	supervisor->programExitCode = 0;
 
 	return true;
 }
 
+bool V2MP_Supervisor_ReloadProgram(
+	V2MP_Supervisor* supervisor,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+)
+{
+	if ( !supervisor || !supervisor->programImage || !V2MP_Supervisor_ResetProgramState(supervisor) )
+	{
+		return false;
+	}
+
+	return V2MP_Supervisor_LoadProgramImage(supervisor, supervisor->programImage, ds, dsLengthInWords, ssLengthInWords);
+}
+
+bool V2MP_Supervisor_AddDataPage(
+	V2MP_Supervisor* supervisor,
+	const V2MP_Word* data,
+	size_t dataLengthInWords,
+	size_t pageLengthInWords,
+	size_t* outPageIndex
+)
+{
+	V2MP_MemoryStore* memoryStore;
+	size_t memorySize;
+	size_t base;
+	MemorySegment pageSeg;
+	DataPage* page;
+
+	if ( !supervisor ||
+	     !V2MP_Supervisor_IsProgramLoaded(supervisor) ||
+	     (!data && dataLengthInWords > 0) ||
+	     dataLengthInWords > pageLengthInWords )
+	{
+		return false;
+	}
+
+	// The SIG instruction specifies the page index in a register.
+	if ( supervisor->numDataPages > (size_t)UINT16_MAX )
+	{
+		return false;
+	}
+
+	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+
+	if ( !memoryStore )
+	{
+		return false;
+	}
+
+	memorySize = V2MP_MemoryStore_GetTotalMemorySize(memoryStore);
+	base = GetEndOfProgramMemory(supervisor);
+
+	if ( base > memorySize ||
+	     pageLengthInWords > (memorySize - base) / sizeof(V2MP_Word) ||
+	     !ReserveDataPages(supervisor, supervisor->numDataPages + 1) )
+	{
+		return false;
+	}
+
+	// As with the first data page, the remainder of the page beyond the
+	// initialisation data is left as it is. The data is written through
+	// the page as a segment, so that it is cleared when the program state
+	// is reset, and so that any segments on pages that the write commits
+	// or copies are refreshed.
+	if ( dataLengthInWords > 0 )
+	{
+		memset(&pageSeg, 0, sizeof(pageSeg));
+		pageSeg.base = base;
+		pageSeg.lengthInBytes = pageLengthInWords * sizeof(V2MP_Word);
+		pageSeg.accessibleLengthInBytes = pageSeg.lengthInBytes;
+
+		if ( !V2MP_Supervisor_WriteRangeToSegment(
+				supervisor,
+				&pageSeg,
+				0,
+				(const V2MP_Byte*)data,
+				dataLengthInWords * sizeof(V2MP_Word)) )
+		{
+			return false;
+		}
+	}
+
+	page = &supervisor->dataPages[supervisor->numDataPages];
+	page->base = base;
+	page->lengthInBytes = pageLengthInWords * sizeof(V2MP_Word);
+
+	if ( outPageIndex )
+	{
+		*outPageIndex = supervisor->numDataPages;
+	}
+
+	++supervisor->numDataPages;
+	return true;
+}
+
+size_t V2MP_Supervisor_GetDataPageCount(const V2MP_Supervisor* supervisor)
+{
+	return supervisor ? supervisor->numDataPages : 0;
+}
+
+size_t V2MP_Supervisor_GetActiveDataPage(const V2MP_Supervisor* supervisor)
+{
+	return supervisor ? supervisor->activeDataPage : 0;
+}
+
+bool V2MP_Supervisor_SetActiveDataPage(V2MP_Supervisor* supervisor, size_t pageIndex)
+{
+	return V2MP_Supervisor_MapDataPage(supervisor, pageIndex);
+}
+
+struct V2MP_ProgramImage* V2MP_Supervisor_GetProgramImage(const V2MP_Supervisor* supervisor)
+{
+	return supervisor ? supervisor->programImage : NULL;
+}
+
+bool V2MP_Supervisor_CopyProgramState(V2MP_Supervisor* supervisor, const V2MP_Supervisor* source)
+{
+	V2MP_CPU* cpu;
+	size_t csLengthInWords;
+
+	if ( !supervisor || !source || supervisor == source || !supervisor->mainboard || !source->mainboard )
+	{
+		return false;
+	}
+
+	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
+
+	if ( !cpu ||
+	     !ReserveDataPages(supervisor, source->numDataPages) ||
+	     !V2MP_Supervisor_Timing_Copy(&supervisor->timing, &source->timing) ||
+	     !V2MP_Supervisor_CopyOngoingActions(supervisor, source) )
+	{
+		return false;
+	}
+
+	FreePrecompiledBlocks(supervisor);
+
+	// The program image is immutable, so is shared rather than copied.
+	V2MP_ProgramImage_AddRef(source->programImage);
+	ReleaseProgramImage(supervisor);
+	supervisor->programImage = source->programImage;
+
+	supervisor->programCS.base = source->programCS.base;
+	supervisor->programCS.lengthInBytes = source->programCS.lengthInBytes;
+	supervisor->programDS.base = source->programDS.base;
+	supervisor->programDS.lengthInBytes = source->programDS.lengthInBytes;
+	supervisor->programSS.base = source->programSS.base;
+	supervisor->programSS.lengthInBytes = source->programSS.lengthInBytes;
+
+	if ( source->numDataPages > 0 )
+	{
+		memcpy(supervisor->dataPages, source->dataPages, source->numDataPages * sizeof(DataPage));
+	}
+
+	supervisor->numDataPages = source->numDataPages;
+	supervisor->activeDataPage = source->activeDataPage;
+	supervisor->writtenBase = source->writtenBase;
+	supervisor->writtenEnd = source->writtenEnd;
+
+	V2MP_Supervisor_RefreshSegmentCache(supervisor);
+
+	csLengthInWords = supervisor->programCS.lengthInBytes / sizeof(V2MP_Word);
+
+	// As when attaching a precompiled program, failing to allocate this
+	// only means that the program falls back to being interpreted.
+	if ( source->precompiledBlocks )
+	{
+		supervisor->precompiledBlocks =
+			(const V2MP_PrecompiledBlock**)BASEUTIL_MALLOC(csLengthInWords * sizeof(const V2MP_PrecompiledBlock*));
+
+		if ( supervisor->precompiledBlocks )
+		{
+			memcpy((void*)supervisor->precompiledBlocks, source->precompiledBlocks, csLengthInWords * sizeof(const V2MP_PrecompiledBlock*));
+		}
+	}
+
+	supervisor->deferMemoryAccess = source->deferMemoryAccess;
+	supervisor->cpuStalled = source->cpuStalled;
+	supervisor->programHasExited = source->programHasExited;
+	supervisor->programExitCode = source->programExitCode;
+
+	V2MP_CPU_CopyState(cpu, V2MP_Mainboard_GetCPU(source->mainboard));
+
+	PassInterfaceToCPU(supervisor);
+	PassDecodedCSToCPU(supervisor);
+	PassPrecompiledBlocksToCPU(supervisor);
+
+	return true;
+}
+
 void V2MP_Supervisor_ClearProgram(V2MP_Supervisor* supervisor)
 {
 	V2MP_CPU* cpu;
@@ -197,10 +716,116 @@ void V2MP_Supervisor_ClearProgram(V2MP_Supervisor* supervisor)
 		V2MP_CPU_Reset(cpu);
 	}
 
-	ResetProgramMemorySegment(&supervisor->programCS);
+	V2MP_Supervisor_ClearActions(supervisor);
+	FreePrecompiledBlocks(supervisor);
+	ReleaseProgramImage(supervisor);
+	FreeDataPages(supervisor);
+
 	ResetProgramMemorySegment(&supervisor->programDS);
 }
 
+bool V2MP_Supervisor_SetPrecompiledProgram(V2MP_Supervisor* supervisor, const V2MP_PrecompiledProgram* program)
+{
+	size_t index;
+
+	if ( !supervisor )
+	{
+		return false;
+	}
+
+	FreePrecompiledBlocks(supervisor);
+
+	if ( !program )
+	{
+		return true;
+	}
+
+	if ( !V2MP_Supervisor_IsProgramLoaded(supervisor) || !PrecompiledProgramMatches(supervisor, program) )
+	{
+		return false;
+	}
+
+	supervisor->precompiledBlocks = (const V2MP_PrecompiledBlock**)BASEUTIL_CALLOC(
+		program->csLengthInWords,
+		sizeof(const V2MP_PrecompiledBlock*)
+	);
+
+	if ( !supervisor->precompiledBlocks )
+	{
+		return false;
+	}
+
+	for ( index = 0; index < program->numBlocks; ++index )
+	{
+		supervisor->precompiledBlocks[program->blocks[index].startWordIndex] = &program->blocks[index];
+	}
+
+	PassPrecompiledBlocksToCPU(supervisor);
+	return true;
+}
+
+void V2MP_Supervisor_SetDeferredMemoryAccessEnabled(V2MP_Supervisor* supervisor, bool enabled)
+{
+	if ( !supervisor || supervisor->deferMemoryAccess == enabled )
+	{
+		return;
+	}
+
+	supervisor->deferMemoryAccess = enabled;
+	PassInterfaceToCPU(supervisor);
+}
+
+bool V2MP_Supervisor_IsDeferredMemoryAccessEnabled(const V2MP_Supervisor* supervisor)
+{
+	return supervisor ? supervisor->deferMemoryAccess : false;
+}
+
+bool V2MP_Supervisor_SetTimingModel(V2MP_Supervisor* supervisor, const V2MP_Supervisor_TimingModel* model)
+{
+	if ( !supervisor )
+	{
+		return false;
+	}
+
+	if ( model )
+	{
+		if ( !V2MP_Supervisor_Timing_Enable(&supervisor->timing, model) )
+		{
+			return false;
+		}
+	}
+	else
+	{
+		V2MP_Supervisor_Timing_Disable(&supervisor->timing);
+	}
+
+	// Whether memory access is deferred may have changed.
+	PassInterfaceToCPU(supervisor);
+	return true;
+}
+
+bool V2MP_Supervisor_GetTimingModel(const V2MP_Supervisor* supervisor, V2MP_Supervisor_TimingModel* outModel)
+{
+	if ( !supervisor || !outModel || !supervisor->timing.enabled )
+	{
+		return false;
+	}
+
+	*outModel = supervisor->timing.model;
+	return true;
+}
+
+void V2MP_Supervisor_GetCacheStatistics(const V2MP_Supervisor* supervisor, V2MP_Supervisor_CacheStatistics* outStats)
+{
+	if ( !outStats )
+	{
+		return;
+	}
+
+	outStats->hits = supervisor ? supervisor->timing.cacheHits : 0;
+	outStats->misses = supervisor ? supervisor->timing.cacheMisses : 0;
+}
+
 bool V2MP_Supervisor_IsProgramLoaded(const V2MP_Supervisor* supervisor)
 {
 	return supervisor && supervisor->programCS.lengthInBytes > 0;
@@ -254,6 +879,27 @@ bool V2MP_Supervisor_ExecuteSingleInstruction(V2MP_Supervisor* supervisor, V2MP_
 	return HandlePostInstructionTasks(supervisor);
 }
 
+bool V2MP_Supervisor_Run(V2MP_Supervisor* supervisor, size_t maxCycles, V2MP_RunResult* outResult)
+{
+	V2MP_CPU* cpu;
+
+	if ( !supervisor || !supervisor->mainboard || !outResult )
+	{
+		return false;
+	}
+
+	if ( supervisor->programHasExited )
+	{
+		outResult->cyclesExecuted = 0;
+		outResult->stopReason = V2MP_RUNSTOP_PROGRAM_EXITED;
+		return true;
+	}
+
+	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
+
+	return cpu ? V2MP_CPU_Run(cpu, maxCycles, outResult) : false;
+}
+
 bool V2MP_Supervisor_FetchCSWord(
 	const V2MP_Supervisor* supervisor,
 	V2MP_Word address,
@@ -1,13 +1,15 @@
 #include <string.h>
 #include "Modules/Supervisor_Action.h"
 #include "Modules/Supervisor_Internal.h"
-#include "LibSharedComponents/DoubleLinkedList.h"
-#include "LibSharedComponents/CircularBuffer.h"
 #include "LibV2MP/Modules/MemoryStore.h"
 #include "LibV2MP/Modules/CPU.h"
 #include "LibBaseUtil/Util.h"
+#include "LibBaseUtil/Heap.h"
 #include "Modules/Supervisor_Action_Stack.h"
 
+// Must be a power of two.
+#define ACTION_QUEUE_INITIAL_CAPACITY 8
+
 typedef enum ActionResult
 {
 	AR_FAILED = 0,
@@ -20,6 +22,9 @@ typedef ActionResult (*ActionHandler)(V2MP_Supervisor*, V2MP_Supervisor_Action*)
 static ActionResult V2MP_Supervisor_HandleLoadWord(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
 static ActionResult V2MP_Supervisor_HandleStoreWord(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
 static ActionResult V2MP_Supervisor_HandleStackOperation(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
+static ActionResult V2MP_Supervisor_HandleCopyDSBlock(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
+static ActionResult V2MP_Supervisor_HandleCopyDSBlockToSS(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
+static ActionResult V2MP_Supervisor_HandleFillDSBlock(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action);
 
 #define LIST_ITEM(value, handler) handler,
 static const ActionHandler ACTION_HANDLERS[] =
@@ -30,19 +35,10 @@ static const ActionHandler ACTION_HANDLERS[] =
 
 static ActionResult V2MP_Supervisor_HandleLoadWord(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
 {
-	V2MP_MemoryStore* memoryStore;
 	V2MP_CPU* cpu;
-	size_t address;
-	V2MP_RegisterIndex destReg;
+	V2MP_Word fault;
 	V2MP_Word loadedWord = 0;
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
-
-	if ( !memoryStore )
-	{
-		return AR_FAILED;
-	}
-
 	cpu = V2MP_Mainboard_GetCPU(supervisor->mainboard);
 
 	if ( !cpu )
@@ -50,50 +46,41 @@ static ActionResult V2MP_Supervisor_HandleLoadWord(V2MP_Supervisor* supervisor,
 		return AR_FAILED;
 	}
 
-	address = supervisor->programDS.base + SVACTION_LOAD_WORD_ARG_ADDRESS(action);
-	destReg = (V2MP_RegisterIndex)SVACTION_LOAD_WORD_ARG_DESTREG(action);
+	fault = V2MP_Supervisor_LoadWordFromDS(supervisor, SVACTION_LOAD_WORD_ARG_ADDRESS(action), &loadedWord);
 
-	if ( address & 0x1 )
+	if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_SPV )
 	{
-		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_ALGN, 0));
-		return AR_COMPLETE;
+		return AR_FAILED;
 	}
 
-	if ( !V2MP_MemoryStore_LoadWord(memoryStore, address, &loadedWord) )
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
 	{
-		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0));
+		V2MP_Supervisor_SetCPUFault(supervisor, fault);
 		return AR_COMPLETE;
 	}
 
-	V2MP_CPU_SetRegisterValueAndUpdateSR(cpu, destReg, loadedWord);
+	V2MP_CPU_SetRegisterValueAndUpdateSR(cpu, (V2MP_RegisterIndex)SVACTION_LOAD_WORD_ARG_DESTREG(action), loadedWord);
 	return AR_COMPLETE;
 }
 
 static ActionResult V2MP_Supervisor_HandleStoreWord(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
 {
-	V2MP_MemoryStore* memoryStore;
-	size_t address;
-	V2MP_Word wordToStore;
+	V2MP_Word fault;
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	fault = V2MP_Supervisor_StoreWordToDS(
+		supervisor,
+		SVACTION_STORE_WORD_ARG_ADDRESS(action),
+		SVACTION_STORE_WORD_ARG_WORD(action)
+	);
 
-	if ( !memoryStore )
+	if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_SPV )
 	{
 		return AR_FAILED;
 	}
 
-	address = supervisor->programDS.base + SVACTION_STORE_WORD_ARG_ADDRESS(action);
-	wordToStore = SVACTION_STORE_WORD_ARG_WORD(action);
-
-	if ( address & 0x1 )
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
 	{
-		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_ALGN, 0));
-		return AR_COMPLETE;
-	}
-
-	if ( !V2MP_MemoryStore_StoreWord(memoryStore, address, wordToStore) )
-	{
-		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0));
+		V2MP_Supervisor_SetCPUFault(supervisor, fault);
 	}
 
 	return AR_COMPLETE;
@@ -167,6 +154,62 @@ static ActionResult V2MP_Supervisor_HandleStackOperation(V2MP_Supervisor* superv
 	return AR_COMPLETE;
 }
 
+static ActionResult CompleteBlockOperation(V2MP_Supervisor* supervisor, V2MP_Word fault)
+{
+	if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_SPV )
+	{
+		return AR_FAILED;
+	}
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+	{
+		V2MP_Supervisor_SetCPUFault(supervisor, fault);
+	}
+
+	return AR_COMPLETE;
+}
+
+static ActionResult V2MP_Supervisor_HandleCopyDSBlock(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
+{
+	return CompleteBlockOperation(
+		supervisor,
+		V2MP_Supervisor_CopyBlockFromDS(
+			supervisor,
+			&supervisor->programDS,
+			SVACTION_BLOCK_ARG_DEST(action),
+			SVACTION_BLOCK_ARG_SOURCE(action),
+			SVACTION_BLOCK_ARG_NUM_WORDS(action)
+		)
+	);
+}
+
+static ActionResult V2MP_Supervisor_HandleCopyDSBlockToSS(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
+{
+	return CompleteBlockOperation(
+		supervisor,
+		V2MP_Supervisor_CopyBlockFromDS(
+			supervisor,
+			&supervisor->programSS,
+			SVACTION_BLOCK_ARG_DEST(action),
+			SVACTION_BLOCK_ARG_SOURCE(action),
+			SVACTION_BLOCK_ARG_NUM_WORDS(action)
+		)
+	);
+}
+
+static ActionResult V2MP_Supervisor_HandleFillDSBlock(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
+{
+	return CompleteBlockOperation(
+		supervisor,
+		V2MP_Supervisor_FillDSBlock(
+			supervisor,
+			SVACTION_BLOCK_ARG_DEST(action),
+			SVACTION_BLOCK_ARG_VALUE(action),
+			SVACTION_BLOCK_ARG_NUM_WORDS(action)
+		)
+	);
+}
+
 static ActionResult ResolveAction(V2MP_Supervisor* supervisor, V2MP_Supervisor_Action* action)
 {
 	if ( !action )
@@ -180,177 +223,301 @@ static ActionResult ResolveAction(V2MP_Supervisor* supervisor, V2MP_Supervisor_A
 		return AR_FAILED;
 	}
 
+	if ( SVACTION_STALL_CYCLES(action) > 0 )
+	{
+		--SVACTION_STALL_CYCLES(action);
+		return AR_ONGOING;
+	}
+
 	return ACTION_HANDLERS[(size_t)action->actionType](supervisor, action);
 }
 
-bool V2MP_Supervisor_CreateActionLists(V2MP_Supervisor* supervisor)
+static bool InitActionQueue(V2MP_Supervisor_ActionQueue* queue)
 {
-	if ( !supervisor )
+	queue->actions = (V2MP_Supervisor_Action*)BASEUTIL_MALLOC(ACTION_QUEUE_INITIAL_CAPACITY * sizeof(V2MP_Supervisor_Action));
+	queue->capacity = queue->actions ? ACTION_QUEUE_INITIAL_CAPACITY : 0;
+	queue->head = 0;
+	queue->count = 0;
+	queue->ownsStorage = true;
+
+	return queue->actions != NULL;
+}
+
+static void PlaceActionQueueInBlock(V2MP_Supervisor_ActionQueue* queue, V2MP_BlockLayout* layout)
+{
+	V2MP_Supervisor_Action* actions;
+
+	actions = (V2MP_Supervisor_Action*)V2MP_BlockLayout_Reserve(layout, ACTION_QUEUE_INITIAL_CAPACITY * sizeof(V2MP_Supervisor_Action));
+
+	if ( queue )
 	{
-		return false;
+		queue->actions = actions;
+		queue->capacity = ACTION_QUEUE_INITIAL_CAPACITY;
+		queue->head = 0;
+		queue->count = 0;
+		queue->ownsStorage = false;
 	}
+}
 
-	supervisor->newActions = V2MPSC_DoubleLL_AllocateAndInit(sizeof(V2MP_Supervisor_Action), NULL);
-	supervisor->ongoingActions = V2MPSC_DoubleLL_AllocateAndInit(sizeof(V2MP_Supervisor_Action), NULL);
+static void DeinitActionQueue(V2MP_Supervisor_ActionQueue* queue)
+{
+	if ( queue->actions && queue->ownsStorage )
+	{
+		BASEUTIL_FREE(queue->actions);
+	}
 
-	return supervisor->newActions != NULL && supervisor->ongoingActions != NULL;
+	queue->actions = NULL;
+	queue->capacity = 0;
+	queue->head = 0;
+	queue->count = 0;
 }
 
-void V2MP_Supervisor_DestroyActionLists(V2MP_Supervisor* supervisor)
+static bool GrowActionQueue(V2MP_Supervisor_ActionQueue* queue)
 {
-	if ( !supervisor )
+	V2MP_Supervisor_Action* actions;
+	size_t newCapacity;
+	size_t firstRun;
+
+	newCapacity = queue->capacity > 0 ? queue->capacity * 2 : ACTION_QUEUE_INITIAL_CAPACITY;
+	actions = (V2MP_Supervisor_Action*)BASEUTIL_MALLOC(newCapacity * sizeof(V2MP_Supervisor_Action));
+
+	if ( !actions )
 	{
-		return;
+		return false;
 	}
 
-	V2MPSC_DoubleLL_DeinitAndFree(supervisor->newActions);
-	supervisor->newActions = NULL;
+	if ( queue->count > 0 )
+	{
+		// Unwrap the existing actions so that they begin at index 0.
+		firstRun = queue->capacity - queue->head;
 
-	V2MPSC_DoubleLL_DeinitAndFree(supervisor->ongoingActions);
-	supervisor->ongoingActions = NULL;
-}
+		if ( firstRun > queue->count )
+		{
+			firstRun = queue->count;
+		}
 
-V2MP_Supervisor_Action* V2MP_Supervisor_CreateNewAction(V2MP_Supervisor* supervisor)
-{
-	V2MPSC_DoubleLL_Node* node;
-	V2MP_Supervisor_Action* action;
+		memcpy(actions, &queue->actions[queue->head], firstRun * sizeof(V2MP_Supervisor_Action));
+		memcpy(&actions[firstRun], queue->actions, (queue->count - firstRun) * sizeof(V2MP_Supervisor_Action));
+	}
 
-	if ( !supervisor )
+	if ( queue->actions && queue->ownsStorage )
 	{
-		return NULL;
+		BASEUTIL_FREE(queue->actions);
 	}
 
-	node = V2MPSC_DoubleLL_AppendToTail(supervisor->newActions);
+	queue->actions = actions;
+	queue->capacity = newCapacity;
+	queue->head = 0;
+	queue->ownsStorage = true;
+
+	return true;
+}
 
-	if ( !node )
+static V2MP_Supervisor_Action* AppendToActionQueue(V2MP_Supervisor_ActionQueue* queue)
+{
+	if ( queue->count >= queue->capacity && !GrowActionQueue(queue) )
 	{
 		return NULL;
 	}
 
-	action = (V2MP_Supervisor_Action*)V2MPSC_DoubleLLNode_GetPayload(node);
+	return &queue->actions[(queue->head + queue->count++) & (queue->capacity - 1)];
+}
 
-	if ( action )
+static void PopFromActionQueue(V2MP_Supervisor_ActionQueue* queue, V2MP_Supervisor_Action* outAction)
+{
+	*outAction = queue->actions[queue->head];
+	queue->head = (queue->head + 1) & (queue->capacity - 1);
+	--queue->count;
+}
+
+static void UpdateCPUStall(V2MP_Supervisor* supervisor)
+{
+	const bool shouldStall = supervisor->ongoingActions.count > 0;
+
+	// Only touch the CPU if the state has changed.
+	if ( shouldStall != supervisor->cpuStalled )
 	{
-		BASEUTIL_ZERO_STRUCT_PTR(action);
+		V2MP_CPU_SetStalled(V2MP_Mainboard_GetCPU(supervisor->mainboard), shouldStall);
+		supervisor->cpuStalled = shouldStall;
 	}
-
-	return action;
 }
 
-V2MPSC_DoubleLL_Node* V2MP_Supervisor_CloneToOngoingAction(V2MP_Supervisor* supervisor, V2MPSC_DoubleLL_Node* createAfter, V2MP_Supervisor_Action* template)
+static void RequeueOngoingAction(V2MP_Supervisor* supervisor, const V2MP_Supervisor_Action* action)
 {
-	V2MPSC_DoubleLL_Node* node;
-	V2MP_Supervisor_Action* action;
+	V2MP_Supervisor_Action* requeued;
 
-	if ( !supervisor || !template )
+	requeued = AppendToActionQueue(&supervisor->ongoingActions);
+
+	if ( !requeued )
 	{
-		return NULL;
+		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, action->actionType));
+		return;
 	}
 
-	if ( createAfter )
+	*requeued = *action;
+}
+
+bool V2MP_Supervisor_CreateActionLists(V2MP_Supervisor* supervisor)
+{
+	bool createdNew;
+	bool createdOngoing;
+
+	if ( !supervisor )
 	{
-		node = V2MPSC_DoubleLL_CreateAfter(supervisor->ongoingActions, createAfter);
+		return false;
 	}
-	else
+
+	createdNew = InitActionQueue(&supervisor->newActions);
+	createdOngoing = InitActionQueue(&supervisor->ongoingActions);
+
+	return createdNew && createdOngoing;
+}
+
+void V2MP_Supervisor_DestroyActionLists(V2MP_Supervisor* supervisor)
+{
+	if ( !supervisor )
 	{
-		node = V2MPSC_DoubleLL_PrependToHead(supervisor->ongoingActions);
+		return;
 	}
 
-	if ( !node )
+	DeinitActionQueue(&supervisor->newActions);
+	DeinitActionQueue(&supervisor->ongoingActions);
+}
+
+void V2MP_Supervisor_PlaceActionListsInBlock(V2MP_Supervisor* supervisor, V2MP_BlockLayout* layout)
+{
+	PlaceActionQueueInBlock(supervisor ? &supervisor->newActions : NULL, layout);
+	PlaceActionQueueInBlock(supervisor ? &supervisor->ongoingActions : NULL, layout);
+}
+
+V2MP_Supervisor_Action* V2MP_Supervisor_CreateNewAction(V2MP_Supervisor* supervisor)
+{
+	V2MP_Supervisor_Action* action;
+
+	if ( !supervisor )
 	{
 		return NULL;
 	}
 
-	action = (V2MP_Supervisor_Action*)V2MPSC_DoubleLLNode_GetPayload(node);
+	action = AppendToActionQueue(&supervisor->newActions);
 
 	if ( action )
 	{
-		*action = *template;
+		BASEUTIL_ZERO_STRUCT_PTR(action);
 	}
 
-	return node;
+	return action;
 }
 
 bool V2MP_Supervisor_ResolveOutstandingActions(V2MP_Supervisor* supervisor)
 {
-	V2MPSC_DoubleLL_Node* node;
-	V2MPSC_DoubleLL_Node* lastProcessedOngoingActionNode = NULL;
+	V2MP_Supervisor_Action action;
+	ActionResult result;
+	size_t numPreviouslyOngoing;
+	size_t index;
+	bool failed = false;
 
 	if ( !supervisor )
 	{
 		return false;
 	}
 
-	node = V2MPSC_DoubleLL_GetHead(supervisor->newActions);
+	// New actions created on this clock cycle are processed first, and
+	// any that take more than one clock cycle are queued as ongoing.
+	// Actions that were already ongoing are then processed in order,
+	// and the ones that are still ongoing are queued again after the
+	// new ones. Each queued action is popped from the head before it
+	// is resolved, since requeueing it may reallocate the ring.
 
-	while ( node )
-	{
-		V2MPSC_DoubleLL_Node* next;
-		ActionResult result;
-		V2MP_Supervisor_Action* action;
+	numPreviouslyOngoing = supervisor->ongoingActions.count;
 
-		action = (V2MP_Supervisor_Action*)V2MPSC_DoubleLLNode_GetPayload(node);
-		result = ResolveAction(supervisor, action);
-		next = V2MPSC_DoubleLLNode_GetNext(node);
+	while ( supervisor->newActions.count > 0 )
+	{
+		PopFromActionQueue(&supervisor->newActions, &action);
+		result = ResolveAction(supervisor, &action);
 
 		if ( result == AR_ONGOING )
 		{
-			// Insert at the beginning of the ongoing actions list,
-			// and then keep track of the node that was just inserted so
-			// that we may inser others after it if we need to.
-			// The ongoing actions list is kept separate and processed
-			// after this. This is so that new actions created on this
-			// clock cycle are processed first, and if they take more
-			// than one clock cycle then they are added to the ongoing
-			// list. After this, all remaining ongoing actions are
-			// processed.
-
-			lastProcessedOngoingActionNode = V2MP_Supervisor_CloneToOngoingAction(supervisor, lastProcessedOngoingActionNode, action);
-
+			RequeueOngoingAction(supervisor, &action);
 		}
 
-		V2MPSC_DoubleLLNode_Destroy(node);
-
 		if ( result == AR_FAILED )
 		{
 			V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0));
 			break;
 		}
-
-		node = next;
 	}
 
-	if ( lastProcessedOngoingActionNode )
+	for ( index = 0; index < numPreviouslyOngoing; ++index )
 	{
-		node = V2MPSC_DoubleLLNode_GetNext(lastProcessedOngoingActionNode);
+		PopFromActionQueue(&supervisor->ongoingActions, &action);
+
+		if ( failed )
+		{
+			// Keep the remaining actions in order, without resolving them.
+			RequeueOngoingAction(supervisor, &action);
+			continue;
+		}
+
+		result = ResolveAction(supervisor, &action);
+
+		if ( result == AR_ONGOING )
+		{
+			RequeueOngoingAction(supervisor, &action);
+		}
+		else if ( result == AR_FAILED )
+		{
+			V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0));
+			failed = true;
+		}
 	}
-	else
+
+	// The CPU waits for any actions that are still ongoing.
+	UpdateCPUStall(supervisor);
+	return true;
+}
+
+void V2MP_Supervisor_ClearActions(V2MP_Supervisor* supervisor)
+{
+	if ( !supervisor )
 	{
-		node = V2MPSC_DoubleLL_GetHead(supervisor->ongoingActions);
+		return;
 	}
 
-	while ( node )
+	supervisor->newActions.head = 0;
+	supervisor->newActions.count = 0;
+	supervisor->ongoingActions.head = 0;
+	supervisor->ongoingActions.count = 0;
+
+	UpdateCPUStall(supervisor);
+}
+
+bool V2MP_Supervisor_CopyOngoingActions(V2MP_Supervisor* supervisor, const V2MP_Supervisor* source)
+{
+	const V2MP_Supervisor_ActionQueue* sourceQueue;
+	V2MP_Supervisor_Action* action;
+	size_t index;
+
+	if ( !supervisor || !source || supervisor == source )
 	{
-		V2MPSC_DoubleLL_Node* next;
-		ActionResult result;
-		V2MP_Supervisor_Action* action;
+		return false;
+	}
 
-		action = (V2MP_Supervisor_Action*)V2MPSC_DoubleLLNode_GetPayload(node);
-		result = ResolveAction(supervisor, action);
-		next = V2MPSC_DoubleLLNode_GetNext(node);
+	sourceQueue = &source->ongoingActions;
 
-		if ( result != AR_ONGOING )
-		{
-			V2MPSC_DoubleLLNode_Destroy(node);
-		}
+	supervisor->ongoingActions.head = 0;
+	supervisor->ongoingActions.count = 0;
 
-		if ( result == AR_FAILED )
+	for ( index = 0; index < sourceQueue->count; ++index )
+	{
+		action = AppendToActionQueue(&supervisor->ongoingActions);
+
+		if ( !action )
 		{
-			V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0));
-			break;
+			return false;
 		}
 
-		node = next;
+		*action = sourceQueue->actions[(sourceQueue->head + index) & (sourceQueue->capacity - 1)];
 	}
 
 	return true;
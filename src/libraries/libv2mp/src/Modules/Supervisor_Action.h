@@ -3,12 +3,15 @@
 
 #include "LibV2MP/Defs.h"
 #include "LibV2MP/Modules/Supervisor.h"
-#include "LibSharedComponents/DoubleLinkedList.h"
+#include "Modules/BlockLayout.h"
 
 #define V2MP_SUPERVISOR_ACTION_LIST \
 	LIST_ITEM(SVAT_LOAD_WORD = 0, V2MP_Supervisor_HandleLoadWord) \
 	LIST_ITEM(SVAT_STORE_WORD, V2MP_Supervisor_HandleStoreWord) \
-	LIST_ITEM(SVAT_STACK_OPERATION, V2MP_Supervisor_HandleStackOperation)
+	LIST_ITEM(SVAT_STACK_OPERATION, V2MP_Supervisor_HandleStackOperation) \
+	LIST_ITEM(SVAT_COPY_DS_BLOCK, V2MP_Supervisor_HandleCopyDSBlock) \
+	LIST_ITEM(SVAT_COPY_DS_BLOCK_TO_SS, V2MP_Supervisor_HandleCopyDSBlockToSS) \
+	LIST_ITEM(SVAT_FILL_DS_BLOCK, V2MP_Supervisor_HandleFillDSBlock)
 
 #define LIST_ITEM(value, handler) value,
 typedef enum V2MP_Supervisor_ActionType
@@ -23,6 +26,24 @@ typedef struct V2MP_Supervisor_Action
 	V2MP_Word args[4];
 } V2MP_Supervisor_Action;
 
+// Fixed-capacity ring of actions, stored contiguously so that queueing
+// and resolving actions does not allocate. The capacity is always a power
+// of two, and is only increased if the ring is ever full.
+typedef struct V2MP_Supervisor_ActionQueue
+{
+	V2MP_Supervisor_Action* actions;
+	size_t capacity;
+	size_t head;
+	size_t count;
+
+	// Not set if the actions lie within a block owned by something else.
+	bool ownsStorage;
+} V2MP_Supervisor_ActionQueue;
+
+// Common to all actions. If this is set when the action is created, the action
+// remains ongoing for this many further cycles before it is performed.
+#define SVACTION_STALL_CYCLES(actionPtr) ((actionPtr)->args[3])
+
 #define SVACTION_LOAD_WORD_ARG_ADDRESS(actionPtr) ((actionPtr)->args[0])
 #define SVACTION_LOAD_WORD_ARG_DESTREG(actionPtr) ((actionPtr)->args[1])
 
@@ -32,10 +53,25 @@ typedef struct V2MP_Supervisor_Action
 #define SVACTION_STACK_REG_FLAGS(actionPtr) ((actionPtr)->args[0])
 #define SVACTION_STACK_IS_PUSH(actionPtr) ((actionPtr)->args[1])
 
+#define SVACTION_BLOCK_ARG_DEST(actionPtr) ((actionPtr)->args[0])
+#define SVACTION_BLOCK_ARG_SOURCE(actionPtr) ((actionPtr)->args[1])
+#define SVACTION_BLOCK_ARG_VALUE(actionPtr) ((actionPtr)->args[1])
+#define SVACTION_BLOCK_ARG_NUM_WORDS(actionPtr) ((actionPtr)->args[2])
+
 bool V2MP_Supervisor_CreateActionLists(V2MP_Supervisor* supervisor);
 void V2MP_Supervisor_DestroyActionLists(V2MP_Supervisor* supervisor);
+
+// Creates the action lists with their initial storage reserved within the block,
+// instead of allocated separately. The supervisor is NULL while the block is
+// being measured. See BlockLayout.h.
+void V2MP_Supervisor_PlaceActionListsInBlock(V2MP_Supervisor* supervisor, V2MP_BlockLayout* layout);
 V2MP_Supervisor_Action* V2MP_Supervisor_CreateNewAction(V2MP_Supervisor* supervisor);
-V2MPSC_DoubleLL_Node* V2MP_Supervisor_CloneToOngoingAction(V2MP_Supervisor* supervisor, V2MPSC_DoubleLL_Node* createAfter, V2MP_Supervisor_Action* template);
 bool V2MP_Supervisor_ResolveOutstandingActions(V2MP_Supervisor* supervisor);
 
-#endif // V2MP_MODULES_SUPERVISOR_POSTINSTRUCTIONACTION_H
+// Discards all new and ongoing actions without resolving them.
+void V2MP_Supervisor_ClearActions(V2MP_Supervisor* supervisor);
+
+// Replaces the supervisor's ongoing actions with copies of the source supervisor's.
+bool V2MP_Supervisor_CopyOngoingActions(V2MP_Supervisor* supervisor, const V2MP_Supervisor* source);
+
+#endif // V2MP_MODULES_SUPERVISOR_ACTION_H
@@ -1,4 +1,3 @@
-#include <string.h>
 #include "Modules/Supervisor_Action_Stack.h"
 #include "Modules/Supervisor_Internal.h"
 #include "LibV2MP/Modules/Mainboard.h"
@@ -7,7 +6,6 @@
 bool V2MP_Supervisor_PerformStackPush(V2MP_Supervisor* supervisor, const V2MP_Word* inWords, size_t numWords)
 {
 	V2MP_CPU* cpu;
-	V2MP_Byte* stackData;
 	V2MP_Word sp;
 
 	if ( !supervisor || !inWords || numWords < 1 )
@@ -24,19 +22,16 @@ bool V2MP_Supervisor_PerformStackPush(V2MP_Supervisor* supervisor, const V2MP_Wo
 
 	sp = V2MP_CPU_GetStackPointer(cpu);
 
-	stackData = V2MP_Supervisor_GetDataRangeFromSegment(
-		supervisor,
-		&supervisor->programSS,
-		sp,
-		numWords * sizeof(V2MP_Word)
-	);
-
-	if ( !stackData )
+	if ( !V2MP_Supervisor_WriteRangeToSegment(
+			supervisor,
+			&supervisor->programSS,
+			sp,
+			(const V2MP_Byte*)inWords,
+			numWords * sizeof(V2MP_Word)) )
 	{
 		return false;
 	}
 
-	memcpy(stackData, inWords, numWords * sizeof(V2MP_Word));
 	sp += (V2MP_Word)(numWords * sizeof(V2MP_Word));
 
 	V2MP_CPU_SetStackPointer(cpu, sp);
@@ -47,7 +42,6 @@ bool V2MP_Supervisor_PerformStackPush(V2MP_Supervisor* supervisor, const V2MP_Wo
 bool V2MP_Supervisor_PerformStackPop(V2MP_Supervisor* supervisor, V2MP_Word* outWords, size_t numWords)
 {
 	V2MP_CPU* cpu;
-	const V2MP_Byte* stackData;
 	V2MP_Word sp;
 
 	if ( !supervisor )
@@ -71,20 +65,17 @@ bool V2MP_Supervisor_PerformStackPop(V2MP_Supervisor* supervisor, V2MP_Word* out
 
 	sp -= (V2MP_Word)(numWords * sizeof(V2MP_Word));
 
-	stackData = V2MP_Supervisor_GetDataRangeFromSegment(
-		supervisor,
-		&supervisor->programSS,
-		sp,
-		numWords * sizeof(V2MP_Word)
-	);
-
-	if ( !stackData )
+	if ( !V2MP_Supervisor_ReadRangeFromSegment(
+			supervisor,
+			&supervisor->programSS,
+			sp,
+			(V2MP_Byte*)outWords,
+			numWords * sizeof(V2MP_Word)) )
 	{
 		// Should never happen.
 		return false;
 	}
 
-	memcpy(outWords, stackData, numWords * sizeof(V2MP_Word));
 	V2MP_CPU_SetStackPointer(cpu, sp);
 
 	return true;
@@ -7,7 +7,12 @@ void RequestLoadWordFromDS(void* opaqueSv, V2MP_Word address, V2MP_RegisterIndex
 void RequestStoreWordToDS(void* opaqueSv, V2MP_Word address, V2MP_Word wordToStore);
 void RequestStackPush(void* opaqueSv, V2MP_Word regFlags);
 void RequestStackPop(void* opaqueSv, V2MP_Word regFlags);
+V2MP_Word LoadWordFromDS(void* opaqueSv, V2MP_Word address, V2MP_Word* outWord);
+V2MP_Word StoreWordToDS(void* opaqueSv, V2MP_Word address, V2MP_Word wordToStore);
+V2MP_Word PushWordsToStack(void* opaqueSv, const V2MP_Word* words, size_t numWords);
+V2MP_Word PopWordsFromStack(void* opaqueSv, V2MP_Word* outWords, size_t numWords);
 void RaiseSignal(void* opaqueSv, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr, V2MP_Word sp);
+bool CompleteClockCycle(void* opaqueSv, bool* outProgramExited);
 
 void V2MP_Supervisor_CreateCPUInterface(V2MP_Supervisor* supervisor, V2MP_CPU_SupervisorInterface* interface)
 {
@@ -23,7 +28,24 @@ void V2MP_Supervisor_CreateCPUInterface(V2MP_Supervisor* supervisor, V2MP_CPU_Su
 	interface->requestStoreWordToDS = &RequestStoreWordToDS;
 	interface->requestStackPush = &RequestStackPush;
 	interface->requestStackPop = &RequestStackPop;
+
+	if ( !V2MP_Supervisor_ShouldDeferMemoryAccess(supervisor) )
+	{
+		interface->loadWordFromDS = &LoadWordFromDS;
+		interface->storeWordToDS = &StoreWordToDS;
+		interface->pushWordsToStack = &PushWordsToStack;
+		interface->popWordsFromStack = &PopWordsFromStack;
+	}
+	else
+	{
+		interface->loadWordFromDS = NULL;
+		interface->storeWordToDS = NULL;
+		interface->pushWordsToStack = NULL;
+		interface->popWordsFromStack = NULL;
+	}
+
 	interface->raiseSignal = &RaiseSignal;
+	interface->completeClockCycle = &CompleteClockCycle;
 }
 
 V2MP_Word FetchInstructionWord(void* opaqueSv, V2MP_Word address, V2MP_Word* destReg)
@@ -51,7 +73,32 @@ void RequestStackPop(void* opaqueSv, V2MP_Word regFlags)
 	V2MP_Supervisor_RequestStackPop((V2MP_Supervisor*)opaqueSv, regFlags);
 }
 
+V2MP_Word LoadWordFromDS(void* opaqueSv, V2MP_Word address, V2MP_Word* outWord)
+{
+	return V2MP_Supervisor_LoadWordFromDS((V2MP_Supervisor*)opaqueSv, address, outWord);
+}
+
+V2MP_Word StoreWordToDS(void* opaqueSv, V2MP_Word address, V2MP_Word wordToStore)
+{
+	return V2MP_Supervisor_StoreWordToDS((V2MP_Supervisor*)opaqueSv, address, wordToStore);
+}
+
+V2MP_Word PushWordsToStack(void* opaqueSv, const V2MP_Word* words, size_t numWords)
+{
+	return V2MP_Supervisor_PushWordsToStack((V2MP_Supervisor*)opaqueSv, words, numWords);
+}
+
+V2MP_Word PopWordsFromStack(void* opaqueSv, V2MP_Word* outWords, size_t numWords)
+{
+	return V2MP_Supervisor_PopWordsFromStack((V2MP_Supervisor*)opaqueSv, outWords, numWords);
+}
+
 void RaiseSignal(void* opaqueSv, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr, V2MP_Word sp)
 {
 	V2MP_Supervisor_RaiseSignal((V2MP_Supervisor*)opaqueSv, signal, r1, lr, sp);
 }
+
+bool CompleteClockCycle(void* opaqueSv, bool* outProgramExited)
+{
+	return V2MP_Supervisor_CompleteClockCycle((V2MP_Supervisor*)opaqueSv, outProgramExited);
+}
@@ -4,77 +4,212 @@
 #include "LibV2MP/Modules/CPU.h"
 #include "LibV2MP/Modules/MemoryStore.h"
 #include "LibV2MP/Modules/Mainboard.h"
+#include "LibBaseUtil/Util.h"
+#include "LibBaseUtil/Heap.h"
+#include "Modules/Supervisor_Action_Stack.h"
+#include "Modules/MemoryStore_Internal.h"
+#include "Modules/ProgramImage_Internal.h"
 
-V2MP_Byte* V2MP_Supervisor_GetDataRangeFromSegment(
+static void CacheSegmentPointers(MemorySegment* seg, V2MP_MemoryStore* memoryStore, size_t memorySize)
+{
+	if ( seg->lengthInBytes > 0 &&
+	     seg->base < memorySize &&
+	     seg->lengthInBytes <= memorySize - seg->base )
+	{
+		seg->readData = V2MP_MemoryStore_GetConstPtrToRange(memoryStore, seg->base, seg->lengthInBytes);
+		seg->writeData = V2MP_MemoryStore_GetExclusivePtrToRange(memoryStore, seg->base, seg->lengthInBytes);
+		seg->accessibleLengthInBytes = seg->lengthInBytes;
+	}
+	else
+	{
+		seg->readData = NULL;
+		seg->writeData = NULL;
+		seg->accessibleLengthInBytes = 0;
+	}
+}
+
+static void CacheCodeSegmentPointers(MemorySegment* seg, const V2MP_ProgramImage* image)
+{
+	seg->readData = image ? (const V2MP_Byte*)image->cs : NULL;
+	seg->writeData = NULL;
+	seg->accessibleLengthInBytes = image ? seg->lengthInBytes : 0;
+}
+
+void V2MP_Supervisor_RefreshSegmentCache(V2MP_Supervisor* supervisor)
+{
+	size_t memorySize;
+
+	if ( !supervisor )
+	{
+		return;
+	}
+
+	supervisor->memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	supervisor->dirtyPages = V2MP_MemoryStore_GetDirtyPageBitmap(supervisor->memoryStore);
+	memorySize = V2MP_MemoryStore_GetTotalMemorySize(supervisor->memoryStore);
+
+	CacheCodeSegmentPointers(&supervisor->programCS, supervisor->programImage);
+	CacheSegmentPointers(&supervisor->programDS, supervisor->memoryStore, memorySize);
+	CacheSegmentPointers(&supervisor->programSS, supervisor->memoryStore, memorySize);
+}
+
+static inline bool SegmentSharesPageWithRange(const MemorySegment* seg, size_t base, size_t numBytes)
+{
+	if ( seg->lengthInBytes < 1 || numBytes < 1 )
+	{
+		return false;
+	}
+
+	return
+		seg->base / V2MP_MEMORYSTORE_PAGE_SIZE <= (base + numBytes - 1) / V2MP_MEMORYSTORE_PAGE_SIZE &&
+		base / V2MP_MEMORYSTORE_PAGE_SIZE <= (seg->base + seg->lengthInBytes - 1) / V2MP_MEMORYSTORE_PAGE_SIZE;
+}
+
+// Only the segments that lie on the same pages as the given range are refreshed.
+static void RefreshSegmentsOnPages(V2MP_Supervisor* supervisor, size_t base, size_t numBytes)
+{
+	const size_t memorySize = V2MP_MemoryStore_GetTotalMemorySize(supervisor->memoryStore);
+
+	if ( SegmentSharesPageWithRange(&supervisor->programDS, base, numBytes) )
+	{
+		CacheSegmentPointers(&supervisor->programDS, supervisor->memoryStore, memorySize);
+	}
+
+	if ( SegmentSharesPageWithRange(&supervisor->programSS, base, numBytes) )
+	{
+		CacheSegmentPointers(&supervisor->programSS, supervisor->memoryStore, memorySize);
+	}
+}
+
+static inline void ExtendWrittenRange(V2MP_Supervisor* supervisor, size_t base, size_t numBytes)
+{
+	if ( numBytes < 1 )
+	{
+		return;
+	}
+
+	if ( supervisor->writtenEnd <= supervisor->writtenBase )
+	{
+		supervisor->writtenBase = base;
+		supervisor->writtenEnd = base + numBytes;
+		return;
+	}
+
+	if ( base < supervisor->writtenBase )
+	{
+		supervisor->writtenBase = base;
+	}
+
+	if ( base + numBytes > supervisor->writtenEnd )
+	{
+		supervisor->writtenEnd = base + numBytes;
+	}
+}
+
+// For writes made directly through a segment's write pointer.
+static inline void MarkRangeWritten(V2MP_Supervisor* supervisor, size_t base, size_t numBytes)
+{
+	V2MP_MemoryStore_MarkRangeDirty(supervisor->dirtyPages, base, numBytes);
+	ExtendWrittenRange(supervisor, base, numBytes);
+}
+
+static inline void LoadWordFromSegment(
 	const V2MP_Supervisor* supervisor,
 	const MemorySegment* seg,
 	size_t address,
-	size_t numBytes
+	V2MP_Word* outWord
 )
 {
-	V2MP_MemoryStore* memoryStore;
+	const V2MP_Byte* data;
 
-	if ( !DataRangeIsInSegment(seg, address, numBytes) )
+	if ( seg->readData )
 	{
-		return NULL;
+		memcpy(outWord, seg->readData + address, sizeof(V2MP_Word));
+		return;
 	}
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	// A segment that spans more than one page of paged memory has no cached
+	// pointers, so the page that the word lies on is looked up instead.
+	data = V2MP_MemoryStore_GetConstPtrToRange(supervisor->memoryStore, seg->base + address, sizeof(V2MP_Word));
 
-	if ( !memoryStore )
+	if ( data )
 	{
-		return NULL;
+		memcpy(outWord, data, sizeof(V2MP_Word));
+	}
+	else
+	{
+		V2MP_MemoryStore_LoadWord(supervisor->memoryStore, seg->base + address, outWord);
 	}
-
-	return V2MP_MemoryStore_GetPtrToRange(memoryStore, seg->base + address, numBytes);
 }
 
-const V2MP_Byte* V2MP_Supervisor_GetConstDataRangeFromSegment(
-	const V2MP_Supervisor* supervisor,
+static bool WriteRangeThroughMemoryStore(
+	V2MP_Supervisor* supervisor,
 	const MemorySegment* seg,
 	size_t address,
+	const V2MP_Byte* data,
 	size_t numBytes
 )
 {
-	V2MP_MemoryStore* memoryStore;
+	const size_t barrierCount = V2MP_MemoryStore_GetPageBarrierCount(supervisor->memoryStore);
 
-	if ( !DataRangeIsInSegment(seg, address, numBytes) )
+	// May fail if a page could not be committed or copied.
+	if ( !V2MP_MemoryStore_WriteRange(supervisor->memoryStore, seg->base + address, data, numBytes) )
 	{
-		return NULL;
+		return false;
 	}
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	ExtendWrittenRange(supervisor, seg->base + address, numBytes);
 
-	if ( !memoryStore )
+	// If the write committed or copied a page, any segment on that page may
+	// still refer to the page it replaced, so must be refreshed. If the written
+	// segment now has the page to itself, subsequent writes to it will be direct.
+	if ( V2MP_MemoryStore_GetPageBarrierCount(supervisor->memoryStore) != barrierCount )
 	{
-		return NULL;
+		RefreshSegmentsOnPages(supervisor, seg->base + address, numBytes);
 	}
 
-	return V2MP_MemoryStore_GetConstPtrToRange(memoryStore, seg->base + address, numBytes);
+	return true;
 }
 
-bool V2MP_Supervisor_FetchWordFromSegment(
-	const V2MP_Supervisor* supervisor,
+static inline bool StoreWordToSegment(
+	V2MP_Supervisor* supervisor,
 	const MemorySegment* seg,
 	size_t address,
-	V2MP_Word* outWord
+	V2MP_Word word
 )
 {
-	V2MP_MemoryStore* memoryStore;
+	V2MP_Byte* data = seg->writeData ? seg->writeData + address : NULL;
 
-	if ( !supervisor || !DataRangeIsInSegment(seg, address, sizeof(V2MP_Word)) )
+	if ( !data )
 	{
-		return false;
+		// As for loads, the page that the word lies on is looked up instead.
+		data = V2MP_MemoryStore_GetExclusivePtrToRange(supervisor->memoryStore, seg->base + address, sizeof(V2MP_Word));
 	}
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	if ( data )
+	{
+		memcpy(data, &word, sizeof(V2MP_Word));
+		MarkRangeWritten(supervisor, seg->base + address, sizeof(V2MP_Word));
+		return true;
+	}
 
-	if ( !memoryStore )
+	return WriteRangeThroughMemoryStore(supervisor, seg, address, (const V2MP_Byte*)&word, sizeof(V2MP_Word));
+}
+
+bool V2MP_Supervisor_FetchWordFromSegment(
+	const V2MP_Supervisor* supervisor,
+	const MemorySegment* seg,
+	size_t address,
+	V2MP_Word* outWord
+)
+{
+	if ( !supervisor || !seg || !outWord || !WordIsInSegment(seg, address) )
 	{
 		return false;
 	}
 
-	return V2MP_MemoryStore_LoadWord(memoryStore, seg->base + address, outWord);
+	LoadWordFromSegment(supervisor, seg, address, outWord);
+	return true;
 }
 
 bool V2MP_Supervisor_ReadRangeFromSegment(
@@ -85,16 +220,64 @@ bool V2MP_Supervisor_ReadRangeFromSegment(
 	size_t numBytes
 )
 {
-	const V2MP_Byte* rawData;
+	if ( !supervisor || !seg || !outBuffer || !DataRangeIsInSegment(seg, address, numBytes) )
+	{
+		return false;
+	}
 
-	rawData = V2MP_Supervisor_GetConstDataRangeFromSegment(supervisor, seg, address, numBytes);
+	if ( seg->readData )
+	{
+		memcpy(outBuffer, seg->readData + address, numBytes);
+		return true;
+	}
+
+	return V2MP_MemoryStore_ReadRange(supervisor->memoryStore, seg->base + address, outBuffer, numBytes);
+}
 
-	if ( !rawData )
+bool V2MP_Supervisor_WriteRangeToSegment(
+	V2MP_Supervisor* supervisor,
+	const MemorySegment* seg,
+	size_t address,
+	const V2MP_Byte* data,
+	size_t numBytes
+)
+{
+	if ( !supervisor || !seg || !data || !DataRangeIsInSegment(seg, address, numBytes) )
 	{
 		return false;
 	}
 
-	memcpy(outBuffer, rawData, numBytes);
+	if ( seg->writeData )
+	{
+		memcpy(seg->writeData + address, data, numBytes);
+		MarkRangeWritten(supervisor, seg->base + address, numBytes);
+		return true;
+	}
+
+	return WriteRangeThroughMemoryStore(supervisor, seg, address, data, numBytes);
+}
+
+bool V2MP_Supervisor_MapDataPage(V2MP_Supervisor* supervisor, size_t pageIndex)
+{
+	MemorySegment* seg;
+
+	if ( !supervisor || pageIndex >= supervisor->numDataPages )
+	{
+		return false;
+	}
+
+	seg = &supervisor->programDS;
+	seg->base = supervisor->dataPages[pageIndex].base;
+	seg->lengthInBytes = supervisor->dataPages[pageIndex].lengthInBytes;
+	supervisor->activeDataPage = pageIndex;
+
+	// No data is moved: only the pointers to the new page are resolved.
+	CacheSegmentPointers(
+		seg,
+		supervisor->memoryStore,
+		V2MP_MemoryStore_GetTotalMemorySize(supervisor->memoryStore)
+	);
+
 	return true;
 }
 
@@ -132,21 +315,104 @@ size_t V2MP_Supervisor_GetMaxDSBytesAvailableAtAddress(V2MP_Supervisor* supervis
 
 V2MP_Word V2MP_Supervisor_FetchInstructionWord(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word* destReg)
 {
-	V2MP_MemoryStore* memoryStore;
+	if ( !supervisor || !destReg )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	if ( !WordIsInSegment(&supervisor->programCS, address) )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0);
+	}
 
+	LoadWordFromSegment(supervisor, &supervisor->programCS, address, destReg);
+	return V2MP_FAULT_NONE;
+}
+
+V2MP_Word V2MP_Supervisor_LoadWordFromDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word* outWord)
+{
+	if ( !supervisor || !outWord )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	// Segments always begin on a word boundary.
+	if ( address & 0x1 )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_ALGN, 0);
+	}
+
+	if ( !WordIsInSegment(&supervisor->programDS, address) )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0);
+	}
+
+	LoadWordFromSegment(supervisor, &supervisor->programDS, address, outWord);
+	return V2MP_FAULT_NONE;
+}
+
+V2MP_Word V2MP_Supervisor_StoreWordToDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word wordToStore)
+{
+	if ( !supervisor )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	// Segments always begin on a word boundary.
+	if ( address & 0x1 )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_ALGN, 0);
+	}
+
+	if ( !WordIsInSegment(&supervisor->programDS, address) )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0);
+	}
+
+	if ( !StoreWordToSegment(supervisor, &supervisor->programDS, address, wordToStore) )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	return V2MP_FAULT_NONE;
+}
+
+V2MP_Word V2MP_Supervisor_PushWordsToStack(V2MP_Supervisor* supervisor, const V2MP_Word* words, size_t numWords)
+{
 	if ( !supervisor )
 	{
 		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
 	}
 
-	memoryStore = V2MP_Mainboard_GetMemoryStore(supervisor->mainboard);
+	return V2MP_Supervisor_PerformStackPush(supervisor, words, numWords)
+		? V2MP_FAULT_NONE
+		: V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SOF, 0);
+}
 
-	if ( !memoryStore )
+V2MP_Word V2MP_Supervisor_PopWordsFromStack(V2MP_Supervisor* supervisor, V2MP_Word* outWords, size_t numWords)
+{
+	if ( !supervisor )
 	{
 		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
 	}
 
-	if ( !V2MP_MemoryStore_LoadWord(memoryStore, address, destReg) )
+	return V2MP_Supervisor_PerformStackPop(supervisor, outWords, numWords)
+		? V2MP_FAULT_NONE
+		: V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SOF, 0);
+}
+
+// Block fills through the memory store are written in chunks of this many words.
+#define FILL_CHUNK_WORDS 64
+
+static V2MP_Word CheckBlockRange(const MemorySegment* seg, size_t address, size_t numBytes)
+{
+	// Segments always begin on a word boundary.
+	if ( address & 0x1 )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_ALGN, 0);
+	}
+
+	if ( numBytes > 0 && !DataRangeIsInSegment(seg, address, numBytes) )
 	{
 		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0);
 	}
@@ -154,6 +420,190 @@ V2MP_Word V2MP_Supervisor_FetchInstructionWord(V2MP_Supervisor* supervisor, V2MP
 	return V2MP_FAULT_NONE;
 }
 
+V2MP_Word V2MP_Supervisor_CopyBlockFromDS(
+	V2MP_Supervisor* supervisor,
+	const MemorySegment* destSeg,
+	V2MP_Word destAddress,
+	V2MP_Word sourceAddress,
+	size_t numWords
+)
+{
+	const MemorySegment* sourceSeg;
+	const size_t numBytes = numWords * sizeof(V2MP_Word);
+	V2MP_Byte* buffer;
+	V2MP_Word fault;
+	bool success;
+
+	if ( !supervisor || !destSeg )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	sourceSeg = &supervisor->programDS;
+	fault = CheckBlockRange(sourceSeg, sourceAddress, numBytes);
+
+	if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_NONE )
+	{
+		fault = CheckBlockRange(destSeg, destAddress, numBytes);
+	}
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE || numBytes < 1 )
+	{
+		return fault;
+	}
+
+	if ( sourceSeg->readData && destSeg->writeData )
+	{
+		// The ranges may overlap if both are in DS.
+		memmove(destSeg->writeData + destAddress, sourceSeg->readData + sourceAddress, numBytes);
+		MarkRangeWritten(supervisor, destSeg->base + destAddress, numBytes);
+		return V2MP_FAULT_NONE;
+	}
+
+	// At least one of the ranges must go through the memory store,
+	// so take a copy of the source before anything is written.
+	buffer = (V2MP_Byte*)BASEUTIL_MALLOC(numBytes);
+
+	if ( !buffer )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	success =
+		V2MP_Supervisor_ReadRangeFromSegment(supervisor, sourceSeg, sourceAddress, buffer, numBytes) &&
+		V2MP_Supervisor_WriteRangeToSegment(supervisor, destSeg, destAddress, buffer, numBytes);
+
+	BASEUTIL_FREE(buffer);
+
+	return success ? V2MP_FAULT_NONE : V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+}
+
+V2MP_Word V2MP_Supervisor_FillDSBlock(
+	V2MP_Supervisor* supervisor,
+	V2MP_Word destAddress,
+	V2MP_Word value,
+	size_t numWords
+)
+{
+	const MemorySegment* seg;
+	const size_t numBytes = numWords * sizeof(V2MP_Word);
+	V2MP_Word chunk[FILL_CHUNK_WORDS];
+	V2MP_Byte* dest;
+	size_t filled;
+	size_t toCopy;
+	V2MP_Word fault;
+
+	if ( !supervisor )
+	{
+		return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+	}
+
+	seg = &supervisor->programDS;
+	fault = CheckBlockRange(seg, destAddress, numBytes);
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE || numBytes < 1 )
+	{
+		return fault;
+	}
+
+	if ( seg->writeData )
+	{
+		dest = seg->writeData + destAddress;
+
+		if ( (value & 0xFF) == (value >> 8) )
+		{
+			memset(dest, value & 0xFF, numBytes);
+		}
+		else
+		{
+			// Double the filled range each time, so that the work is done by memcpy().
+			memcpy(dest, &value, sizeof(V2MP_Word));
+
+			for ( filled = sizeof(V2MP_Word); filled < numBytes; filled += toCopy )
+			{
+				toCopy = filled < numBytes - filled ? filled : numBytes - filled;
+				memcpy(dest + filled, dest, toCopy);
+			}
+		}
+
+		MarkRangeWritten(supervisor, seg->base + destAddress, numBytes);
+		return V2MP_FAULT_NONE;
+	}
+
+	for ( filled = 0; filled < BASEUTIL_ARRAY_SIZE(chunk); ++filled )
+	{
+		chunk[filled] = value;
+	}
+
+	for ( filled = 0; filled < numBytes; filled += toCopy )
+	{
+		toCopy = sizeof(chunk) < numBytes - filled ? sizeof(chunk) : numBytes - filled;
+
+		if ( !V2MP_Supervisor_WriteRangeToSegment(supervisor, seg, destAddress + filled, (const V2MP_Byte*)chunk, toCopy) )
+		{
+			return V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, 0);
+		}
+	}
+
+	return V2MP_FAULT_NONE;
+}
+
+// Returns 0 if the access will fault, since no memory is accessed in that case.
+static V2MP_Word GetAccessLatency(
+	V2MP_Supervisor* supervisor,
+	const MemorySegment* seg,
+	size_t address,
+	size_t numBytes,
+	size_t baseLatency
+)
+{
+	size_t latency;
+
+	if ( !supervisor->timing.enabled ||
+	     (address & 0x1) ||
+	     !DataRangeIsInSegment(seg, address, numBytes) )
+	{
+		return 0;
+	}
+
+	latency = V2MP_Supervisor_Timing_Access(&supervisor->timing, baseLatency, seg->base + address, numBytes);
+	return latency < UINT16_MAX ? (V2MP_Word)latency : (V2MP_Word)UINT16_MAX;
+}
+
+static V2MP_Word GetStackAccessLatency(V2MP_Supervisor* supervisor, V2MP_Word regFlags, bool isPush)
+{
+	size_t numBytes = 0;
+	size_t sp;
+	size_t index;
+
+	if ( !supervisor->timing.enabled )
+	{
+		return 0;
+	}
+
+	for ( index = 0; index <= V2MP_REGID_MAX; ++index )
+	{
+		if ( regFlags & (1 << index) )
+		{
+			numBytes += sizeof(V2MP_Word);
+		}
+	}
+
+	sp = V2MP_CPU_GetStackPointer(V2MP_Mainboard_GetCPU(supervisor->mainboard));
+
+	if ( !isPush )
+	{
+		if ( sp < numBytes )
+		{
+			return 0;
+		}
+
+		sp -= numBytes;
+	}
+
+	return GetAccessLatency(supervisor, &supervisor->programSS, sp, numBytes, supervisor->timing.model.stackLatency);
+}
+
 void V2MP_Supervisor_RequestLoadWordFromDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_RegisterIndex destReg)
 {
 	V2MP_Supervisor_Action* action;
@@ -169,6 +619,13 @@ void V2MP_Supervisor_RequestLoadWordFromDS(V2MP_Supervisor* supervisor, V2MP_Wor
 	action->actionType = SVAT_LOAD_WORD;
 	SVACTION_LOAD_WORD_ARG_ADDRESS(action) = address;
 	SVACTION_LOAD_WORD_ARG_DESTREG(action) = destReg;
+	SVACTION_STALL_CYCLES(action) = GetAccessLatency(
+		supervisor,
+		&supervisor->programDS,
+		address,
+		sizeof(V2MP_Word),
+		supervisor->timing.model.loadLatency
+	);
 }
 
 void V2MP_Supervisor_RequestStoreWordToDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word wordToStore)
@@ -186,6 +643,13 @@ void V2MP_Supervisor_RequestStoreWordToDS(V2MP_Supervisor* supervisor, V2MP_Word
 	action->actionType = SVAT_STORE_WORD;
 	SVACTION_STORE_WORD_ARG_ADDRESS(action) = address;
 	SVACTION_STORE_WORD_ARG_WORD(action) = wordToStore;
+	SVACTION_STALL_CYCLES(action) = GetAccessLatency(
+		supervisor,
+		&supervisor->programDS,
+		address,
+		sizeof(V2MP_Word),
+		supervisor->timing.model.storeLatency
+	);
 }
 
 void V2MP_Supervisor_RequestStackPush(V2MP_Supervisor* supervisor, V2MP_Word regFlags)
@@ -203,6 +667,7 @@ void V2MP_Supervisor_RequestStackPush(V2MP_Supervisor* supervisor, V2MP_Word reg
 	action->actionType = SVAT_STACK_OPERATION;
 	SVACTION_STACK_REG_FLAGS(action) = regFlags;
 	SVACTION_STACK_IS_PUSH(action) = (V2MP_Word)true;
+	SVACTION_STALL_CYCLES(action) = GetStackAccessLatency(supervisor, regFlags, true);
 }
 
 void V2MP_Supervisor_RequestStackPop(V2MP_Supervisor* supervisor, V2MP_Word regFlags)
@@ -220,13 +685,132 @@ void V2MP_Supervisor_RequestStackPop(V2MP_Supervisor* supervisor, V2MP_Word regF
 	action->actionType = SVAT_STACK_OPERATION;
 	SVACTION_STACK_REG_FLAGS(action) = regFlags;
 	SVACTION_STACK_IS_PUSH(action) = (V2MP_Word)false;
+	SVACTION_STALL_CYCLES(action) = GetStackAccessLatency(supervisor, regFlags, false);
+}
+
+static void HandleEndProgramSignal(V2MP_Supervisor* supervisor, V2MP_Word r1)
+{
+	if ( supervisor->programHasExited )
+	{
+		// Ignore
+		return;
+	}
+
+	supervisor->programHasExited = true;
+	supervisor->programExitCode = r1;
+}
+
+static void HandleSwapDataPageSignal(V2MP_Supervisor* supervisor, V2MP_Word r1)
+{
+	if ( !V2MP_Supervisor_MapDataPage(supervisor, r1) )
+	{
+		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SEG, 0));
+	}
+}
+
+static void HandleBlockSignal(V2MP_Supervisor* supervisor, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr)
+{
+	const MemorySegment* paramSeg = &supervisor->programDS;
+	const MemorySegment* destSeg = &supervisor->programDS;
+	const MemorySegment* sourceSeg = &supervisor->programDS;
+	const size_t numBytes = (size_t)r1 * sizeof(V2MP_Word);
+	V2MP_Supervisor_ActionType actionType;
+	V2MP_Supervisor_Action* action;
+	V2MP_Word params[2];
+	V2MP_Word fault;
+	V2MP_Word latency;
+
+	switch ( signal )
+	{
+		case V2MP_SIGNAL_COPY_DS_BLOCK:
+		{
+			actionType = SVAT_COPY_DS_BLOCK;
+			break;
+		}
+
+		case V2MP_SIGNAL_COPY_DS_BLOCK_TO_SS:
+		{
+			actionType = SVAT_COPY_DS_BLOCK_TO_SS;
+			destSeg = &supervisor->programSS;
+			break;
+		}
+
+		default:
+		{
+			// The second parameter is the value to fill with.
+			actionType = SVAT_FILL_DS_BLOCK;
+			sourceSeg = NULL;
+			break;
+		}
+	}
+
+	// The destination, and the source or fill value, are read from DS at LR.
+	fault = CheckBlockRange(paramSeg, lr, sizeof(params));
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+	{
+		V2MP_Supervisor_SetCPUFault(supervisor, fault);
+		return;
+	}
+
+	LoadWordFromSegment(supervisor, paramSeg, lr, &params[0]);
+	LoadWordFromSegment(supervisor, paramSeg, (size_t)lr + sizeof(V2MP_Word), &params[1]);
+
+	// The ranges are checked now so that any fault is raised by the SIG instruction,
+	// but the operation itself is only performed once its latency has elapsed.
+	fault = CheckBlockRange(destSeg, params[0], numBytes);
+
+	if ( V2MP_CPU_FAULT_CODE(fault) == V2MP_FAULT_NONE && sourceSeg )
+	{
+		fault = CheckBlockRange(sourceSeg, params[1], numBytes);
+	}
+
+	if ( V2MP_CPU_FAULT_CODE(fault) != V2MP_FAULT_NONE )
+	{
+		V2MP_Supervisor_SetCPUFault(supervisor, fault);
+		return;
+	}
+
+	if ( numBytes < 1 )
+	{
+		return;
+	}
+
+	latency = 0;
+
+	if ( supervisor->timing.enabled )
+	{
+		const size_t perWord = supervisor->timing.model.blockLatencyPerWord;
+
+		latency = (perWord > 0 && r1 > UINT16_MAX / perWord) ? UINT16_MAX : (V2MP_Word)(r1 * perWord);
+
+		if ( sourceSeg )
+		{
+			latency = GetAccessLatency(supervisor, sourceSeg, params[1], numBytes, latency);
+		}
+
+		latency = GetAccessLatency(supervisor, destSeg, params[0], numBytes, latency);
+	}
+
+	action = V2MP_Supervisor_CreateNewAction(supervisor);
+
+	if ( !action )
+	{
+		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_SPV, actionType));
+		return;
+	}
+
+	action->actionType = actionType;
+	SVACTION_BLOCK_ARG_DEST(action) = params[0];
+	SVACTION_BLOCK_ARG_SOURCE(action) = params[1];
+	SVACTION_BLOCK_ARG_NUM_WORDS(action) = r1;
+	SVACTION_STALL_CYCLES(action) = latency;
 }
 
 // This is very limited for the moment. When we add more than a handful of signals,
 // this will need to be expanded into something better.
 void V2MP_Supervisor_RaiseSignal(V2MP_Supervisor* supervisor, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr, V2MP_Word sp)
 {
-	(void)lr;
 	(void)sp;
 
 	if ( !supervisor )
@@ -234,18 +818,47 @@ void V2MP_Supervisor_RaiseSignal(V2MP_Supervisor* supervisor, V2MP_Word signal,
 		return;
 	}
 
-	if ( signal != V2MP_SIGNAL_END_PROGRAM )
+	switch ( signal )
 	{
-		V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_INS, 0));
-		return;
+		case V2MP_SIGNAL_END_PROGRAM:
+		{
+			HandleEndProgramSignal(supervisor, r1);
+			break;
+		}
+
+		case V2MP_SIGNAL_SWAP_DATA_PAGE:
+		{
+			HandleSwapDataPageSignal(supervisor, r1);
+			break;
+		}
+
+		case V2MP_SIGNAL_COPY_DS_BLOCK:
+		case V2MP_SIGNAL_FILL_DS_BLOCK:
+		case V2MP_SIGNAL_COPY_DS_BLOCK_TO_SS:
+		{
+			HandleBlockSignal(supervisor, signal, r1, lr);
+			break;
+		}
+
+		default:
+		{
+			V2MP_Supervisor_SetCPUFault(supervisor, V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_INS, 0));
+			break;
+		}
 	}
+}
 
-	if ( supervisor->programHasExited )
+bool V2MP_Supervisor_CompleteClockCycle(V2MP_Supervisor* supervisor, bool* outProgramExited)
+{
+	if ( !supervisor || !V2MP_Supervisor_ResolveOutstandingActions(supervisor) )
 	{
-		// Ignore
-		return;
+		return false;
 	}
 
-	supervisor->programHasExited = true;
-	supervisor->programExitCode = r1;
+	if ( outProgramExited )
+	{
+		*outProgramExited = supervisor->programHasExited;
+	}
+
+	return true;
 }
@@ -4,34 +4,114 @@
 #include "LibV2MP/Defs.h"
 #include "LibV2MP/Modules/Supervisor.h"
 #include "LibV2MP/Modules/Mainboard.h"
+#include "LibV2MP/Modules/MemoryStore.h"
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+#include "LibV2MP/Modules/ProgramImage.h"
 #include "Modules/Supervisor_Action.h"
-#include "LibSharedComponents/DoubleLinkedList.h"
+#include "Modules/Supervisor_Timing.h"
+#include "Modules/CPU_Decode.h"
 
 typedef struct MemorySegment
 {
 	size_t base;
 	size_t lengthInBytes;
+
+	// Host pointers to the start of the segment, cached from the memory store
+	// by V2MP_Supervisor_RefreshSegmentCache(). Either may be NULL, in which
+	// case the segment is accessed through the memory store instead. This
+	// happens if memory is paged and the segment spans more than one page.
+	// The write pointer is also NULL if the segment's page is shared with
+	// another store or not yet committed, so checking it acts as the write
+	// barrier for copy-on-write memory. If the segment does not lie within
+	// the memory store, the accessible length is 0, so that every access to
+	// the segment is out of bounds.
+	const V2MP_Byte* readData;
+	V2MP_Byte* writeData;
+	size_t accessibleLengthInBytes;
 } MemorySegment;
 
+// A data page is a region of the memory store that can be mapped
+// as the data segment. Only one page is mapped at a time.
+typedef struct DataPage
+{
+	size_t base;
+	size_t lengthInBytes;
+} DataPage;
+
 struct V2MP_Supervisor
 {
-	V2MPSC_DoubleLL* newActions;
-	V2MPSC_DoubleLL* ongoingActions;
+	V2MP_Supervisor_ActionQueue newActions;
+	V2MP_Supervisor_ActionQueue ongoingActions;
 
 	MemorySegment programCS;
 	MemorySegment programDS;
 	MemorySegment programSS;
 
+	// Page 0 holds the data segment that the program was loaded with, and
+	// the stack segment follows it. Any further pages are laid out after the
+	// stack segment. Swapping pages only changes where programDS points.
+	DataPage* dataPages;
+	size_t numDataPages;
+	size_t dataPagesCapacity;
+	size_t activeDataPage;
+
+	// Holds the code segment and its predecoded form, and may be shared with
+	// other supervisors. The code segment is never placed in the memory store:
+	// it is always fetched from here.
+	V2MP_ProgramImage* programImage;
+
+	// Lookup table from CS word index to the precompiled block that begins there.
+	// Only allocated while a precompiled program is attached.
+	const V2MP_PrecompiledBlock** precompiledBlocks;
+
 	V2MP_Mainboard* mainboard;
 
+	// Cached along with the segment pointers. Direct writes
+	// through a segment's write pointer must be marked here.
+	V2MP_MemoryStore* memoryStore;
+	V2MP_Byte* dirtyPages;
+
+	// The range of the memory store that has been written to through the
+	// segments since the program state was last reset, as [writtenBase, writtenEnd).
+	// This is what the next reset clears, rather than all of memory.
+	size_t writtenBase;
+	size_t writtenEnd;
+
+	// If set, LDST and STK are queued as actions and resolved at the end
+	// of the clock cycle, instead of accessing memory immediately.
+	bool deferMemoryAccess;
+
+	// Memory is always accessed through actions while timing is enabled.
+	V2MP_Supervisor_Timing timing;
+
+	// Mirrors the CPU's stall state, which is set
+	// whenever there are actions ongoing.
+	bool cpuStalled;
+
 	bool programHasExited;
 	V2MP_Word programExitCode;
+
+	// If set, the supervisor lies within a block owned by something else.
+	bool placedInBlock;
 };
 
+// Reserves space within the block for a supervisor and the initial storage for
+// its action lists, and initialises them there if the block has been allocated.
+// See BlockLayout.h.
+V2MP_Supervisor* V2MP_Supervisor_PlaceInBlock(V2MP_BlockLayout* layout);
+
+static inline bool V2MP_Supervisor_ShouldDeferMemoryAccess(const V2MP_Supervisor* supervisor)
+{
+	return supervisor->deferMemoryAccess || supervisor->timing.enabled;
+}
+
 static inline void ResetProgramMemorySegment(MemorySegment* seg)
 {
 	seg->base = 0;
 	seg->lengthInBytes = 0;
+	seg->readData = NULL;
+	seg->writeData = NULL;
+	seg->accessibleLengthInBytes = 0;
 }
 
 static inline bool DataRangeIsInSegment(const MemorySegment* seg, size_t address, size_t numBytes)
@@ -39,24 +119,21 @@ static inline bool DataRangeIsInSegment(const MemorySegment* seg, size_t address
 	// Check is specially constructed to avoid possibility of a size_t overflow.
 	return
 		seg &&
-		address < seg->lengthInBytes &&
-		numBytes <= seg->lengthInBytes &&
-		address <= seg->lengthInBytes - numBytes;
+		address < seg->accessibleLengthInBytes &&
+		numBytes <= seg->accessibleLengthInBytes &&
+		address <= seg->accessibleLengthInBytes - numBytes;
 }
 
-V2MP_Byte* V2MP_Supervisor_GetDataRangeFromSegment(
-	const V2MP_Supervisor* supervisor,
-	const MemorySegment* seg,
-	size_t address,
-	size_t numBytes
-);
+static inline bool WordIsInSegment(const MemorySegment* seg, size_t address)
+{
+	return seg->accessibleLengthInBytes >= sizeof(V2MP_Word) &&
+	       address <= seg->accessibleLengthInBytes - sizeof(V2MP_Word);
+}
 
-const V2MP_Byte* V2MP_Supervisor_GetConstDataRangeFromSegment(
-	const V2MP_Supervisor* supervisor,
-	const MemorySegment* seg,
-	size_t address,
-	size_t numBytes
-);
+// Resolves the host pointers of all program segments from the program image
+// and the current mainboard's memory store. This must be called whenever the segments
+// change, the memory store is reallocated, or the mainboard changes.
+void V2MP_Supervisor_RefreshSegmentCache(V2MP_Supervisor* supervisor);
 
 bool V2MP_Supervisor_FetchWordFromSegment(
 	const V2MP_Supervisor* supervisor,
@@ -73,10 +150,44 @@ bool V2MP_Supervisor_ReadRangeFromSegment(
 	size_t numBytes
 );
 
+bool V2MP_Supervisor_WriteRangeToSegment(
+	V2MP_Supervisor* supervisor,
+	const MemorySegment* seg,
+	size_t address,
+	const V2MP_Byte* data,
+	size_t numBytes
+);
+
+// Maps the given data page as the data segment. Returns false if there is no such page.
+bool V2MP_Supervisor_MapDataPage(V2MP_Supervisor* supervisor, size_t pageIndex);
+
 void V2MP_Supervisor_SetCPUFault(V2MP_Supervisor* supervisor, V2MP_Word fault);
 size_t V2MP_Supervisor_GetMaxDSBytesAvailableAtAddress(V2MP_Supervisor* supervisor, V2MP_Word address);
 
 V2MP_Word V2MP_Supervisor_FetchInstructionWord(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word* destReg);
+// These perform the operation immediately, and return a fault word indicating the result.
+V2MP_Word V2MP_Supervisor_LoadWordFromDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word* outWord);
+V2MP_Word V2MP_Supervisor_StoreWordToDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word wordToStore);
+V2MP_Word V2MP_Supervisor_PushWordsToStack(V2MP_Supervisor* supervisor, const V2MP_Word* words, size_t numWords);
+V2MP_Word V2MP_Supervisor_PopWordsFromStack(V2MP_Supervisor* supervisor, V2MP_Word* outWords, size_t numWords);
+
+// Copies words from DS to the destination segment, which may be DS itself, in which case
+// the ranges may overlap. Faults if either range is unaligned or lies outside its segment.
+V2MP_Word V2MP_Supervisor_CopyBlockFromDS(
+	V2MP_Supervisor* supervisor,
+	const MemorySegment* destSeg,
+	V2MP_Word destAddress,
+	V2MP_Word sourceAddress,
+	size_t numWords
+);
+
+V2MP_Word V2MP_Supervisor_FillDSBlock(
+	V2MP_Supervisor* supervisor,
+	V2MP_Word destAddress,
+	V2MP_Word value,
+	size_t numWords
+);
+
 void V2MP_Supervisor_RequestLoadWordFromDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_RegisterIndex destReg);
 void V2MP_Supervisor_RequestStoreWordToDS(V2MP_Supervisor* supervisor, V2MP_Word address, V2MP_Word wordToStore);
 
@@ -85,4 +196,6 @@ void V2MP_Supervisor_RequestStackPop(V2MP_Supervisor* supervisor, V2MP_Word regF
 
 void V2MP_Supervisor_RaiseSignal(V2MP_Supervisor* supervisor, V2MP_Word signal, V2MP_Word r1, V2MP_Word lr, V2MP_Word sp);
 
+bool V2MP_Supervisor_CompleteClockCycle(V2MP_Supervisor* supervisor, bool* outProgramExited);
+
 #endif // V2MP_MODULES_SUPERVISOR_INTERNAL_H
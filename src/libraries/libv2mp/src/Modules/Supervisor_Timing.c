@@ -0,0 +1,203 @@
+#include <string.h>
+#include "Modules/Supervisor_Timing.h"
+#include "LibBaseUtil/Heap.h"
+
+#define INVALID_TAG (~(size_t)0)
+
+static inline bool IsPowerOfTwo(size_t value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+static bool ModelIsValid(const V2MP_Supervisor_TimingModel* model)
+{
+	if ( model->cacheNumSets < 1 )
+	{
+		return true;
+	}
+
+	return
+		IsPowerOfTwo(model->cacheNumSets) &&
+		model->cacheNumWays > 0 &&
+		model->cacheNumWays <= (~(size_t)0) / sizeof(size_t) / model->cacheNumSets &&
+		IsPowerOfTwo(model->cacheLineSizeInBytes) &&
+		model->cacheLineSizeInBytes >= sizeof(V2MP_Word);
+}
+
+static inline size_t NumCacheEntries(const V2MP_Supervisor_TimingModel* model)
+{
+	return model->cacheNumSets * model->cacheNumWays;
+}
+
+static void InvalidateCache(V2MP_Supervisor_Timing* timing)
+{
+	size_t index;
+
+	if ( !timing->cacheTags )
+	{
+		return;
+	}
+
+	for ( index = 0; index < NumCacheEntries(&timing->model); ++index )
+	{
+		timing->cacheTags[index] = INVALID_TAG;
+	}
+}
+
+// Returns true if the line was already cached.
+static bool AccessLine(V2MP_Supervisor_Timing* timing, size_t line)
+{
+	const size_t numWays = timing->model.cacheNumWays;
+	size_t* set = &timing->cacheTags[(line & (timing->model.cacheNumSets - 1)) * numWays];
+	size_t way = 0;
+	bool hit;
+
+	while ( way < numWays && set[way] != line )
+	{
+		++way;
+	}
+
+	hit = way < numWays;
+
+	// On a miss, the least recently used line drops off the end of the set.
+	if ( !hit )
+	{
+		way = numWays - 1;
+	}
+
+	// Either way, the line becomes the most recently used.
+	memmove(&set[1], &set[0], way * sizeof(size_t));
+	set[0] = line;
+
+	return hit;
+}
+
+bool V2MP_Supervisor_Timing_Enable(V2MP_Supervisor_Timing* timing, const V2MP_Supervisor_TimingModel* model)
+{
+	size_t* cacheTags = NULL;
+
+	if ( !timing || !model || !ModelIsValid(model) )
+	{
+		return false;
+	}
+
+	if ( model->cacheNumSets > 0 )
+	{
+		cacheTags = (size_t*)BASEUTIL_MALLOC(NumCacheEntries(model) * sizeof(size_t));
+
+		if ( !cacheTags )
+		{
+			return false;
+		}
+	}
+
+	V2MP_Supervisor_Timing_Disable(timing);
+
+	timing->enabled = true;
+	timing->model = *model;
+	timing->cacheTags = cacheTags;
+	timing->lineShift = 0;
+
+	while ( cacheTags && ((size_t)1 << timing->lineShift) < model->cacheLineSizeInBytes )
+	{
+		++timing->lineShift;
+	}
+
+	V2MP_Supervisor_Timing_Reset(timing);
+	return true;
+}
+
+void V2MP_Supervisor_Timing_Disable(V2MP_Supervisor_Timing* timing)
+{
+	if ( !timing )
+	{
+		return;
+	}
+
+	if ( timing->cacheTags )
+	{
+		BASEUTIL_FREE(timing->cacheTags);
+	}
+
+	memset(timing, 0, sizeof(*timing));
+}
+
+bool V2MP_Supervisor_Timing_Copy(V2MP_Supervisor_Timing* timing, const V2MP_Supervisor_Timing* source)
+{
+	if ( !timing || !source || timing == source )
+	{
+		return false;
+	}
+
+	if ( !source->enabled )
+	{
+		V2MP_Supervisor_Timing_Disable(timing);
+		return true;
+	}
+
+	if ( !V2MP_Supervisor_Timing_Enable(timing, &source->model) )
+	{
+		return false;
+	}
+
+	if ( source->cacheTags )
+	{
+		memcpy(timing->cacheTags, source->cacheTags, NumCacheEntries(&source->model) * sizeof(size_t));
+	}
+
+	timing->cacheHits = source->cacheHits;
+	timing->cacheMisses = source->cacheMisses;
+
+	return true;
+}
+
+void V2MP_Supervisor_Timing_Reset(V2MP_Supervisor_Timing* timing)
+{
+	if ( !timing )
+	{
+		return;
+	}
+
+	InvalidateCache(timing);
+	timing->cacheHits = 0;
+	timing->cacheMisses = 0;
+}
+
+size_t V2MP_Supervisor_Timing_Access(
+	V2MP_Supervisor_Timing* timing,
+	size_t baseLatency,
+	size_t address,
+	size_t numBytes
+)
+{
+	size_t latency = baseLatency;
+	size_t line;
+	size_t lastLine;
+
+	if ( !timing || !timing->enabled )
+	{
+		return 0;
+	}
+
+	if ( !timing->cacheTags || numBytes < 1 )
+	{
+		return latency;
+	}
+
+	lastLine = (address + numBytes - 1) >> timing->lineShift;
+
+	for ( line = address >> timing->lineShift; line <= lastLine; ++line )
+	{
+		if ( AccessLine(timing, line) )
+		{
+			++timing->cacheHits;
+		}
+		else
+		{
+			++timing->cacheMisses;
+			latency += timing->model.cacheMissPenalty;
+		}
+	}
+
+	return latency;
+}
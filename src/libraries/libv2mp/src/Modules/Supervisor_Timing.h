@@ -0,0 +1,44 @@
+#ifndef V2MP_MODULES_SUPERVISOR_TIMING_H
+#define V2MP_MODULES_SUPERVISOR_TIMING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "LibV2MP/Modules/Supervisor.h"
+
+// Only the tags of cached lines are simulated: data is always
+// read from and written to the memory store. Each set is ordered
+// from the most to the least recently used line, and the least
+// recently used line is evicted on a miss. Stores allocate lines
+// in the same way as loads.
+typedef struct V2MP_Supervisor_Timing
+{
+	bool enabled;
+	V2MP_Supervisor_TimingModel model;
+
+	// cacheNumSets * cacheNumWays entries, or NULL if no cache is simulated.
+	size_t* cacheTags;
+	size_t lineShift;
+
+	size_t cacheHits;
+	size_t cacheMisses;
+} V2MP_Supervisor_Timing;
+
+// Returns false if the model is invalid or the cache could not be allocated,
+// in which case the timing state is left as it was.
+bool V2MP_Supervisor_Timing_Enable(V2MP_Supervisor_Timing* timing, const V2MP_Supervisor_TimingModel* model);
+void V2MP_Supervisor_Timing_Disable(V2MP_Supervisor_Timing* timing);
+bool V2MP_Supervisor_Timing_Copy(V2MP_Supervisor_Timing* timing, const V2MP_Supervisor_Timing* source);
+
+// Empties the cache and clears the hit and miss counts.
+void V2MP_Supervisor_Timing_Reset(V2MP_Supervisor_Timing* timing);
+
+// Simulates an access to the given range of the memory store, and returns
+// the number of cycles that it takes beyond the cycle that issued it.
+size_t V2MP_Supervisor_Timing_Access(
+	V2MP_Supervisor_Timing* timing,
+	size_t baseLatency,
+	size_t address,
+	size_t numBytes
+);
+
+#endif // V2MP_MODULES_SUPERVISOR_TIMING_H
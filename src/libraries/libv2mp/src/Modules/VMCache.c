@@ -0,0 +1,220 @@
+#include "LibV2MP/Modules/VMCache.h"
+#include "LibV2MP/Modules/VirtualMachine.h"
+#include "LibV2MP/Modules/Supervisor.h"
+#include "LibV2MP/Modules/Mainboard.h"
+#include "LibV2MP/Modules/MemoryStore.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Thread.h"
+
+struct V2MP_VMCache
+{
+	size_t memoryBytesPerVM;
+
+	// Everything below is protected by the mutex.
+	BaseUtil_Mutex* mutex;
+	V2MP_VirtualMachine** idleVMs;
+	size_t numIdleVMs;
+	size_t maxIdleVMs;
+};
+
+static V2MP_VirtualMachine* CreateVM(const V2MP_VMCache* cache)
+{
+	return V2MP_VirtualMachine_AllocateAndInitInSingleBlock(cache->memoryBytesPerVM);
+}
+
+static bool CanBeRecycled(const V2MP_VMCache* cache, V2MP_VirtualMachine* vm)
+{
+	V2MP_MemoryStore* memoryStore = V2MP_Mainboard_GetMemoryStore(V2MP_VirtualMachine_GetMainboard(vm));
+
+	return
+		!V2MP_MemoryStore_IsPaged(memoryStore) &&
+		V2MP_MemoryStore_GetTotalMemorySize(memoryStore) == cache->memoryBytesPerVM;
+}
+
+// Must be called with the mutex locked. Returns NULL if there are no idle VMs.
+static V2MP_VirtualMachine* TakeIdleVM(V2MP_VMCache* cache, const V2MP_ProgramImage* image)
+{
+	V2MP_VirtualMachine* vm;
+	size_t index;
+
+	if ( cache->numIdleVMs < 1 )
+	{
+		return NULL;
+	}
+
+	// Prefer the most recently recycled VM, since its memory is most likely
+	// to still be cached, unless an older one last ran the same image.
+	index = cache->numIdleVMs - 1;
+
+	if ( image )
+	{
+		size_t candidate;
+
+		for ( candidate = cache->numIdleVMs; candidate > 0; --candidate )
+		{
+			if ( V2MP_Supervisor_GetProgramImage(V2MP_VirtualMachine_GetSupervisor(cache->idleVMs[candidate - 1])) == image )
+			{
+				index = candidate - 1;
+				break;
+			}
+		}
+	}
+
+	vm = cache->idleVMs[index];
+	cache->idleVMs[index] = cache->idleVMs[cache->numIdleVMs - 1];
+	--cache->numIdleVMs;
+
+	return vm;
+}
+
+static V2MP_VirtualMachine* Acquire(V2MP_VMCache* cache, const V2MP_ProgramImage* image)
+{
+	V2MP_VirtualMachine* vm;
+
+	BaseUtil_Mutex_Lock(cache->mutex);
+	vm = TakeIdleVM(cache, image);
+	BaseUtil_Mutex_Unlock(cache->mutex);
+
+	// Nothing from the previous user of the VM may be visible to the next.
+	if ( vm && !V2MP_VirtualMachine_ResetProgramState(vm) )
+	{
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+		vm = NULL;
+	}
+
+	return vm ? vm : CreateVM(cache);
+}
+
+V2MP_VMCache* V2MP_VMCache_AllocateAndInit(size_t memoryBytesPerVM, size_t maxIdleVMs)
+{
+	V2MP_VMCache* cache;
+
+	if ( memoryBytesPerVM < sizeof(V2MP_Word) || (memoryBytesPerVM & 0x1) )
+	{
+		return NULL;
+	}
+
+	cache = BASEUTIL_CALLOC_STRUCT(V2MP_VMCache);
+
+	if ( !cache )
+	{
+		return NULL;
+	}
+
+	cache->memoryBytesPerVM = memoryBytesPerVM;
+	cache->maxIdleVMs = maxIdleVMs;
+	cache->mutex = BaseUtil_Mutex_AllocateAndInit();
+
+	if ( maxIdleVMs > 0 )
+	{
+		cache->idleVMs = (V2MP_VirtualMachine**)BASEUTIL_MALLOC(maxIdleVMs * sizeof(V2MP_VirtualMachine*));
+	}
+
+	if ( !cache->mutex || (maxIdleVMs > 0 && !cache->idleVMs) )
+	{
+		V2MP_VMCache_DeinitAndFree(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void V2MP_VMCache_DeinitAndFree(V2MP_VMCache* cache)
+{
+	size_t index;
+
+	if ( !cache )
+	{
+		return;
+	}
+
+	if ( cache->idleVMs )
+	{
+		for ( index = 0; index < cache->numIdleVMs; ++index )
+		{
+			V2MP_VirtualMachine_DeinitAndFree(cache->idleVMs[index]);
+		}
+
+		BASEUTIL_FREE(cache->idleVMs);
+	}
+
+	BaseUtil_Mutex_DeinitAndFree(cache->mutex);
+	BASEUTIL_FREE(cache);
+}
+
+struct V2MP_VirtualMachine* V2MP_VMCache_Acquire(V2MP_VMCache* cache)
+{
+	return cache ? Acquire(cache, NULL) : NULL;
+}
+
+struct V2MP_VirtualMachine* V2MP_VMCache_AcquireWithProgramImage(
+	V2MP_VMCache* cache,
+	struct V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+)
+{
+	V2MP_VirtualMachine* vm;
+
+	if ( !cache || !image )
+	{
+		return NULL;
+	}
+
+	vm = Acquire(cache, image);
+
+	if ( vm && !V2MP_VirtualMachine_LoadProgramImage(vm, image, ds, dsLengthInWords, ssLengthInWords) )
+	{
+		// The VM is still usable, even though the program did not fit.
+		V2MP_VMCache_Recycle(cache, vm);
+		vm = NULL;
+	}
+
+	return vm;
+}
+
+void V2MP_VMCache_Recycle(V2MP_VMCache* cache, struct V2MP_VirtualMachine* vm)
+{
+	bool recycled = false;
+
+	if ( !vm )
+	{
+		return;
+	}
+
+	if ( cache && CanBeRecycled(cache, vm) )
+	{
+		BaseUtil_Mutex_Lock(cache->mutex);
+
+		if ( cache->numIdleVMs < cache->maxIdleVMs )
+		{
+			cache->idleVMs[cache->numIdleVMs++] = vm;
+			recycled = true;
+		}
+
+		BaseUtil_Mutex_Unlock(cache->mutex);
+	}
+
+	if ( !recycled )
+	{
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+	}
+}
+
+size_t V2MP_VMCache_GetIdleCount(V2MP_VMCache* cache)
+{
+	size_t count;
+
+	if ( !cache )
+	{
+		return 0;
+	}
+
+	BaseUtil_Mutex_Lock(cache->mutex);
+	count = cache->numIdleVMs;
+	BaseUtil_Mutex_Unlock(cache->mutex);
+
+	return count;
+}
@@ -0,0 +1,493 @@
+#include <stdint.h>
+#include "LibV2MP/Modules/VMPool.h"
+#include "LibV2MP/Modules/VirtualMachine.h"
+#include "LibBaseUtil/Heap.h"
+#include "LibBaseUtil/Thread.h"
+
+typedef struct Worker
+{
+	// For the work-stealing scheduler, the VMs still to be run this tick
+	// are [queueHead, queueTail). The worker takes VMs from the head, and
+	// other workers steal them from the tail. Since VMs are never added to
+	// a queue once the tick has started, the queue is always a contiguous
+	// range, and is protected by its own mutex rather than the pool's.
+	// These are written throughout the tick, so come first, in the same
+	// cache line as each other.
+	BaseUtil_Mutex* queueMutex;
+	size_t queueHead;
+	size_t queueTail;
+
+	V2MP_VMPool* pool;
+	BaseUtil_Thread* thread;
+	size_t index;
+
+	// The contiguous range of the pool's VMs that this worker is
+	// given by the contiguous and work-stealing schedulers.
+	size_t firstVM;
+	size_t numVMs;
+
+	// Used to pick which worker to steal from.
+	uint32_t randomState;
+
+	// The last tick that this worker ran.
+	size_t tick;
+} Worker;
+
+// The size of a cache line is assumed to be at most this many bytes.
+#define CACHE_LINE_SIZE 64
+
+#define ROUND_UP_TO_CACHE_LINE(size) \
+	(((size) + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1))
+
+struct V2MP_VMPool
+{
+	V2MP_VirtualMachine** vms;
+	V2MP_VMPool_Result* results;
+	size_t numVMs;
+
+	// Each worker is followed by its queue mutex, and both begin on a cache
+	// line and take up whole cache lines, so that workers taking VMs from
+	// their own queues never write to a cache line that holds another
+	// worker's queue or mutex. The workers are allocated in workersBlock,
+	// which may begin before the first worker in order to align it.
+	V2MP_Byte* workers;
+	size_t workerStride;
+	void* workersBlock;
+	size_t numWorkers;
+
+	// Everything below is protected by the mutex.
+	BaseUtil_Mutex* mutex;
+	BaseUtil_CondVar* tickStarted;
+	BaseUtil_CondVar* tickFinished;
+	size_t tick;
+	size_t cycleQuantum;
+	V2MP_VMPool_Scheduler scheduler;
+	size_t workersRunning;
+	bool shuttingDown;
+};
+
+static inline Worker* GetWorker(V2MP_VMPool* pool, size_t index)
+{
+	return (Worker*)(pool->workers + (index * pool->workerStride));
+}
+
+static void RunVM(V2MP_VMPool* pool, size_t index, size_t cycleQuantum)
+{
+	V2MP_VMPool_Result* result = &pool->results[index];
+
+	result->runResult.cyclesExecuted = 0;
+	result->runResult.stopReason = V2MP_RUNSTOP_CYCLE_LIMIT;
+	result->runFailed = !V2MP_VirtualMachine_Run(pool->vms[index], cycleQuantum, &result->runResult);
+}
+
+static uint32_t NextRandom(Worker* worker)
+{
+	// Xorshift: quality is unimportant, it just needs to be cheap,
+	// and to send different workers to different victims.
+	uint32_t value = worker->randomState;
+
+	value ^= value << 13;
+	value ^= value >> 17;
+	value ^= value << 5;
+
+	worker->randomState = value;
+	return value;
+}
+
+static bool TakeFromOwnQueue(Worker* worker, size_t* outIndex)
+{
+	bool taken = false;
+
+	BaseUtil_Mutex_Lock(worker->queueMutex);
+
+	if ( worker->queueHead < worker->queueTail )
+	{
+		*outIndex = worker->queueHead++;
+		taken = true;
+	}
+
+	BaseUtil_Mutex_Unlock(worker->queueMutex);
+	return taken;
+}
+
+static bool StealFromQueue(Worker* victim, size_t* outIndex)
+{
+	bool stolen = false;
+
+	BaseUtil_Mutex_Lock(victim->queueMutex);
+
+	if ( victim->queueHead < victim->queueTail )
+	{
+		*outIndex = --victim->queueTail;
+		stolen = true;
+	}
+
+	BaseUtil_Mutex_Unlock(victim->queueMutex);
+	return stolen;
+}
+
+static bool StealFromAnyWorker(Worker* worker, size_t* outIndex)
+{
+	V2MP_VMPool* pool = worker->pool;
+	size_t start;
+	size_t offset;
+	Worker* victim;
+
+	// Start from a random worker, so that idle workers do not
+	// all converge on the same victim, but then try every other
+	// worker so that no queued VM can be missed.
+	start = (size_t)NextRandom(worker) % pool->numWorkers;
+
+	for ( offset = 0; offset < pool->numWorkers; ++offset )
+	{
+		victim = GetWorker(pool, (start + offset) % pool->numWorkers);
+
+		if ( victim != worker && StealFromQueue(victim, outIndex) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void RunTickForWorker(Worker* worker, V2MP_VMPool_Scheduler scheduler, size_t cycleQuantum)
+{
+	V2MP_VMPool* pool = worker->pool;
+	size_t index;
+
+	switch ( scheduler )
+	{
+		case V2MP_VMPOOL_SCHEDULER_ROUND_ROBIN:
+		{
+			for ( index = worker->index; index < pool->numVMs; index += pool->numWorkers )
+			{
+				RunVM(pool, index, cycleQuantum);
+			}
+
+			break;
+		}
+
+		case V2MP_VMPOOL_SCHEDULER_WORK_STEALING:
+		{
+			// Once every queue is empty, no more work can appear
+			// this tick, so the worker is finished.
+			while ( TakeFromOwnQueue(worker, &index) || StealFromAnyWorker(worker, &index) )
+			{
+				RunVM(pool, index, cycleQuantum);
+			}
+
+			break;
+		}
+
+		default:
+		{
+			for ( index = worker->firstVM; index < worker->firstVM + worker->numVMs; ++index )
+			{
+				RunVM(pool, index, cycleQuantum);
+			}
+
+			break;
+		}
+	}
+}
+
+static void WorkerMain(void* userData)
+{
+	Worker* worker = (Worker*)userData;
+	V2MP_VMPool* pool = worker->pool;
+	size_t cycleQuantum;
+	V2MP_VMPool_Scheduler scheduler;
+
+	BaseUtil_Mutex_Lock(pool->mutex);
+
+	while ( true )
+	{
+		while ( !pool->shuttingDown && worker->tick == pool->tick )
+		{
+			BaseUtil_CondVar_Wait(pool->tickStarted, pool->mutex);
+		}
+
+		if ( pool->shuttingDown )
+		{
+			break;
+		}
+
+		worker->tick = pool->tick;
+		cycleQuantum = pool->cycleQuantum;
+		scheduler = pool->scheduler;
+
+		BaseUtil_Mutex_Unlock(pool->mutex);
+		RunTickForWorker(worker, scheduler, cycleQuantum);
+		BaseUtil_Mutex_Lock(pool->mutex);
+
+		if ( --pool->workersRunning < 1 )
+		{
+			BaseUtil_CondVar_Broadcast(pool->tickFinished);
+		}
+	}
+
+	BaseUtil_Mutex_Unlock(pool->mutex);
+}
+
+static bool CreateVMs(V2MP_VMPool* pool, size_t numVMs, size_t memoryBytesPerVM)
+{
+	size_t index;
+
+	pool->vms = (V2MP_VirtualMachine**)BASEUTIL_CALLOC(numVMs, sizeof(V2MP_VirtualMachine*));
+	pool->results = (V2MP_VMPool_Result*)BASEUTIL_CALLOC(numVMs, sizeof(V2MP_VMPool_Result));
+
+	if ( !pool->vms || !pool->results )
+	{
+		return false;
+	}
+
+	// Set as we go, so that only the VMs that were created are freed on failure.
+	for ( pool->numVMs = 0; pool->numVMs < numVMs; ++pool->numVMs )
+	{
+		index = pool->numVMs;
+		// The pool iterates over every VM each tick, so keep each one compact.
+		pool->vms[index] = V2MP_VirtualMachine_AllocateAndInitInSingleBlock(memoryBytesPerVM);
+
+		if ( !pool->vms[index] )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool StartWorkers(V2MP_VMPool* pool, size_t numWorkers)
+{
+	const size_t workerSize = ROUND_UP_TO_CACHE_LINE(sizeof(Worker));
+	size_t index;
+	Worker* worker;
+	size_t misalignment;
+
+	pool->mutex = BaseUtil_Mutex_AllocateAndInit();
+	pool->tickStarted = BaseUtil_CondVar_AllocateAndInit();
+	pool->tickFinished = BaseUtil_CondVar_AllocateAndInit();
+
+	// The heap only guarantees alignment suitable for any built-in type,
+	// so allocate enough extra to move the workers up to a cache line.
+	pool->workerStride = workerSize + ROUND_UP_TO_CACHE_LINE(BaseUtil_Mutex_GetSize());
+	pool->workersBlock = BASEUTIL_CALLOC(1, (numWorkers * pool->workerStride) + CACHE_LINE_SIZE - 1);
+
+	if ( !pool->mutex || !pool->tickStarted || !pool->tickFinished || !pool->workersBlock )
+	{
+		return false;
+	}
+
+	misalignment = (size_t)((uintptr_t)pool->workersBlock & (CACHE_LINE_SIZE - 1));
+	pool->workers = (V2MP_Byte*)pool->workersBlock + (misalignment > 0 ? CACHE_LINE_SIZE - misalignment : 0);
+
+	for ( pool->numWorkers = 0; pool->numWorkers < numWorkers; ++pool->numWorkers )
+	{
+		index = pool->numWorkers;
+		worker = GetWorker(pool, index);
+
+		worker->pool = pool;
+		worker->index = index;
+		worker->firstVM = (index * pool->numVMs) / numWorkers;
+		worker->numVMs = (((index + 1) * pool->numVMs) / numWorkers) - worker->firstVM;
+		worker->randomState = (uint32_t)(0x9E3779B9u * (uint32_t)(index + 1));
+		worker->tick = pool->tick;
+		worker->queueMutex = BaseUtil_Mutex_InitInPlace((V2MP_Byte*)worker + workerSize);
+		worker->thread = worker->queueMutex ? BaseUtil_Thread_Start(&WorkerMain, worker) : NULL;
+
+		if ( !worker->thread )
+		{
+			// This worker is not counted, so will not be cleaned up later.
+			BaseUtil_Mutex_Deinit(worker->queueMutex);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void StopWorkers(V2MP_VMPool* pool)
+{
+	size_t index;
+	Worker* worker;
+
+	if ( pool->numWorkers > 0 )
+	{
+		BaseUtil_Mutex_Lock(pool->mutex);
+		pool->shuttingDown = true;
+		BaseUtil_CondVar_Broadcast(pool->tickStarted);
+		BaseUtil_Mutex_Unlock(pool->mutex);
+
+		for ( index = 0; index < pool->numWorkers; ++index )
+		{
+			worker = GetWorker(pool, index);
+			BaseUtil_Thread_Join(worker->thread);
+			BaseUtil_Mutex_Deinit(worker->queueMutex);
+		}
+
+		pool->numWorkers = 0;
+	}
+
+	if ( pool->workersBlock )
+	{
+		BASEUTIL_FREE(pool->workersBlock);
+		pool->workersBlock = NULL;
+		pool->workers = NULL;
+	}
+
+	BaseUtil_CondVar_DeinitAndFree(pool->tickFinished);
+	BaseUtil_CondVar_DeinitAndFree(pool->tickStarted);
+	BaseUtil_Mutex_DeinitAndFree(pool->mutex);
+
+	pool->tickFinished = NULL;
+	pool->tickStarted = NULL;
+	pool->mutex = NULL;
+}
+
+V2MP_VMPool* V2MP_VMPool_AllocateAndInit(size_t numVMs, size_t memoryBytesPerVM, size_t numThreads)
+{
+	V2MP_VMPool* pool;
+
+	if ( numVMs < 1 )
+	{
+		return NULL;
+	}
+
+	if ( numThreads < 1 )
+	{
+		numThreads = BaseUtil_Thread_GetProcessorCount();
+	}
+
+	// Any more threads would never have anything to run.
+	if ( numThreads > numVMs )
+	{
+		numThreads = numVMs;
+	}
+
+	pool = BASEUTIL_CALLOC_STRUCT(V2MP_VMPool);
+
+	if ( !pool )
+	{
+		return NULL;
+	}
+
+	pool->scheduler = V2MP_VMPOOL_SCHEDULER_WORK_STEALING;
+
+	if ( !CreateVMs(pool, numVMs, memoryBytesPerVM) || !StartWorkers(pool, numThreads) )
+	{
+		V2MP_VMPool_DeinitAndFree(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+void V2MP_VMPool_DeinitAndFree(V2MP_VMPool* pool)
+{
+	size_t index;
+
+	if ( !pool )
+	{
+		return;
+	}
+
+	StopWorkers(pool);
+
+	if ( pool->vms )
+	{
+		for ( index = 0; index < pool->numVMs; ++index )
+		{
+			V2MP_VirtualMachine_DeinitAndFree(pool->vms[index]);
+		}
+
+		BASEUTIL_FREE(pool->vms);
+	}
+
+	if ( pool->results )
+	{
+		BASEUTIL_FREE(pool->results);
+	}
+
+	BASEUTIL_FREE(pool);
+}
+
+size_t V2MP_VMPool_GetVMCount(const V2MP_VMPool* pool)
+{
+	return pool ? pool->numVMs : 0;
+}
+
+size_t V2MP_VMPool_GetThreadCount(const V2MP_VMPool* pool)
+{
+	return pool ? pool->numWorkers : 0;
+}
+
+bool V2MP_VMPool_SetScheduler(V2MP_VMPool* pool, V2MP_VMPool_Scheduler scheduler)
+{
+	if ( !pool ||
+	     (scheduler != V2MP_VMPOOL_SCHEDULER_CONTIGUOUS &&
+	      scheduler != V2MP_VMPOOL_SCHEDULER_ROUND_ROBIN &&
+	      scheduler != V2MP_VMPOOL_SCHEDULER_WORK_STEALING) )
+	{
+		return false;
+	}
+
+	BaseUtil_Mutex_Lock(pool->mutex);
+	pool->scheduler = scheduler;
+	BaseUtil_Mutex_Unlock(pool->mutex);
+
+	return true;
+}
+
+V2MP_VMPool_Scheduler V2MP_VMPool_GetScheduler(const V2MP_VMPool* pool)
+{
+	return pool ? pool->scheduler : V2MP_VMPOOL_SCHEDULER_CONTIGUOUS;
+}
+
+struct V2MP_VirtualMachine* V2MP_VMPool_GetVM(V2MP_VMPool* pool, size_t index)
+{
+	return (pool && index < pool->numVMs) ? pool->vms[index] : NULL;
+}
+
+bool V2MP_VMPool_RunTick(V2MP_VMPool* pool, size_t cycleQuantum)
+{
+	size_t index;
+	Worker* worker;
+
+	if ( !pool )
+	{
+		return false;
+	}
+
+	BaseUtil_Mutex_Lock(pool->mutex);
+
+	// All workers are idle between ticks, so the queues can be
+	// refilled without taking their locks. Starting each worker
+	// with its own contiguous range means that VMs are only moved
+	// between threads when the work is actually unbalanced.
+	for ( index = 0; index < pool->numWorkers; ++index )
+	{
+		worker = GetWorker(pool, index);
+		worker->queueHead = worker->firstVM;
+		worker->queueTail = worker->firstVM + worker->numVMs;
+	}
+
+	pool->cycleQuantum = cycleQuantum;
+	pool->workersRunning = pool->numWorkers;
+	++pool->tick;
+
+	BaseUtil_CondVar_Broadcast(pool->tickStarted);
+
+	while ( pool->workersRunning > 0 )
+	{
+		BaseUtil_CondVar_Wait(pool->tickFinished, pool->mutex);
+	}
+
+	BaseUtil_Mutex_Unlock(pool->mutex);
+	return true;
+}
+
+const V2MP_VMPool_Result* V2MP_VMPool_GetResult(const V2MP_VMPool* pool, size_t index)
+{
+	return (pool && index < pool->numVMs) ? &pool->results[index] : NULL;
+}
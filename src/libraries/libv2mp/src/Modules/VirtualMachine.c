@@ -1,20 +1,63 @@
+#include <stdint.h>
 #include "LibV2MP/Modules/VirtualMachine.h"
 #include "LibV2MP/Modules/Mainboard.h"
 #include "LibV2MP/Modules/Supervisor.h"
 #include "LibV2MP/Modules/MemoryStore.h"
+#include "LibV2MP/Modules/CPU.h"
 #include "LibBaseUtil/Heap.h"
+#include "Modules/BlockLayout.h"
+#include "Modules/Mainboard_Internal.h"
+#include "Modules/Supervisor_Internal.h"
 
 struct V2MP_VirtualMachine
 {
 	V2MP_Mainboard* mainboard;
 	V2MP_Supervisor* supervisor;
+
+	// If the virtual machine was allocated in a single block, this is
+	// the allocation itself, which may begin before the virtual machine
+	// does in order to align it.
+	void* block;
 };
 
+// Modules are laid out in the order in which they are used when the
+// virtual machine runs, with memory last. See BlockLayout.h.
+static V2MP_VirtualMachine* PlaceInBlock(V2MP_BlockLayout* layout, size_t totalMemoryBytes)
+{
+	V2MP_VirtualMachine* vm;
+	V2MP_Supervisor* supervisor;
+	V2MP_Mainboard* mainboard;
+
+	vm = (V2MP_VirtualMachine*)V2MP_BlockLayout_Reserve(layout, sizeof(V2MP_VirtualMachine));
+	supervisor = V2MP_Supervisor_PlaceInBlock(layout);
+	mainboard = V2MP_Mainboard_PlaceInBlock(layout, totalMemoryBytes);
+
+	if ( vm )
+	{
+		vm->mainboard = mainboard;
+		vm->supervisor = supervisor;
+		vm->block = NULL;
+	}
+
+	return vm;
+}
+
 V2MP_VirtualMachine* V2MP_VirtualMachine_AllocateAndInit(void)
+{
+	return V2MP_VirtualMachine_AllocateAndInitWithMemoryStore(V2MP_MemoryStore_AllocateAndInit());
+}
+
+V2MP_VirtualMachine* V2MP_VirtualMachine_AllocateAndInitWithMemoryStore(struct V2MP_MemoryStore* memoryStore)
 {
 	V2MP_VirtualMachine* vm = BASEUTIL_CALLOC_STRUCT(V2MP_VirtualMachine);
 
-	vm->mainboard = V2MP_Mainboard_AllocateAndInit();
+	if ( !vm )
+	{
+		V2MP_MemoryStore_DeinitAndFree(memoryStore);
+		return NULL;
+	}
+
+	vm->mainboard = V2MP_Mainboard_AllocateAndInitWithMemoryStore(memoryStore);
 	vm->supervisor = V2MP_Supervisor_AllocateAndInit();
 
 	if ( !vm->mainboard || !vm->supervisor )
@@ -28,6 +71,71 @@ V2MP_VirtualMachine* V2MP_VirtualMachine_AllocateAndInit(void)
 	return vm;
 }
 
+V2MP_VirtualMachine* V2MP_VirtualMachine_AllocateAndInitInSingleBlock(size_t totalMemoryBytes)
+{
+	V2MP_BlockLayout layout;
+	V2MP_Byte* block;
+	V2MP_VirtualMachine* vm;
+	size_t misalignment;
+
+	if ( totalMemoryBytes & 0x1 )
+	{
+		return NULL;
+	}
+
+	layout.base = NULL;
+	layout.size = 0;
+	PlaceInBlock(&layout, totalMemoryBytes);
+
+	// The heap only guarantees alignment suitable for any built-in type,
+	// so allocate enough extra to move the base up to the next boundary.
+	block = (V2MP_Byte*)BASEUTIL_CALLOC(1, layout.size + V2MP_BLOCKLAYOUT_ALIGNMENT - 1);
+
+	if ( !block )
+	{
+		return NULL;
+	}
+
+	misalignment = (size_t)((uintptr_t)block & (V2MP_BLOCKLAYOUT_ALIGNMENT - 1));
+
+	layout.base = misalignment > 0 ? block + (V2MP_BLOCKLAYOUT_ALIGNMENT - misalignment) : block;
+	layout.size = 0;
+	vm = PlaceInBlock(&layout, totalMemoryBytes);
+	vm->block = block;
+
+	V2MP_Supervisor_SetMainboard(vm->supervisor, vm->mainboard);
+
+	return vm;
+}
+
+V2MP_VirtualMachine* V2MP_VirtualMachine_Fork(V2MP_VirtualMachine* parent)
+{
+	V2MP_VirtualMachine* vm;
+
+	if ( !parent )
+	{
+		return NULL;
+	}
+
+	vm = V2MP_VirtualMachine_AllocateAndInit();
+
+	if ( !vm )
+	{
+		return NULL;
+	}
+
+	if ( !V2MP_MemoryStore_ForkFrom(
+			V2MP_Mainboard_GetMemoryStore(vm->mainboard),
+			V2MP_Mainboard_GetMemoryStore(parent->mainboard)) ||
+	     !V2MP_Supervisor_CopyProgramState(vm->supervisor, parent->supervisor) )
+	{
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+		return NULL;
+	}
+
+	return vm;
+}
+
 void V2MP_VirtualMachine_DeinitAndFree(V2MP_VirtualMachine* vm)
 {
 	if ( !vm )
@@ -38,7 +146,14 @@ void V2MP_VirtualMachine_DeinitAndFree(V2MP_VirtualMachine* vm)
 	V2MP_Supervisor_DeinitAndFree(vm->supervisor);
 	V2MP_Mainboard_DeinitAndFree(vm->mainboard);
 
-	BASEUTIL_FREE(vm);
+	if ( vm->block )
+	{
+		BASEUTIL_FREE(vm->block);
+	}
+	else
+	{
+		BASEUTIL_FREE(vm);
+	}
 }
 
 struct V2MP_Mainboard* V2MP_VirtualMachine_GetMainboard(V2MP_VirtualMachine* vm)
@@ -79,6 +194,20 @@ bool V2MP_VirtualMachine_AllocateTotalMemory(V2MP_VirtualMachine* vm, size_t siz
 	return V2MP_MemoryStore_AllocateTotalMemory(memoryStore, sizeInBytes);
 }
 
+bool V2MP_VirtualMachine_AllocatePagedMemory(V2MP_VirtualMachine* vm, size_t sizeInBytes)
+{
+	V2MP_MemoryStore* memoryStore;
+
+	if ( !vm )
+	{
+		return false;
+	}
+
+	memoryStore = V2MP_Mainboard_GetMemoryStore(vm->mainboard);
+
+	return V2MP_MemoryStore_AllocatePagedMemory(memoryStore, sizeInBytes);
+}
+
 bool V2MP_VirtualMachine_LoadProgram(
 	V2MP_VirtualMachine* vm,
 	const V2MP_Word* cs,
@@ -93,6 +222,48 @@ bool V2MP_VirtualMachine_LoadProgram(
 		: false;
 }
 
+bool V2MP_VirtualMachine_LoadProgramImage(
+	V2MP_VirtualMachine* vm,
+	struct V2MP_ProgramImage* image,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+)
+{
+	return vm->supervisor
+		? V2MP_Supervisor_LoadProgramImage(vm->supervisor, image, ds, dsLengthInWords, ssLengthInWords)
+		: false;
+}
+
+bool V2MP_VirtualMachine_ResetProgramState(V2MP_VirtualMachine* vm)
+{
+	return vm
+		? V2MP_Supervisor_ResetProgramState(vm->supervisor)
+		: false;
+}
+
+bool V2MP_VirtualMachine_ReloadProgram(
+	V2MP_VirtualMachine* vm,
+	const V2MP_Word* ds,
+	size_t dsLengthInWords,
+	size_t ssLengthInWords
+)
+{
+	return vm
+		? V2MP_Supervisor_ReloadProgram(vm->supervisor, ds, dsLengthInWords, ssLengthInWords)
+		: false;
+}
+
+bool V2MP_VirtualMachine_SetPrecompiledProgram(
+	V2MP_VirtualMachine* vm,
+	const struct V2MP_PrecompiledProgram* program
+)
+{
+	return vm
+		? V2MP_Supervisor_SetPrecompiledProgram(vm->supervisor, program)
+		: false;
+}
+
 void V2MP_VirtualMachine_ClearProgram(V2MP_VirtualMachine* vm)
 {
 	if ( !vm )
@@ -116,3 +287,87 @@ bool V2MP_VirtualMachine_ExecuteClockCycle(V2MP_VirtualMachine* vm)
 		? V2MP_Supervisor_ExecuteClockCycle(vm->supervisor)
 		: false;
 }
+
+bool V2MP_VirtualMachine_Run(V2MP_VirtualMachine* vm, size_t maxCycles, V2MP_RunResult* outResult)
+{
+	return vm
+		? V2MP_Supervisor_Run(vm->supervisor, maxCycles, outResult)
+		: false;
+}
+
+bool V2MP_VirtualMachine_RunLockstep(
+	V2MP_VirtualMachine* const* vms,
+	size_t numVMs,
+	size_t maxCycles,
+	V2MP_RunResult* outResults
+)
+{
+	V2MP_CPU* cpus[V2MP_CPU_LOCKSTEP_LANES];
+	V2MP_RunResult cpuResults[V2MP_CPU_LOCKSTEP_LANES];
+	size_t vmIndices[V2MP_CPU_LOCKSTEP_LANES];
+	size_t numCPUs = 0;
+	size_t index;
+	size_t cpuIndex;
+
+	if ( (!vms || !outResults) && numVMs > 0 )
+	{
+		return false;
+	}
+
+	for ( index = 0; index < numVMs; ++index )
+	{
+		if ( !vms[index] )
+		{
+			return false;
+		}
+
+		// As with V2MP_Supervisor_Run(), a program that has
+		// already exited does not run any more cycles.
+		if ( V2MP_Supervisor_HasProgramExited(vms[index]->supervisor) )
+		{
+			outResults[index].cyclesExecuted = 0;
+			outResults[index].stopReason = V2MP_RUNSTOP_PROGRAM_EXITED;
+		}
+		else
+		{
+			cpus[numCPUs] = V2MP_Mainboard_GetCPU(vms[index]->mainboard);
+			vmIndices[numCPUs] = index;
+			++numCPUs;
+		}
+
+		// Run the CPUs in full groups wherever possible.
+		if ( numCPUs == V2MP_CPU_LOCKSTEP_LANES || (index + 1 == numVMs && numCPUs > 0) )
+		{
+			if ( !V2MP_CPU_RunLockstep(cpus, numCPUs, maxCycles, cpuResults) )
+			{
+				return false;
+			}
+
+			for ( cpuIndex = 0; cpuIndex < numCPUs; ++cpuIndex )
+			{
+				outResults[vmIndices[cpuIndex]] = cpuResults[cpuIndex];
+			}
+
+			numCPUs = 0;
+		}
+	}
+
+	return true;
+}
+
+void V2MP_VirtualMachine_SetBlockTranslationEnabled(V2MP_VirtualMachine* vm, bool enabled)
+{
+	if ( !vm )
+	{
+		return;
+	}
+
+	V2MP_CPU_SetBlockTranslationEnabled(V2MP_Mainboard_GetCPU(vm->mainboard), enabled);
+}
+
+bool V2MP_VirtualMachine_IsBlockTranslationEnabled(const V2MP_VirtualMachine* vm)
+{
+	return vm
+		? V2MP_CPU_IsBlockTranslationEnabled(V2MP_Mainboard_GetCPU(vm->mainboard))
+		: false;
+}
@@ -0,0 +1,63 @@
+// Generates a C source file containing the decoded form of every
+// possible 16-bit instruction word, using the same decoder that the
+// library uses at runtime. The output is compiled into LibV2MP when
+// V2MP_FULL_DECODE_TABLE is enabled.
+
+#include <stdio.h>
+#include "Modules/CPU_Decode.h"
+
+#define NUM_INSTRUCTION_WORDS 0x10000
+
+int main(int argc, char** argv)
+{
+	FILE* outFile;
+	size_t word;
+
+	if ( argc != 2 )
+	{
+		fprintf(stderr, "Usage: %s <output file>\n", argc > 0 ? argv[0] : "DecodeTableGenerator");
+		return 1;
+	}
+
+	outFile = fopen(argv[1], "w");
+
+	if ( !outFile )
+	{
+		fprintf(stderr, "Could not open %s for writing.\n", argv[1]);
+		return 1;
+	}
+
+	fprintf(outFile, "// Generated by DecodeTableGenerator - do not edit.\n\n");
+	fprintf(outFile, "#include \"Modules/CPU_Decode.h\"\n\n");
+	fprintf(outFile, "const V2MP_CPU_DecodedInstruction V2MP_CPU_DECODE_TABLE[0x10000] =\n{\n");
+
+	for ( word = 0; word < NUM_INSTRUCTION_WORDS; ++word )
+	{
+		V2MP_CPU_DecodedInstruction decoded;
+
+		V2MP_CPU_DecodeInstruction((V2MP_Word)word, &decoded);
+
+		fprintf(
+			outFile,
+			"\t{ 0x%04X, 0x%04X, 0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%02X }%s\n",
+			(unsigned int)decoded.word,
+			(unsigned int)decoded.immediate,
+			(unsigned int)decoded.handler,
+			(unsigned int)decoded.sourceReg,
+			(unsigned int)decoded.destReg,
+			(unsigned int)decoded.flags,
+			(unsigned int)decoded.fusion,
+			word + 1 < NUM_INSTRUCTION_WORDS ? "," : ""
+		);
+	}
+
+	fprintf(outFile, "};\n");
+
+	if ( fclose(outFile) != 0 )
+	{
+		fprintf(stderr, "Failed to write %s.\n", argv[1]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * Custom generated header according to this library's build configuration.
+ * Exported public functions in this library are declared like so:
+ *
+ * LIBV2MPLINK_PUBLIC(int) MyExportedFunction(int in);
+ */
+
+#ifndef LIBV2MPLINK_EXPORT_H
+#define LIBV2MPLINK_EXPORT_H
+
+////////////////////////////////////////////
+// Extern c
+////////////////////////////////////////////
+
+#ifdef __cplusplus
+// C++ needs extern C annotation
+#	define LIBV2MPLINK_EXTERNC extern "C"
+#else
+// C does not need this annotation
+#	define LIBV2MPLINK_EXTERNC
+#endif // __cplusplus
+
+#ifdef _WIN32
+
+////////////////////////////////////////////
+// Begin Windows
+////////////////////////////////////////////
+
+// Windows supports specifying the cdecl calling convention
+#	define LIBV2MPLINK_CDECL __cdecl
+
+#	ifdef LIBV2MPLINK_PRODUCER
+		// Shared library is being built, so mark functions for export
+# 		define LIBV2MPLINK_EXPORT __declspec(dllexport)
+#	else
+		// Shared library is being used, so mark functions for import
+#		define LIBV2MPLINK_EXPORT __declspec(dllimport)
+#	endif // LIBV2MPLINK_PRODUCER
+
+////////////////////////////////////////////
+// End Windows
+////////////////////////////////////////////
+
+#else
+
+////////////////////////////////////////////
+// Begin Linux
+////////////////////////////////////////////
+
+// Not on Windows, so cdecl is not required
+#	define LIBV2MPLINK_CDECL
+
+	// Shared library is being built, so mark exported functions as visible
+#	define LIBV2MPLINK_EXPORT __attribute__((visibility("default")))
+
+////////////////////////////////////////////
+// End Linux
+////////////////////////////////////////////
+
+#endif // _WIN32
+
+// Now combine all of these switches into a macro that exposes a function in the library's public API:
+#define LIBV2MPLINK_PUBLIC(returnType) LIBV2MPLINK_EXTERNC LIBV2MPLINK_EXPORT returnType LIBV2MPLINK_CDECL
+
+#endif // LIBV2MPLINK_EXPORT_H
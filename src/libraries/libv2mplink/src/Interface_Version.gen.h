@@ -0,0 +1,14 @@
+// This file is generated by CMake. Do not edit it manually!
+
+#pragma once
+
+#include <cstdint>
+
+namespace V2MPLink
+{
+	static constexpr int32_t VERSION_MAJOR = 1;
+	static constexpr int32_t VERSION_MINOR = 0;
+	static constexpr int32_t VERSION_PATCH = 0;
+	static constexpr const char* const VERSION_STRING = "1.0.0";
+	static constexpr const char* const BUILD_IDENTIFIER_STRING = "";
+}
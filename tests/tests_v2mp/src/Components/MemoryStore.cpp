@@ -0,0 +1,548 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#include "catch2/catch.hpp"
+#include "LibV2MP/Modules/MemoryStore.h"
+
+static constexpr size_t PAGED_MEMORY_BYTES = 4 * V2MP_MEMORYSTORE_PAGE_SIZE;
+
+static std::vector<V2MP_Byte> GetAndClearDirtyPages(V2MP_MemoryStore* mem)
+{
+	std::vector<V2MP_Byte> bitmap(V2MP_MemoryStore_GetDirtyPageBitmapSize(mem));
+	REQUIRE(V2MP_MemoryStore_GetAndClearDirtyPages(mem, bitmap.data(), bitmap.size()));
+	return bitmap;
+}
+
+SCENARIO("Allocating paged memory", "[components]")
+{
+	GIVEN("A memory store")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(mem);
+
+		WHEN("Paged memory is allocated")
+		{
+			REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES));
+
+			THEN("The memory store is paged, and no pages are committed")
+			{
+				CHECK(V2MP_MemoryStore_IsPaged(mem));
+				CHECK(V2MP_MemoryStore_GetTotalMemorySize(mem) == PAGED_MEMORY_BYTES);
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == 0);
+				CHECK(V2MP_MemoryStore_GetPtrToBase(mem) == nullptr);
+			}
+
+			AND_THEN("Reads from uncommitted pages return zero without committing them")
+			{
+				V2MP_Word word = 0xFFFF;
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE, &word));
+				CHECK(word == 0);
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == 0);
+			}
+		}
+
+		AND_WHEN("Contiguous memory is allocated after paged memory")
+		{
+			REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES));
+			REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, PAGED_MEMORY_BYTES));
+
+			THEN("The memory store is no longer paged, and all of its memory is committed")
+			{
+				CHECK_FALSE(V2MP_MemoryStore_IsPaged(mem));
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == PAGED_MEMORY_BYTES);
+				CHECK(V2MP_MemoryStore_GetPtrToBase(mem) != nullptr);
+			}
+		}
+
+		AND_WHEN("Paged memory of an odd size is allocated")
+		{
+			THEN("The allocation fails")
+			{
+				CHECK_FALSE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES + 1));
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+}
+
+SCENARIO("Accessing paged memory", "[components]")
+{
+	GIVEN("A memory store with paged memory")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(mem);
+		REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES));
+
+		WHEN("A word is stored")
+		{
+			REQUIRE(V2MP_MemoryStore_StoreWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE + 2, 0x1234));
+
+			THEN("Only the page containing the word is committed")
+			{
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == V2MP_MEMORYSTORE_PAGE_SIZE);
+			}
+
+			AND_THEN("The word can be loaded again")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE + 2, &word));
+				CHECK(word == 0x1234);
+			}
+		}
+
+		AND_WHEN("A range that spans a page boundary is written")
+		{
+			std::vector<V2MP_Byte> data(8);
+
+			for ( size_t index = 0; index < data.size(); ++index )
+			{
+				data[index] = static_cast<V2MP_Byte>(index + 1);
+			}
+
+			const size_t base = V2MP_MEMORYSTORE_PAGE_SIZE - (data.size() / 2);
+			REQUIRE(V2MP_MemoryStore_WriteRange(mem, base, data.data(), data.size()));
+
+			THEN("Both pages are committed")
+			{
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == 2 * V2MP_MEMORYSTORE_PAGE_SIZE);
+			}
+
+			AND_THEN("The range can be read back")
+			{
+				std::vector<V2MP_Byte> readBack(data.size());
+				REQUIRE(V2MP_MemoryStore_ReadRange(mem, base, readBack.data(), readBack.size()));
+				CHECK(readBack == data);
+			}
+
+			AND_THEN("A pointer to the range cannot be obtained, but pointers within each page can")
+			{
+				CHECK(V2MP_MemoryStore_GetPtrToRange(mem, base, data.size()) == nullptr);
+				CHECK(V2MP_MemoryStore_GetConstPtrToRange(mem, base, data.size()) == nullptr);
+
+				const V2MP_Byte* secondHalf = V2MP_MemoryStore_GetConstPtrToRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE, data.size() / 2);
+				REQUIRE(secondHalf);
+				CHECK(secondHalf[0] == data[data.size() / 2]);
+			}
+		}
+
+		AND_WHEN("A range that extends past the end of memory is accessed")
+		{
+			V2MP_Byte data[4] = { 0 };
+
+			THEN("The access fails, and no pages are committed")
+			{
+				CHECK_FALSE(V2MP_MemoryStore_WriteRange(mem, PAGED_MEMORY_BYTES - 2, data, sizeof(data)));
+				CHECK_FALSE(V2MP_MemoryStore_ReadRange(mem, PAGED_MEMORY_BYTES - 2, data, sizeof(data)));
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == 0);
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+}
+
+SCENARIO("Forking memory", "[components]")
+{
+	GIVEN("A memory store with paged memory, where two pages have been written to")
+	{
+		V2MP_MemoryStore* parent = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(parent);
+		REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(parent, PAGED_MEMORY_BYTES));
+		REQUIRE(V2MP_MemoryStore_StoreWord(parent, 0, 0x1111));
+		REQUIRE(V2MP_MemoryStore_StoreWord(parent, V2MP_MEMORYSTORE_PAGE_SIZE, 0x2222));
+
+		V2MP_MemoryStore* child = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(child);
+
+		WHEN("Another memory store is forked from it")
+		{
+			REQUIRE(V2MP_MemoryStore_ForkFrom(child, parent));
+
+			THEN("The forked store shares all of the committed pages")
+			{
+				CHECK(V2MP_MemoryStore_IsPaged(child));
+				CHECK(V2MP_MemoryStore_GetTotalMemorySize(child) == PAGED_MEMORY_BYTES);
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(child) == 2 * V2MP_MEMORYSTORE_PAGE_SIZE);
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(child) == 2 * V2MP_MEMORYSTORE_PAGE_SIZE);
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(parent) == 2 * V2MP_MEMORYSTORE_PAGE_SIZE);
+				CHECK(V2MP_MemoryStore_GetConstPtrToRange(child, 0, 2) == V2MP_MemoryStore_GetConstPtrToRange(parent, 0, 2));
+			}
+
+			AND_THEN("The forked store contains the same data")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(V2MP_MemoryStore_LoadWord(child, V2MP_MEMORYSTORE_PAGE_SIZE, &word));
+				CHECK(word == 0x2222);
+			}
+		}
+
+		AND_WHEN("The forked store writes to a shared page")
+		{
+			REQUIRE(V2MP_MemoryStore_ForkFrom(child, parent));
+			REQUIRE(V2MP_MemoryStore_StoreWord(child, 0, 0x3333));
+
+			THEN("Only that page is copied")
+			{
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(child) == V2MP_MEMORYSTORE_PAGE_SIZE);
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(parent) == V2MP_MEMORYSTORE_PAGE_SIZE);
+				CHECK(V2MP_MemoryStore_GetConstPtrToRange(child, 0, 2) != V2MP_MemoryStore_GetConstPtrToRange(parent, 0, 2));
+			}
+
+			AND_THEN("The write is not visible to the original store")
+			{
+				V2MP_Word parentWord = 0;
+				V2MP_Word childWord = 0;
+
+				REQUIRE(V2MP_MemoryStore_LoadWord(parent, 0, &parentWord));
+				REQUIRE(V2MP_MemoryStore_LoadWord(child, 0, &childWord));
+				CHECK(parentWord == 0x1111);
+				CHECK(childWord == 0x3333);
+			}
+		}
+
+		AND_WHEN("The original store is freed after forking")
+		{
+			REQUIRE(V2MP_MemoryStore_ForkFrom(child, parent));
+			V2MP_MemoryStore_DeinitAndFree(parent);
+			parent = nullptr;
+
+			THEN("The forked store still holds the pages, and no longer shares them")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(V2MP_MemoryStore_LoadWord(child, 0, &word));
+				CHECK(word == 0x1111);
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(child) == 0);
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(child);
+		V2MP_MemoryStore_DeinitAndFree(parent);
+	}
+
+	GIVEN("A memory store with contiguous memory")
+	{
+		V2MP_MemoryStore* parent = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(parent);
+		REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(parent, PAGED_MEMORY_BYTES));
+		REQUIRE(V2MP_MemoryStore_StoreWord(parent, 0, 0x1111));
+
+		V2MP_MemoryStore* child = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(child);
+
+		WHEN("Another memory store is forked from it, and written to")
+		{
+			REQUIRE(V2MP_MemoryStore_ForkFrom(child, parent));
+			REQUIRE(V2MP_MemoryStore_StoreWord(child, 0, 0x3333));
+
+			THEN("The memory was copied in full")
+			{
+				V2MP_Word parentWord = 0;
+
+				CHECK_FALSE(V2MP_MemoryStore_IsPaged(child));
+				CHECK(V2MP_MemoryStore_GetTotalMemorySize(child) == PAGED_MEMORY_BYTES);
+				CHECK(V2MP_MemoryStore_GetSharedMemorySize(child) == 0);
+
+				REQUIRE(V2MP_MemoryStore_LoadWord(parent, 0, &parentWord));
+				CHECK(parentWord == 0x1111);
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(child);
+		V2MP_MemoryStore_DeinitAndFree(parent);
+	}
+}
+
+SCENARIO("Tracking dirty pages", "[components]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A memory store with ") + (paged ? "paged" : "contiguous") + " memory")
+		{
+			V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInit();
+			REQUIRE(mem);
+
+			if ( paged )
+			{
+				REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES));
+			}
+			else
+			{
+				REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, PAGED_MEMORY_BYTES));
+			}
+
+			WHEN("Nothing has been written")
+			{
+				THEN("The bitmap has one bit per page, and no pages are dirty")
+				{
+					REQUIRE(V2MP_MemoryStore_GetDirtyPageBitmapSize(mem) == 1);
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x00 });
+				}
+			}
+
+			AND_WHEN("A word is stored, and a range that spans two pages is written")
+			{
+				V2MP_Byte data[4] = { 1, 2, 3, 4 };
+
+				REQUIRE(V2MP_MemoryStore_StoreWord(mem, 2, 0x1234));
+				REQUIRE(V2MP_MemoryStore_WriteRange(mem, (3 * V2MP_MEMORYSTORE_PAGE_SIZE) - 2, data, sizeof(data)));
+
+				THEN("Exactly the pages that were written to are dirty")
+				{
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x0D });
+				}
+
+				AND_THEN("Querying the dirty pages clears them")
+				{
+					GetAndClearDirtyPages(mem);
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x00 });
+				}
+			}
+
+			AND_WHEN("Memory is only read from")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE, &word));
+				REQUIRE(V2MP_MemoryStore_GetConstPtrToRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE, sizeof(word)));
+
+				THEN("No pages are dirty")
+				{
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x00 });
+				}
+			}
+
+			AND_WHEN("A writable pointer to a range is obtained")
+			{
+				REQUIRE(V2MP_MemoryStore_GetPtrToRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE, sizeof(V2MP_Word)));
+
+				THEN("The page containing the range is dirty")
+				{
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x02 });
+				}
+			}
+
+			AND_WHEN("The dirty pages are queried with a buffer that is too small")
+			{
+				REQUIRE(V2MP_MemoryStore_StoreWord(mem, 0, 0x1234));
+
+				THEN("The query fails, and the dirty pages are not cleared")
+				{
+					V2MP_Byte byte = 0;
+					CHECK_FALSE(V2MP_MemoryStore_GetAndClearDirtyPages(mem, &byte, 0));
+					CHECK(GetAndClearDirtyPages(mem) == std::vector<V2MP_Byte>{ 0x01 });
+				}
+			}
+
+			AND_WHEN("Another memory store is forked from it")
+			{
+				REQUIRE(V2MP_MemoryStore_StoreWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE, 0x1234));
+
+				V2MP_MemoryStore* child = V2MP_MemoryStore_AllocateAndInit();
+				REQUIRE(child);
+				REQUIRE(V2MP_MemoryStore_ForkFrom(child, mem));
+
+				THEN("All of the memory that the forked store inherited is dirty")
+				{
+					CHECK(GetAndClearDirtyPages(child) == std::vector<V2MP_Byte>{ static_cast<V2MP_Byte>(paged ? 0x02 : 0x0F) });
+				}
+
+				V2MP_MemoryStore_DeinitAndFree(child);
+			}
+
+			V2MP_MemoryStore_DeinitAndFree(mem);
+		}
+	}
+}
+
+SCENARIO("Zeroing a range of memory", "[components]")
+{
+	GIVEN("A memory store with paged memory, where one page has been written to")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(mem);
+		REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(mem, PAGED_MEMORY_BYTES));
+
+		std::vector<V2MP_Byte> data(V2MP_MEMORYSTORE_PAGE_SIZE, 0xAB);
+		REQUIRE(V2MP_MemoryStore_WriteRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE, data.data(), data.size()));
+
+		WHEN("A range that covers part of that page and all of an uncommitted page is zeroed")
+		{
+			REQUIRE(V2MP_MemoryStore_ZeroRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE + 2, 2 * V2MP_MEMORYSTORE_PAGE_SIZE - 2));
+
+			THEN("Only the range within the committed page is cleared, and no page is committed")
+			{
+				V2MP_Word word = 0;
+
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE, &word));
+				CHECK(word == 0xABAB);
+
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE + 2, &word));
+				CHECK(word == 0);
+
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, (2 * V2MP_MEMORYSTORE_PAGE_SIZE) - 2, &word));
+				CHECK(word == 0);
+
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(mem) == V2MP_MEMORYSTORE_PAGE_SIZE);
+			}
+		}
+
+		AND_WHEN("A range that extends past the end of memory is zeroed")
+		{
+			THEN("Nothing is changed")
+			{
+				V2MP_Word word = 0;
+
+				CHECK_FALSE(V2MP_MemoryStore_ZeroRange(mem, V2MP_MEMORYSTORE_PAGE_SIZE, PAGED_MEMORY_BYTES));
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, V2MP_MEMORYSTORE_PAGE_SIZE, &word));
+				CHECK(word == 0xABAB);
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+
+	GIVEN("A memory store with contiguous memory")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInit();
+		REQUIRE(mem);
+		REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, PAGED_MEMORY_BYTES));
+
+		std::vector<V2MP_Byte> data(PAGED_MEMORY_BYTES, 0xAB);
+		REQUIRE(V2MP_MemoryStore_WriteRange(mem, 0, data.data(), data.size()));
+		GetAndClearDirtyPages(mem);
+
+		WHEN("A range is zeroed")
+		{
+			REQUIRE(V2MP_MemoryStore_ZeroRange(mem, 2, 4));
+
+			THEN("Only that range is cleared, and its page is marked dirty")
+			{
+				V2MP_Word words[4] = { 0, 0, 0, 0 };
+				REQUIRE(V2MP_MemoryStore_ReadRange(mem, 0, reinterpret_cast<V2MP_Byte*>(words), sizeof(words)));
+
+				CHECK(words[0] == 0xABAB);
+				CHECK(words[1] == 0);
+				CHECK(words[2] == 0);
+				CHECK(words[3] == 0xABAB);
+
+				const std::vector<V2MP_Byte> bitmap = GetAndClearDirtyPages(mem);
+				REQUIRE(bitmap.size() == 1);
+				CHECK(bitmap[0] == 0x01);
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+}
+
+SCENARIO("Backing memory with huge pages", "[components]")
+{
+	GIVEN("A memory store that is backed by huge pages")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MEMORYSTORE_BACKING_HUGE_PAGES, nullptr);
+		REQUIRE(mem);
+		CHECK(V2MP_MemoryStore_GetBacking(mem) == V2MP_MEMORYSTORE_BACKING_HUGE_PAGES);
+
+		WHEN("Contiguous memory is allocated")
+		{
+			static constexpr size_t MEMORY_SIZE = 4 * 1024 * 1024;
+			REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, MEMORY_SIZE));
+
+			THEN("The memory is filled with zeroes, and can be written to")
+			{
+				V2MP_Word word = 0xFFFF;
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, MEMORY_SIZE - sizeof(V2MP_Word), &word));
+				CHECK(word == 0);
+
+				REQUIRE(V2MP_MemoryStore_StoreWord(mem, MEMORY_SIZE - sizeof(V2MP_Word), 0x1234));
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, MEMORY_SIZE - sizeof(V2MP_Word), &word));
+				CHECK(word == 0x1234);
+			}
+
+			AND_THEN("The memory can be reallocated")
+			{
+				REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, 64));
+				CHECK(V2MP_MemoryStore_GetTotalMemorySize(mem) == 64);
+			}
+		}
+
+		AND_WHEN("Paged memory is allocated")
+		{
+			THEN("The allocation fails")
+			{
+				CHECK_FALSE(V2MP_MemoryStore_AllocatePagedMemory(mem, 64));
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+}
+
+SCENARIO("Backing memory with a file", "[components]")
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "V2MP_Tests_MemoryStore.bin").string();
+	std::filesystem::remove(path);
+
+	WHEN("A memory store is created with a file backing but no file path")
+	{
+		THEN("The store is not created")
+		{
+			CHECK(V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MEMORYSTORE_BACKING_FILE, nullptr) == nullptr);
+		}
+	}
+
+	GIVEN("A memory store that is backed by a file")
+	{
+		V2MP_MemoryStore* mem = V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MEMORYSTORE_BACKING_FILE, path.c_str());
+		REQUIRE(mem);
+		CHECK(V2MP_MemoryStore_GetBacking(mem) == V2MP_MEMORYSTORE_BACKING_FILE);
+
+		REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, 64));
+		REQUIRE(V2MP_MemoryStore_StoreWord(mem, 2, 0x1234));
+
+		WHEN("The file is read while the memory is in use")
+		{
+			std::ifstream file(path, std::ios::binary);
+			std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+			THEN("The file holds the contents of memory")
+			{
+				V2MP_Word word = 0;
+
+				REQUIRE(contents.size() == 64);
+				std::memcpy(&word, contents.data() + 2, sizeof(word));
+				CHECK(word == 0x1234);
+			}
+		}
+
+		AND_WHEN("The store is freed, and a new store is created from the same file")
+		{
+			V2MP_MemoryStore_DeinitAndFree(mem);
+
+			mem = V2MP_MemoryStore_AllocateAndInitWithBacking(V2MP_MEMORYSTORE_BACKING_FILE, path.c_str());
+			REQUIRE(mem);
+			REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(mem, 64));
+
+			THEN("The contents of memory have persisted")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(V2MP_MemoryStore_LoadWord(mem, 2, &word));
+				CHECK(word == 0x1234);
+			}
+		}
+
+		AND_WHEN("Paged memory is allocated")
+		{
+			THEN("The allocation fails")
+			{
+				CHECK_FALSE(V2MP_MemoryStore_AllocatePagedMemory(mem, 64));
+			}
+		}
+
+		V2MP_MemoryStore_DeinitAndFree(mem);
+	}
+
+	std::filesystem::remove(path);
+}
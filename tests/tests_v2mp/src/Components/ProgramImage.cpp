@@ -0,0 +1,47 @@
+#include "catch2/catch.hpp"
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "TestUtil/Assembly.h"
+
+SCENARIO("Creating a program image", "[components]")
+{
+	static const V2MP_Word CS[] =
+	{
+		Asm::ASGNL(Asm::REG_R0, 5),
+		Asm::ADDL(Asm::REG_R0, 1)
+	};
+
+	WHEN("A program image is created from an empty code segment")
+	{
+		THEN("A null pointer is returned")
+		{
+			CHECK(V2MP_ProgramImage_AllocateAndInit(CS, 0) == nullptr);
+			CHECK(V2MP_ProgramImage_AllocateAndInit(nullptr, 2) == nullptr);
+		}
+	}
+
+	AND_WHEN("A program image is created from a valid code segment")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(CS, 2);
+		REQUIRE(image);
+
+		THEN("The image holds a copy of the code segment, and one reference")
+		{
+			CHECK(V2MP_ProgramImage_GetRefCount(image) == 1);
+			REQUIRE(V2MP_ProgramImage_GetCSLengthInWords(image) == 2);
+			CHECK(V2MP_ProgramImage_GetCS(image) != CS);
+			CHECK(V2MP_ProgramImage_GetCS(image)[0] == CS[0]);
+			CHECK(V2MP_ProgramImage_GetCS(image)[1] == CS[1]);
+		}
+
+		AND_THEN("References can be added and released")
+		{
+			CHECK(V2MP_ProgramImage_AddRef(image) == image);
+			CHECK(V2MP_ProgramImage_GetRefCount(image) == 2);
+
+			V2MP_ProgramImage_Release(image);
+			CHECK(V2MP_ProgramImage_GetRefCount(image) == 1);
+		}
+
+		V2MP_ProgramImage_Release(image);
+	}
+}
@@ -0,0 +1,158 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+static constexpr V2MP_Word EXIT_CODE = 7;
+
+SCENARIO("Run: A program that raises the \"End Program\" signal stops the run", "[execution]")
+{
+	GIVEN("A virtual machine with a program that exits after three instructions")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::ASGNL(Asm::REG_R1, EXIT_CODE),
+			Asm::SIG()
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run with a cycle budget larger than the program")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The run stops after the signal is raised, and the exit code is set")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(result.cyclesExecuted == 3);
+				CHECK(vm.HasProgramExited());
+				CHECK(vm.GetProgramExitCode() == EXIT_CODE);
+				CHECK_FALSE(vm.CPUHasFault());
+			}
+
+			AND_WHEN("The program is run again")
+			{
+				REQUIRE(vm.Run(100, result));
+
+				THEN("No further cycles are executed")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(result.cyclesExecuted == 0);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Run: A program that does not exit stops when the cycle budget is used up", "[execution]")
+{
+	GIVEN("A virtual machine with a program that increments R0 in an infinite loop")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::ADDL(Asm::REG_R0, 1),
+			Asm::SUBL(Asm::REG_PC, 2)
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run with a budget of 100 cycles")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("Exactly 100 cycles are executed")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(result.cyclesExecuted == 100);
+				CHECK(vm.GetR0() == 50);
+				CHECK(vm.GetPC() == 0);
+				CHECK_FALSE(vm.HasProgramExited());
+				CHECK_FALSE(vm.CPUHasFault());
+			}
+
+			AND_WHEN("The program is run for another 10 cycles")
+			{
+				REQUIRE(vm.Run(10, result));
+
+				THEN("Execution continues from where it left off")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+					CHECK(result.cyclesExecuted == 10);
+					CHECK(vm.GetR0() == 55);
+				}
+			}
+		}
+
+		WHEN("The program is run with a budget of zero cycles")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(0, result));
+
+			THEN("No cycles are executed")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(result.cyclesExecuted == 0);
+				CHECK(vm.GetR0() == 0);
+				CHECK(vm.GetPC() == 0);
+			}
+		}
+	}
+}
+
+SCENARIO("Run: A fault raised by the program stops the run", "[execution]")
+{
+	GIVEN("A virtual machine with a program that divides by zero on its second instruction")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::NOP(),
+			Asm::DIVL(Asm::REG_R0, 0),
+			Asm::NOP()
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The run stops on the cycle that raised the fault")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 2);
+				CHECK(vm.CPUHasFault());
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_DIV);
+				CHECK(vm.GetPC() == 4);
+			}
+
+			AND_WHEN("The program is run again")
+			{
+				REQUIRE(vm.Run(100, result));
+
+				THEN("No further cycles are executed")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+					CHECK(result.cyclesExecuted == 0);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,339 @@
+#include <string>
+#include <vector>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	// Raises the given block signal for R1 = numWords and LR = 0, then exits.
+	struct BlockSignalProgram
+	{
+		V2MP_Word cs[6];
+
+		BlockSignalProgram(V2MP_Word signal, V2MP_Word numWords) :
+			cs
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::ASGNL(Asm::REG_R1, static_cast<uint8_t>(numWords)),
+				Asm::ASGNL(Asm::REG_R0, static_cast<uint8_t>(signal)),
+				Asm::SIG(),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			}
+		{
+		}
+	};
+
+	template<size_t DSN>
+	void LoadBlockSignalProgram(
+		TestHarnessVM& vm,
+		V2MP_Word signal,
+		V2MP_Word numWords,
+		const V2MP_Word (&ds)[DSN],
+		V2MP_Word ssWords = 0
+	)
+	{
+		const BlockSignalProgram program(signal, numWords);
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(program.cs, ds);
+		prog.SetStackSize(ssWords);
+
+		REQUIRE(vm.LoadProgram(prog));
+	}
+
+	std::vector<V2MP_Word> GetDSWords(TestHarnessVM& vm, V2MP_Word address, size_t numWords)
+	{
+		std::vector<V2MP_Word> words;
+
+		for ( size_t index = 0; index < numWords; ++index )
+		{
+			V2MP_Word word = 0;
+			REQUIRE(vm.GetDSWord(static_cast<V2MP_Word>(address + (index * sizeof(V2MP_Word))), word));
+			words.push_back(word);
+		}
+
+		return words;
+	}
+}
+
+SCENARIO("Block signals: A block of words can be copied within DS", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A virtual machine using ") + (paged ? "paged" : "contiguous") + " memory")
+		{
+			TestHarnessVM vm;
+
+			if ( paged )
+			{
+				REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), TestHarnessVM::DEFAULT_RAM_BYTES));
+			}
+
+			WHEN("A block is copied to a range that does not overlap it")
+			{
+				static const V2MP_Word DS[] = { 12, 4, 1, 2, 3, 4, 0, 0, 0, 0 };
+				LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 4, DS);
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("The destination holds a copy of the source")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(result.cyclesExecuted == 6);
+					CHECK(GetDSWords(vm, 4, 8) == std::vector<V2MP_Word>({ 1, 2, 3, 4, 1, 2, 3, 4 }));
+				}
+
+				AND_THEN("The arguments are left unchanged")
+				{
+					CHECK(vm.GetR1() == 4);
+					CHECK(vm.GetLR() == 0);
+				}
+			}
+
+			AND_WHEN("A block is copied to a range that overlaps it")
+			{
+				static const V2MP_Word DS[] = { 6, 4, 1, 2, 3, 4, 0 };
+				LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 4, DS);
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("The destination holds the contents that the source had before the copy")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(GetDSWords(vm, 4, 5) == std::vector<V2MP_Word>({ 1, 1, 2, 3, 4 }));
+				}
+			}
+
+			AND_WHEN("No words are copied")
+			{
+				static const V2MP_Word DS[] = { 4, 6, 1, 2 };
+				LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 0, DS);
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("Memory is not modified")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(GetDSWords(vm, 4, 2) == std::vector<V2MP_Word>({ 1, 2 }));
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Block signals: A block of words in DS can be filled with a value", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A virtual machine using ") + (paged ? "paged" : "contiguous") + " memory")
+		{
+			TestHarnessVM vm;
+
+			if ( paged )
+			{
+				REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), TestHarnessVM::DEFAULT_RAM_BYTES));
+			}
+
+			WHEN("A block is filled with a value whose bytes differ")
+			{
+				static const V2MP_Word DS[] = { 6, 0xABCD, 1, 2, 3, 4, 5, 6, 7 };
+				LoadBlockSignalProgram(vm, V2MP_SIGNAL_FILL_DS_BLOCK, 5, DS);
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("Only the words in the block are set to the value")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(result.cyclesExecuted == 6);
+					CHECK(GetDSWords(vm, 4, 7) == std::vector<V2MP_Word>({ 1, 0xABCD, 0xABCD, 0xABCD, 0xABCD, 0xABCD, 7 }));
+				}
+			}
+
+			AND_WHEN("A block is cleared")
+			{
+				static const V2MP_Word DS[] = { 4, 0, 1, 2, 3 };
+				LoadBlockSignalProgram(vm, V2MP_SIGNAL_FILL_DS_BLOCK, 2, DS);
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("The words in the block are set to zero")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(GetDSWords(vm, 4, 3) == std::vector<V2MP_Word>({ 0, 0, 3 }));
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Block signals: A block of words can be copied from DS to SS", "[execution]")
+{
+	GIVEN("A virtual machine with a program that has a stack")
+	{
+		TestHarnessVM vm;
+
+		WHEN("A block is copied into the stack")
+		{
+			static const V2MP_Word DS[] = { 2, 4, 0x1234, 0x5678 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK_TO_SS, 2, DS, 4);
+
+			std::vector<V2MP_Word> ssBefore;
+			REQUIRE(vm.GetSSData(0, 4, ssBefore));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The stack holds a copy of the source, and SP is unchanged")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(vm.GetSP() == 0);
+
+				std::vector<V2MP_Word> ss;
+				REQUIRE(vm.GetSSData(0, 4, ss));
+				CHECK(ss == std::vector<V2MP_Word>({ ssBefore[0], 0x1234, 0x5678, ssBefore[3] }));
+			}
+		}
+
+		AND_WHEN("A block is copied past the end of the stack")
+		{
+			static const V2MP_Word DS[] = { 6, 4, 0x1234, 0x5678 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK_TO_SS, 2, DS, 4);
+
+			std::vector<V2MP_Word> ssBefore;
+			REQUIRE(vm.GetSSData(0, 4, ssBefore));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("A SEG fault is raised, and the stack is not modified")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+
+				std::vector<V2MP_Word> ss;
+				REQUIRE(vm.GetSSData(0, 4, ss));
+				CHECK(ss == ssBefore);
+			}
+		}
+	}
+}
+
+SCENARIO("Block signals: Invalid ranges raise faults without modifying memory", "[execution]")
+{
+	GIVEN("A virtual machine")
+	{
+		TestHarnessVM vm;
+
+		WHEN("The destination address is not aligned")
+		{
+			static const V2MP_Word DS[] = { 5, 4, 1, 2, 0 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 1, DS);
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("An ALGN fault is raised on the cycle that raised the signal")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 4);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_ALGN);
+				CHECK(GetDSWords(vm, 4, 3) == std::vector<V2MP_Word>({ 1, 2, 0 }));
+			}
+		}
+
+		AND_WHEN("The source range extends past the end of DS")
+		{
+			static const V2MP_Word DS[] = { 4, 6, 1, 2 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 2, DS);
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("A SEG fault is raised")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+				CHECK(GetDSWords(vm, 4, 2) == std::vector<V2MP_Word>({ 1, 2 }));
+			}
+		}
+
+		AND_WHEN("The filled range extends past the end of DS")
+		{
+			static const V2MP_Word DS[] = { 4, 0xFFFF, 1, 2 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_FILL_DS_BLOCK, 3, DS);
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("A SEG fault is raised")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+				CHECK(GetDSWords(vm, 4, 2) == std::vector<V2MP_Word>({ 1, 2 }));
+			}
+		}
+
+		AND_WHEN("The parameter block does not fit in DS")
+		{
+			static const V2MP_Word DS[] = { 0 };
+			LoadBlockSignalProgram(vm, V2MP_SIGNAL_FILL_DS_BLOCK, 1, DS);
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("A SEG fault is raised")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+			}
+		}
+	}
+}
+
+SCENARIO("Block signals: With a timing model, block operations take cycles per word", "[execution]")
+{
+	GIVEN("A virtual machine with a timing model that specifies a block latency")
+	{
+		TestHarnessVM vm;
+
+		V2MP_Supervisor_TimingModel model {};
+		model.blockLatencyPerWord = 2;
+		REQUIRE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+
+		static const V2MP_Word DS[] = { 12, 4, 1, 2, 3, 4, 0, 0, 0, 0 };
+		LoadBlockSignalProgram(vm, V2MP_SIGNAL_COPY_DS_BLOCK, 4, DS);
+
+		WHEN("The program is run to completion")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The CPU stalls for the latency of each word copied")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(result.cyclesExecuted == 6 + (4 * model.blockLatencyPerWord));
+				CHECK(GetDSWords(vm, 12, 4) == std::vector<V2MP_Word>({ 1, 2, 3, 4 }));
+			}
+		}
+
+		AND_WHEN("The run stops before the copy has completed")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(6, result));
+
+			THEN("The destination has not been modified yet")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(V2MP_CPU_IsStalled(V2MP_Mainboard_GetCPU(V2MP_Supervisor_GetMainboard(vm.GetSupervisor()))));
+				CHECK(GetDSWords(vm, 12, 4) == std::vector<V2MP_Word>({ 0, 0, 0, 0 }));
+			}
+		}
+	}
+}
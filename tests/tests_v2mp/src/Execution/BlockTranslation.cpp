@@ -0,0 +1,106 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	using RunOutcome = TestHarnessVM::RunOutcome;
+
+	template<size_t N>
+	RunOutcome RunProgram(const V2MP_Word (&cs)[N], bool translateBlocks, size_t maxCycles)
+	{
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(cs);
+
+		return TestHarnessVM::RunProgram(prog, maxCycles, [translateBlocks](TestHarnessVM& vm)
+		{
+			vm.SetBlockTranslationEnabled(translateBlocks);
+		});
+	}
+}
+
+SCENARIO("Block translation: A hot loop produces the same results as the interpreter", "[execution]")
+{
+	GIVEN("A program that adds 3 to R1 one hundred times and then exits")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_R0, 0),
+			Asm::ASGNL(Asm::REG_R1, 0),
+			Asm::ADDL(Asm::REG_R1, 3),
+			Asm::ADDL(Asm::REG_R0, 1),
+			Asm::ASGNR(Asm::REG_R0, Asm::REG_LR),
+			Asm::SUBL(Asm::REG_LR, 100),
+			Asm::BXZL(1),
+			Asm::SUBL(Asm::REG_PC, 6),
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::SIG()
+		};
+
+		WHEN("The program is run to completion with and without block translation")
+		{
+			const RunOutcome translated = RunProgram(CS, true, 10000);
+			const RunOutcome interpreted = RunProgram(CS, false, 10000);
+
+			THEN("The program exits with the expected result")
+			{
+				CHECK(translated.result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(translated.r1 == 300);
+			}
+
+			AND_THEN("The CPU state and cycle count are identical")
+			{
+				TestHarnessVM::CheckOutcomesMatch(translated, interpreted);
+			}
+		}
+
+		WHEN("The program is run with a cycle budget that runs out part way through a block")
+		{
+			const RunOutcome translated = RunProgram(CS, true, 317);
+			const RunOutcome interpreted = RunProgram(CS, false, 317);
+
+			THEN("Exactly the budgeted number of cycles are executed")
+			{
+				CHECK(translated.result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(translated.result.cyclesExecuted == 317);
+			}
+
+			AND_THEN("The CPU state is identical")
+			{
+				TestHarnessVM::CheckOutcomesMatch(translated, interpreted);
+			}
+		}
+	}
+}
+
+SCENARIO("Block translation: A fault raised inside a hot loop matches the interpreter", "[execution]")
+{
+	GIVEN("A program that divides by a decreasing value until it divides by zero")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_R1, 40),
+			Asm::ASGNL(Asm::REG_R0, 100),
+			Asm::DIVR(Asm::REG_R0),
+			Asm::SUBL(Asm::REG_R1, 1),
+			Asm::SUBL(Asm::REG_PC, 4)
+		};
+
+		WHEN("The program is run with and without block translation")
+		{
+			const RunOutcome translated = RunProgram(CS, true, 10000);
+			const RunOutcome interpreted = RunProgram(CS, false, 10000);
+
+			THEN("A DIV fault is raised")
+			{
+				CHECK(translated.result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(translated.fault) == V2MP_FAULT_DIV);
+			}
+
+			AND_THEN("The CPU state and cycle count are identical")
+			{
+				TestHarnessVM::CheckOutcomesMatch(translated, interpreted);
+			}
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#include <memory>
+#include <string>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+SCENARIO("Data pages: A program can swap which data page is mapped as the data segment", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A program with two data pages, using ") + (paged ? "paged" : "contiguous") + " memory")
+		{
+			TestHarnessVM vm;
+
+			if ( paged )
+			{
+				REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), TestHarnessVM::DEFAULT_RAM_BYTES));
+			}
+
+			// Increments the first word of page 0, then adds 2 to the first word
+			// of page 1, then reads the first word of page 0 back into R1.
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::ADDL(Asm::REG_R0, 1),
+				Asm::STOR(Asm::REG_R0),
+				Asm::ASGNL(Asm::REG_R1, 1),
+				Asm::ASGNL(Asm::REG_R0, V2MP_SIGNAL_SWAP_DATA_PAGE),
+				Asm::SIG(),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::ADDL(Asm::REG_R0, 2),
+				Asm::STOR(Asm::REG_R0),
+				Asm::ASGNL(Asm::REG_R1, 0),
+				Asm::ASGNL(Asm::REG_R0, V2MP_SIGNAL_SWAP_DATA_PAGE),
+				Asm::SIG(),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			};
+
+			static const V2MP_Word DS[] = { 10, 0xAAAA };
+			static const V2MP_Word PAGE1[] = { 20 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+			prog.SetStackSize(4);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			size_t pageIndex = 0;
+			REQUIRE(V2MP_Supervisor_AddDataPage(vm.GetSupervisor(), PAGE1, 1, 3, &pageIndex));
+
+			THEN("The new page follows the page that the program was loaded with")
+			{
+				CHECK(pageIndex == 1);
+				CHECK(V2MP_Supervisor_GetDataPageCount(vm.GetSupervisor()) == 2);
+				CHECK(V2MP_Supervisor_GetActiveDataPage(vm.GetSupervisor()) == 0);
+			}
+
+			WHEN("The program is run")
+			{
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(100, result));
+
+				THEN("Each page was accessed independently, and page 0 is mapped again")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(vm.GetR1() == 11);
+					CHECK(V2MP_Supervisor_GetActiveDataPage(vm.GetSupervisor()) == 0);
+
+					V2MP_Word word = 0;
+					REQUIRE(vm.GetDSWord(0, word));
+					CHECK(word == 11);
+					REQUIRE(vm.GetDSWord(2, word));
+					CHECK(word == 0xAAAA);
+				}
+
+				AND_THEN("Page 1 holds its own data, and has its own size")
+				{
+					REQUIRE(V2MP_Supervisor_SetActiveDataPage(vm.GetSupervisor(), 1));
+
+					V2MP_Word word = 0;
+					REQUIRE(vm.GetDSWord(0, word));
+					CHECK(word == 22);
+					CHECK(vm.GetDSWord(4, word));
+					CHECK_FALSE(vm.GetDSWord(6, word));
+				}
+			}
+
+			AND_WHEN("A forked VM swaps pages")
+			{
+				std::unique_ptr<TestHarnessVM> child = vm.Fork();
+				REQUIRE(child);
+
+				REQUIRE(V2MP_Supervisor_GetDataPageCount(child->GetSupervisor()) == 2);
+				REQUIRE(V2MP_Supervisor_SetActiveDataPage(child->GetSupervisor(), 1));
+
+				THEN("Only the forked VM's data segment changes")
+				{
+					V2MP_Word word = 0;
+
+					REQUIRE(child->GetDSWord(0, word));
+					CHECK(word == 20);
+
+					REQUIRE(vm.GetDSWord(0, word));
+					CHECK(word == 10);
+					CHECK(V2MP_Supervisor_GetActiveDataPage(vm.GetSupervisor()) == 0);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Data pages: Invalid page requests are rejected", "[execution]")
+{
+	GIVEN("A loaded program with a single data page")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_R1, 1),
+			Asm::ASGNL(Asm::REG_R0, V2MP_SIGNAL_SWAP_DATA_PAGE),
+			Asm::SIG()
+		};
+
+		static const V2MP_Word DS[] = { 0x1234 };
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(CS, DS);
+		prog.SetStackSize(4);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program swaps to a page that does not exist")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(10, result));
+
+			THEN("A SEG fault is raised, and the original page remains mapped")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+				CHECK(V2MP_Supervisor_GetActiveDataPage(vm.GetSupervisor()) == 0);
+
+				V2MP_Word word = 0;
+				REQUIRE(vm.GetDSWord(0, word));
+				CHECK(word == 0x1234);
+			}
+		}
+
+		AND_WHEN("A page is added that does not fit in memory")
+		{
+			THEN("The page is rejected")
+			{
+				CHECK_FALSE(V2MP_Supervisor_AddDataPage(
+					vm.GetSupervisor(),
+					nullptr,
+					0,
+					TestHarnessVM::DEFAULT_RAM_BYTES / sizeof(V2MP_Word),
+					nullptr
+				));
+
+				CHECK(V2MP_Supervisor_GetDataPageCount(vm.GetSupervisor()) == 1);
+			}
+		}
+
+		AND_WHEN("A page's initialisation data is longer than the page")
+		{
+			static const V2MP_Word PAGE[] = { 1, 2 };
+
+			THEN("The page is rejected")
+			{
+				CHECK_FALSE(V2MP_Supervisor_AddDataPage(vm.GetSupervisor(), PAGE, 2, 1, nullptr));
+			}
+		}
+
+		AND_WHEN("The program is cleared")
+		{
+			V2MP_Supervisor_ClearProgram(vm.GetSupervisor());
+
+			THEN("No data pages remain, and none can be added")
+			{
+				CHECK(V2MP_Supervisor_GetDataPageCount(vm.GetSupervisor()) == 0);
+				CHECK_FALSE(V2MP_Supervisor_AddDataPage(vm.GetSupervisor(), nullptr, 0, 1, nullptr));
+			}
+		}
+	}
+}
@@ -0,0 +1,143 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	using RunOutcome = TestHarnessVM::RunOutcome;
+
+	template<size_t CSN, size_t DSN>
+	RunOutcome RunProgram(
+		const V2MP_Word (&cs)[CSN],
+		const V2MP_Word (&ds)[DSN],
+		V2MP_Word ssWords,
+		bool deferMemoryAccess
+	)
+	{
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(cs, ds);
+		prog.SetStackSize(ssWords);
+
+		return TestHarnessVM::RunProgram(prog, 1000, [deferMemoryAccess](TestHarnessVM& vm)
+		{
+			V2MP_Supervisor_SetDeferredMemoryAccessEnabled(vm.GetSupervisor(), deferMemoryAccess);
+			REQUIRE(V2MP_Supervisor_IsDeferredMemoryAccessEnabled(vm.GetSupervisor()) == deferMemoryAccess);
+		});
+	}
+}
+
+SCENARIO("Deferred memory access: Loads, stores and stack operations match immediate memory access", "[execution]")
+{
+	GIVEN("A program that sums the data segment, storing each partial sum to memory via the stack")
+	{
+		namespace SumDS = TestPrograms::SumDS;
+
+		WHEN("The program is run with and without deferred memory access")
+		{
+			const RunOutcome immediate = RunProgram(SumDS::CS, SumDS::DS, SumDS::SS_WORDS, false);
+			const RunOutcome deferred = RunProgram(SumDS::CS, SumDS::DS, SumDS::SS_WORDS, true);
+
+			THEN("The program exits with the expected result")
+			{
+				CHECK(immediate.result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(immediate.r1 == SumDS::SUM);
+				CHECK(immediate.sp == 0);
+			}
+
+			AND_THEN("The CPU state, memory and cycle count are identical")
+			{
+				TestHarnessVM::CheckOutcomesMatch(immediate, deferred);
+			}
+		}
+	}
+}
+
+SCENARIO("Deferred memory access: Memory faults match immediate memory access", "[execution]")
+{
+	static const V2MP_Word DS[] = { 0x1234 };
+
+	GIVEN("A program that loads from an unaligned address")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_LR, 1),
+			Asm::LOAD(Asm::REG_R0)
+		};
+
+		WHEN("The program is run with and without deferred memory access")
+		{
+			const RunOutcome immediate = RunProgram(CS, DS, 1, false);
+			const RunOutcome deferred = RunProgram(CS, DS, 1, true);
+
+			THEN("An ALGN fault is raised in both cases")
+			{
+				CHECK(Asm::FaultFromWord(immediate.fault) == V2MP_FAULT_ALGN);
+				TestHarnessVM::CheckOutcomesMatch(immediate, deferred);
+			}
+		}
+	}
+
+	GIVEN("A program that stores to an address outside of memory")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::IASGNL(Asm::REG_LR, -2),
+			Asm::STOR(Asm::REG_R0)
+		};
+
+		WHEN("The program is run with and without deferred memory access")
+		{
+			const RunOutcome immediate = RunProgram(CS, DS, 1, false);
+			const RunOutcome deferred = RunProgram(CS, DS, 1, true);
+
+			THEN("A SEG fault is raised in both cases")
+			{
+				CHECK(Asm::FaultFromWord(immediate.fault) == V2MP_FAULT_SEG);
+				TestHarnessVM::CheckOutcomesMatch(immediate, deferred);
+			}
+		}
+	}
+
+	GIVEN("A program that pushes more registers than the stack can hold")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::PUSH(1 << Asm::REG_R0),
+			Asm::PUSH((1 << Asm::REG_R0) | (1 << Asm::REG_R1))
+		};
+
+		WHEN("The program is run with and without deferred memory access")
+		{
+			const RunOutcome immediate = RunProgram(CS, DS, 2, false);
+			const RunOutcome deferred = RunProgram(CS, DS, 2, true);
+
+			THEN("An SOF fault is raised in both cases")
+			{
+				CHECK(Asm::FaultFromWord(immediate.fault) == V2MP_FAULT_SOF);
+				CHECK(immediate.sp == sizeof(V2MP_Word));
+				TestHarnessVM::CheckOutcomesMatch(immediate, deferred);
+			}
+		}
+	}
+
+	GIVEN("A program that pops from an empty stack")
+	{
+		static const V2MP_Word CS[] =
+		{
+			Asm::POP(1 << Asm::REG_R1)
+		};
+
+		WHEN("The program is run with and without deferred memory access")
+		{
+			const RunOutcome immediate = RunProgram(CS, DS, 2, false);
+			const RunOutcome deferred = RunProgram(CS, DS, 2, true);
+
+			THEN("An SOF fault is raised in both cases")
+			{
+				CHECK(Asm::FaultFromWord(immediate.fault) == V2MP_FAULT_SOF);
+				TestHarnessVM::CheckOutcomesMatch(immediate, deferred);
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	static constexpr size_t MEMORY_PAGES = 4;
+
+	// The data segment begins at the start of memory,
+	// so this places the stack segment at the start of page 2.
+	static constexpr V2MP_Word DS_WORDS = 1024;
+
+	// Address within the data segment that lies on page 1 of memory.
+	static constexpr V2MP_Word DS_STORE_ADDRESS = 94 << 4;
+
+	std::vector<V2MP_Byte> GetAndClearDirtyPages(TestHarnessVM& vm)
+	{
+		std::vector<V2MP_Byte> bitmap(V2MP_MemoryStore_GetDirtyPageBitmapSize(vm.GetMemoryStore()));
+		REQUIRE(V2MP_MemoryStore_GetAndClearDirtyPages(vm.GetMemoryStore(), bitmap.data(), bitmap.size()));
+		return bitmap;
+	}
+}
+
+SCENARIO("Dirty pages: Stores and stack pushes made by a program mark pages as dirty", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		for ( bool defer : { false, true } )
+		{
+			GIVEN(std::string("A program that stores a word to the data segment and pushes to the stack, in ") +
+			      (paged ? "paged" : "contiguous") + " memory, with " + (defer ? "deferred" : "immediate") + " memory access")
+			{
+				TestHarnessVM vm(MEMORY_PAGES * V2MP_MEMORYSTORE_PAGE_SIZE);
+
+				if ( paged )
+				{
+					REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), MEMORY_PAGES * V2MP_MEMORYSTORE_PAGE_SIZE));
+				}
+
+				V2MP_Supervisor_SetDeferredMemoryAccessEnabled(vm.GetSupervisor(), defer);
+
+				const std::vector<V2MP_Word> cs =
+				{
+					Asm::ASGNL(Asm::REG_LR, DS_STORE_ADDRESS >> 4),
+					Asm::SHFTL(Asm::REG_LR, 4),
+					Asm::STOR(Asm::REG_LR),
+					Asm::PUSH(1 << Asm::REG_LR)
+				};
+
+				const std::vector<V2MP_Word> ds(DS_WORDS, 0);
+
+				TestHarnessVM::ProgramDef prog;
+				prog.SetCSAndDS(cs, ds);
+				prog.SetStackSize(4);
+
+				REQUIRE(vm.LoadProgram(prog));
+
+				WHEN("The program is loaded")
+				{
+					THEN("Only the pages holding the data segment are dirty")
+					{
+						CHECK(GetAndClearDirtyPages(vm) == std::vector<V2MP_Byte>{ 0x03 });
+					}
+				}
+
+				AND_WHEN("The program is run after the dirty pages have been cleared")
+				{
+					GetAndClearDirtyPages(vm);
+
+					V2MP_RunResult result {};
+					REQUIRE(vm.Run(cs.size(), result));
+					REQUIRE_FALSE(vm.CPUHasFault());
+
+					V2MP_Word word = 0;
+					REQUIRE(vm.GetDSWord(DS_STORE_ADDRESS, word));
+					REQUIRE(word == DS_STORE_ADDRESS);
+
+					THEN("Only the pages that the program wrote to are dirty")
+					{
+						CHECK(GetAndClearDirtyPages(vm) == std::vector<V2MP_Byte>{ 0x06 });
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	namespace SumDS = TestPrograms::SumDS;
+
+	static constexpr size_t CYCLES_BEFORE_FORK = 20;
+
+	void LoadProgram(TestHarnessVM& vm, bool paged)
+	{
+		if ( paged )
+		{
+			REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), 2 * V2MP_MEMORYSTORE_PAGE_SIZE));
+		}
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(SumDS::CS, SumDS::DS);
+		prog.SetStackSize(SumDS::SS_WORDS);
+
+		REQUIRE(vm.LoadProgram(prog));
+	}
+
+	V2MP_Word GetPartialSum(const TestHarnessVM& vm)
+	{
+		V2MP_Word word = 0;
+		REQUIRE(vm.GetDSWord(SumDS::PARTIAL_SUM_ADDRESS, word));
+		return word;
+	}
+}
+
+SCENARIO("Forking: A forked VM continues from the state of its parent", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A VM with ") + (paged ? "paged" : "contiguous") + " memory that is part of the way through a program")
+		{
+			TestHarnessVM reference;
+			LoadProgram(reference, paged);
+
+			V2MP_RunResult referenceResult {};
+			REQUIRE(reference.Run(1000, referenceResult));
+			REQUIRE(referenceResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+			TestHarnessVM parent;
+			LoadProgram(parent, paged);
+
+			V2MP_RunResult parentResult {};
+			REQUIRE(parent.Run(CYCLES_BEFORE_FORK, parentResult));
+			REQUIRE(parentResult.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+
+			const V2MP_Word partialSumAtFork = GetPartialSum(parent);
+
+			WHEN("The VM is forked")
+			{
+				std::unique_ptr<TestHarnessVM> child = parent.Fork();
+				REQUIRE(child);
+
+				THEN("The child has the same CPU state and memory as the parent")
+				{
+					CHECK(child->GetR0() == parent.GetR0());
+					CHECK(child->GetR1() == parent.GetR1());
+					CHECK(child->GetLR() == parent.GetLR());
+					CHECK(child->GetPC() == parent.GetPC());
+					CHECK(child->GetSR() == parent.GetSR());
+					CHECK(child->GetSP() == parent.GetSP());
+					CHECK(GetPartialSum(*child) == partialSumAtFork);
+				}
+
+				AND_THEN("Paged memory is shared rather than copied")
+				{
+					if ( paged )
+					{
+						CHECK(V2MP_MemoryStore_GetSharedMemorySize(child->GetMemoryStore()) == V2MP_MEMORYSTORE_PAGE_SIZE);
+					}
+				}
+			}
+
+			AND_WHEN("Both the parent and the child run to completion")
+			{
+				std::unique_ptr<TestHarnessVM> child = parent.Fork();
+				REQUIRE(child);
+
+				V2MP_RunResult childResult {};
+				REQUIRE(child->Run(1000, childResult));
+				REQUIRE(parent.Run(1000, parentResult));
+
+				THEN("Both finish with the same result as a VM that was never forked")
+				{
+					CHECK(childResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(parentResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(CYCLES_BEFORE_FORK + childResult.cyclesExecuted == referenceResult.cyclesExecuted);
+					CHECK(parentResult.cyclesExecuted == childResult.cyclesExecuted);
+
+					CHECK(child->GetR1() == reference.GetR1());
+					CHECK(parent.GetR1() == reference.GetR1());
+					CHECK(GetPartialSum(*child) == GetPartialSum(reference));
+					CHECK(GetPartialSum(parent) == GetPartialSum(reference));
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Forking: Writes made after forking are not visible to the other VM", "[execution]")
+{
+	for ( bool paged : { false, true } )
+	{
+		GIVEN(std::string("A VM with ") + (paged ? "paged" : "contiguous") + " memory that has already written to memory")
+		{
+			TestHarnessVM parent;
+			LoadProgram(parent, paged);
+
+			V2MP_RunResult parentResult {};
+			REQUIRE(parent.Run(CYCLES_BEFORE_FORK, parentResult));
+
+			const V2MP_Word partialSumAtFork = GetPartialSum(parent);
+			REQUIRE(partialSumAtFork != 0);
+
+			std::unique_ptr<TestHarnessVM> child = parent.Fork();
+			REQUIRE(child);
+
+			WHEN("The parent continues running after the fork")
+			{
+				REQUIRE(parent.Run(1000, parentResult));
+				REQUIRE(parentResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+				THEN("The child's memory is unchanged")
+				{
+					CHECK(GetPartialSum(parent) == SumDS::SUM);
+					CHECK(GetPartialSum(*child) == partialSumAtFork);
+				}
+			}
+
+			AND_WHEN("The child continues running after the fork")
+			{
+				V2MP_RunResult childResult {};
+				REQUIRE(child->Run(1000, childResult));
+				REQUIRE(childResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+				THEN("The parent's memory is unchanged")
+				{
+					CHECK(GetPartialSum(*child) == SumDS::SUM);
+					CHECK(GetPartialSum(parent) == partialSumAtFork);
+				}
+			}
+		}
+	}
+}
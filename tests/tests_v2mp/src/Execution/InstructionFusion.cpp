@@ -0,0 +1,117 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+// Loads 0x8123 into R1, then jumps over an instruction
+// using the sequence generated by the JUMP macro.
+static const V2MP_Word FUSION_TEST_CS[] =
+{
+	Asm::ASGNL(Asm::REG_R1, 0x81),
+	Asm::SHFTL(Asm::REG_R1, 8),
+	Asm::ADDL(Asm::REG_R1, 0x23),
+	Asm::ASGNL(Asm::REG_LR, 0x00),
+	Asm::SHFTL(Asm::REG_LR, 8),
+	Asm::ADDL(Asm::REG_LR, 8 * sizeof(V2MP_Word)),
+	Asm::ASGNR(Asm::REG_LR, Asm::REG_PC),
+	Asm::ADDL(Asm::REG_R0, 1),
+	Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+	Asm::SIG()
+};
+
+static constexpr V2MP_Word LOADED_VALUE = 0x8123;
+static constexpr size_t NUM_CYCLES_TO_EXIT = 9;
+
+SCENARIO("Instruction fusion: Fused sequences leave the CPU in the same state as unfused sequences", "[execution]")
+{
+	GIVEN("A virtual machine with a program that loads a 16-bit constant and then jumps")
+	{
+		TestHarnessVM vm;
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(FUSION_TEST_CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run to completion in one go")
+		{
+			TestHarnessVM steppedVM;
+			REQUIRE(steppedVM.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			size_t steppedCycles = 0;
+
+			while ( !steppedVM.HasProgramExited() && !steppedVM.CPUHasFault() && steppedCycles < 100 )
+			{
+				V2MP_RunResult stepResult {};
+				REQUIRE(steppedVM.Run(1, stepResult));
+				steppedCycles += stepResult.cyclesExecuted;
+			}
+
+			THEN("The same number of cycles are executed as when running one cycle at a time")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(result.cyclesExecuted == NUM_CYCLES_TO_EXIT);
+				CHECK(steppedCycles == NUM_CYCLES_TO_EXIT);
+			}
+
+			AND_THEN("All registers match those of the program run one cycle at a time")
+			{
+				CHECK(vm.GetProgramExitCode() == LOADED_VALUE);
+				CHECK(vm.GetR0() == steppedVM.GetR0());
+				CHECK(vm.GetR1() == steppedVM.GetR1());
+				CHECK(vm.GetLR() == steppedVM.GetLR());
+				CHECK(vm.GetPC() == steppedVM.GetPC());
+				CHECK(vm.GetSR() == steppedVM.GetSR());
+				CHECK(vm.GetIR() == steppedVM.GetIR());
+			}
+		}
+
+		WHEN("The program is run for exactly the length of the 16-bit constant load")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("The state matches that left by the final ADD instruction")
+			{
+				CHECK(result.cyclesExecuted == 3);
+				CHECK(vm.GetR1() == LOADED_VALUE);
+				CHECK(vm.GetSR() == 0);
+				CHECK(vm.GetPC() == 3 * sizeof(V2MP_Word));
+				CHECK(vm.GetIR() == FUSION_TEST_CS[2]);
+			}
+		}
+
+		WHEN("The program is run for fewer cycles than the 16-bit constant load")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(2, result));
+
+			THEN("The sequence is executed one instruction at a time")
+			{
+				CHECK(result.cyclesExecuted == 2);
+				CHECK(vm.GetR1() == 0x8100);
+				CHECK(vm.GetSR() == Asm::SR_C);
+				CHECK(vm.GetPC() == 2 * sizeof(V2MP_Word));
+				CHECK(vm.GetIR() == FUSION_TEST_CS[1]);
+			}
+		}
+
+		WHEN("The program is run starting from the middle of the jump sequence")
+		{
+			vm.SetLR(0x0001);
+			vm.SetPC(4 * sizeof(V2MP_Word));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("Only the instructions that were branched to are executed")
+			{
+				CHECK(result.cyclesExecuted == 3);
+				CHECK(vm.GetLR() == 0x0100 + 8 * sizeof(V2MP_Word));
+				CHECK(vm.GetPC() == 0x0100 + 8 * sizeof(V2MP_Word));
+			}
+		}
+	}
+}
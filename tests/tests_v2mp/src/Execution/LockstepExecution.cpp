@@ -0,0 +1,341 @@
+#include <vector>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+
+namespace
+{
+	// Runs the same sequence of arithmetic on the first word of
+	// the data segment ten times, and stores the result after it.
+	// Control flow is identical for every input.
+	static const V2MP_Word ARITHMETIC_CS[] =
+	{
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R0),
+		Asm::ASGNL(Asm::REG_R1, 10),
+		Asm::MULL(Asm::REG_R0, 3),
+		Asm::ADDR(Asm::REG_LR, Asm::REG_R0),
+		Asm::SHFTL(Asm::REG_R0, -1),
+		Asm::BITWL(Asm::REG_R0, Asm::BitwiseOp::XOR, 3, false),
+		Asm::IMULL(Asm::REG_R0, -5),
+		Asm::SUBL(Asm::REG_R1, 1),
+		Asm::BXZL(1),
+		Asm::SUBL(Asm::REG_PC, 8),
+		Asm::ASGNL(Asm::REG_LR, 2),
+		Asm::STOR(Asm::REG_R0),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	// Counts down from the first word of the data segment, then divides
+	// 100 by the second word and stores the result after them. Control
+	// flow depends on the input, and a divisor of 0 raises a fault.
+	static const V2MP_Word DIVERGENT_CS[] =
+	{
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R0),
+		Asm::ASGNL(Asm::REG_LR, 2),
+		Asm::LOAD(Asm::REG_R1),
+		Asm::SUBL(Asm::REG_R0, 1),
+		Asm::BXZL(1),
+		Asm::SUBL(Asm::REG_PC, 3),
+		Asm::ASGNL(Asm::REG_R0, 100),
+		Asm::DIVR(Asm::REG_R0),
+		Asm::ASGNL(Asm::REG_LR, 4),
+		Asm::STOR(Asm::REG_R0),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	static constexpr size_t NUM_VMS = 37;
+
+	struct ProgramSpec
+	{
+		const V2MP_Word* cs;
+		size_t csWords;
+		size_t dsWords;
+	};
+
+	static const ProgramSpec ARITHMETIC_PROGRAM = { ARITHMETIC_CS, sizeof(ARITHMETIC_CS) / sizeof(ARITHMETIC_CS[0]), 2 };
+	static const ProgramSpec DIVERGENT_PROGRAM = { DIVERGENT_CS, sizeof(DIVERGENT_CS) / sizeof(DIVERGENT_CS[0]), 3 };
+
+	std::vector<V2MP_Word> DSForVM(const ProgramSpec& program, size_t index)
+	{
+		std::vector<V2MP_Word> ds(program.dsWords, 0);
+
+		if ( program.cs == ARITHMETIC_CS )
+		{
+			ds[0] = static_cast<V2MP_Word>((index * 937) + 1);
+		}
+		else
+		{
+			// Several VMs share each loop count, so some groups stay together.
+			ds[0] = static_cast<V2MP_Word>(1 + ((index % 3) * 4));
+			ds[1] = static_cast<V2MP_Word>(index % 5 == 0 ? 0 : index);
+		}
+
+		return ds;
+	}
+
+	struct VMState
+	{
+		V2MP_Word r0 = 0;
+		V2MP_Word r1 = 0;
+		V2MP_Word lr = 0;
+		V2MP_Word pc = 0;
+		V2MP_Word sr = 0;
+		V2MP_Word ir = 0;
+		V2MP_Word sp = 0;
+		V2MP_Word fault = 0;
+		std::vector<V2MP_Word> ds;
+	};
+
+	// A set of VMs, where the VM at each index is given one of the programs
+	// in turn. VMs given the same program share its program image.
+	class VMSet
+	{
+	public:
+		VMSet(const std::vector<ProgramSpec>& programs, const V2MP_Supervisor_TimingModel* timingModel = nullptr)
+		{
+			for ( const ProgramSpec& program : programs )
+			{
+				m_Images.push_back(V2MP_ProgramImage_AllocateAndInit(program.cs, program.csWords));
+				REQUIRE(m_Images.back());
+			}
+
+			for ( size_t index = 0; index < NUM_VMS; ++index )
+			{
+				const size_t programIndex = index % programs.size();
+				const std::vector<V2MP_Word> ds = DSForVM(programs[programIndex], index);
+
+				V2MP_VirtualMachine* vm = V2MP_VirtualMachine_AllocateAndInit();
+				REQUIRE(vm);
+				m_VMs.push_back(vm);
+
+				REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, TestHarnessVM::DEFAULT_RAM_BYTES));
+				REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, m_Images[programIndex], ds.data(), ds.size(), 4));
+
+				if ( timingModel )
+				{
+					REQUIRE(V2MP_Supervisor_SetTimingModel(V2MP_VirtualMachine_GetSupervisor(vm), timingModel));
+				}
+
+				m_DSWords.push_back(ds.size());
+			}
+		}
+
+		~VMSet()
+		{
+			for ( V2MP_VirtualMachine* vm : m_VMs )
+			{
+				V2MP_VirtualMachine_DeinitAndFree(vm);
+			}
+
+			for ( V2MP_ProgramImage* image : m_Images )
+			{
+				V2MP_ProgramImage_Release(image);
+			}
+		}
+
+		void SetBlockTranslationEnabled(bool enabled)
+		{
+			for ( V2MP_VirtualMachine* vm : m_VMs )
+			{
+				V2MP_VirtualMachine_SetBlockTranslationEnabled(vm, enabled);
+			}
+		}
+
+		std::vector<V2MP_RunResult> RunEach(size_t maxCycles)
+		{
+			std::vector<V2MP_RunResult> results(m_VMs.size());
+
+			for ( size_t index = 0; index < m_VMs.size(); ++index )
+			{
+				REQUIRE(V2MP_VirtualMachine_Run(m_VMs[index], maxCycles, &results[index]));
+			}
+
+			return results;
+		}
+
+		std::vector<V2MP_RunResult> RunLockstep(size_t maxCycles)
+		{
+			std::vector<V2MP_RunResult> results(m_VMs.size());
+			REQUIRE(V2MP_VirtualMachine_RunLockstep(m_VMs.data(), m_VMs.size(), maxCycles, results.data()));
+			return results;
+		}
+
+		VMState GetState(size_t index)
+		{
+			V2MP_CPU* cpu = V2MP_Mainboard_GetCPU(V2MP_VirtualMachine_GetMainboard(m_VMs[index]));
+			V2MP_Supervisor* supervisor = V2MP_VirtualMachine_GetSupervisor(m_VMs[index]);
+			VMState state;
+
+			state.r0 = V2MP_CPU_GetR0(cpu);
+			state.r1 = V2MP_CPU_GetR1(cpu);
+			state.lr = V2MP_CPU_GetLinkRegister(cpu);
+			state.pc = V2MP_CPU_GetProgramCounter(cpu);
+			state.sr = V2MP_CPU_GetStatusRegister(cpu);
+			state.ir = V2MP_CPU_GetInstructionRegister(cpu);
+			state.sp = V2MP_CPU_GetStackPointer(cpu);
+			state.fault = V2MP_CPU_GetFaultWord(cpu);
+
+			for ( size_t word = 0; word < m_DSWords[index]; ++word )
+			{
+				V2MP_Word value = 0;
+				REQUIRE(V2MP_Supervisor_FetchDSWord(supervisor, static_cast<V2MP_Word>(word * sizeof(V2MP_Word)), &value));
+				state.ds.push_back(value);
+			}
+
+			return state;
+		}
+
+		bool HasExited(size_t index) const
+		{
+			return V2MP_Supervisor_HasProgramExited(V2MP_VirtualMachine_GetSupervisor(m_VMs[index]));
+		}
+
+		size_t Count() const
+		{
+			return m_VMs.size();
+		}
+
+	private:
+		std::vector<V2MP_ProgramImage*> m_Images;
+		std::vector<V2MP_VirtualMachine*> m_VMs;
+		std::vector<size_t> m_DSWords;
+	};
+
+	// Runs both sets with each budget in turn, one with the scalar
+	// engine and one in lockstep, checking that they match each time.
+	void CheckLockstepMatchesScalar(VMSet& scalar, VMSet& lockstep, const std::vector<size_t>& budgets)
+	{
+		for ( size_t maxCycles : budgets )
+		{
+			const std::vector<V2MP_RunResult> scalarResults = scalar.RunEach(maxCycles);
+			const std::vector<V2MP_RunResult> lockstepResults = lockstep.RunLockstep(maxCycles);
+
+			for ( size_t index = 0; index < scalar.Count(); ++index )
+			{
+				INFO("VM " << index << " with a budget of " << maxCycles << " cycles");
+
+				const VMState scalarState = scalar.GetState(index);
+				const VMState lockstepState = lockstep.GetState(index);
+
+				CHECK(lockstepResults[index].stopReason == scalarResults[index].stopReason);
+				CHECK(lockstepResults[index].cyclesExecuted == scalarResults[index].cyclesExecuted);
+				CHECK(lockstepState.r0 == scalarState.r0);
+				CHECK(lockstepState.r1 == scalarState.r1);
+				CHECK(lockstepState.lr == scalarState.lr);
+				CHECK(lockstepState.pc == scalarState.pc);
+				CHECK(lockstepState.sr == scalarState.sr);
+				CHECK(lockstepState.ir == scalarState.ir);
+				CHECK(lockstepState.sp == scalarState.sp);
+				CHECK(lockstepState.fault == scalarState.fault);
+				CHECK(lockstepState.ds == scalarState.ds);
+			}
+		}
+	}
+}
+
+SCENARIO("Lockstep execution: VMs with identical control flow match the scalar engine", "[execution]")
+{
+	for ( bool translate : { false, true } )
+	{
+		GIVEN(std::string("VMs sharing an arithmetic program, with block translation ") + (translate ? "enabled" : "disabled"))
+		{
+			VMSet scalar({ ARITHMETIC_PROGRAM });
+			VMSet lockstep({ ARITHMETIC_PROGRAM });
+
+			scalar.SetBlockTranslationEnabled(translate);
+			lockstep.SetBlockTranslationEnabled(translate);
+
+			WHEN("The programs are run to completion in one call")
+			{
+				THEN("Every VM's results, registers and memory match the scalar engine, and every program has exited")
+				{
+					CheckLockstepMatchesScalar(scalar, lockstep, { 1000 });
+
+					for ( size_t index = 0; index < lockstep.Count(); ++index )
+					{
+						CHECK(lockstep.HasExited(index));
+					}
+				}
+			}
+
+			AND_WHEN("The programs are run over several calls with budgets that end mid-block")
+			{
+				THEN("Every VM matches the scalar engine after each call, and after exiting")
+				{
+					CheckLockstepMatchesScalar(scalar, lockstep, { 0, 1, 4, 7, 13, 2, 50, 1000, 1000 });
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Lockstep execution: VMs whose control flow diverges match the scalar engine", "[execution]")
+{
+	GIVEN("VMs sharing a program whose loop count depends on its input, some of which fault")
+	{
+		VMSet scalar({ DIVERGENT_PROGRAM });
+		VMSet lockstep({ DIVERGENT_PROGRAM });
+
+		WHEN("The programs are run to completion")
+		{
+			THEN("Every VM matches the scalar engine, and only the VMs with a divisor of 0 have faulted")
+			{
+				CheckLockstepMatchesScalar(scalar, lockstep, { 1000 });
+
+				for ( size_t index = 0; index < lockstep.Count(); ++index )
+				{
+					const V2MP_Fault expected = index % 5 == 0 ? V2MP_FAULT_DIV : V2MP_FAULT_NONE;
+					CHECK(Asm::FaultFromWord(lockstep.GetState(index).fault) == expected);
+				}
+			}
+		}
+
+		AND_WHEN("The programs are run in short slices")
+		{
+			THEN("Every VM matches the scalar engine after each slice")
+			{
+				CheckLockstepMatchesScalar(scalar, lockstep, { 3, 3, 5, 8, 1, 1000 });
+			}
+		}
+	}
+
+	GIVEN("VMs that alternate between two different programs")
+	{
+		VMSet scalar({ ARITHMETIC_PROGRAM, DIVERGENT_PROGRAM });
+		VMSet lockstep({ ARITHMETIC_PROGRAM, DIVERGENT_PROGRAM });
+
+		WHEN("The programs are run")
+		{
+			THEN("Every VM matches the scalar engine")
+			{
+				CheckLockstepMatchesScalar(scalar, lockstep, { 9, 1000 });
+			}
+		}
+	}
+}
+
+SCENARIO("Lockstep execution: VMs that stall on memory access match the scalar engine", "[execution]")
+{
+	GIVEN("VMs sharing a program, with a timing model that stalls on loads and stores")
+	{
+		V2MP_Supervisor_TimingModel model {};
+		model.loadLatency = 3;
+		model.storeLatency = 2;
+
+		VMSet scalar({ ARITHMETIC_PROGRAM, DIVERGENT_PROGRAM }, &model);
+		VMSet lockstep({ ARITHMETIC_PROGRAM, DIVERGENT_PROGRAM }, &model);
+
+		WHEN("The programs are run in slices that end during stalls")
+		{
+			THEN("Every VM matches the scalar engine after each slice")
+			{
+				CheckLockstepMatchesScalar(scalar, lockstep, { 2, 1, 1, 6, 1000 });
+			}
+		}
+	}
+}
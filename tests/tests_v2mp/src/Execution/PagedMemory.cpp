@@ -0,0 +1,137 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+
+SCENARIO("Paged memory: Programs run identically on paged and contiguous memory", "[execution]")
+{
+	GIVEN("A program that sums the data segment, storing each partial sum to memory via the stack")
+	{
+		namespace SumDS = TestPrograms::SumDS;
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(SumDS::CS, SumDS::DS);
+		prog.SetStackSize(SumDS::SS_WORDS);
+
+		TestHarnessVM contiguousVM;
+		REQUIRE(contiguousVM.LoadProgram(prog));
+
+		TestHarnessVM pagedVM;
+		REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(pagedVM.GetMemoryStore(), 2 * V2MP_MEMORYSTORE_PAGE_SIZE));
+		REQUIRE(pagedVM.LoadProgram(prog));
+
+		WHEN("The program is loaded into paged memory")
+		{
+			THEN("Only the page containing the program is committed")
+			{
+				CHECK(V2MP_MemoryStore_GetCommittedMemorySize(pagedVM.GetMemoryStore()) == V2MP_MEMORYSTORE_PAGE_SIZE);
+			}
+		}
+
+		AND_WHEN("The program is run on both paged and contiguous memory")
+		{
+			V2MP_RunResult contiguousResult {};
+			REQUIRE(contiguousVM.Run(1000, contiguousResult));
+
+			V2MP_RunResult pagedResult {};
+			REQUIRE(pagedVM.Run(1000, pagedResult));
+
+			THEN("The program exits with the same result in both cases")
+			{
+				CHECK(pagedResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(pagedResult.cyclesExecuted == contiguousResult.cyclesExecuted);
+				CHECK(pagedVM.GetR1() == SumDS::SUM);
+				CHECK(pagedVM.GetR1() == contiguousVM.GetR1());
+				CHECK(pagedVM.GetSP() == contiguousVM.GetSP());
+			}
+
+			AND_THEN("The data segment contents are identical")
+			{
+				std::vector<V2MP_Byte> contiguousDS;
+				std::vector<V2MP_Byte> pagedDS;
+
+				REQUIRE(contiguousVM.GetDSData(0, sizeof(SumDS::DS), contiguousDS));
+				REQUIRE(pagedVM.GetDSData(0, sizeof(SumDS::DS), pagedDS));
+				CHECK(pagedDS == contiguousDS);
+			}
+		}
+	}
+}
+
+SCENARIO("Paged memory: A data segment that spans several pages is accessed a page at a time", "[execution]")
+{
+	GIVEN("A program that stores words to and loads them from different pages of a three-page data segment")
+	{
+		// Addresses are built by shifting, since ASGNL only assigns 8-bit literals.
+		const std::vector<V2MP_Word> cs =
+		{
+			Asm::ASGNL(Asm::REG_LR, 1),
+			Asm::SHFTL(Asm::REG_LR, 10),
+			Asm::ASGNL(Asm::REG_R0, 11),
+			Asm::STOR(Asm::REG_R0),
+			Asm::ASGNL(Asm::REG_LR, 1),
+			Asm::SHFTL(Asm::REG_LR, 11),
+			Asm::ASGNL(Asm::REG_R0, 22),
+			Asm::STOR(Asm::REG_R0),
+			Asm::LOAD(Asm::REG_R1),
+			Asm::ASGNL(Asm::REG_LR, 1),
+			Asm::SHFTL(Asm::REG_LR, 10),
+			Asm::LOAD(Asm::REG_R0),
+			Asm::ADDR(Asm::REG_R0, Asm::REG_R1),
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::SIG()
+		};
+
+		const std::vector<V2MP_Word> ds(3 * V2MP_MEMORYSTORE_PAGE_SIZE / sizeof(V2MP_Word), 0);
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(cs, ds);
+		prog.SetStackSize(4);
+
+		TestHarnessVM vm(4 * V2MP_MEMORYSTORE_PAGE_SIZE);
+		REQUIRE(V2MP_MemoryStore_AllocatePagedMemory(vm.GetMemoryStore(), 4 * V2MP_MEMORYSTORE_PAGE_SIZE));
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+			REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+			THEN("Each word is stored to and loaded from the correct page")
+			{
+				V2MP_Word word = 0;
+
+				CHECK(vm.GetR1() == 33);
+				REQUIRE(vm.GetDSWord(1024, word));
+				CHECK(word == 11);
+				REQUIRE(vm.GetDSWord(2048, word));
+				CHECK(word == 22);
+			}
+		}
+
+		AND_WHEN("The program is run in a VM forked from this one, so that the pages are shared")
+		{
+			std::unique_ptr<TestHarnessVM> child = vm.Fork();
+			REQUIRE(child);
+
+			V2MP_RunResult result {};
+			REQUIRE(child->Run(100, result));
+			REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+			THEN("The pages written to are copied, and the words are only visible to the child")
+			{
+				V2MP_Word word = 0;
+
+				CHECK(child->GetR1() == 33);
+				REQUIRE(child->GetDSWord(2048, word));
+				CHECK(word == 22);
+
+				REQUIRE(vm.GetDSWord(1024, word));
+				CHECK(word == 0);
+				REQUIRE(vm.GetDSWord(2048, word));
+				CHECK(word == 0);
+			}
+		}
+	}
+}
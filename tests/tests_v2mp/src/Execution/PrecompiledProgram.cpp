@@ -0,0 +1,238 @@
+#include <string>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/PrecompiledProgram.h"
+
+namespace
+{
+	static constexpr V2MP_Word MARKER = 0xBEEF;
+
+	static const V2MP_Word CS[] =
+	{
+		Asm::ASGNL(Asm::REG_R0, 5),
+		Asm::ADDL(Asm::REG_R0, 3),
+		Asm::NOP()
+	};
+
+	// Stands in for generated code covering the first two instructions.
+	// It also writes a value that the interpreter never would, so that
+	// the tests can tell which path was taken.
+	void ExecuteFirstBlock(V2MP_PrecompiledRegisters* regs)
+	{
+		regs->r0 = 8;
+		regs->r1 = MARKER;
+		regs->sr = 0;
+		regs->ir = CS[1];
+		regs->pc = 2 * sizeof(V2MP_Word);
+	}
+
+	void ExecuteFaultingBlock(V2MP_PrecompiledRegisters* regs)
+	{
+		regs->ir = CS[0];
+		regs->pc = sizeof(V2MP_Word);
+		regs->fault = V2MP_CPU_MAKE_FAULT_WORD(V2MP_FAULT_DIV, 0);
+	}
+
+	static const V2MP_PrecompiledBlock BLOCKS[] =
+	{
+		{ 0, 2, &ExecuteFirstBlock }
+	};
+
+	static const V2MP_PrecompiledBlock FAULTING_BLOCKS[] =
+	{
+		{ 0, 1, &ExecuteFaultingBlock }
+	};
+
+	V2MP_PrecompiledProgram CreateProgram(const V2MP_PrecompiledBlock* blocks)
+	{
+		V2MP_PrecompiledProgram program {};
+
+		program.abiVersion = V2MP_PRECOMPILED_ABI_VERSION;
+		program.csHash = V2MP_PrecompiledProgram_HashCS(CS, sizeof(CS) / sizeof(CS[0]));
+		program.csLengthInWords = sizeof(CS) / sizeof(CS[0]);
+		program.numBlocks = 1;
+		program.blocks = blocks;
+
+		return program;
+	}
+
+	void AppendSource(void* userData, const char* text)
+	{
+		*static_cast<std::string*>(userData) += text;
+	}
+}
+
+SCENARIO("Precompiled program: Blocks from a matching program are executed instead of being interpreted", "[execution]")
+{
+	GIVEN("A virtual machine with a program loaded")
+	{
+		TestHarnessVM vm;
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("A precompiled program generated from the same code segment is attached")
+		{
+			const V2MP_PrecompiledProgram program = CreateProgram(BLOCKS);
+			REQUIRE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+
+			AND_WHEN("The program is run")
+			{
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(3, result));
+
+				THEN("The precompiled block is executed, and accounts for one cycle per instruction")
+				{
+					CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+					CHECK(result.cyclesExecuted == 3);
+					CHECK(vm.GetR0() == 8);
+					CHECK(vm.GetR1() == MARKER);
+					CHECK(vm.GetPC() == 3 * sizeof(V2MP_Word));
+					CHECK_FALSE(vm.CPUHasFault());
+				}
+			}
+
+			AND_WHEN("The program is run with a budget smaller than the block")
+			{
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(1, result));
+
+				THEN("The instruction is interpreted instead")
+				{
+					CHECK(result.cyclesExecuted == 1);
+					CHECK(vm.GetR0() == 5);
+					CHECK(vm.GetR1() == 0);
+				}
+			}
+
+			AND_WHEN("The program is loaded again, and then run")
+			{
+				REQUIRE(vm.LoadProgram(prog));
+
+				V2MP_RunResult result {};
+				REQUIRE(vm.Run(3, result));
+
+				THEN("The precompiled program is no longer used")
+				{
+					CHECK(result.cyclesExecuted == 3);
+					CHECK(vm.GetR0() == 8);
+					CHECK(vm.GetR1() == 0);
+				}
+			}
+		}
+
+		WHEN("A precompiled block raises a fault")
+		{
+			const V2MP_PrecompiledProgram program = CreateProgram(FAULTING_BLOCKS);
+			REQUIRE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("The run stops with the fault set on the CPU")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 1);
+				CHECK(vm.CPUHasFault());
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_DIV);
+				CHECK(vm.GetPC() == sizeof(V2MP_Word));
+			}
+		}
+	}
+}
+
+SCENARIO("Precompiled program: Programs that do not match the loaded code segment are rejected", "[execution]")
+{
+	GIVEN("A virtual machine with a program loaded")
+	{
+		TestHarnessVM vm;
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		V2MP_PrecompiledProgram program = CreateProgram(BLOCKS);
+
+		WHEN("The precompiled program's code segment hash does not match")
+		{
+			++program.csHash;
+
+			THEN("Attaching the program fails")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+			}
+		}
+
+		WHEN("The precompiled program's code segment length does not match")
+		{
+			++program.csLengthInWords;
+
+			THEN("Attaching the program fails")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+			}
+		}
+
+		WHEN("The precompiled program was built for a different ABI version")
+		{
+			++program.abiVersion;
+
+			THEN("Attaching the program fails")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+			}
+		}
+
+		WHEN("The precompiled program has a block that extends past the end of the code segment")
+		{
+			static const V2MP_PrecompiledBlock OVERLONG_BLOCKS[] =
+			{
+				{ 2, 2, &ExecuteFirstBlock }
+			};
+
+			program.blocks = OVERLONG_BLOCKS;
+
+			THEN("Attaching the program fails")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program));
+			}
+		}
+
+		WHEN("A rejected program is run")
+		{
+			++program.csHash;
+			V2MP_Supervisor_SetPrecompiledProgram(vm.GetSupervisor(), &program);
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("Every instruction is interpreted")
+			{
+				CHECK(vm.GetR0() == 8);
+				CHECK(vm.GetR1() == 0);
+			}
+		}
+	}
+}
+
+SCENARIO("Precompiled program: Source is generated for a code segment", "[execution]")
+{
+	GIVEN("A code segment")
+	{
+		WHEN("Source is generated for it")
+		{
+			std::string source;
+			REQUIRE(V2MP_PrecompiledProgram_GenerateSource(CS, sizeof(CS) / sizeof(CS[0]), &AppendSource, &source));
+
+			THEN("The source defines the exported descriptor and a block for the entry point")
+			{
+				CHECK(source.find(V2MP_PRECOMPILED_PROGRAM_SYMBOL) != std::string::npos);
+				CHECK(source.find("Block_00000") != std::string::npos);
+			}
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+SCENARIO("Predecoded program: Literal operands are extended in the same way as when executing from memory", "[execution]")
+{
+	GIVEN("A virtual machine with a program that uses negative and shifted literal operands")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::IASGNL(Asm::REG_R1, -3),
+			Asm::IMULL(Asm::REG_R1, -2),
+			Asm::SHFTL(Asm::REG_R1, -1),
+			Asm::BITWL(Asm::REG_R1, Asm::BitwiseOp::OR, 3, false),
+			Asm::BITWL(Asm::REG_R1, Asm::BitwiseOp::AND, 1, true),
+			Asm::SUBL(Asm::REG_R1, 9),
+			Asm::BXZL(1),
+			Asm::ADDL(Asm::REG_R1, 100),
+			Asm::ADDL(Asm::REG_R1, 5),
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::SIG()
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The program exits with the expected exit code")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(result.cyclesExecuted == 10);
+				CHECK(vm.GetProgramExitCode() == 5);
+				CHECK_FALSE(vm.CPUHasFault());
+			}
+		}
+	}
+}
+
+SCENARIO("Predecoded program: Invalid instructions raise the same faults as when executing from memory", "[execution]")
+{
+	GIVEN("A virtual machine with a program containing an instruction with reserved bits set")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::NOP(),
+			Asm::NOP() | 0x0001
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("A RES fault is raised on the second instruction")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 2);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_RES);
+				CHECK(vm.GetPC() == 4);
+			}
+		}
+	}
+
+	GIVEN("A virtual machine with a program containing an unassigned instruction")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::Instr(Asm::Instruction::UNASSIGNED1)
+		};
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCS(CS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("The program is run")
+		{
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("An INI fault is raised, with the opcode as the fault arguments")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_INI);
+				CHECK(Asm::FaultArgsFromWord(vm.GetCPUFaultWord()) == static_cast<V2MP_Word>(Asm::Instruction::UNASSIGNED1));
+			}
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "TestUtil/Assembly.h"
+
+SCENARIO("Segment access: Addresses outside a segment raise a SEG fault, even if memory follows it", "[execution]")
+{
+	GIVEN("A virtual machine with a program that has code, data and stack segments")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word DS[] = { 0x1234 };
+
+		WHEN("Execution runs past the end of the code segment")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::NOP()
+			};
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+			prog.SetStackSize(4);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(10, result));
+
+			THEN("A SEG fault is raised on the cycle that fetches the next instruction")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 2);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+			}
+		}
+
+		WHEN("A word is loaded from just past the end of the data segment")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 2),
+				Asm::LOAD(Asm::REG_R0)
+			};
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+			prog.SetStackSize(4);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(10, result));
+
+			THEN("A SEG fault is raised")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+			}
+		}
+	}
+}
+
+SCENARIO("Segment access: Reallocating memory invalidates the loaded program's data and stack segments", "[execution]")
+{
+	GIVEN("A virtual machine with a loaded program")
+	{
+		TestHarnessVM vm;
+
+		static const V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_LR, 2),
+			Asm::LOAD(Asm::REG_R0),
+			Asm::ADDL(Asm::REG_R0, 1)
+		};
+
+		static const V2MP_Word DS[] = { 0x1234, 9 };
+
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(CS, DS);
+		prog.SetStackSize(4);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		WHEN("Memory is reallocated to be too small for the program, and the program is run")
+		{
+			REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(vm.GetMemoryStore(), sizeof(V2MP_Word)));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(10, result));
+
+			THEN("A SEG fault is raised when loading from the data segment, instead of accessing the old memory")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_FAULT);
+				CHECK(result.cyclesExecuted == 2);
+				CHECK(Asm::FaultFromWord(vm.GetCPUFaultWord()) == V2MP_FAULT_SEG);
+			}
+
+			AND_THEN("The data segment can no longer be read")
+			{
+				V2MP_Word word = 0;
+				CHECK_FALSE(vm.GetDSWord(0, word));
+			}
+
+			AND_THEN("The code segment, which is not held in memory, can still be read")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(vm.GetCSWord(0, word));
+				CHECK(word == CS[0]);
+			}
+		}
+
+		WHEN("Memory is reallocated and the program is loaded again")
+		{
+			REQUIRE(V2MP_MemoryStore_AllocateTotalMemory(vm.GetMemoryStore(), 2 * TestHarnessVM::DEFAULT_RAM_BYTES));
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("The program runs from the new memory")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(vm.GetR0() == 10);
+			}
+
+			AND_THEN("The data segment is read from the new memory")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(vm.GetDSWord(0, word));
+				CHECK(word == 0x1234);
+			}
+		}
+	}
+}
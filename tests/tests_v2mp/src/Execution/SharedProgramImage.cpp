@@ -0,0 +1,133 @@
+#include <memory>
+#include <vector>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+
+namespace
+{
+	namespace SumDS = TestPrograms::SumDS;
+
+	static constexpr size_t DS_WORDS = SumDS::DS_WORDS;
+	static constexpr size_t SS_WORDS = SumDS::SS_WORDS;
+	static constexpr size_t NUM_VMS = 4;
+}
+
+SCENARIO("Shared program image: Many VMs can run a program from one image", "[execution]")
+{
+	GIVEN("A program image, and several VMs with only enough memory for the data and stack segments")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(SumDS::CS, SumDS::CS_WORDS);
+		REQUIRE(image);
+
+		std::vector<std::unique_ptr<TestHarnessVM>> vms;
+
+		for ( size_t index = 0; index < NUM_VMS; ++index )
+		{
+			vms.emplace_back(new TestHarnessVM((DS_WORDS + SS_WORDS) * sizeof(V2MP_Word)));
+		}
+
+		WHEN("The image is loaded into each VM, each with different data")
+		{
+			for ( size_t index = 0; index < NUM_VMS; ++index )
+			{
+				const V2MP_Word base = static_cast<V2MP_Word>(index + 1);
+				const V2MP_Word ds[DS_WORDS] = { base, base, base, base, 0 };
+
+				REQUIRE(V2MP_Supervisor_LoadProgramImage(vms[index]->GetSupervisor(), image, ds, DS_WORDS, SS_WORDS));
+				CHECK(V2MP_Supervisor_GetProgramImage(vms[index]->GetSupervisor()) == image);
+			}
+
+			THEN("Each VM holds a reference to the image")
+			{
+				CHECK(V2MP_ProgramImage_GetRefCount(image) == NUM_VMS + 1);
+			}
+
+			AND_THEN("Each VM runs the program against its own data")
+			{
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					V2MP_RunResult result {};
+					REQUIRE(vms[index]->Run(1000, result));
+
+					CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(vms[index]->GetR1() == 4 * (index + 1));
+				}
+
+				// Each VM stored its partial sums to its own data segment.
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					V2MP_Word word = 0;
+					REQUIRE(vms[index]->GetDSWord(SumDS::PARTIAL_SUM_ADDRESS, word));
+					CHECK(word == 4 * (index + 1));
+				}
+			}
+
+			AND_THEN("The code segment is fetched from the image")
+			{
+				V2MP_Word word = 0;
+				REQUIRE(vms[0]->GetCSWord(0, word));
+				CHECK(word == SumDS::CS[0]);
+			}
+		}
+
+		AND_WHEN("The creator releases its reference after loading the image")
+		{
+			REQUIRE(V2MP_Supervisor_LoadProgramImage(vms[0]->GetSupervisor(), image, SumDS::DS, DS_WORDS, SS_WORDS));
+			V2MP_ProgramImage_Release(image);
+			image = nullptr;
+
+			THEN("The VM can still run the program")
+			{
+				V2MP_RunResult result {};
+				REQUIRE(vms[0]->Run(1000, result));
+
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(vms[0]->GetR1() == SumDS::SUM);
+			}
+		}
+
+		AND_WHEN("A VM that holds the image is forked")
+		{
+			REQUIRE(V2MP_Supervisor_LoadProgramImage(vms[0]->GetSupervisor(), image, SumDS::DS, DS_WORDS, SS_WORDS));
+			std::unique_ptr<TestHarnessVM> child = vms[0]->Fork();
+			REQUIRE(child);
+
+			THEN("The forked VM shares the image")
+			{
+				CHECK(V2MP_Supervisor_GetProgramImage(child->GetSupervisor()) == image);
+				CHECK(V2MP_ProgramImage_GetRefCount(image) == 3);
+			}
+
+			AND_THEN("The data that the forked VM writes is not seen by its parent")
+			{
+				V2MP_RunResult result {};
+				REQUIRE(child->Run(1000, result));
+				REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+				V2MP_Word word = 0;
+				REQUIRE(child->GetDSWord(SumDS::PARTIAL_SUM_ADDRESS, word));
+				CHECK(word == SumDS::SUM);
+				REQUIRE(vms[0]->GetDSWord(SumDS::PARTIAL_SUM_ADDRESS, word));
+				CHECK(word == 0);
+			}
+		}
+
+		AND_WHEN("A program is cleared from a VM that holds the image")
+		{
+			REQUIRE(V2MP_Supervisor_LoadProgramImage(vms[0]->GetSupervisor(), image, SumDS::DS, DS_WORDS, SS_WORDS));
+			V2MP_Supervisor_ClearProgram(vms[0]->GetSupervisor());
+
+			THEN("The VM releases its reference")
+			{
+				CHECK(V2MP_ProgramImage_GetRefCount(image) == 1);
+				CHECK(V2MP_Supervisor_GetProgramImage(vms[0]->GetSupervisor()) == nullptr);
+			}
+		}
+
+		vms.clear();
+		V2MP_ProgramImage_Release(image);
+	}
+}
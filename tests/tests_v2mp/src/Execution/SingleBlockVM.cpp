@@ -0,0 +1,200 @@
+#include <cstdint>
+#include "catch2/catch.hpp"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/VirtualMachine.h"
+#include "LibV2MP/Modules/Supervisor.h"
+#include "LibV2MP/Modules/Mainboard.h"
+#include "LibV2MP/Modules/MemoryStore.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "LibV2MP/Modules/CPU.h"
+
+namespace
+{
+	// Pushes the first word of the data segment to the stack,
+	// and then stores it to the third word of the data segment.
+	static const V2MP_Word CS[] =
+	{
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R0),
+		Asm::PUSH(1 << Asm::REG_R0),
+		Asm::ASGNL(Asm::REG_LR, 4),
+		Asm::STOR(Asm::REG_R0),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	static const V2MP_Word DS[] = { 7, 0, 0 };
+
+	static constexpr size_t MEMORY_BYTES = 64;
+	static constexpr size_t SS_WORDS = 4;
+
+	V2MP_MemoryStore* GetMemoryStore(V2MP_VirtualMachine* vm)
+	{
+		return V2MP_Mainboard_GetMemoryStore(V2MP_VirtualMachine_GetMainboard(vm));
+	}
+
+	V2MP_Word GetMemoryWord(V2MP_VirtualMachine* vm, size_t address)
+	{
+		V2MP_Word word = 0;
+		REQUIRE(V2MP_MemoryStore_LoadWord(GetMemoryStore(vm), address, &word));
+		return word;
+	}
+
+	V2MP_RunResult RunToCompletion(V2MP_VirtualMachine* vm)
+	{
+		V2MP_RunResult result {};
+		REQUIRE(V2MP_VirtualMachine_Run(vm, 100, &result));
+		REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+		return result;
+	}
+
+	bool IsAligned(const void* ptr)
+	{
+		return (reinterpret_cast<std::uintptr_t>(ptr) % 64) == 0;
+	}
+}
+
+SCENARIO("Single-block VMs: A VM allocated in a single block behaves like any other", "[execution]")
+{
+	GIVEN("A VM allocated in a single block, and a VM allocated normally")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(CS, sizeof(CS) / sizeof(CS[0]));
+		REQUIRE(image);
+
+		V2MP_VirtualMachine* vm = V2MP_VirtualMachine_AllocateAndInitInSingleBlock(MEMORY_BYTES);
+		REQUIRE(vm);
+
+		V2MP_VirtualMachine* reference = V2MP_VirtualMachine_AllocateAndInit();
+		REQUIRE(reference);
+		REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(reference, MEMORY_BYTES));
+
+		THEN("Its memory is allocated, contiguous, and zeroed")
+		{
+			V2MP_MemoryStore* memoryStore = GetMemoryStore(vm);
+
+			CHECK(V2MP_VirtualMachine_GetTotalMemoryBytes(vm) == MEMORY_BYTES);
+			CHECK_FALSE(V2MP_MemoryStore_IsPaged(memoryStore));
+
+			for ( size_t address = 0; address < MEMORY_BYTES; address += sizeof(V2MP_Word) )
+			{
+				INFO("Address " << address);
+				CHECK(GetMemoryWord(vm, address) == 0);
+			}
+		}
+
+		AND_THEN("Each of its modules begins on a cache line, in order after the VM")
+		{
+			V2MP_Supervisor* supervisor = V2MP_VirtualMachine_GetSupervisor(vm);
+			V2MP_Mainboard* mainboard = V2MP_VirtualMachine_GetMainboard(vm);
+			V2MP_CPU* cpu = V2MP_Mainboard_GetCPU(mainboard);
+			V2MP_MemoryStore* memoryStore = V2MP_Mainboard_GetMemoryStore(mainboard);
+
+			CHECK(IsAligned(vm));
+			CHECK(IsAligned(supervisor));
+			CHECK(IsAligned(mainboard));
+			CHECK(IsAligned(cpu));
+			CHECK(IsAligned(memoryStore));
+
+			const std::uintptr_t vmAddress = reinterpret_cast<std::uintptr_t>(vm);
+
+			CHECK(reinterpret_cast<std::uintptr_t>(supervisor) > vmAddress);
+			CHECK(reinterpret_cast<std::uintptr_t>(mainboard) > reinterpret_cast<std::uintptr_t>(supervisor));
+			CHECK(reinterpret_cast<std::uintptr_t>(cpu) > reinterpret_cast<std::uintptr_t>(mainboard));
+			CHECK(reinterpret_cast<std::uintptr_t>(memoryStore) > reinterpret_cast<std::uintptr_t>(cpu));
+		}
+
+		AND_WHEN("The same program is run on both")
+		{
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, DS, 3, SS_WORDS));
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(reference, image, DS, 3, SS_WORDS));
+
+			const V2MP_RunResult result = RunToCompletion(vm);
+			const V2MP_RunResult referenceResult = RunToCompletion(reference);
+
+			THEN("The results are the same")
+			{
+				CHECK(result.cyclesExecuted == referenceResult.cyclesExecuted);
+
+				// Only the data segment and the pushed word are initialised in the reference VM.
+				for ( size_t address = 0; address < sizeof(DS) + sizeof(V2MP_Word); address += sizeof(V2MP_Word) )
+				{
+					INFO("Address " << address);
+					CHECK(GetMemoryWord(vm, address) == GetMemoryWord(reference, address));
+				}
+
+				CHECK(GetMemoryWord(vm, 4) == 7);
+			}
+		}
+
+		AND_WHEN("The program is run with memory accesses deferred as actions")
+		{
+			V2MP_Supervisor_SetDeferredMemoryAccessEnabled(V2MP_VirtualMachine_GetSupervisor(vm), true);
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, DS, 3, SS_WORDS));
+			RunToCompletion(vm);
+
+			THEN("The actions are performed")
+			{
+				CHECK(GetMemoryWord(vm, 4) == 7);
+				CHECK(GetMemoryWord(vm, 6) == 7);
+			}
+		}
+
+		AND_WHEN("The VM's memory is reallocated")
+		{
+			REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, 2 * MEMORY_BYTES));
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, DS, 3, SS_WORDS));
+			RunToCompletion(vm);
+
+			THEN("The program runs in the new memory")
+			{
+				CHECK(V2MP_VirtualMachine_GetTotalMemoryBytes(vm) == 2 * MEMORY_BYTES);
+				CHECK(GetMemoryWord(vm, 4) == 7);
+			}
+		}
+
+		AND_WHEN("The VM is forked after loading the program")
+		{
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, DS, 3, SS_WORDS));
+
+			V2MP_VirtualMachine* child = V2MP_VirtualMachine_Fork(vm);
+			REQUIRE(child);
+
+			RunToCompletion(child);
+
+			THEN("The child runs the program without affecting the parent")
+			{
+				CHECK(GetMemoryWord(child, 4) == 7);
+				CHECK(GetMemoryWord(vm, 4) == 0);
+			}
+
+			V2MP_VirtualMachine_DeinitAndFree(child);
+		}
+
+		V2MP_VirtualMachine_DeinitAndFree(reference);
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+		V2MP_ProgramImage_Release(image);
+	}
+
+	GIVEN("A VM allocated in a single block with no memory")
+	{
+		V2MP_VirtualMachine* vm = V2MP_VirtualMachine_AllocateAndInitInSingleBlock(0);
+		REQUIRE(vm);
+
+		THEN("It has no memory until some is allocated")
+		{
+			CHECK(V2MP_VirtualMachine_GetTotalMemoryBytes(vm) == 0);
+			REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, MEMORY_BYTES));
+			CHECK(V2MP_VirtualMachine_GetTotalMemoryBytes(vm) == MEMORY_BYTES);
+		}
+
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+	}
+
+	GIVEN("An odd memory size")
+	{
+		THEN("A VM cannot be allocated in a single block")
+		{
+			CHECK_FALSE(V2MP_VirtualMachine_AllocateAndInitInSingleBlock(MEMORY_BYTES + 1));
+		}
+	}
+}
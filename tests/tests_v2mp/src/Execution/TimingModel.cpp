@@ -0,0 +1,469 @@
+#include <memory>
+#include <vector>
+#include <string>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+
+namespace
+{
+	namespace SumDS = TestPrograms::SumDS;
+
+	static constexpr V2MP_Word STRIDE_ITERATIONS = 8;
+
+	// Loads alternately from address 0 and from the given address,
+	// STRIDE_ITERATIONS times each.
+	std::vector<V2MP_Word> StrideCS(V2MP_Word address)
+	{
+		return std::vector<V2MP_Word>(
+		{
+			Asm::ASGNL(Asm::REG_R1, STRIDE_ITERATIONS),
+			Asm::ASGNL(Asm::REG_LR, 0),
+			Asm::LOAD(Asm::REG_R0),
+			Asm::ASGNL(Asm::REG_LR, static_cast<uint8_t>(address)),
+			Asm::LOAD(Asm::REG_R0),
+			Asm::SUBL(Asm::REG_R1, 1),
+			Asm::BXZL(1),
+			Asm::SUBL(Asm::REG_PC, 7),
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::SIG()
+		});
+	}
+
+	V2MP_Supervisor_TimingModel LatencyOnlyModel()
+	{
+		V2MP_Supervisor_TimingModel model {};
+
+		model.loadLatency = 3;
+		model.storeLatency = 2;
+		model.stackLatency = 1;
+
+		return model;
+	}
+
+	V2MP_Supervisor_TimingModel SingleLineCacheModel()
+	{
+		V2MP_Supervisor_TimingModel model {};
+
+		model.loadLatency = 1;
+		model.cacheNumSets = 1;
+		model.cacheNumWays = 1;
+		model.cacheLineSizeInBytes = 4;
+		model.cacheMissPenalty = 10;
+
+		return model;
+	}
+
+	void LoadSumProgram(TestHarnessVM& vm)
+	{
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(SumDS::CS, SumDS::DS);
+		prog.SetStackSize(SumDS::SS_WORDS);
+
+		REQUIRE(vm.LoadProgram(prog));
+	}
+}
+
+SCENARIO("Timing model: Memory accesses take the modelled number of cycles", "[execution]")
+{
+	GIVEN("A virtual machine with a timing model that only specifies latencies")
+	{
+		TestHarnessVM vm;
+
+		const V2MP_Supervisor_TimingModel model = LatencyOnlyModel();
+		REQUIRE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+
+		WHEN("A program loads a single word and exits")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			};
+
+			static const V2MP_Word DS[] = { 0x1234 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("The CPU stalls for the load latency after the load")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				CHECK(result.cyclesExecuted == 4 + model.loadLatency);
+				CHECK(vm.GetR1() == 0x1234);
+			}
+		}
+
+		AND_WHEN("The run stops while the CPU is stalled")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::ADDL(Asm::REG_R1, 1)
+			};
+
+			static const V2MP_Word DS[] = { 0x1234 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(3, result));
+
+			THEN("The load has not completed yet")
+			{
+				CHECK(result.stopReason == V2MP_RUNSTOP_CYCLE_LIMIT);
+				CHECK(V2MP_CPU_IsStalled(V2MP_Mainboard_GetCPU(V2MP_Supervisor_GetMainboard(vm.GetSupervisor()))));
+				CHECK(vm.GetR1() == 0);
+				CHECK(vm.GetPC() == 4);
+			}
+
+			AND_THEN("Running on completes the load before the next instruction is executed")
+			{
+				REQUIRE(vm.Run(3, result));
+
+				CHECK(vm.GetR1() == 0x1235);
+				CHECK(vm.GetPC() == 6);
+			}
+
+			AND_THEN("A forked VM completes the load in the same way")
+			{
+				std::unique_ptr<TestHarnessVM> child = vm.Fork();
+				REQUIRE(child);
+
+				REQUIRE(child->Run(3, result));
+
+				CHECK(child->GetR1() == 0x1235);
+				CHECK(child->GetPC() == 6);
+			}
+		}
+	}
+}
+
+SCENARIO("Timing model: Programs produce the same results, taking more cycles", "[execution]")
+{
+	GIVEN("Two virtual machines, one of which has a timing model")
+	{
+		TestHarnessVM untimedVM;
+		TestHarnessVM timedVM;
+
+		const V2MP_Supervisor_TimingModel model = LatencyOnlyModel();
+		REQUIRE(V2MP_Supervisor_SetTimingModel(timedVM.GetSupervisor(), &model));
+
+		V2MP_Supervisor_TimingModel retrievedModel {};
+		REQUIRE(V2MP_Supervisor_GetTimingModel(timedVM.GetSupervisor(), &retrievedModel));
+		CHECK(retrievedModel.loadLatency == model.loadLatency);
+		CHECK_FALSE(V2MP_Supervisor_GetTimingModel(untimedVM.GetSupervisor(), &retrievedModel));
+
+		WHEN("The same program is run on both")
+		{
+			LoadSumProgram(untimedVM);
+			LoadSumProgram(timedVM);
+
+			V2MP_RunResult untimedResult {};
+			V2MP_RunResult timedResult {};
+			REQUIRE(untimedVM.Run(1000, untimedResult));
+			REQUIRE(timedVM.Run(1000, timedResult));
+
+			THEN("The results are identical")
+			{
+				REQUIRE(untimedResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				REQUIRE(timedResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+				CHECK(timedVM.GetR1() == untimedVM.GetR1());
+				CHECK(timedVM.GetR1() == SumDS::SUM);
+
+				std::vector<V2MP_Byte> untimedDS;
+				std::vector<V2MP_Byte> timedDS;
+				REQUIRE(untimedVM.GetDSData(0, sizeof(SumDS::DS), untimedDS));
+				REQUIRE(timedVM.GetDSData(0, sizeof(SumDS::DS), timedDS));
+				CHECK(timedDS == untimedDS);
+			}
+
+			AND_THEN("Each iteration takes the latencies of its load, store, push and pop in additional cycles")
+			{
+				const size_t perIteration = model.loadLatency + model.storeLatency + (2 * model.stackLatency);
+				CHECK(timedResult.cyclesExecuted == untimedResult.cyclesExecuted + (4 * perIteration));
+			}
+		}
+
+		AND_WHEN("The timing model is removed")
+		{
+			REQUIRE(V2MP_Supervisor_SetTimingModel(timedVM.GetSupervisor(), nullptr));
+
+			LoadSumProgram(untimedVM);
+			LoadSumProgram(timedVM);
+
+			V2MP_RunResult untimedResult {};
+			V2MP_RunResult timedResult {};
+			REQUIRE(untimedVM.Run(1000, untimedResult));
+			REQUIRE(timedVM.Run(1000, timedResult));
+
+			THEN("The program takes the same number of cycles on both")
+			{
+				CHECK(timedResult.cyclesExecuted == untimedResult.cyclesExecuted);
+			}
+		}
+	}
+}
+
+SCENARIO("Timing model: A simulated cache adds a penalty to accesses that miss", "[execution]")
+{
+	GIVEN("A virtual machine with a cache of a single two-word line")
+	{
+		TestHarnessVM vm;
+
+		const V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+		REQUIRE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+
+		WHEN("A program loads two words from the same line")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::ASGNL(Asm::REG_LR, 2),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			};
+
+			static const V2MP_Word DS[] = { 1, 2, 3 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("Only the first load misses")
+			{
+				V2MP_Supervisor_CacheStatistics stats {};
+				V2MP_Supervisor_GetCacheStatistics(vm.GetSupervisor(), &stats);
+
+				CHECK(stats.hits == 1);
+				CHECK(stats.misses == 1);
+				CHECK(result.cyclesExecuted == 6 + (2 * model.loadLatency) + model.cacheMissPenalty);
+				CHECK(vm.GetR1() == 2);
+			}
+
+			AND_THEN("Loading the program again empties the cache and clears the statistics")
+			{
+				REQUIRE(vm.LoadProgram(prog));
+
+				V2MP_Supervisor_CacheStatistics stats {};
+				V2MP_Supervisor_GetCacheStatistics(vm.GetSupervisor(), &stats);
+
+				CHECK(stats.hits == 0);
+				CHECK(stats.misses == 0);
+			}
+		}
+
+		AND_WHEN("A program alternates loads between two lines that map to the same set")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::ASGNL(Asm::REG_LR, 4),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			};
+
+			static const V2MP_Word DS[] = { 1, 2, 3 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("Each load evicts the other line, so every load misses")
+			{
+				V2MP_Supervisor_CacheStatistics stats {};
+				V2MP_Supervisor_GetCacheStatistics(vm.GetSupervisor(), &stats);
+
+				CHECK(stats.hits == 0);
+				CHECK(stats.misses == 3);
+				CHECK(vm.GetR1() == 3);
+			}
+		}
+	}
+
+	GIVEN("A virtual machine with a two-way cache")
+	{
+		TestHarnessVM vm;
+
+		V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+		model.cacheNumWays = 2;
+		REQUIRE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+
+		WHEN("A program alternates loads between two lines that map to the same set")
+		{
+			static const V2MP_Word CS[] =
+			{
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::ASGNL(Asm::REG_LR, 4),
+				Asm::LOAD(Asm::REG_R1),
+				Asm::ASGNL(Asm::REG_LR, 0),
+				Asm::LOAD(Asm::REG_R0),
+				Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+				Asm::SIG()
+			};
+
+			static const V2MP_Word DS[] = { 1, 2, 3 };
+
+			TestHarnessVM::ProgramDef prog;
+			prog.SetCSAndDS(CS, DS);
+
+			REQUIRE(vm.LoadProgram(prog));
+
+			V2MP_RunResult result {};
+			REQUIRE(vm.Run(100, result));
+
+			THEN("Both lines fit in the set, so the last load hits")
+			{
+				V2MP_Supervisor_CacheStatistics stats {};
+				V2MP_Supervisor_GetCacheStatistics(vm.GetSupervisor(), &stats);
+
+				CHECK(stats.hits == 1);
+				CHECK(stats.misses == 2);
+			}
+		}
+	}
+}
+
+SCENARIO("Timing model: The cost of a strided loop depends on whether its addresses conflict", "[execution]")
+{
+	// Two direct-mapped sets of two-word lines, so that addresses
+	// 4 bytes apart map to different sets, and addresses 8 bytes
+	// apart map to the same set.
+	for ( size_t numWays : { 1, 2 } )
+	{
+		GIVEN("A virtual machine with a " + std::to_string(numWays) + "-way cache of two sets")
+		{
+			V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+			model.cacheNumSets = 2;
+			model.cacheNumWays = numWays;
+
+			static const V2MP_Word DS[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+			V2MP_RunResult results[2] {};
+			V2MP_Supervisor_CacheStatistics stats[2] {};
+			const V2MP_Word strides[2] = { 4, 8 };
+
+			for ( size_t index = 0; index < 2; ++index )
+			{
+				const std::vector<V2MP_Word> cs = StrideCS(strides[index]);
+				const std::vector<V2MP_Word> ds(DS, DS + (sizeof(DS) / sizeof(DS[0])));
+
+				TestHarnessVM vm;
+				REQUIRE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+
+				TestHarnessVM::ProgramDef prog;
+				prog.SetCSAndDS(cs, ds);
+				REQUIRE(vm.LoadProgram(prog));
+
+				REQUIRE(vm.Run(1000, results[index]));
+				REQUIRE(results[index].stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+				V2MP_Supervisor_GetCacheStatistics(vm.GetSupervisor(), &stats[index]);
+			}
+
+			WHEN("A loop alternates loads between lines in different sets")
+			{
+				THEN("Only the first load from each line misses")
+				{
+					CHECK(stats[0].misses == 2);
+					CHECK(stats[0].hits == (2 * STRIDE_ITERATIONS) - 2);
+				}
+			}
+
+			AND_WHEN("A loop alternates loads between lines in the same set")
+			{
+				if ( numWays < 2 )
+				{
+					THEN("Each load evicts the other line, so every load misses")
+					{
+						CHECK(stats[1].misses == 2 * STRIDE_ITERATIONS);
+						CHECK(stats[1].hits == 0);
+					}
+
+					AND_THEN("The loop takes the miss penalty for every load that would otherwise hit")
+					{
+						CHECK(results[1].cyclesExecuted ==
+						      results[0].cyclesExecuted + (((2 * STRIDE_ITERATIONS) - 2) * model.cacheMissPenalty));
+					}
+				}
+				else
+				{
+					THEN("Both lines fit in the set, so the loop costs the same as one that does not conflict")
+					{
+						CHECK(stats[1].misses == 2);
+						CHECK(results[1].cyclesExecuted == results[0].cyclesExecuted);
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Timing model: Invalid models are rejected", "[execution]")
+{
+	GIVEN("A virtual machine")
+	{
+		TestHarnessVM vm;
+
+		WHEN("A model with a number of cache sets that is not a power of two is set")
+		{
+			V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+			model.cacheNumSets = 3;
+
+			THEN("The model is rejected")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+				CHECK_FALSE(V2MP_Supervisor_GetTimingModel(vm.GetSupervisor(), &model));
+			}
+		}
+
+		AND_WHEN("A model with a cache line smaller than a word is set")
+		{
+			V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+			model.cacheLineSizeInBytes = 1;
+
+			THEN("The model is rejected")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+			}
+		}
+
+		AND_WHEN("A model with no ways per cache set is set")
+		{
+			V2MP_Supervisor_TimingModel model = SingleLineCacheModel();
+			model.cacheNumWays = 0;
+
+			THEN("The model is rejected")
+			{
+				CHECK_FALSE(V2MP_Supervisor_SetTimingModel(vm.GetSupervisor(), &model));
+			}
+		}
+	}
+}
@@ -0,0 +1,387 @@
+#include <vector>
+#include "catch2/catch.hpp"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/VMCache.h"
+#include "LibV2MP/Modules/VirtualMachine.h"
+#include "LibV2MP/Modules/Supervisor.h"
+#include "LibV2MP/Modules/Mainboard.h"
+#include "LibV2MP/Modules/MemoryStore.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "LibV2MP/Modules/CPU.h"
+
+namespace
+{
+	// Pushes the first word of the data segment to the stack,
+	// and then stores it to the third word of the data segment.
+	static const V2MP_Word CS[] =
+	{
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R0),
+		Asm::PUSH(1 << Asm::REG_R0),
+		Asm::ASGNL(Asm::REG_LR, 4),
+		Asm::STOR(Asm::REG_R0),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	// Swaps to data page 1 and loads its first word into R1,
+	// leaving page 1 mapped when the program ends.
+	static const V2MP_Word SWAP_CS[] =
+	{
+		Asm::ASGNL(Asm::REG_R1, 1),
+		Asm::ASGNL(Asm::REG_R0, V2MP_SIGNAL_SWAP_DATA_PAGE),
+		Asm::SIG(),
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R1),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	static constexpr size_t MEMORY_BYTES = 64;
+	static constexpr size_t SS_WORDS = 4;
+
+	// Beyond the end of the stack segment, so never written by the program.
+	static constexpr size_t SENTINEL_ADDRESS = 32;
+	static constexpr V2MP_Word SENTINEL = 0xBEEF;
+
+	V2MP_MemoryStore* GetMemoryStore(V2MP_VirtualMachine* vm)
+	{
+		return V2MP_Mainboard_GetMemoryStore(V2MP_VirtualMachine_GetMainboard(vm));
+	}
+
+	V2MP_CPU* GetCPU(V2MP_VirtualMachine* vm)
+	{
+		return V2MP_Mainboard_GetCPU(V2MP_VirtualMachine_GetMainboard(vm));
+	}
+
+	V2MP_Word GetMemoryWord(V2MP_VirtualMachine* vm, size_t address)
+	{
+		V2MP_Word word = 0;
+		REQUIRE(V2MP_MemoryStore_LoadWord(GetMemoryStore(vm), address, &word));
+		return word;
+	}
+
+	void RunToCompletion(V2MP_VirtualMachine* vm)
+	{
+		V2MP_RunResult result {};
+		REQUIRE(V2MP_VirtualMachine_Run(vm, 100, &result));
+		REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+	}
+
+	void CheckCPUIsReset(V2MP_VirtualMachine* vm)
+	{
+		V2MP_CPU* cpu = GetCPU(vm);
+
+		CHECK(V2MP_CPU_GetR0(cpu) == 0);
+		CHECK(V2MP_CPU_GetR1(cpu) == 0);
+		CHECK(V2MP_CPU_GetLinkRegister(cpu) == 0);
+		CHECK(V2MP_CPU_GetProgramCounter(cpu) == 0);
+		CHECK(V2MP_CPU_GetStatusRegister(cpu) == 0);
+		CHECK(V2MP_CPU_GetStackPointer(cpu) == 0);
+		CHECK(V2MP_CPU_GetFaultWord(cpu) == 0);
+		CHECK_FALSE(V2MP_Supervisor_HasProgramExited(V2MP_VirtualMachine_GetSupervisor(vm)));
+	}
+}
+
+SCENARIO("Reusing VMs: Reloading a program resets the VM, and clears only the memory that was written", "[execution]")
+{
+	GIVEN("A VM that has run a program to completion")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(CS, sizeof(CS) / sizeof(CS[0]));
+		REQUIRE(image);
+
+		V2MP_VirtualMachine* vm = V2MP_VirtualMachine_AllocateAndInit();
+		REQUIRE(vm);
+		REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, MEMORY_BYTES));
+		REQUIRE(V2MP_MemoryStore_StoreWord(GetMemoryStore(vm), SENTINEL_ADDRESS, SENTINEL));
+
+		const V2MP_Word firstDS[] = { 7, 0, 0 };
+		REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, firstDS, 3, SS_WORDS));
+		RunToCompletion(vm);
+
+		REQUIRE(GetMemoryWord(vm, 4) == 7);
+		REQUIRE(GetMemoryWord(vm, 6) == 7);
+
+		WHEN("The program is reloaded with a new data segment")
+		{
+			const V2MP_Word secondDS[] = { 9, 0, 0 };
+			REQUIRE(V2MP_VirtualMachine_ReloadProgram(vm, secondDS, 3, SS_WORDS));
+
+			THEN("The CPU is reset, the new data segment is loaded, and the stack is cleared")
+			{
+				CheckCPUIsReset(vm);
+				CHECK(V2MP_Supervisor_GetProgramImage(V2MP_VirtualMachine_GetSupervisor(vm)) == image);
+				CHECK(GetMemoryWord(vm, 0) == 9);
+				CHECK(GetMemoryWord(vm, 4) == 0);
+				CHECK(GetMemoryWord(vm, 6) == 0);
+			}
+
+			AND_THEN("Memory that the program did not write to is left alone")
+			{
+				CHECK(GetMemoryWord(vm, SENTINEL_ADDRESS) == SENTINEL);
+			}
+
+			AND_THEN("The program runs again from the start")
+			{
+				RunToCompletion(vm);
+
+				CHECK(GetMemoryWord(vm, 4) == 9);
+				CHECK(GetMemoryWord(vm, 6) == 9);
+			}
+		}
+
+		AND_WHEN("The program is reloaded with a shorter data segment")
+		{
+			const V2MP_Word secondDS[] = { 9 };
+			REQUIRE(V2MP_VirtualMachine_ReloadProgram(vm, secondDS, 1, SS_WORDS));
+
+			THEN("Nothing that the previous run wrote remains in memory")
+			{
+				CHECK(GetMemoryWord(vm, 0) == 9);
+
+				// The previous run wrote to the rest of its data segment and the first word of
+				// its stack. The rest of memory was never initialised, so is not checked.
+				for ( size_t address = 2; address <= 6; address += sizeof(V2MP_Word) )
+				{
+					INFO("Address " << address);
+					CHECK(GetMemoryWord(vm, address) == 0);
+				}
+			}
+		}
+
+		AND_WHEN("Only the program state is reset")
+		{
+			REQUIRE(V2MP_VirtualMachine_ResetProgramState(vm));
+
+			THEN("The program remains loaded, but everything it wrote is cleared")
+			{
+				CheckCPUIsReset(vm);
+				CHECK(V2MP_VirtualMachine_IsProgramLoaded(vm));
+				CHECK(GetMemoryWord(vm, 0) == 0);
+				CHECK(GetMemoryWord(vm, 4) == 0);
+				CHECK(GetMemoryWord(vm, 6) == 0);
+				CHECK(GetMemoryWord(vm, SENTINEL_ADDRESS) == SENTINEL);
+			}
+		}
+
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+		V2MP_ProgramImage_Release(image);
+	}
+
+	GIVEN("A VM with no program loaded")
+	{
+		V2MP_VirtualMachine* vm = V2MP_VirtualMachine_AllocateAndInit();
+		REQUIRE(vm);
+		REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, MEMORY_BYTES));
+
+		WHEN("A program is reloaded")
+		{
+			THEN("This fails")
+			{
+				const V2MP_Word ds[] = { 1 };
+				CHECK_FALSE(V2MP_VirtualMachine_ReloadProgram(vm, ds, 1, SS_WORDS));
+			}
+		}
+
+		V2MP_VirtualMachine_DeinitAndFree(vm);
+	}
+}
+
+SCENARIO("Reusing VMs: A VM cache hands out recycled VMs", "[execution]")
+{
+	GIVEN("A VM cache that holds up to two VMs")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(CS, sizeof(CS) / sizeof(CS[0]));
+		REQUIRE(image);
+
+		V2MP_ProgramImage* otherImage = V2MP_ProgramImage_AllocateAndInit(CS, sizeof(CS) / sizeof(CS[0]));
+		REQUIRE(otherImage);
+
+		V2MP_VMCache* cache = V2MP_VMCache_AllocateAndInit(MEMORY_BYTES, 2);
+		REQUIRE(cache);
+		REQUIRE(V2MP_VMCache_GetIdleCount(cache) == 0);
+
+		const V2MP_Word ds[] = { 7, 0, 0 };
+
+		WHEN("A VM is acquired, run and recycled")
+		{
+			V2MP_VirtualMachine* vm = V2MP_VMCache_AcquireWithProgramImage(cache, image, ds, 3, SS_WORDS);
+			REQUIRE(vm);
+			CHECK(V2MP_VirtualMachine_GetTotalMemoryBytes(vm) == MEMORY_BYTES);
+
+			RunToCompletion(vm);
+			V2MP_VMCache_Recycle(cache, vm);
+
+			THEN("The cache holds it")
+			{
+				CHECK(V2MP_VMCache_GetIdleCount(cache) == 1);
+			}
+
+			AND_THEN("The same VM is handed out again, reset and ready to run")
+			{
+				const V2MP_Word newDS[] = { 9, 0, 0 };
+				V2MP_VirtualMachine* reused = V2MP_VMCache_AcquireWithProgramImage(cache, image, newDS, 3, SS_WORDS);
+
+				REQUIRE(reused == vm);
+				CHECK(V2MP_VMCache_GetIdleCount(cache) == 0);
+				CheckCPUIsReset(reused);
+				CHECK(GetMemoryWord(reused, 6) == 0);
+
+				RunToCompletion(reused);
+				CHECK(GetMemoryWord(reused, 4) == 9);
+
+				V2MP_VMCache_Recycle(cache, reused);
+			}
+
+			AND_THEN("A VM acquired without a program has been reset")
+			{
+				V2MP_VirtualMachine* reused = V2MP_VMCache_Acquire(cache);
+
+				REQUIRE(reused == vm);
+				CheckCPUIsReset(reused);
+				CHECK(GetMemoryWord(reused, 4) == 0);
+
+				V2MP_VMCache_Recycle(cache, reused);
+			}
+		}
+
+		AND_WHEN("VMs that last ran different images are recycled")
+		{
+			V2MP_VirtualMachine* first = V2MP_VMCache_AcquireWithProgramImage(cache, image, ds, 3, SS_WORDS);
+			V2MP_VirtualMachine* second = V2MP_VMCache_AcquireWithProgramImage(cache, otherImage, ds, 3, SS_WORDS);
+			REQUIRE(first);
+			REQUIRE(second);
+			REQUIRE(first != second);
+
+			V2MP_VMCache_Recycle(cache, first);
+			V2MP_VMCache_Recycle(cache, second);
+
+			THEN("A VM that last ran the requested image is preferred")
+			{
+				V2MP_VirtualMachine* vm = V2MP_VMCache_AcquireWithProgramImage(cache, image, ds, 3, SS_WORDS);
+				CHECK(vm == first);
+				V2MP_VMCache_Recycle(cache, vm);
+			}
+		}
+
+		AND_WHEN("More VMs are recycled than the cache can hold")
+		{
+			std::vector<V2MP_VirtualMachine*> vms;
+
+			for ( size_t index = 0; index < 3; ++index )
+			{
+				vms.push_back(V2MP_VMCache_Acquire(cache));
+				REQUIRE(vms.back());
+			}
+
+			for ( V2MP_VirtualMachine* vm : vms )
+			{
+				V2MP_VMCache_Recycle(cache, vm);
+			}
+
+			THEN("The extra VMs are freed")
+			{
+				CHECK(V2MP_VMCache_GetIdleCount(cache) == 2);
+			}
+		}
+
+		AND_WHEN("A VM whose memory has been reallocated is recycled")
+		{
+			V2MP_VirtualMachine* vm = V2MP_VMCache_Acquire(cache);
+			REQUIRE(vm);
+			REQUIRE(V2MP_VirtualMachine_AllocateTotalMemory(vm, 2 * MEMORY_BYTES));
+
+			V2MP_VMCache_Recycle(cache, vm);
+
+			THEN("The VM is freed instead of being held")
+			{
+				CHECK(V2MP_VMCache_GetIdleCount(cache) == 0);
+			}
+		}
+
+		V2MP_VMCache_DeinitAndFree(cache);
+		V2MP_ProgramImage_Release(otherImage);
+		V2MP_ProgramImage_Release(image);
+	}
+
+	GIVEN("An odd memory size")
+	{
+		THEN("A VM cache cannot be created")
+		{
+			CHECK_FALSE(V2MP_VMCache_AllocateAndInit(MEMORY_BYTES + 1, 2));
+		}
+	}
+}
+
+SCENARIO("Reusing VMs: Data pages added during a previous run are cleared when the VM is recycled", "[execution]")
+{
+	GIVEN("A VM from a cache that has run a program on a partly initialised data page")
+	{
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(SWAP_CS, sizeof(SWAP_CS) / sizeof(SWAP_CS[0]));
+		REQUIRE(image);
+
+		V2MP_VMCache* cache = V2MP_VMCache_AllocateAndInit(MEMORY_BYTES, 1);
+		REQUIRE(cache);
+
+		const V2MP_Word ds[] = { 7, 0, 0 };
+		V2MP_VirtualMachine* vm = V2MP_VMCache_AcquireWithProgramImage(cache, image, ds, 3, SS_WORDS);
+		REQUIRE(vm);
+
+		V2MP_Supervisor* supervisor = V2MP_VirtualMachine_GetSupervisor(vm);
+
+		// The page follows the stack segment, and only its first two words are initialised.
+		const size_t pageBase = sizeof(ds) + (SS_WORDS * sizeof(V2MP_Word));
+		const size_t pageLengthInWords = 4;
+		const V2MP_Word pageData[] = { 0x1234, 0x5678 };
+		REQUIRE(V2MP_Supervisor_AddDataPage(supervisor, pageData, 2, pageLengthInWords, nullptr));
+
+		RunToCompletion(vm);
+
+		REQUIRE(V2MP_CPU_GetR1(GetCPU(vm)) == 0x1234);
+		REQUIRE(V2MP_Supervisor_GetActiveDataPage(supervisor) == 1);
+
+		V2MP_VMCache_Recycle(cache, vm);
+
+		WHEN("The VM is acquired again")
+		{
+			V2MP_VirtualMachine* reused = V2MP_VMCache_Acquire(cache);
+			REQUIRE(reused == vm);
+
+			THEN("The data page is cleared, and the data segment is page 0 again")
+			{
+				CheckCPUIsReset(reused);
+				CHECK(V2MP_Supervisor_GetDataPageCount(supervisor) == 1);
+				CHECK(V2MP_Supervisor_GetActiveDataPage(supervisor) == 0);
+
+				for ( size_t address = pageBase; address < pageBase + sizeof(pageData); address += sizeof(V2MP_Word) )
+				{
+					INFO("Address " << address);
+					CHECK(GetMemoryWord(reused, address) == 0);
+				}
+			}
+
+			V2MP_VMCache_Recycle(cache, reused);
+		}
+
+		AND_WHEN("The VM is acquired again with a stack segment that covers the old data page")
+		{
+			const size_t ssWords = SS_WORDS + pageLengthInWords;
+			V2MP_VirtualMachine* reused = V2MP_VMCache_AcquireWithProgramImage(cache, image, ds, 3, ssWords);
+			REQUIRE(reused == vm);
+
+			THEN("No data from the previous run is visible in the stack segment")
+			{
+				for ( size_t address = sizeof(ds); address < pageBase + sizeof(pageData); address += sizeof(V2MP_Word) )
+				{
+					INFO("Address " << address);
+					CHECK(GetMemoryWord(reused, address) == 0);
+				}
+			}
+
+			V2MP_VMCache_Recycle(cache, reused);
+		}
+
+		V2MP_VMCache_DeinitAndFree(cache);
+		V2MP_ProgramImage_Release(image);
+	}
+}
@@ -0,0 +1,523 @@
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include "catch2/catch.hpp"
+#include "Helpers/TestHarnessVM.h"
+#include "Helpers/TestPrograms.h"
+#include "TestUtil/Assembly.h"
+#include "LibV2MP/Modules/ProgramImage.h"
+#include "LibV2MP/Modules/VMPool.h"
+
+namespace
+{
+	namespace SumDS = TestPrograms::SumDS;
+
+	static constexpr size_t SS_WORDS = 4;
+	static constexpr size_t NUM_VMS = 37;
+	static constexpr size_t NUM_THREADS = 4;
+
+	// Each VM sums a different set of values.
+	std::vector<V2MP_Word> DSForVM(size_t index)
+	{
+		return std::vector<V2MP_Word>({ static_cast<V2MP_Word>(index), 1, 2, 3, 0 });
+	}
+
+	V2MP_Word ExpectedSumForVM(size_t index)
+	{
+		return static_cast<V2MP_Word>(index + 6);
+	}
+
+	// Counts R0 down from the first word of the data segment, so that
+	// the number of cycles a VM runs for is set by its data.
+	static const V2MP_Word COUNTDOWN_CS[] =
+	{
+		Asm::ASGNL(Asm::REG_LR, 0),
+		Asm::LOAD(Asm::REG_R0),
+		Asm::SUBL(Asm::REG_R0, 1),
+		Asm::BXZL(1),
+		Asm::SUBL(Asm::REG_PC, 3),
+		Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+		Asm::SIG()
+	};
+
+	static constexpr size_t COUNTDOWN_CS_WORDS = sizeof(COUNTDOWN_CS) / sizeof(COUNTDOWN_CS[0]);
+
+	static const V2MP_VMPool_Scheduler SCHEDULERS[] =
+	{
+		V2MP_VMPOOL_SCHEDULER_CONTIGUOUS,
+		V2MP_VMPOOL_SCHEDULER_ROUND_ROBIN,
+		V2MP_VMPOOL_SCHEDULER_WORK_STEALING
+	};
+
+	V2MP_CPU* GetCPU(V2MP_VMPool* pool, size_t index)
+	{
+		return V2MP_Mainboard_GetCPU(V2MP_VirtualMachine_GetMainboard(V2MP_VMPool_GetVM(pool, index)));
+	}
+
+	size_t GetCyclesForSingleRun(const V2MP_Word* csData, size_t csWords, const std::vector<V2MP_Word>& ds)
+	{
+		const std::vector<V2MP_Word> cs(csData, csData + csWords);
+
+		TestHarnessVM vm;
+		TestHarnessVM::ProgramDef prog;
+		prog.SetCSAndDS(cs, ds);
+		prog.SetStackSize(SS_WORDS);
+
+		REQUIRE(vm.LoadProgram(prog));
+
+		V2MP_RunResult result {};
+		REQUIRE(vm.Run(100000, result));
+		REQUIRE(result.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+
+		return result.cyclesExecuted;
+	}
+
+	size_t GetCyclesForSingleRun()
+	{
+		return GetCyclesForSingleRun(SumDS::CS, SumDS::CS_WORDS, DSForVM(0));
+	}
+
+	// Most VMs count down from a small number, but every seventh
+	// one runs for far longer, and they are clustered at the start.
+	V2MP_Word CountdownForVM(size_t index)
+	{
+		return static_cast<V2MP_Word>((index % 7 == 0 || index < 4) ? 500 : 1 + (index % 5));
+	}
+}
+
+SCENARIO("VM pool: Every VM in the pool is run on each tick", "[execution]")
+{
+	GIVEN("A pool of VMs, each loaded with a program that sums different data")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, NUM_THREADS);
+		REQUIRE(pool);
+
+		REQUIRE(V2MP_VMPool_GetVMCount(pool) == NUM_VMS);
+		REQUIRE(V2MP_VMPool_GetThreadCount(pool) == NUM_THREADS);
+
+		for ( size_t index = 0; index < NUM_VMS; ++index )
+		{
+			const std::vector<V2MP_Word> ds = DSForVM(index);
+
+			REQUIRE(V2MP_VirtualMachine_LoadProgram(
+				V2MP_VMPool_GetVM(pool, index),
+				SumDS::CS,
+				SumDS::CS_WORDS,
+				ds.data(),
+				ds.size(),
+				SS_WORDS
+			));
+		}
+
+		const size_t cyclesForSingleRun = GetCyclesForSingleRun();
+
+		WHEN("A tick is run with a cycle quantum long enough for the programs to finish")
+		{
+			REQUIRE(V2MP_VMPool_RunTick(pool, 1000));
+
+			THEN("Every program exits with its own result, taking the same cycles as a single run")
+			{
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					const V2MP_VMPool_Result* result = V2MP_VMPool_GetResult(pool, index);
+					REQUIRE(result);
+
+					CHECK_FALSE(result->runFailed);
+					CHECK(result->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(result->runResult.cyclesExecuted == cyclesForSingleRun);
+					CHECK(V2MP_CPU_GetR1(GetCPU(pool, index)) == ExpectedSumForVM(index));
+				}
+			}
+
+			AND_THEN("Running another tick executes no further cycles")
+			{
+				REQUIRE(V2MP_VMPool_RunTick(pool, 1000));
+
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					const V2MP_VMPool_Result* result = V2MP_VMPool_GetResult(pool, index);
+
+					CHECK(result->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(result->runResult.cyclesExecuted == 0);
+				}
+			}
+		}
+
+		AND_WHEN("Ticks are run with a short cycle quantum until every program has finished")
+		{
+			static constexpr size_t QUANTUM = 5;
+
+			std::vector<size_t> totalCycles(NUM_VMS, 0);
+			size_t numTicks = 0;
+			bool allExited = false;
+
+			while ( !allExited && numTicks < cyclesForSingleRun )
+			{
+				REQUIRE(V2MP_VMPool_RunTick(pool, QUANTUM));
+				++numTicks;
+				allExited = true;
+
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					const V2MP_VMPool_Result* result = V2MP_VMPool_GetResult(pool, index);
+
+					REQUIRE_FALSE(result->runFailed);
+					REQUIRE(result->runResult.cyclesExecuted <= QUANTUM);
+
+					totalCycles[index] += result->runResult.cyclesExecuted;
+					allExited = allExited && result->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED;
+				}
+			}
+
+			THEN("Every program finishes after the same number of cycles as a single run")
+			{
+				REQUIRE(allExited);
+				CHECK(numTicks == (cyclesForSingleRun + QUANTUM - 1) / QUANTUM);
+
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					CHECK(totalCycles[index] == cyclesForSingleRun);
+					CHECK(V2MP_CPU_GetR1(GetCPU(pool, index)) == ExpectedSumForVM(index));
+				}
+			}
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+	}
+}
+
+SCENARIO("VM pool: Every scheduler runs each VM exactly once per tick", "[execution]")
+{
+	for ( V2MP_VMPool_Scheduler scheduler : SCHEDULERS )
+	{
+		GIVEN("A pool of VMs with very uneven amounts of work, using scheduler " + std::to_string(scheduler))
+		{
+			V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, NUM_THREADS);
+			REQUIRE(pool);
+			REQUIRE(V2MP_VMPool_SetScheduler(pool, scheduler));
+			REQUIRE(V2MP_VMPool_GetScheduler(pool) == scheduler);
+
+			for ( size_t index = 0; index < NUM_VMS; ++index )
+			{
+				const V2MP_Word ds[] = { CountdownForVM(index) };
+
+				REQUIRE(V2MP_VirtualMachine_LoadProgram(
+					V2MP_VMPool_GetVM(pool, index),
+					COUNTDOWN_CS,
+					COUNTDOWN_CS_WORDS,
+					ds,
+					1,
+					0
+				));
+			}
+
+			WHEN("A tick is run")
+			{
+				REQUIRE(V2MP_VMPool_RunTick(pool, 100000));
+
+				THEN("Every program exits, taking the same cycles as a single run")
+				{
+					for ( size_t index = 0; index < NUM_VMS; ++index )
+					{
+						const V2MP_VMPool_Result* result = V2MP_VMPool_GetResult(pool, index);
+						const size_t expectedCycles = GetCyclesForSingleRun(
+							COUNTDOWN_CS,
+							COUNTDOWN_CS_WORDS,
+							std::vector<V2MP_Word>({ CountdownForVM(index) })
+						);
+
+						CHECK_FALSE(result->runFailed);
+						CHECK(result->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+						CHECK(result->runResult.cyclesExecuted == expectedCycles);
+					}
+				}
+			}
+
+			V2MP_VMPool_DeinitAndFree(pool);
+		}
+	}
+}
+
+SCENARIO("VM pool: The scheduler can be changed", "[execution]")
+{
+	GIVEN("A newly created pool")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, NUM_THREADS);
+		REQUIRE(pool);
+
+		THEN("The work-stealing scheduler is used by default")
+		{
+			CHECK(V2MP_VMPool_GetScheduler(pool) == V2MP_VMPOOL_SCHEDULER_WORK_STEALING);
+		}
+
+		AND_WHEN("An invalid scheduler is set")
+		{
+			const bool set = V2MP_VMPool_SetScheduler(pool, static_cast<V2MP_VMPool_Scheduler>(1000));
+
+			THEN("The scheduler is not changed")
+			{
+				CHECK_FALSE(set);
+				CHECK(V2MP_VMPool_GetScheduler(pool) == V2MP_VMPOOL_SCHEDULER_WORK_STEALING);
+			}
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+	}
+}
+
+SCENARIO("VM pool: VMs on different threads can share a program image", "[execution]")
+{
+	GIVEN("A pool of VMs, all loaded from the same program image")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, NUM_THREADS);
+		REQUIRE(pool);
+
+		V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(SumDS::CS, SumDS::CS_WORDS);
+		REQUIRE(image);
+
+		for ( size_t index = 0; index < NUM_VMS; ++index )
+		{
+			const std::vector<V2MP_Word> ds = DSForVM(index);
+
+			REQUIRE(V2MP_VirtualMachine_LoadProgramImage(
+				V2MP_VMPool_GetVM(pool, index),
+				image,
+				ds.data(),
+				ds.size(),
+				SS_WORDS
+			));
+		}
+
+		REQUIRE(V2MP_ProgramImage_GetRefCount(image) == NUM_VMS + 1);
+
+		WHEN("A tick is run")
+		{
+			REQUIRE(V2MP_VMPool_RunTick(pool, 1000));
+
+			THEN("Every program exits with its own result")
+			{
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					CHECK(V2MP_VMPool_GetResult(pool, index)->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					CHECK(V2MP_CPU_GetR1(GetCPU(pool, index)) == ExpectedSumForVM(index));
+				}
+			}
+
+			AND_THEN("Freeing the pool releases every VM's reference to the image")
+			{
+				V2MP_VMPool_DeinitAndFree(pool);
+				pool = nullptr;
+
+				CHECK(V2MP_ProgramImage_GetRefCount(image) == 1);
+			}
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+		V2MP_ProgramImage_Release(image);
+	}
+}
+
+SCENARIO("VM pool: A fault in one VM does not affect the others", "[execution]")
+{
+	GIVEN("A pool in which one VM runs a program that faults")
+	{
+		static constexpr size_t FAULTING_VM = 3;
+
+		static const V2MP_Word FAULTING_CS[] =
+		{
+			Asm::ASGNL(Asm::REG_LR, 1),
+			Asm::LOAD(Asm::REG_R0)
+		};
+
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, NUM_THREADS);
+		REQUIRE(pool);
+
+		for ( size_t index = 0; index < NUM_VMS; ++index )
+		{
+			const std::vector<V2MP_Word> ds = DSForVM(index);
+			const bool faults = index == FAULTING_VM;
+
+			REQUIRE(V2MP_VirtualMachine_LoadProgram(
+				V2MP_VMPool_GetVM(pool, index),
+				faults ? FAULTING_CS : SumDS::CS,
+				faults ? sizeof(FAULTING_CS) / sizeof(FAULTING_CS[0]) : SumDS::CS_WORDS,
+				ds.data(),
+				ds.size(),
+				SS_WORDS
+			));
+		}
+
+		WHEN("A tick is run")
+		{
+			REQUIRE(V2MP_VMPool_RunTick(pool, 1000));
+
+			THEN("Only the faulting VM reports a fault")
+			{
+				for ( size_t index = 0; index < NUM_VMS; ++index )
+				{
+					const V2MP_VMPool_Result* result = V2MP_VMPool_GetResult(pool, index);
+
+					if ( index == FAULTING_VM )
+					{
+						CHECK(result->runResult.stopReason == V2MP_RUNSTOP_FAULT);
+						CHECK(result->runResult.cyclesExecuted == 2);
+						CHECK(Asm::FaultFromWord(V2MP_CPU_GetFaultWord(GetCPU(pool, index))) == V2MP_FAULT_ALGN);
+					}
+					else
+					{
+						CHECK(result->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+						CHECK(V2MP_CPU_GetR1(GetCPU(pool, index)) == ExpectedSumForVM(index));
+					}
+				}
+			}
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+	}
+}
+
+SCENARIO("VM pool: The number of threads is chosen sensibly", "[execution]")
+{
+	GIVEN("A pool that is created with a thread count of 0")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(NUM_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, 0);
+		REQUIRE(pool);
+
+		THEN("At least one thread is started")
+		{
+			CHECK(V2MP_VMPool_GetThreadCount(pool) >= 1);
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+	}
+
+	GIVEN("A pool that is created with more threads than VMs")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(2, TestHarnessVM::DEFAULT_RAM_BYTES, 8);
+		REQUIRE(pool);
+
+		THEN("Only one thread is started per VM")
+		{
+			CHECK(V2MP_VMPool_GetThreadCount(pool) == 2);
+		}
+
+		V2MP_VMPool_DeinitAndFree(pool);
+	}
+
+	GIVEN("A pool that is created with no VMs")
+	{
+		V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(0, TestHarnessVM::DEFAULT_RAM_BYTES, 2);
+
+		THEN("The pool is not created")
+		{
+			CHECK_FALSE(pool);
+		}
+	}
+}
+
+// Hidden by default, since it takes a while and only prints its results.
+// Run it on its own with the tag [benchmark], ideally in a release build.
+// The thread counts to compare are given as a comma-separated list in the
+// V2MP_BENCHMARK_THREADS environment variable, eg. "1,2,4,8". By default,
+// there is one thread per core.
+SCENARIO("VM pool: Tick latency of each scheduler for a skewed workload", "[.][benchmark]")
+{
+	static constexpr size_t BENCHMARK_VMS = 10000;
+	static constexpr size_t BENCHMARK_TICKS = 30;
+
+	std::vector<size_t> threadCounts;
+
+	if ( const char* threadList = std::getenv("V2MP_BENCHMARK_THREADS") )
+	{
+		std::istringstream stream(threadList);
+		std::string item;
+
+		while ( std::getline(stream, item, ',') )
+		{
+			threadCounts.push_back(static_cast<size_t>(std::stoul(item)));
+		}
+	}
+
+	if ( threadCounts.empty() )
+	{
+		threadCounts.push_back(0);
+	}
+
+	V2MP_ProgramImage* image = V2MP_ProgramImage_AllocateAndInit(COUNTDOWN_CS, COUNTDOWN_CS_WORDS);
+	REQUIRE(image);
+
+	// Fixed seed, so that each run of the benchmark has the same workload.
+	std::vector<V2MP_Word> countdowns(BENCHMARK_VMS);
+	uint32_t random = 12345;
+
+	for ( V2MP_Word& countdown : countdowns )
+	{
+		random = (random * 1103515245u) + 12345u;
+		const uint32_t value = random >> 8;
+
+		countdown = static_cast<V2MP_Word>(value % 200 == 0 ? 20000 + (value % 40000) : 1 + (value % 100));
+	}
+
+	for ( size_t threadCount : threadCounts )
+	{
+		GIVEN("A pool of VMs in which a few run for thousands of times longer than the rest, with " +
+		      (threadCount > 0 ? std::to_string(threadCount) : std::string("one per core")) + " threads")
+		{
+			V2MP_VMPool* pool = V2MP_VMPool_AllocateAndInit(BENCHMARK_VMS, TestHarnessVM::DEFAULT_RAM_BYTES, threadCount);
+			REQUIRE(pool);
+
+			WHEN("Ticks are run with each scheduler, reloading the programs before each tick")
+			{
+				for ( V2MP_VMPool_Scheduler scheduler : SCHEDULERS )
+				{
+					REQUIRE(V2MP_VMPool_SetScheduler(pool, scheduler));
+
+					std::vector<double> tickMs;
+
+					for ( size_t tick = 0; tick < BENCHMARK_TICKS; ++tick )
+					{
+						for ( size_t index = 0; index < BENCHMARK_VMS; ++index )
+						{
+							V2MP_VirtualMachine* vm = V2MP_VMPool_GetVM(pool, index);
+
+							V2MP_CPU_Reset(V2MP_Mainboard_GetCPU(V2MP_VirtualMachine_GetMainboard(vm)));
+							REQUIRE(V2MP_VirtualMachine_LoadProgramImage(vm, image, &countdowns[index], 1, 0));
+						}
+
+						const auto start = std::chrono::steady_clock::now();
+						REQUIRE(V2MP_VMPool_RunTick(pool, 1000000));
+						const auto end = std::chrono::steady_clock::now();
+
+						tickMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+					}
+
+					std::sort(tickMs.begin(), tickMs.end());
+
+					std::cout
+						<< "Scheduler " << scheduler
+						<< " (" << V2MP_VMPool_GetThreadCount(pool) << " threads, " << BENCHMARK_VMS << " VMs): "
+						<< "median " << tickMs[tickMs.size() / 2] << "ms, "
+						<< "p90 " << tickMs[(tickMs.size() * 9) / 10] << "ms, "
+						<< "max " << tickMs.back() << "ms"
+						<< std::endl;
+				}
+
+				THEN("Every program has exited")
+				{
+					for ( size_t index = 0; index < BENCHMARK_VMS; ++index )
+					{
+						CHECK(V2MP_VMPool_GetResult(pool, index)->runResult.stopReason == V2MP_RUNSTOP_PROGRAM_EXITED);
+					}
+				}
+			}
+
+			V2MP_VMPool_DeinitAndFree(pool);
+		}
+	}
+
+	V2MP_ProgramImage_Release(image);
+}
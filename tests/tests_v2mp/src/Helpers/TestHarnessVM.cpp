@@ -1,5 +1,6 @@
 #include <vector>
 #include <cstring>
+#include "catch2/catch.hpp"
 #include "Helpers/TestHarnessVM.h"
 #include "LibSharedComponents/CircularBuffer.h"
 #include "LibV2MP/Modules/Supervisor.h"
@@ -14,12 +15,78 @@ TestHarnessVM::TestHarnessVM(size_t totalRamInBytes)
 	ThrowExceptionIfNotInitialisedCorrectly(totalRamInBytes);
 }
 
+TestHarnessVM::TestHarnessVM(V2MP_VirtualMachine* vm) :
+	m_VM(vm)
+{
+	ThrowExceptionIfNotInitialisedCorrectly(V2MP_VirtualMachine_GetTotalMemoryBytes(m_VM));
+}
+
 TestHarnessVM::~TestHarnessVM()
 {
 	V2MP_VirtualMachine_DeinitAndFree(m_VM);
 	m_VM = nullptr;
 }
 
+TestHarnessVM::RunOutcome TestHarnessVM::RunProgram(
+	const ProgramDef& prog,
+	size_t maxCycles,
+	const std::function<void(TestHarnessVM&)>& configure
+)
+{
+	TestHarnessVM vm;
+	configure(vm);
+
+	RunOutcome outcome;
+
+	REQUIRE(vm.LoadProgram(prog));
+	REQUIRE(vm.Run(maxCycles, outcome.result));
+
+	outcome.r0 = vm.GetR0();
+	outcome.r1 = vm.GetR1();
+	outcome.lr = vm.GetLR();
+	outcome.pc = vm.GetPC();
+	outcome.sr = vm.GetSR();
+	outcome.ir = vm.GetIR();
+	outcome.sp = vm.GetSP();
+	outcome.fault = vm.GetCPUFaultWord();
+	outcome.exited = vm.HasProgramExited();
+
+	if ( prog.GetDSWords() > 0 )
+	{
+		REQUIRE(vm.GetDSData(0, prog.GetDSWords() * sizeof(V2MP_Word), outcome.ds));
+	}
+
+	return outcome;
+}
+
+void TestHarnessVM::CheckOutcomesMatch(const RunOutcome& first, const RunOutcome& second)
+{
+	CHECK(first.result.stopReason == second.result.stopReason);
+	CHECK(first.result.cyclesExecuted == second.result.cyclesExecuted);
+	CHECK(first.r0 == second.r0);
+	CHECK(first.r1 == second.r1);
+	CHECK(first.lr == second.lr);
+	CHECK(first.pc == second.pc);
+	CHECK(first.sr == second.sr);
+	CHECK(first.ir == second.ir);
+	CHECK(first.sp == second.sp);
+	CHECK(first.fault == second.fault);
+	CHECK(first.exited == second.exited);
+	CHECK(first.ds == second.ds);
+}
+
+std::unique_ptr<TestHarnessVM> TestHarnessVM::Fork()
+{
+	V2MP_VirtualMachine* child = V2MP_VirtualMachine_Fork(m_VM);
+
+	if ( !child )
+	{
+		return std::unique_ptr<TestHarnessVM>();
+	}
+
+	return std::unique_ptr<TestHarnessVM>(new TestHarnessVM(child));
+}
+
 V2MP_Mainboard* TestHarnessVM::GetMainboard()
 {
 	return V2MP_VirtualMachine_GetMainboard(m_VM);
@@ -160,6 +227,16 @@ bool TestHarnessVM::Execute(V2MP_Word instruction)
 	return V2MP_Supervisor_ExecuteSingleInstruction(GetSupervisor(), instruction);
 }
 
+bool TestHarnessVM::Run(size_t maxCycles, V2MP_RunResult& outResult)
+{
+	return V2MP_VirtualMachine_Run(m_VM, maxCycles, &outResult);
+}
+
+void TestHarnessVM::SetBlockTranslationEnabled(bool enabled)
+{
+	V2MP_VirtualMachine_SetBlockTranslationEnabled(m_VM, enabled);
+}
+
 bool TestHarnessVM::HasProgramExited() const
 {
 	return V2MP_Supervisor_HasProgramExited(GetSupervisor());
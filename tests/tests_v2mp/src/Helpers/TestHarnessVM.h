@@ -2,6 +2,7 @@
 
 #include <stdexcept>
 #include <vector>
+#include <functional>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
@@ -132,6 +133,23 @@ public:
 		std::vector<V2MP_Word> m_DSFill;
 	};
 
+	// The state of a VM after running a program, so that runs of
+	// the same program in different configurations can be compared.
+	struct RunOutcome
+	{
+		V2MP_RunResult result {};
+		V2MP_Word r0 = 0;
+		V2MP_Word r1 = 0;
+		V2MP_Word lr = 0;
+		V2MP_Word pc = 0;
+		V2MP_Word sr = 0;
+		V2MP_Word ir = 0;
+		V2MP_Word sp = 0;
+		V2MP_Word fault = 0;
+		bool exited = false;
+		std::vector<V2MP_Byte> ds;
+	};
+
 	class InitException : public std::runtime_error
 	{
 	public:
@@ -149,6 +167,21 @@ public:
 	TestHarnessVM& operator =(const TestHarnessVM& other) = delete;
 	TestHarnessVM& operator =(TestHarnessVM&& other) = delete;
 
+	// Creates a VM, passes it to the configure function, and then loads the
+	// program and runs it for at most maxCycles. Loading and running must succeed.
+	static RunOutcome RunProgram(
+		const ProgramDef& prog,
+		size_t maxCycles,
+		const std::function<void(TestHarnessVM&)>& configure
+	);
+
+	// Checks that the run results, registers, fault and data segment are the same.
+	static void CheckOutcomesMatch(const RunOutcome& first, const RunOutcome& second);
+
+	// Returns a harness that owns a fork of this harness's VM,
+	// or null if the VM could not be forked.
+	std::unique_ptr<TestHarnessVM> Fork();
+
 	V2MP_Mainboard* GetMainboard();
 	const V2MP_Mainboard* GetMainboard() const;
 
@@ -188,6 +221,8 @@ public:
 
 	void ResetCPU();
 	bool Execute(V2MP_Word instruction);
+	bool Run(size_t maxCycles, V2MP_RunResult& outResult);
+	void SetBlockTranslationEnabled(bool enabled);
 
 	bool HasProgramExited() const;
 	V2MP_Word GetProgramExitCode() const;
@@ -204,6 +239,9 @@ protected:
 	}
 
 private:
+	// Takes ownership of the VM.
+	explicit TestHarnessVM(V2MP_VirtualMachine* vm);
+
 	void ThrowExceptionIfNotInitialisedCorrectly(size_t totalRamInBytes);
 
 	V2MP_VirtualMachine* m_VM;
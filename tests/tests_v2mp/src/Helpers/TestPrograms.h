@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include "LibV2MP/Defs.h"
+#include "TestUtil/Assembly.h"
+
+// Programs that are run by more than one set of tests.
+namespace TestPrograms
+{
+	// Sums the data segment, storing each partial sum to
+	// the last word of the data segment via the stack.
+	namespace SumDS
+	{
+		inline constexpr V2MP_Word CS[] =
+		{
+			Asm::ASGNL(Asm::REG_LR, 0),
+			Asm::ASGNL(Asm::REG_R1, 0),
+			Asm::LOAD(Asm::REG_R0),
+			Asm::ADDR(Asm::REG_R0, Asm::REG_R1),
+			Asm::PUSH(1 << Asm::REG_LR),
+			Asm::ASGNL(Asm::REG_LR, 8),
+			Asm::STOR(Asm::REG_R1),
+			Asm::POP(1 << Asm::REG_LR),
+			Asm::ADDL(Asm::REG_LR, 2),
+			Asm::ASGNR(Asm::REG_LR, Asm::REG_R0),
+			Asm::SUBL(Asm::REG_R0, 8),
+			Asm::BXZL(1),
+			Asm::SUBL(Asm::REG_PC, 11),
+			Asm::IASGNL(Asm::REG_R0, V2MP_SIGNAL_END_PROGRAM),
+			Asm::SIG()
+		};
+
+		// The program always sums the first four words,
+		// and stores the partial sums to the fifth.
+		inline constexpr V2MP_Word DS[] = { 5, 6, 7, 8, 0 };
+
+		inline constexpr size_t CS_WORDS = sizeof(CS) / sizeof(CS[0]);
+		inline constexpr size_t DS_WORDS = sizeof(DS) / sizeof(DS[0]);
+
+		// Enough for the one word that the program pushes.
+		inline constexpr size_t SS_WORDS = 4;
+
+		inline constexpr V2MP_Word PARTIAL_SUM_ADDRESS = 8;
+		inline constexpr V2MP_Word SUM = 26;
+	}
+}